@@ -1,7 +1,7 @@
 /****************************************************************************
  * drivers/bch/bch.h
  *
- *   Copyright (C) 2008-2009, 2014-2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2008-2009, 2014-2015, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -52,25 +52,64 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_BCH_CACHE_NSECTORS
+#  define CONFIG_BCH_CACHE_NSECTORS 1
+#endif
+
+#ifndef CONFIG_BCH_READAHEAD
+#  define CONFIG_BCH_READAHEAD 0
+#endif
+
+#if CONFIG_BCH_READAHEAD > CONFIG_BCH_CACHE_NSECTORS
+#  error CONFIG_BCH_READAHEAD may not exceed CONFIG_BCH_CACHE_NSECTORS
+#endif
+
+/* Read-ahead reads a group of CONFIG_BCH_READAHEAD adjacent cache lines */
+
+#if CONFIG_BCH_READAHEAD > 1
+#  define BCH_RAGROUPS (CONFIG_BCH_CACHE_NSECTORS / CONFIG_BCH_READAHEAD)
+#endif
+
+/* Helpers ******************************************************************/
+
 #define bchlib_semgive(d) sem_post(&(d)->sem)  /* To match bchlib_semtake */
 #define MAX_OPENCNT     (255)                  /* Limit of uint8_t */
 
+/* The sector buffer of cache line 'l' */
+
+#define bchlib_linebuffer(d,l) (&(d)->buffer[(size_t)(l) * (d)->sectsize])
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
 
+/* One sector in the cache */
+
+struct bchlib_line_s
+{
+  size_t sector;           /* The sector in the line ((size_t)-1: none) */
+  uint32_t age;            /* Value of the LRU clock at the last access */
+  bool dirty;              /* true: Data has been written to the line */
+};
+
 struct bchlib_s
 {
   FAR struct inode *inode; /* I-node of the block driver */
   uint32_t sectsize;       /* The size of one sector on the device */
   size_t nsectors;         /* Number of sectors supported by the device */
-  size_t sector;           /* The current sector in the buffer */
   sem_t sem;               /* For atomic accesses to this structure */
   uint8_t refs;            /* Number of references */
-  bool dirty;              /* true: Data has been written to the buffer */
   bool readonly;           /* true: Only read operations are supported */
   bool unlinked;           /* true: The driver has been unlinked */
-  FAR uint8_t *buffer;     /* One sector buffer */
+  uint32_t clock;          /* LRU clock, advanced on each cache access */
+#if CONFIG_BCH_READAHEAD > 1
+  size_t ranext;           /* Sector that would continue a sequential read */
+#endif
+  FAR uint8_t *buffer;     /* CONFIG_BCH_CACHE_NSECTORS sector buffers */
+
+  struct bchlib_line_s line[CONFIG_BCH_CACHE_NSECTORS];
 
 #if defined(CONFIG_BCH_ENCRYPTION)
   uint8_t key[CONFIG_BCH_ENCRYPTION_KEY_SIZE];  /* Encryption key */
@@ -96,8 +135,13 @@ EXTERN const struct file_operations bch_fops;
  ****************************************************************************/
 
 EXTERN void bchlib_semtake(FAR struct bchlib_s *bch);
-EXTERN int  bchlib_flushsector(FAR struct bchlib_s *bch);
+EXTERN void bchlib_initcache(FAR struct bchlib_s *bch);
+EXTERN int  bchlib_flushcache(FAR struct bchlib_s *bch);
 EXTERN int  bchlib_readsector(FAR struct bchlib_s *bch, size_t sector);
+EXTERN void bchlib_invalidate(FAR struct bchlib_s *bch, size_t sector,
+                              size_t nsectors);
+EXTERN void bchlib_overlay(FAR struct bchlib_s *bch, FAR uint8_t *buffer,
+                           size_t sector, size_t nsectors);
 
 #undef EXTERN
 #if defined(__cplusplus)
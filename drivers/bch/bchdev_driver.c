@@ -152,7 +152,7 @@ static int bch_close(FAR struct file *filep)
   /* Flush any dirty pages remaining in the cache */
 
   bchlib_semtake(bch);
-  (void)bchlib_flushsector(bch);
+  (void)bchlib_flushcache(bch);
 
   /* Decrement the reference count (I don't use bchlib_decref() because I
    * want the entire close operation to be atomic wrt other driver
@@ -355,7 +355,14 @@ static int bch_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 
   else if (cmd == DIOC_SETKEY)
     {
+      /* Sectors in the cache were decrypted with the old key */
+
+      bchlib_semtake(bch);
+      (void)bchlib_flushcache(bch);
+      bchlib_initcache(bch);
+
       memcpy(bch->key, (FAR void *)arg, CONFIG_BCH_ENCRYPTION_KEY_SIZE);
+      bchlib_semgive(bch);
       ret = OK;
     }
 #endif
@@ -40,7 +40,9 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include <errno.h>
 #include <assert.h>
 #include <debug.h>
@@ -74,10 +76,11 @@ static void bch_xor(uint32_t *R, uint32_t *A, uint32_t *B)
  ****************************************************************************/
 
 #if defined(CONFIG_BCH_ENCRYPTION)
-static int bch_cypher(FAR struct bchlib_s *bch, int encrypt)
+static int bch_cypher(FAR struct bchlib_s *bch, FAR uint8_t *sectbuf,
+                      size_t sector, int encrypt)
 {
   int blocks = bch->sectsize / 16;
-  FAR uint32_t *buffer = (FAR uint32_t *)bch->buffer;
+  FAR uint32_t *buffer = (FAR uint32_t *)sectbuf;
   int i;
 
   for (i = 0; i < blocks; i++, buffer += 16 / sizeof(uint32_t) )
@@ -85,7 +88,7 @@ static int bch_cypher(FAR struct bchlib_s *bch, int encrypt)
       uint32_t T[4];
       uint32_t X[4] =
       {
-        bch->sector, 0, 0, i
+        sector, 0, 0, i
       };
 
       aes_cypher(X, X, 16, NULL, bch->key, CONFIG_BCH_ENCRYPTION_KEY_SIZE,
@@ -104,45 +107,65 @@ static int bch_cypher(FAR struct bchlib_s *bch, int encrypt)
 #endif
 
 /****************************************************************************
- * Public Functions
+ * Name: bchlib_findline
+ *
+ * Description:
+ *   Return the index of the cache line holding 'sector' or -1 if the
+ *   sector is not in the cache.
+ *
  ****************************************************************************/
 
+static int bchlib_findline(FAR struct bchlib_s *bch, size_t sector)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_BCH_CACHE_NSECTORS; i++)
+    {
+      if (bch->line[i].sector == sector)
+        {
+          return i;
+        }
+    }
+
+  return -1;
+}
+
 /****************************************************************************
- * Name: bchlib_flushsector
+ * Name: bchlib_flushline
  *
  * Description:
- *   Flush the current contents of the sector buffer (if dirty)
- *
- * Assumptions:
- *   Caller must assume mutual exclusion
+ *   Write one cache line to the media if it is dirty.
  *
  ****************************************************************************/
 
-int bchlib_flushsector(FAR struct bchlib_s *bch)
+static int bchlib_flushline(FAR struct bchlib_s *bch, int ndx)
 {
+  FAR struct bchlib_line_s *line = &bch->line[ndx];
   FAR struct inode *inode;
+  FAR uint8_t *buffer;
   ssize_t ret = OK;
 
   /* Check if the sector has been modified and is out of synch with the
    * media.
    */
 
-  if (bch->dirty)
+  if (line->dirty)
     {
-      inode = bch->inode;
+      inode  = bch->inode;
+      buffer = bchlib_linebuffer(bch, ndx);
 
 #if defined(CONFIG_BCH_ENCRYPTION)
       /* Encrypt data as necessary */
 
-      bch_cypher(bch, CYPHER_ENCRYPT);
+      bch_cypher(bch, buffer, line->sector, CYPHER_ENCRYPT);
 #endif
 
       /* Write the sector to the media */
 
-      ret = inode->u.i_bops->write(inode, bch->buffer, bch->sector, 1);
+      ret = inode->u.i_bops->write(inode, buffer, line->sector, 1);
       if (ret < 0)
         {
-          ferr("Write failed: %d\n");
+          ferr("Write failed: %d\n", ret);
         }
 
 #if defined(CONFIG_BCH_ENCRYPTION)
@@ -150,22 +173,224 @@ int bchlib_flushsector(FAR struct bchlib_s *bch)
        * TODO: Add configuration switch for extra sector buffer
        */
 
-      bch_cypher(bch, CYPHER_DECRYPT);
+      bch_cypher(bch, buffer, line->sector, CYPHER_DECRYPT);
 #endif
 
       /* The sector is now in sync with the media */
 
-      bch->dirty = false;
+      line->dirty = false;
     }
 
   return (int)ret;
 }
 
+/****************************************************************************
+ * Name: bchlib_lruline
+ *
+ * Description:
+ *   Select the cache line to be replaced:  An unused line if there is one,
+ *   otherwise the least recently used line.
+ *
+ ****************************************************************************/
+
+static int bchlib_lruline(FAR struct bchlib_s *bch)
+{
+  uint32_t oldest = UINT32_MAX;
+  int ndx = 0;
+  int i;
+
+  for (i = 0; i < CONFIG_BCH_CACHE_NSECTORS; i++)
+    {
+      if (bch->line[i].sector == (size_t)-1)
+        {
+          return i;
+        }
+
+      if (bch->line[i].age < oldest)
+        {
+          oldest = bch->line[i].age;
+          ndx    = i;
+        }
+    }
+
+  return ndx;
+}
+
+/****************************************************************************
+ * Name: bchlib_readahead
+ *
+ * Description:
+ *   'sector' is not in the cache and continues a sequential read.  Replace
+ *   the least recently used group of CONFIG_BCH_READAHEAD adjacent cache
+ *   lines with 'sector' and the sectors that follow it, reading them all
+ *   with one request to the block driver.
+ *
+ * Returned Value:
+ *   The cache line holding 'sector' on success; a negated errno value on
+ *   failure.
+ *
+ ****************************************************************************/
+
+#if CONFIG_BCH_READAHEAD > 1
+static int bchlib_readahead(FAR struct bchlib_s *bch, size_t sector)
+{
+  FAR struct inode *inode = bch->inode;
+  FAR struct bchlib_line_s *line;
+  uint32_t oldest = UINT32_MAX;
+  uint32_t newest;
+  size_t count;
+  ssize_t ret;
+  int first = 0;
+  int group;
+  int i;
+
+  /* Find the group whose most recently used line is the oldest */
+
+  for (group = 0; group < BCH_RAGROUPS; group++)
+    {
+      newest = 0;
+      for (i = 0; i < CONFIG_BCH_READAHEAD; i++)
+        {
+          line = &bch->line[group * CONFIG_BCH_READAHEAD + i];
+          if (line->sector != (size_t)-1 && line->age > newest)
+            {
+              newest = line->age;
+            }
+        }
+
+      if (newest < oldest)
+        {
+          oldest = newest;
+          first  = group * CONFIG_BCH_READAHEAD;
+        }
+    }
+
+  /* Stop at the end of the media or at the first sector that is already
+   * cached (so that a sector is never held in two lines).
+   */
+
+  count = bch->nsectors - sector;
+  if (count > CONFIG_BCH_READAHEAD)
+    {
+      count = CONFIG_BCH_READAHEAD;
+    }
+
+  for (i = 1; i < count; i++)
+    {
+      if (bchlib_findline(bch, sector + i) >= 0)
+        {
+          count = i;
+          break;
+        }
+    }
+
+  /* Write back and release the lines of the group that will be used */
+
+  for (i = 0; i < count; i++)
+    {
+      ret = bchlib_flushline(bch, first + i);
+      if (ret < 0)
+        {
+          return (int)ret;
+        }
+
+      bch->line[first + i].sector = (size_t)-1;
+    }
+
+  ret = inode->u.i_bops->read(inode, bchlib_linebuffer(bch, first), sector,
+                              count);
+  if (ret < 0)
+    {
+      ferr("Read failed: %d\n", ret);
+      return (int)ret;
+    }
+
+  bch->clock++;
+  for (i = 0; i < count; i++)
+    {
+      line         = &bch->line[first + i];
+      line->sector = sector + i;
+      line->age    = bch->clock;
+
+#if defined(CONFIG_BCH_ENCRYPTION)
+      bch_cypher(bch, bchlib_linebuffer(bch, first + i), sector + i,
+                 CYPHER_DECRYPT);
+#endif
+    }
+
+  bch->ranext = sector + count;
+  return first;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: bchlib_initcache
+ *
+ * Description:
+ *   Mark all cache lines empty.
+ *
+ ****************************************************************************/
+
+void bchlib_initcache(FAR struct bchlib_s *bch)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_BCH_CACHE_NSECTORS; i++)
+    {
+      bch->line[i].sector = (size_t)-1;
+      bch->line[i].dirty  = false;
+    }
+
+#if CONFIG_BCH_READAHEAD > 1
+  bch->ranext = (size_t)-1;
+#endif
+}
+
+/****************************************************************************
+ * Name: bchlib_flushcache
+ *
+ * Description:
+ *   Write all dirty cache lines to the media
+ *
+ * Assumptions:
+ *   Caller must assume mutual exclusion
+ *
+ ****************************************************************************/
+
+int bchlib_flushcache(FAR struct bchlib_s *bch)
+{
+  int ret = OK;
+  int tmp;
+  int i;
+
+  for (i = 0; i < CONFIG_BCH_CACHE_NSECTORS; i++)
+    {
+      tmp = bchlib_flushline(bch, i);
+      if (tmp < 0 && ret == OK)
+        {
+          ret = tmp;
+        }
+    }
+
+  return ret;
+}
+
 /****************************************************************************
  * Name: bchlib_readsector
  *
  * Description:
- *   Flush the current contents of the sector buffer (if dirty)
+ *   Get a sector into the cache, replacing the least recently used sector
+ *   (after writing it back if it is dirty) if the sector is not already
+ *   cached.
+ *
+ * Returned Value:
+ *   The index of the cache line holding the sector on success; a negated
+ *   errno value on failure.  The sector data is then available at
+ *   bchlib_linebuffer(bch, index).
  *
  * Assumptions:
  *   Caller must assume mutual exclusion
@@ -175,25 +400,119 @@ int bchlib_flushsector(FAR struct bchlib_s *bch)
 int bchlib_readsector(FAR struct bchlib_s *bch, size_t sector)
 {
   FAR struct inode *inode;
-  ssize_t ret = OK;
+  FAR struct bchlib_line_s *line;
+  ssize_t ret;
+  int ndx;
 
-  if (bch->sector != sector)
+  /* Is the sector already in the cache? */
+
+  ndx = bchlib_findline(bch, sector);
+  if (ndx >= 0)
     {
-      inode = bch->inode;
+      bch->line[ndx].age = ++bch->clock;
+      return ndx;
+    }
 
-      (void)bchlib_flushsector(bch);
-      bch->sector = (size_t)-1;
+#if CONFIG_BCH_READAHEAD > 1
+  /* Does this continue a sequential read? */
+
+  if (sector == bch->ranext)
+    {
+      return bchlib_readahead(bch, sector);
+    }
+
+  bch->ranext = sector + 1;
+#endif
+
+  /* No.. replace the least recently used line */
+
+  inode = bch->inode;
+  ndx   = bchlib_lruline(bch);
+  line  = &bch->line[ndx];
+
+  ret = bchlib_flushline(bch, ndx);
+  if (ret < 0)
+    {
+      return (int)ret;
+    }
+
+  line->sector = (size_t)-1;
+
+  ret = inode->u.i_bops->read(inode, bchlib_linebuffer(bch, ndx), sector, 1);
+  if (ret < 0)
+    {
+      ferr("Read failed: %d\n", ret);
+      return (int)ret;
+    }
+
+  line->sector = sector;
+  line->age    = ++bch->clock;
 
-      ret = inode->u.i_bops->read(inode, bch->buffer, sector, 1);
-      if (ret < 0)
-        {
-          ferr("Read failed: %d\n");
-        }
-      bch->sector = sector;
 #if defined(CONFIG_BCH_ENCRYPTION)
-      bch_cypher(bch, CYPHER_DECRYPT);
+  bch_cypher(bch, bchlib_linebuffer(bch, ndx), sector, CYPHER_DECRYPT);
 #endif
+
+  return ndx;
+}
+
+/****************************************************************************
+ * Name: bchlib_invalidate
+ *
+ * Description:
+ *   Discard any cached copies of the sectors in the range, including any
+ *   unwritten changes.  This is called before the sectors are written
+ *   directly to the media.
+ *
+ * Assumptions:
+ *   Caller must assume mutual exclusion
+ *
+ ****************************************************************************/
+
+void bchlib_invalidate(FAR struct bchlib_s *bch, size_t sector,
+                       size_t nsectors)
+{
+  FAR struct bchlib_line_s *line;
+  int i;
+
+  for (i = 0; i < CONFIG_BCH_CACHE_NSECTORS; i++)
+    {
+      line = &bch->line[i];
+      if (line->sector != (size_t)-1 && line->sector >= sector &&
+          line->sector - sector < nsectors)
+        {
+          line->sector = (size_t)-1;
+          line->dirty  = false;
+        }
     }
-  return (int)ret;
 }
 
+/****************************************************************************
+ * Name: bchlib_overlay
+ *
+ * Description:
+ *   The sectors in the range have been read directly from the media into
+ *   'buffer'.  Copy any cached sectors in the range with unwritten changes
+ *   over the stale data.
+ *
+ * Assumptions:
+ *   Caller must assume mutual exclusion
+ *
+ ****************************************************************************/
+
+void bchlib_overlay(FAR struct bchlib_s *bch, FAR uint8_t *buffer,
+                    size_t sector, size_t nsectors)
+{
+  FAR struct bchlib_line_s *line;
+  int i;
+
+  for (i = 0; i < CONFIG_BCH_CACHE_NSECTORS; i++)
+    {
+      line = &bch->line[i];
+      if (line->dirty && line->sector >= sector &&
+          line->sector - sector < nsectors)
+        {
+          memcpy(&buffer[(line->sector - sector) * bch->sectsize],
+                 bchlib_linebuffer(bch, i), bch->sectsize);
+        }
+    }
+}
@@ -121,12 +121,12 @@ int bchlib_setup(const char *blkdev, bool readonly, FAR void **handle)
   sem_init(&bch->sem, 0, 1);
   bch->nsectors = geo.geo_nsectors;
   bch->sectsize = geo.geo_sectorsize;
-  bch->sector   = (size_t)-1;
   bch->readonly = readonly;
 
-  /* Allocate the sector I/O buffer */
+  /* Allocate the sector I/O buffers, one per cache line */
 
-  bch->buffer = (FAR uint8_t *)kmm_malloc(bch->sectsize);
+  bch->buffer = (FAR uint8_t *)
+    kmm_malloc((size_t)CONFIG_BCH_CACHE_NSECTORS * bch->sectsize);
   if (!bch->buffer)
     {
       ferr("ERROR: Failed to allocate sector buffer\n");
@@ -134,6 +134,8 @@ int bchlib_setup(const char *blkdev, bool readonly, FAR void **handle)
       goto errout_with_bch;
     }
 
+  bchlib_initcache(bch);
+
   *handle = bch;
   return OK;
 
@@ -97,9 +97,13 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset,
   byteswritten = 0;
   if (sectoffset > 0)
     {
-      /* Read the full sector into the sector buffer */
+      /* Read the full sector into the sector cache */
 
-      bchlib_readsector(bch, sector);
+      ret = bchlib_readsector(bch, sector);
+      if (ret < 0)
+        {
+          return ret;
+        }
 
       /* Copy the tail end of the sector from the user buffer */
 
@@ -112,8 +116,8 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset,
           nbytes = len;
         }
 
-      memcpy(&bch->buffer[sectoffset], buffer, nbytes);
-      bch->dirty = true;
+      memcpy(bchlib_linebuffer(bch, ret) + sectoffset, buffer, nbytes);
+      bch->line[ret].dirty = true;
 
       /* Adjust pointers and counts */
 
@@ -141,6 +145,10 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset,
           nsectors = bch->nsectors - sector;
         }
 
+      /* Any cached copies of these sectors are about to become stale */
+
+      bchlib_invalidate(bch, sector, nsectors);
+
       /* Write the contiguous sectors */
 
       ret = bch->inode->u.i_bops->write(bch->inode, (FAR uint8_t *)buffer,
@@ -170,28 +178,34 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset,
 
   if (len > 0)
     {
-      /* Read the sector into the sector buffer */
+      /* Read the sector into the sector cache */
 
-      bchlib_readsector(bch, sector);
+      ret = bchlib_readsector(bch, sector);
+      if (ret < 0)
+        {
+          return byteswritten > 0 ? (ssize_t)byteswritten : ret;
+        }
 
       /* Copy the head end of the sector from the user buffer */
 
-      memcpy(bch->buffer, buffer, len);
-      bch->dirty = true;
+      memcpy(bchlib_linebuffer(bch, ret), buffer, len);
+      bch->line[ret].dirty = true;
 
       /* Adjust counts */
 
       byteswritten += len;
     }
 
+#ifndef CONFIG_BCH_WRITEBACK
   /* Finally, flush any cached writes to the device as well */
 
-  ret = bchlib_flushsector(bch);
+  ret = bchlib_flushcache(bch);
   if (ret < 0)
     {
       ferr("ERROR: Flush failed: %d\n", ret);
       return ret;
     }
+#endif
 
   return byteswritten;
 }
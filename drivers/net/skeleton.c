@@ -104,6 +104,16 @@
 
 #define BUF ((struct eth_hdr_s *)priv->sk_dev.d_buf)
 
+/* The number of TX and RX descriptors when the queued packet interface is
+ * used.  Each must be a power of two.
+ */
+
+#ifdef CONFIG_NETDEV_PKTQUEUE
+#  define skeleton_NTXDESC 4
+#  define skeleton_NRXDESC 4
+#  define skeleton_NBUFFERS (skeleton_NTXDESC + skeleton_NRXDESC + 1)
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -120,6 +130,15 @@ struct skel_driver_s
   struct work_s sk_irqwork;    /* For deferring interupt work to the work queue */
   struct work_s sk_pollwork;   /* For deferring poll work to the work queue */
 
+#ifdef CONFIG_NETDEV_PKTQUEUE
+  /* TX and RX packet queues */
+
+  struct netdev_pktq_s sk_txq;
+  struct netdev_pktq_s sk_rxq;
+  struct netdev_pktdesc_s sk_txdesc[skeleton_NTXDESC];
+  struct netdev_pktdesc_s sk_rxdesc[skeleton_NRXDESC];
+#endif
+
   /* This holds the information visible to the NuttX network */
 
   struct net_driver_s sk_dev;  /* Interface understood by the network */
@@ -142,7 +161,16 @@ struct skel_driver_s
  * allocated dynamically.
  */
 
+#ifdef CONFIG_NETDEV_PKTQUEUE
+/* With the queued packet interface, there is one packet buffer for each TX
+ * and RX descriptor and one more for d_buf.
+ */
+
+static uint8_t g_pktbuf[skeleton_NBUFFERS]
+                       [MAX_NET_DEV_MTU + CONFIG_NET_GUARDSIZE];
+#else
 static uint8_t g_pktbuf[MAX_NET_DEV_MTU + CONFIG_NET_GUARDSIZE];
+#endif
 
 /* Driver state structure */
 
@@ -159,6 +187,7 @@ static int  skel_txpoll(FAR struct net_driver_s *dev);
 
 /* Interrupt handling */
 
+static int  skel_input(FAR struct net_driver_s *dev);
 static void skel_receive(FAR struct skel_driver_s *priv);
 static void skel_txdone(FAR struct skel_driver_s *priv);
 
@@ -228,7 +257,22 @@ static int skel_transmit(FAR struct skel_driver_s *priv)
 
   NETDEV_TXPACKETS(priv->sk_dev);
 
+#ifdef CONFIG_NETDEV_PKTQUEUE
+  /* Add the packet in d_buf to the TX queue.  d_buf then holds a free
+   * buffer for the next packet.
+   */
+
+  if (netdev_pktq_put(&priv->sk_dev, &priv->sk_txq) < 0)
+    {
+      return -EBUSY;
+    }
+
+  /* Give the new descriptor to the hardware.  It is the descriptor just
+   * before netdev_pktq_tail(): address=pd_buf, length=pd_len
+   */
+#else
   /* Send the packet: address=priv->sk_dev.d_buf, length=priv->sk_dev.d_len */
+#endif
 
   /* Enable Tx interrupts */
 
@@ -302,6 +346,10 @@ static int skel_txpoll(FAR struct net_driver_s *dev)
       /* Check if there is room in the device to hold another packet. If not,
        * return a non-zero value to terminate the poll.
        */
+
+#ifdef CONFIG_NETDEV_PKTQUEUE
+      return netdev_pktq_full(&priv->sk_txq);
+#endif
     }
 
   /* If zero is returned, the polling will continue until all connections have
@@ -312,145 +360,194 @@ static int skel_txpoll(FAR struct net_driver_s *dev)
 }
 
 /****************************************************************************
- * Name: skel_receive
+ * Name: skel_input
  *
  * Description:
- *   An interrupt was received indicating the availability of a new RX packet
+ *   Dispatch the received packet in d_buf.  Any response is sent.
  *
  * Parameters:
- *   priv - Reference to the driver state structure
+ *   dev - Reference to the NuttX driver state structure
  *
  * Returned Value:
- *   None
+ *   OK always
  *
  * Assumptions:
  *   The network is locked.
  *
  ****************************************************************************/
 
-static void skel_receive(FAR struct skel_driver_s *priv)
+static int skel_input(FAR struct net_driver_s *dev)
 {
-  do
-    {
-      /* Check for errors and update statistics */
-
-      /* Check if the packet is a valid size for the network buffer
-       * configuration.
-       */
-
-      /* Copy the data data from the hardware to priv->sk_dev.d_buf.  Set
-       * amount of data in priv->sk_dev.d_len
-       */
+  FAR struct skel_driver_s *priv = (FAR struct skel_driver_s *)dev->d_private;
 
 #ifdef CONFIG_NET_PKT
-      /* When packet sockets are enabled, feed the frame into the packet tap */
+  /* When packet sockets are enabled, feed the frame into the packet tap */
 
-       pkt_input(&priv->sk_dev);
+  pkt_input(&priv->sk_dev);
 #endif
 
-      /* We only accept IP packets of the configured type and ARP packets */
+  /* We only accept IP packets of the configured type and ARP packets */
 
 #ifdef CONFIG_NET_IPv4
-      if (BUF->type == HTONS(ETHTYPE_IP))
-        {
-          ninfo("IPv4 frame\n");
-          NETDEV_RXIPV4(&priv->sk_dev);
+  if (BUF->type == HTONS(ETHTYPE_IP))
+    {
+      ninfo("IPv4 frame\n");
+      NETDEV_RXIPV4(&priv->sk_dev);
 
-          /* Handle ARP on input then give the IPv4 packet to the network
-           * layer
-           */
+      /* Handle ARP on input then give the IPv4 packet to the network
+       * layer
+       */
 
-          arp_ipin(&priv->sk_dev);
-          ipv4_input(&priv->sk_dev);
+      arp_ipin(&priv->sk_dev);
+      ipv4_input(&priv->sk_dev);
 
-          /* If the above function invocation resulted in data that should be
-           * sent out on the network, the field  d_len will set to a value > 0.
-           */
+      /* If the above function invocation resulted in data that should be
+       * sent out on the network, the field  d_len will set to a value > 0.
+       */
 
-          if (priv->sk_dev.d_len > 0)
-            {
-              /* Update the Ethernet header with the correct MAC address */
+      if (priv->sk_dev.d_len > 0)
+        {
+          /* Update the Ethernet header with the correct MAC address */
 
 #ifdef CONFIG_NET_IPv6
-              if (IFF_IS_IPv4(priv->sk_dev.d_flags))
+          if (IFF_IS_IPv4(priv->sk_dev.d_flags))
 #endif
-                {
-                  arp_out(&priv->sk_dev);
-                }
+            {
+              arp_out(&priv->sk_dev);
+            }
 #ifdef CONFIG_NET_IPv6
-              else
-                {
-                  neighbor_out(&kel->sk_dev);
-                }
+          else
+            {
+              neighbor_out(&priv->sk_dev);
+            }
 #endif
 
-              /* And send the packet */
+          /* And send the packet */
 
-              skel_transmit(priv);
-            }
+          skel_transmit(priv);
         }
-      else
+    }
+  else
 #endif
 #ifdef CONFIG_NET_IPv6
-      if (BUF->type == HTONS(ETHTYPE_IP6))
-        {
-          ninfo("Iv6 frame\n");
-          NETDEV_RXIPV6(&priv->sk_dev);
+  if (BUF->type == HTONS(ETHTYPE_IP6))
+    {
+      ninfo("Iv6 frame\n");
+      NETDEV_RXIPV6(&priv->sk_dev);
 
-          /* Give the IPv6 packet to the network layer */
+      /* Give the IPv6 packet to the network layer */
 
-          ipv6_input(&priv->sk_dev);
+      ipv6_input(&priv->sk_dev);
 
-          /* If the above function invocation resulted in data that should be
-           * sent out on the network, the field  d_len will set to a value > 0.
-           */
+      /* If the above function invocation resulted in data that should be
+       * sent out on the network, the field  d_len will set to a value > 0.
+       */
 
-          if (priv->sk_dev.d_len > 0)
-           {
-              /* Update the Ethernet header with the correct MAC address */
+      if (priv->sk_dev.d_len > 0)
+        {
+          /* Update the Ethernet header with the correct MAC address */
 
 #ifdef CONFIG_NET_IPv4
-              if (IFF_IS_IPv4(priv->sk_dev.d_flags))
-                {
-                  arp_out(&priv->sk_dev);
-                }
-              else
+          if (IFF_IS_IPv4(priv->sk_dev.d_flags))
+            {
+              arp_out(&priv->sk_dev);
+            }
+          else
 #endif
 #ifdef CONFIG_NET_IPv6
-                {
-                  neighbor_out(&priv->sk_dev);
-                }
+            {
+              neighbor_out(&priv->sk_dev);
+            }
 #endif
 
-              /* And send the packet */
+          /* And send the packet */
 
-              skel_transmit(priv);
-            }
+          skel_transmit(priv);
         }
-      else
+    }
+  else
 #endif
 #ifdef CONFIG_NET_ARP
-      if (BUF->type == htons(ETHTYPE_ARP))
-        {
-          arp_arpin(&priv->sk_dev);
-          NETDEV_RXARP(&priv->sk_dev);
+  if (BUF->type == htons(ETHTYPE_ARP))
+    {
+      arp_arpin(&priv->sk_dev);
+      NETDEV_RXARP(&priv->sk_dev);
 
-          /* If the above function invocation resulted in data that should be
-           * sent out on the network, the field  d_len will set to a value > 0.
-           */
+      /* If the above function invocation resulted in data that should be
+       * sent out on the network, the field  d_len will set to a value > 0.
+       */
 
-          if (priv->sk_dev.d_len > 0)
-            {
-              skel_transmit(priv);
-            }
-        }
-      else
-#endif
+      if (priv->sk_dev.d_len > 0)
         {
-          NETDEV_RXDROPPED(&priv->sk_dev);
+          skel_transmit(priv);
         }
     }
+  else
+#endif
+    {
+      NETDEV_RXDROPPED(&priv->sk_dev);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: skel_receive
+ *
+ * Description:
+ *   An interrupt was received indicating the availability of a new RX packet
+ *
+ * Parameters:
+ *   priv - Reference to the driver state structure
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+static void skel_receive(FAR struct skel_driver_s *priv)
+{
+#ifdef CONFIG_NETDEV_PKTQUEUE
+  /* The hardware receives each packet into the buffer of the descriptor at
+   * netdev_pktq_tail(&priv->sk_rxq).  For each completed RX descriptor,
+   * check for errors, set pd_len, and call netdev_pktq_commit().  Then
+   * reload the hardware descriptor with the (possibly new) pd_buf of each
+   * free descriptor.
+   */
+
+  /* Dispatch a batch of received packets.  Responses are added to the TX
+   * queue by skel_transmit().
+   */
+
+  (void)netdev_rxqueue_process(&priv->sk_dev, &priv->sk_rxq, &priv->sk_txq,
+                               skel_input, CONFIG_NETDEV_RXBUDGET);
+
+  /* If packets remain, process them later so that other work may run */
+
+  if (!netdev_pktq_empty(&priv->sk_rxq))
+    {
+      work_queue(ETHWORK, &priv->sk_irqwork, skel_interrupt_work, priv, 0);
+    }
+#else
+  do
+    {
+      /* Check for errors and update statistics */
+
+      /* Check if the packet is a valid size for the network buffer
+       * configuration.
+       */
+
+      /* Copy the data data from the hardware to priv->sk_dev.d_buf.  Set
+       * amount of data in priv->sk_dev.d_len
+       */
+
+      (void)skel_input(&priv->sk_dev);
+    }
   while (); /* While there are more packets to be processed */
+#endif
 }
 
 /****************************************************************************
@@ -480,6 +577,12 @@ static void skel_txdone(FAR struct skel_driver_s *priv)
 
   /* Check if there are pending transmissions */
 
+#ifdef CONFIG_NETDEV_PKTQUEUE
+  /* Call netdev_pktq_remove() for each descriptor at the head of the TX
+   * queue that the hardware has finished sending.
+   */
+#endif
+
   /* If no further transmissions are pending, then cancel the TX timeout and
    * disable further Tx interrupts.
    */
@@ -1139,6 +1242,9 @@ static int skel_ioctl(FAR struct net_driver_s *dev, int cmd, long arg)
 int skel_initialize(int intf)
 {
   FAR struct skel_driver_s *priv;
+#ifdef CONFIG_NETDEV_PKTQUEUE
+  int i;
+#endif
 
   /* Get the interface structure associated with this interface number. */
 
@@ -1159,7 +1265,23 @@ int skel_initialize(int intf)
   /* Initialize the driver structure */
 
   memset(priv, 0, sizeof(struct skel_driver_s));
+#ifdef CONFIG_NETDEV_PKTQUEUE
+  for (i = 0; i < skeleton_NTXDESC; i++)
+    {
+      priv->sk_txdesc[i].pd_buf = g_pktbuf[i];
+    }
+
+  for (i = 0; i < skeleton_NRXDESC; i++)
+    {
+      priv->sk_rxdesc[i].pd_buf = g_pktbuf[skeleton_NTXDESC + i];
+    }
+
+  (void)netdev_pktq_init(&priv->sk_txq, priv->sk_txdesc, skeleton_NTXDESC);
+  (void)netdev_pktq_init(&priv->sk_rxq, priv->sk_rxdesc, skeleton_NRXDESC);
+  priv->sk_dev.d_buf     = g_pktbuf[skeleton_NBUFFERS - 1];
+#else
   priv->sk_dev.d_buf     = g_pktbuf;      /* Single packet buffer */
+#endif
   priv->sk_dev.d_ifup    = skel_ifup;     /* I/F up (new IP address) callback */
   priv->sk_dev.d_ifdown  = skel_ifdown;   /* I/F down callback */
   priv->sk_dev.d_txavail = skel_txavail;  /* New TX data callback */
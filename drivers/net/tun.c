@@ -1,7 +1,7 @@
 /****************************************************************************
  * drivers/net/tun.c
  *
- *   Copyright (C) 2015-2016 Max Nekludov. All rights reserved.
+ *   Copyright (C) 2015-2017 Max Nekludov. All rights reserved.
  *   Author: Max Nekludov <macscomp@gmail.com>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -103,6 +103,19 @@
 
 #define TUN_WDDELAY   (1*CLK_TCK)
 
+/* CONFIG_TUN_NTXPKTS is the number of packets that may be queued for the
+ * reader when the queued packet interface is used.
+ */
+
+#ifdef CONFIG_NETDEV_PKTQUEUE
+#  ifndef CONFIG_TUN_NTXPKTS
+#    define CONFIG_TUN_NTXPKTS 4
+#  endif
+#  if (CONFIG_TUN_NTXPKTS & (CONFIG_TUN_NTXPKTS - 1)) != 0
+#    error CONFIG_TUN_NTXPKTS must be a power of two
+#  endif
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -125,10 +138,21 @@ struct tun_device_s
 
   bool              read_wait;
 
+#ifdef CONFIG_NETDEV_PKTQUEUE
+  /* Packets from the network to the reader, including the responses to
+   * written packets.  d_buf always holds the one buffer that is not owned
+   * by a descriptor.
+   */
+
+  struct netdev_pktq_s txq;
+  struct netdev_pktdesc_s txdesc[CONFIG_TUN_NTXPKTS];
+  uint8_t           txbuf[CONFIG_TUN_NTXPKTS + 1][CONFIG_NET_TUN_MTU];
+#else
   uint8_t           read_buf[CONFIG_NET_TUN_MTU];
   size_t            read_d_len;
   uint8_t           write_buf[CONFIG_NET_TUN_MTU];
   size_t            write_d_len;
+#endif
 
   sem_t             waitsem;
   sem_t             read_wait_sem;
@@ -379,10 +403,21 @@ static int tun_txpoll(struct net_driver_s *dev)
     {
       /* Send the packet */
 
+#ifdef CONFIG_NETDEV_PKTQUEUE
+      /* Queue the packet for the reader and continue polling until the
+       * queue is full.
+       */
+
+      (void)netdev_pktq_put(&priv->dev, &priv->txq);
+      tun_fd_transmit(priv);
+
+      return netdev_pktq_full(&priv->txq);
+#else
       priv->read_d_len = priv->dev.d_len;
       tun_fd_transmit(priv);
 
       return 1;
+#endif
     }
 
   /* If zero is returned, the polling will continue until all connections have
@@ -444,7 +479,11 @@ static void tun_net_receive(FAR struct tun_device_s *priv)
 
       if (priv->dev.d_len > 0)
         {
+#ifdef CONFIG_NETDEV_PKTQUEUE
+          (void)netdev_pktq_put(&priv->dev, &priv->txq);
+#else
           priv->write_d_len = priv->dev.d_len;
+#endif
           tun_fd_transmit(priv);
         }
       else
@@ -475,7 +514,11 @@ static void tun_net_receive(FAR struct tun_device_s *priv)
 
       if (priv->dev.d_len > 0)
         {
+#ifdef CONFIG_NETDEV_PKTQUEUE
+          (void)netdev_pktq_put(&priv->dev, &priv->txq);
+#else
           priv->write_d_len = priv->dev.d_len;
+#endif
           tun_fd_transmit(priv);
         }
       else
@@ -485,7 +528,7 @@ static void tun_net_receive(FAR struct tun_device_s *priv)
     }
   else
     {
-      priv->write_d_len = 0;
+      priv->dev.d_len = 0;
       tun_pollnotify(priv, POLLOUT);
     }
 
@@ -519,7 +562,9 @@ static void tun_txdone(FAR struct tun_device_s *priv)
 
   /* Then poll the network for new XMIT data */
 
+#ifndef CONFIG_NETDEV_PKTQUEUE
   priv->dev.d_buf = priv->read_buf;
+#endif
   (void)devif_poll(&priv->dev, tun_txpoll);
 }
 
@@ -553,11 +598,17 @@ static void tun_poll_work(FAR void *arg)
    * the TX poll if he are unable to accept another packet for transmission.
    */
 
+#ifdef CONFIG_NETDEV_PKTQUEUE
+  if (!netdev_pktq_full(&priv->txq))
+#else
   if (priv->read_d_len == 0)
+#endif
     {
       /* If so, poll the network for new XMIT data. */
 
+#ifndef CONFIG_NETDEV_PKTQUEUE
       priv->dev.d_buf = priv->read_buf;
+#endif
       (void)devif_timer(&priv->dev, tun_txpoll);
     }
 
@@ -708,7 +759,11 @@ static int tun_txavail(struct net_driver_s *dev)
 
   /* Check if there is room to hold another network packet. */
 
+#ifdef CONFIG_NETDEV_PKTQUEUE
+  if (netdev_pktq_full(&priv->txq))
+#else
   if (priv->read_d_len != 0 || priv->write_d_len != 0)
+#endif
     {
       tun_unlock(priv);
       return OK;
@@ -720,7 +775,9 @@ static int tun_txavail(struct net_driver_s *dev)
     {
       /* Poll the network for new XMIT data */
 
+#ifndef CONFIG_NETDEV_PKTQUEUE
       priv->dev.d_buf = priv->read_buf;
+#endif
       (void)devif_poll(&priv->dev, tun_txpoll);
     }
 
@@ -824,6 +881,9 @@ static void tun_ipv6multicast(FAR struct tun_device_s *priv)
 static int tun_dev_init(FAR struct tun_device_s *priv, FAR struct file *filep,
                         FAR const char *devfmt)
 {
+#ifdef CONFIG_NETDEV_PKTQUEUE
+  int i;
+#endif
   int ret;
 
   /* Initialize the driver structure */
@@ -855,7 +915,17 @@ static int tun_dev_init(FAR struct tun_device_s *priv, FAR struct file *filep,
 
   /* Initialize other variables */
 
+#ifdef CONFIG_NETDEV_PKTQUEUE
+  for (i = 0; i < CONFIG_TUN_NTXPKTS; i++)
+    {
+      priv->txdesc[i].pd_buf = priv->txbuf[i];
+    }
+
+  (void)netdev_pktq_init(&priv->txq, priv->txdesc, CONFIG_TUN_NTXPKTS);
+  priv->dev.d_buf     = priv->txbuf[CONFIG_TUN_NTXPKTS];
+#else
   priv->write_d_len   = 0;
+#endif
   priv->read_wait     = false;
 
   /* Put the interface in the down state */
@@ -958,7 +1028,13 @@ static ssize_t tun_write(FAR struct file *filep, FAR const char *buffer,
 
   tun_lock(priv);
 
+  /* There must be room to hold the response to the packet */
+
+#ifdef CONFIG_NETDEV_PKTQUEUE
+  if (netdev_pktq_full(&priv->txq))
+#else
   if (priv->write_d_len > 0)
+#endif
     {
       tun_unlock(priv);
       return -EBUSY;
@@ -972,9 +1048,10 @@ static ssize_t tun_write(FAR struct file *filep, FAR const char *buffer,
     }
   else
     {
-      memcpy(priv->write_buf, buffer, buflen);
-
+#ifndef CONFIG_NETDEV_PKTQUEUE
       priv->dev.d_buf = priv->write_buf;
+#endif
+      memcpy(priv->dev.d_buf, buffer, buflen);
       priv->dev.d_len = buflen;
 
       tun_net_receive(priv);
@@ -996,9 +1073,14 @@ static ssize_t tun_read(FAR struct file *filep, FAR char *buffer,
                         size_t buflen)
 {
   FAR struct tun_device_s *priv = filep->f_priv;
-  ssize_t ret;
+#ifdef CONFIG_NETDEV_PKTQUEUE
+  FAR struct netdev_pktdesc_s *desc;
+  bool full;
+#else
   size_t write_d_len;
   size_t read_d_len;
+#endif
+  ssize_t ret;
 
   if (!priv)
     {
@@ -1007,6 +1089,51 @@ static ssize_t tun_read(FAR struct file *filep, FAR char *buffer,
 
   tun_lock(priv);
 
+#ifdef CONFIG_NETDEV_PKTQUEUE
+  /* Wait for a packet to be queued for the reader */
+
+  while (netdev_pktq_empty(&priv->txq))
+    {
+      if ((filep->f_oflags & O_NONBLOCK) != 0)
+        {
+          ret = -EAGAIN;
+          goto out;
+        }
+
+      priv->read_wait = true;
+      tun_unlock(priv);
+      sem_wait(&priv->read_wait_sem);
+      tun_lock(priv);
+    }
+
+  net_lock();
+
+  desc = netdev_pktq_head(&priv->txq);
+  if (buflen < desc->pd_len)
+    {
+      ret = -EINVAL;
+    }
+  else
+    {
+      memcpy(buffer, desc->pd_buf, desc->pd_len);
+      ret = (ssize_t)desc->pd_len;
+    }
+
+  /* Free the descriptor.  If the queue was full, a packet may now be
+   * written and there is room for the network to send more.
+   */
+
+  full = netdev_pktq_full(&priv->txq);
+  netdev_pktq_remove(&priv->txq);
+
+  if (full)
+    {
+      tun_pollnotify(priv, POLLOUT);
+    }
+
+  tun_txdone(priv);
+  net_unlock();
+#else
   /* Check if there are data to read in write buffer */
 
   write_d_len = priv->write_d_len;
@@ -1065,6 +1192,7 @@ static ssize_t tun_read(FAR struct file *filep, FAR char *buffer,
   tun_txdone(priv);
 
   net_unlock();
+#endif
 
 out:
   tun_unlock(priv);
@@ -1109,6 +1237,21 @@ int tun_poll(FAR struct file *filep, FAR struct pollfd *fds, bool setup)
 
       eventset = 0;
 
+#ifdef CONFIG_NETDEV_PKTQUEUE
+      /* Writing is possible if there is room for the response; reading is
+       * possible if any packet is queued.
+       */
+
+      if (!netdev_pktq_full(&priv->txq))
+        {
+          eventset |= (fds->events & POLLOUT);
+        }
+
+      if (!netdev_pktq_empty(&priv->txq))
+        {
+          eventset |= (fds->events & POLLIN);
+        }
+#else
       /* If write buffer is empty notify App.  */
 
       if (priv->write_d_len == 0)
@@ -1124,6 +1267,7 @@ int tun_poll(FAR struct file *filep, FAR struct pollfd *fds, bool setup)
         {
           eventset |= (fds->events & POLLIN);
         }
+#endif
 
       if (eventset)
         {
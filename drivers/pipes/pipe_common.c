@@ -1,7 +1,7 @@
 /****************************************************************************
  * drivers/pipes/pipe_common.c
  *
- *   Copyright (C) 2008-2009, 2011, 2015-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2008-2009, 2011, 2015-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -105,6 +105,49 @@ static void pipecommon_semtake(FAR sem_t *sem)
     }
 }
 
+/****************************************************************************
+ * Name: pipecommon_wakeup
+ *
+ * Description:
+ *   Wake up all threads waiting on the read or write semaphore.
+ *
+ ****************************************************************************/
+
+static void pipecommon_wakeup(FAR sem_t *sem)
+{
+  int sval;
+
+  while (sem_getvalue(sem, &sval) == 0 && sval < 0)
+    {
+      sem_post(sem);
+    }
+}
+
+/****************************************************************************
+ * Name: pipecommon_bufused
+ *
+ * Description:
+ *   Return the number of bytes in the buffer.  The buffer is a ring
+ *   buffer with one byte always left unused so that a full buffer can be
+ *   distinguished from an empty one.
+ *
+ *     d_rdndx - Index to remove next byte from the buffer
+ *     d_wrndx - Index to next location to add a byte to the buffer.
+ *
+ ****************************************************************************/
+
+static size_t pipecommon_bufused(FAR struct pipe_dev_s *dev)
+{
+  if (dev->d_wrndx < dev->d_rdndx)
+    {
+      return (dev->d_bufsize - dev->d_rdndx) + dev->d_wrndx;
+    }
+  else
+    {
+      return dev->d_wrndx - dev->d_rdndx;
+    }
+}
+
 /****************************************************************************
  * Name: pipecommon_pollnotify
  ****************************************************************************/
@@ -138,7 +181,7 @@ static void pipecommon_pollnotify(FAR struct pipe_dev_s *dev,
           if (fds->revents != 0)
             {
               finfo("Report events: %02x\n", fds->revents);
-              sem_post(fds->sem);
+              poll_notify(fds);
             }
         }
     }
@@ -147,6 +190,77 @@ static void pipecommon_pollnotify(FAR struct pipe_dev_s *dev,
 #  define pipecommon_pollnotify(dev,event)
 #endif
 
+/****************************************************************************
+ * Name: pipecommon_resize
+ *
+ * Description:
+ *   Change the size of the pipe buffer.  Any buffered data is moved to the
+ *   beginning of the new buffer.
+ *
+ * Returned Value:
+ *   The new buffer size on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+static int pipecommon_resize(FAR struct pipe_dev_s *dev, size_t bufsize)
+{
+  FAR uint8_t *buffer;
+  size_t nbytes;
+  size_t ncopy;
+
+  if (bufsize < 2 || bufsize > CONFIG_DEV_PIPE_MAXSIZE)
+    {
+      return -EINVAL;
+    }
+
+  /* The new buffer must be able to hold all of the buffered data */
+
+  nbytes = pipecommon_bufused(dev);
+  if (nbytes >= bufsize)
+    {
+      return -EBUSY;
+    }
+
+  /* Is the buffer allocated?  If not, the new size will be used when the
+   * pipe is opened.
+   */
+
+  if (dev->d_buffer != NULL && bufsize != dev->d_bufsize)
+    {
+      buffer = (FAR uint8_t *)kmm_malloc(bufsize);
+      if (buffer == NULL)
+        {
+          return -ENOMEM;
+        }
+
+      /* Copy the data in (up to) two segments:  From the read index to the
+       * end of the old buffer, then from the beginning of the old buffer.
+       */
+
+      ncopy = dev->d_bufsize - dev->d_rdndx;
+      if (ncopy > nbytes)
+        {
+          ncopy = nbytes;
+        }
+
+      memcpy(buffer, &dev->d_buffer[dev->d_rdndx], ncopy);
+      memcpy(&buffer[ncopy], dev->d_buffer, nbytes - ncopy);
+
+      kmm_free(dev->d_buffer);
+      dev->d_buffer = buffer;
+      dev->d_rdndx  = 0;
+      dev->d_wrndx  = nbytes;
+    }
+
+  dev->d_bufsize = bufsize;
+
+  /* There may now be space for waiting writers */
+
+  pipecommon_wakeup(&dev->d_wrsem);
+  pipecommon_pollnotify(dev, POLLOUT);
+  return bufsize;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -206,7 +320,6 @@ int pipecommon_open(FAR struct file *filep)
 {
   FAR struct inode      *inode = filep->f_inode;
   FAR struct pipe_dev_s *dev   = inode->i_private;
-  int                    sval;
   int                    ret;
 
   DEBUGASSERT(dev != NULL);
@@ -254,10 +367,7 @@ int pipecommon_open(FAR struct file *filep)
 
       if (dev->d_nwriters == 1)
         {
-          while (sem_getvalue(&dev->d_rdsem, &sval) == 0 && sval < 0)
-            {
-              sem_post(&dev->d_rdsem);
-            }
+          pipecommon_wakeup(&dev->d_rdsem);
         }
     }
 
@@ -318,7 +428,6 @@ int pipecommon_close(FAR struct file *filep)
 {
   FAR struct inode      *inode = filep->f_inode;
   FAR struct pipe_dev_s *dev   = inode->i_private;
-  int                    sval;
 
   DEBUGASSERT(dev && dev->d_refs > 0);
 
@@ -349,10 +458,7 @@ int pipecommon_close(FAR struct file *filep)
 
           if (--dev->d_nwriters <= 0)
             {
-              while (sem_getvalue(&dev->d_rdsem, &sval) == 0 && sval < 0)
-                {
-                  sem_post(&dev->d_rdsem);
-                }
+              pipecommon_wakeup(&dev->d_rdsem);
 
               /* Inform poll readers that other end closed. */
 
@@ -428,7 +534,7 @@ ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
   FAR uint8_t           *start  = (FAR uint8_t *)buffer;
 #endif
   ssize_t                nread  = 0;
-  int                    sval;
+  size_t                 ncopy;
   int                    ret;
 
   DEBUGASSERT(dev);
@@ -478,26 +584,39 @@ ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
         }
     }
 
-  /* Then return whatever is available in the pipe (which is at least one byte) */
+  /* Then return whatever is available in the pipe (which is at least one
+   * byte).  The data is copied in at most two segments:  From the read
+   * index up to the write index or the end of the buffer and then, if the
+   * data wraps, from the beginning of the buffer.
+   */
 
   nread = 0;
   while ((size_t)nread < len && dev->d_wrndx != dev->d_rdndx)
     {
-      *buffer++ = dev->d_buffer[dev->d_rdndx];
-      if (++dev->d_rdndx >= dev->d_bufsize)
+      if (dev->d_wrndx > dev->d_rdndx)
+        {
+          ncopy = dev->d_wrndx - dev->d_rdndx;
+        }
+      else
         {
-          dev->d_rdndx = 0;
+          ncopy = dev->d_bufsize - dev->d_rdndx;
         }
 
-      nread++;
+      if (ncopy > len - nread)
+        {
+          ncopy = len - nread;
+        }
+
+      memcpy(&buffer[nread], &dev->d_buffer[dev->d_rdndx], ncopy);
+      nread += ncopy;
+
+      ncopy += dev->d_rdndx;
+      dev->d_rdndx = (ncopy >= dev->d_bufsize) ? 0 : ncopy;
     }
 
   /* Notify all waiting writers that bytes have been removed from the buffer */
 
-  while (sem_getvalue(&dev->d_wrsem, &sval) == 0 && sval < 0)
-    {
-      sem_post(&dev->d_wrsem);
-    }
+  pipecommon_wakeup(&dev->d_wrsem);
 
   /* Notify all poll/select waiters that they can write to the FIFO */
 
@@ -517,10 +636,10 @@ ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer,
 {
   FAR struct inode      *inode    = filep->f_inode;
   FAR struct pipe_dev_s *dev      = inode->i_private;
-  ssize_t                nwritten = 0;
-  ssize_t                last;
-  int                    nxtwrndx;
-  int                    sval;
+  size_t                 nwritten = 0;
+  size_t                 last;
+  size_t                 nspace;
+  size_t                 ncopy;
 
   DEBUGASSERT(dev);
   pipe_dumpbuffer("To PIPE:", (FAR uint8_t *)buffer, len);
@@ -556,82 +675,85 @@ ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer,
   last = 0;
   for (; ; )
     {
-      /* Calculate the write index AFTER the next byte is written */
-
-      nxtwrndx = dev->d_wrndx + 1;
-      if (nxtwrndx >= dev->d_bufsize)
-        {
-          nxtwrndx = 0;
-        }
-
-      /* Would the next write overflow the circular buffer? */
+      /* Copy as much as will fit in the buffer.  This takes at most two
+       * segments:  From the write index up to the read index or the end of
+       * the buffer and then, if the free space wraps, from the beginning of
+       * the buffer.  One byte is always left unused so that a full buffer
+       * can be distinguished from an empty one.
+       */
 
-      if (nxtwrndx != dev->d_rdndx)
+      while (nwritten < len)
         {
-          /* No... copy the byte */
-
-          dev->d_buffer[dev->d_wrndx] = *buffer++;
-          dev->d_wrndx = nxtwrndx;
-
-          /* Is the write complete? */
-
-          nwritten++;
-          if ((size_t)nwritten >= len)
+          if (dev->d_rdndx > dev->d_wrndx)
             {
-              /* Yes.. Notify all of the waiting readers that more data is available */
-
-              while (sem_getvalue(&dev->d_rdsem, &sval) == 0 && sval < 0)
+              nspace = dev->d_rdndx - dev->d_wrndx - 1;
+            }
+          else
+            {
+              nspace = dev->d_bufsize - dev->d_wrndx;
+              if (dev->d_rdndx == 0)
                 {
-                  sem_post(&dev->d_rdsem);
+                  nspace--;
                 }
+            }
 
-              /* Notify all poll/select waiters that they can write to the FIFO */
+          if (nspace == 0)
+            {
+              break;
+            }
 
-              pipecommon_pollnotify(dev, POLLIN);
+          ncopy = len - nwritten;
+          if (ncopy > nspace)
+            {
+              ncopy = nspace;
+            }
 
-              /* Return the number of bytes written */
+          memcpy(&dev->d_buffer[dev->d_wrndx], &buffer[nwritten], ncopy);
+          nwritten += ncopy;
 
-              sem_post(&dev->d_bfsem);
-              return len;
-            }
+          ncopy += dev->d_wrndx;
+          dev->d_wrndx = (ncopy >= dev->d_bufsize) ? 0 : ncopy;
         }
-      else
-        {
-          /* There is not enough room for the next byte.  Was anything written in this pass? */
 
-          if (last < nwritten)
-            {
-              /* Yes.. Notify all of the waiting readers that more data is available */
+      /* Was anything written in this pass?  If so, notify all of the waiting
+       * readers and poll/select waiters that more data is available.
+       */
 
-              while (sem_getvalue(&dev->d_rdsem, &sval) == 0 && sval < 0)
-                {
-                  sem_post(&dev->d_rdsem);
-                }
-            }
+      if (last < nwritten)
+        {
+          pipecommon_wakeup(&dev->d_rdsem);
+          pipecommon_pollnotify(dev, POLLIN);
+        }
 
-          last = nwritten;
+      last = nwritten;
 
-          /* If O_NONBLOCK was set, then return partial bytes written or EGAIN */
+      /* Is the write complete? */
 
-          if (filep->f_oflags & O_NONBLOCK)
-            {
-              if (nwritten == 0)
-                {
-                  nwritten = -EAGAIN;
-                }
+      if (nwritten >= len)
+        {
+          /* Yes.. return the number of bytes written */
 
-              sem_post(&dev->d_bfsem);
-              return nwritten;
-            }
+          sem_post(&dev->d_bfsem);
+          return len;
+        }
 
-          /* There is more to be written.. wait for data to be removed from the pipe */
+      /* There is not enough room for the rest of the data.  If O_NONBLOCK
+       * was set, then return partial bytes written or EGAIN
+       */
 
-          sched_lock();
+      if (filep->f_oflags & O_NONBLOCK)
+        {
           sem_post(&dev->d_bfsem);
-          pipecommon_semtake(&dev->d_wrsem);
-          sched_unlock();
-          pipecommon_semtake(&dev->d_bfsem);
+          return nwritten > 0 ? (ssize_t)nwritten : -EAGAIN;
         }
+
+      /* There is more to be written.. wait for data to be removed from the pipe */
+
+      sched_lock();
+      sem_post(&dev->d_bfsem);
+      pipecommon_semtake(&dev->d_wrsem);
+      sched_unlock();
+      pipecommon_semtake(&dev->d_bfsem);
     }
 }
 
@@ -646,7 +768,7 @@ int pipecommon_poll(FAR struct file *filep, FAR struct pollfd *fds,
   FAR struct inode      *inode    = filep->f_inode;
   FAR struct pipe_dev_s *dev      = inode->i_private;
   pollevent_t            eventset;
-  pipe_ndx_t             nbytes;
+  size_t                 nbytes;
   int                    ret      = OK;
   int                    i;
 
@@ -686,14 +808,7 @@ int pipecommon_poll(FAR struct file *filep, FAR struct pollfd *fds,
        * First, determine how many bytes are in the buffer
        */
 
-      if (dev->d_wrndx >= dev->d_rdndx)
-        {
-          nbytes = dev->d_wrndx - dev->d_rdndx;
-        }
-      else
-        {
-          nbytes = (dev->d_bufsize - 1) + dev->d_wrndx - dev->d_rdndx;
-        }
+      nbytes = pipecommon_bufused(dev);
 
       /* Notify the POLLOUT event if the pipe is not full, but only if
        * there is readers. */
@@ -796,29 +911,27 @@ int pipecommon_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
         }
         break;
 
+      case PIPEIOC_GETSIZE:
+        {
+          ret = dev->d_bufsize;
+        }
+        break;
+
+      case PIPEIOC_SETSIZE:
+        {
+          ret = pipecommon_resize(dev, (size_t)arg);
+        }
+        break;
+
       case FIONWRITE:  /* Number of bytes waiting in send queue */
       case FIONREAD:   /* Number of bytes available for reading */
         {
-          int count;
-
           /* Determine the number of bytes written to the buffer.  This is,
            * of course, also the number of bytes that may be read from the
            * buffer.
-           *
-           *   d_rdndx - index to remove next byte from the buffer
-           *   d_wrndx - Index to next location to add a byte to the buffer.
            */
 
-          if (dev->d_wrndx < dev->d_rdndx)
-            {
-              count = (dev->d_bufsize - dev->d_rdndx) + dev->d_wrndx;
-            }
-          else
-            {
-              count = dev->d_wrndx - dev->d_rdndx;
-            }
-
-          *(FAR int *)((uintptr_t)arg) = count;
+          *(FAR int *)((uintptr_t)arg) = pipecommon_bufused(dev);
           ret = 0;
         }
         break;
@@ -827,24 +940,10 @@ int pipecommon_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 
       case FIONSPACE:
         {
-          int count;
-
-          /* Determine the number of bytes free in the buffer.
-           *
-           *   d_rdndx - index to remove next byte from the buffer
-           *   d_wrndx - Index to next location to add a byte to the buffer.
-           */
-
-          if (dev->d_wrndx < dev->d_rdndx)
-            {
-              count = (dev->d_rdndx - dev->d_wrndx) - 1;
-            }
-          else
-            {
-              count = ((dev->d_bufsize - dev->d_wrndx) + dev->d_rdndx) - 1;
-            }
+          /* Determine the number of bytes free in the buffer. */
 
-          *(FAR int *)((uintptr_t)arg) = count;
+          *(FAR int *)((uintptr_t)arg) =
+            (dev->d_bufsize - 1) - pipecommon_bufused(dev);
           ret = 0;
         }
         break;
@@ -1,7 +1,7 @@
 /****************************************************************************
  * drivers/syslog/note_driver.c
  *
- *   Copyright (C) 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -41,9 +41,14 @@
 
 #include <sys/types.h>
 #include <sched.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <semaphore.h>
 #include <assert.h>
 #include <errno.h>
 
+#include <nuttx/clock.h>
 #include <nuttx/sched_note.h>
 #include <nuttx/fs/fs.h>
 
@@ -74,17 +79,147 @@ static const struct file_operations note_fops =
 #endif
 #ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
   , 0            /* unlink */
-#endif 
+#endif
 };
 
+#ifdef CONFIG_SCHED_NOTE_LOCKFREE
+/* Notes must be removed from the buffers by only one reader at a time */
+
+static sem_t g_note_exclsem = SEM_INITIALIZER(1);
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
 /****************************************************************************
  * Name: note_read
+ *
+ * Description:
+ *   With CONFIG_SCHED_NOTE_LOCKFREE, the first read returns a stream header
+ *   that describes the format of the notes that follow.  The read blocks
+ *   until at least one note is available unless O_NONBLOCK is set.
+ *
  ****************************************************************************/
 
+#ifdef CONFIG_SCHED_NOTE_LOCKFREE
+static ssize_t note_read(FAR struct file *filep, FAR char *buffer,
+                         size_t buflen)
+{
+  ssize_t notelen;
+  ssize_t retlen;
+  int ret;
+
+  DEBUGASSERT(filep != 0 && buffer != NULL && buflen > 0);
+
+  /* Get exclusive access to the note buffers */
+
+  ret = sem_wait(&g_note_exclsem);
+  if (ret < 0)
+    {
+      DEBUGASSERT(get_errno() > 0);
+      return -get_errno();
+    }
+
+  /* Return the stream header at the beginning of the stream */
+
+  retlen = 0;
+  if (filep->f_pos == 0)
+    {
+      FAR struct note_stream_s *hdr = (FAR struct note_stream_s *)buffer;
+
+      if (buflen < sizeof(struct note_stream_s))
+        {
+          retlen = -EINVAL;
+          goto errout_with_sem;
+        }
+
+      memcpy(hdr->nhd_magic, NOTE_STREAM_MAGIC, 4);
+      hdr->nhd_version = NOTE_STREAM_VERSION;
+#ifdef CONFIG_SMP
+      hdr->nhd_flags   = NOTE_STREAM_SMP;
+      hdr->nhd_ncpus   = CONFIG_SMP_NCPUS;
+#else
+      hdr->nhd_flags   = 0;
+      hdr->nhd_ncpus   = 1;
+#endif
+      hdr->nhd_ptrsize = sizeof(FAR void *);
+
+      retlen  = sizeof(struct note_stream_s);
+      buffer += sizeof(struct note_stream_s);
+      buflen -= sizeof(struct note_stream_s);
+    }
+
+  /* Then loop, adding as many whole notes as will fit in the user buffer */
+
+  for (; ; )
+    {
+      notelen = sched_note_size();
+      if (notelen == 0)
+        {
+          /* The buffers are empty.  Return what we have or wait for more
+           * notes.  Notes are added from interrupt handlers and from
+           * other CPUs without any notification so we just poll.
+           */
+
+          if (retlen > 0)
+            {
+              break;
+            }
+          else if ((filep->f_oflags & O_NONBLOCK) != 0)
+            {
+              retlen = -EAGAIN;
+              break;
+            }
+          else if (usleep(USEC_PER_TICK) < 0)
+            {
+              retlen = -EINTR;
+              break;
+            }
+
+          continue;
+        }
+
+      /* Stop if the next note will not fit, unless nothing has been
+       * returned yet.  In that case, sched_note_get() will discard the note
+       * and return an error.
+       */
+
+      if (notelen > buflen && retlen > 0)
+        {
+          break;
+        }
+
+      /* Get the next note (removing it from the buffer) */
+
+      notelen = sched_note_get((FAR uint8_t *)buffer, buflen);
+      if (notelen <= 0)
+        {
+          if (retlen == 0)
+            {
+              retlen = notelen;
+            }
+
+          break;
+        }
+
+      /* Update pointers from the note that was transferred */
+
+      retlen += notelen;
+      buffer += notelen;
+      buflen -= notelen;
+    }
+
+  if (retlen > 0)
+    {
+      filep->f_pos += retlen;
+    }
+
+errout_with_sem:
+  sem_post(&g_note_exclsem);
+  return retlen;
+}
+#else
 static ssize_t note_read(FAR struct file *filep, FAR char *buffer,
                          size_t buflen)
 {
@@ -140,6 +275,7 @@ static ssize_t note_read(FAR struct file *filep, FAR char *buffer,
   sched_unlock();
   return retlen;
 }
+#endif
 
 /****************************************************************************
  * Public Functions
@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/aio/aio.h
  *
- *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -78,6 +78,44 @@
 #  error AIO needs file and/or socket descriptors
 #endif
 
+/* AIO engine configuration */
+
+#ifdef CONFIG_FS_AIO_ENGINE
+#  ifndef CONFIG_FS_AIO_NTHREADS
+#    define CONFIG_FS_AIO_NTHREADS 1
+#  endif
+
+#  ifndef CONFIG_FS_AIO_PRIORITY
+#    define CONFIG_FS_AIO_PRIORITY 100
+#  endif
+
+#  ifndef CONFIG_FS_AIO_STACKSIZE
+#    define CONFIG_FS_AIO_STACKSIZE 2048
+#  endif
+
+#  ifndef CONFIG_FS_AIO_COALESCE
+#    define CONFIG_FS_AIO_COALESCE 1024
+#  endif
+
+#  ifndef AIO_HAVE_FILEP
+#    undef CONFIG_FS_AIO_COALESCE
+#    define CONFIG_FS_AIO_COALESCE 0
+#  endif
+#endif
+
+/* The worker that performs the I/O restores its own priority after the
+ * I/O completes when the AIO engine is used.  Otherwise, the priority of
+ * the low-priority work queue must be restored.
+ */
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+#  ifdef CONFIG_FS_AIO_ENGINE
+#    define aio_restorepriority(p) ((void)(p))
+#  else
+#    define aio_restorepriority(p) lpwork_restorepriority(p)
+#  endif
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -101,8 +139,14 @@ struct aio_container_s
 #endif
     FAR void *ptr;                 /* Generic pointer to FAR data */
   } u;
+#ifdef CONFIG_FS_AIO_ENGINE
+  dq_entry_t aioc_qlink;           /* Supports the AIO submission queue */
+  worker_t aioc_worker;            /* Performs the I/O on the AIO thread */
+#else
   struct work_s aioc_work;         /* Used to defer I/O to the work thread */
+#endif
   pid_t aioc_pid;                  /* ID of the waiting task */
+  uint8_t aioc_opcode;             /* LIO_READ, LIO_WRITE, or LIO_NOP */
 #ifdef CONFIG_PRIORITY_INHERITANCE
   uint8_t aioc_prio;               /* Priority of the waiting task */
 #endif
@@ -240,11 +284,30 @@ FAR struct aio_container_s *aio_contain(FAR struct aiocb *aiocbp);
 
 FAR struct aiocb *aioc_decant(FAR struct aio_container_s *aioc);
 
+/****************************************************************************
+ * Name: aioc_discard
+ *
+ * Description:
+ *   Undo aio_contain() for a request that could not be queued.  The
+ *   completion queue slot reserved by aio_contain(), if any, is given back
+ *   and the container is freed.
+ *
+ * Input Parameters:
+ *   aioc - Pointer to the AIO control block container
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void aioc_discard(FAR struct aio_container_s *aioc);
+
 /****************************************************************************
  * Name: aio_queue
  *
  * Description:
- *   Schedule the asynchronous I/O on the low priority work queue
+ *   Schedule the asynchronous I/O on the low priority work queue or, if
+ *   CONFIG_FS_AIO_ENGINE is selected, on the AIO submission queue.
  *
  * Input Parameters:
  *   arg - Worker argument.  In this case, a pointer to an instance of
@@ -258,6 +321,24 @@ FAR struct aiocb *aioc_decant(FAR struct aio_container_s *aioc);
 
 int aio_queue(FAR struct aio_container_s *aioc, worker_t worker);
 
+/****************************************************************************
+ * Name: aio_dequeue
+ *
+ * Description:
+ *   Remove asynchronous I/O that has not yet been started from the queue
+ *   on which it was scheduled by aio_queue().
+ *
+ * Input Parameters:
+ *   aioc - Pointer to the AIO control block container
+ *
+ * Returned Value:
+ *   Zero (OK) if the I/O was removed from the queue.  -ENOENT is returned
+ *   if the I/O has already been started.
+ *
+ ****************************************************************************/
+
+int aio_dequeue(FAR struct aio_container_s *aioc);
+
 /****************************************************************************
  * Name: aio_signal
  *
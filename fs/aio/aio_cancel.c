@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/aio/aio_cancel.c
  *
- *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -98,6 +98,7 @@ int aio_cancel(int fildes, FAR struct aiocb *aiocbp)
 {
   FAR struct aio_container_s *aioc;
   FAR struct aio_container_s *next;
+  pid_t pid;
   int status;
   int ret;
 
@@ -133,24 +134,31 @@ int aio_cancel(int fildes, FAR struct aiocb *aiocbp)
                * possibilities:* (1) the work has already been started and
                * is no longer queued, or (2) the work has not been started
                * and is still in the work queue.  Only the second case can
-               * be canceled.  work_cancel() will return -ENOENT in the
+               * be canceled.  aio_dequeue() will return -ENOENT in the
                * first case.
                */
 
-              status = work_cancel(LPWORK, &aioc->aioc_work);
+              status = aio_dequeue(aioc);
               if (status >= 0)
                 {
+                  /* Remove the container from the list of pending
+                   * transfers.  A container for I/O that has already been
+                   * started belongs to the worker that performs the I/O.
+                   */
+
+                  pid = aioc->aioc_pid;
+                  (void)aioc_decant(aioc);
+
+                  /* And notify the client of the cancellation */
+
                   aiocbp->aio_result = -ECANCELED;
+                  (void)aio_signal(pid, aiocbp);
                   ret = AIO_CANCELED;
                 }
               else
                 {
                   ret = AIO_NOTCANCELED;
                 }
-
-              /* Remove the container from the list of pending transfers */
-
-              (void)aioc_decant(aioc);
             }
         }
     }
@@ -177,21 +185,26 @@ int aio_cancel(int fildes, FAR struct aiocb *aiocbp)
                * possibilities:* (1) the work has already been started and
                * is no longer queued, or (2) the work has not been started
                * and is still in the work queue.  Only the second case can
-               * be canceled.  work_cancel() will return -ENOENT in the
+               * be canceled.  aio_dequeue() will return -ENOENT in the
                * first case.
                */
 
-              status = work_cancel(LPWORK, &aioc->aioc_work);
-
-              /* Remove the container from the list of pending transfers */
-
+              status = aio_dequeue(aioc);
               next   = (FAR struct aio_container_s *)aioc->aioc_link.flink;
-              aiocbp = aioc_decant(aioc);
-              DEBUGASSERT(aiocbp);
 
               if (status >= 0)
                 {
+                  /* Remove the container from the list of pending
+                   * transfers and notify the client of the cancellation.
+                   */
+
+                  pid    = aioc->aioc_pid;
+                  aiocbp = aioc_decant(aioc);
+                  DEBUGASSERT(aiocbp);
+
                   aiocbp->aio_result = -ECANCELED;
+                  (void)aio_signal(pid, aiocbp);
+
                   if (ret != AIO_NOTCANCELED)
                     {
                       ret = AIO_CANCELED;
@@ -0,0 +1,724 @@
+/****************************************************************************
+ * fs/aio/aio_engine.c
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <queue.h>
+#include <aio.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/kthread.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/fs/fs.h>
+
+#include "aio/aio.h"
+
+#ifdef CONFIG_FS_AIO_ENGINE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Get the AIO container from its link in the submission queue */
+
+#define AIOC_FROM_QLINK(e) \
+  ((FAR struct aio_container_s *) \
+   ((FAR uint8_t *)(e) - offsetof(struct aio_container_s, aioc_qlink)))
+
+#ifndef MIN
+#  define MIN(a,b) ((a) < (b) ? (a) : (b))
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes the state of one AIO thread */
+
+struct aio_worker_s
+{
+  pid_t aiow_pid;                /* Process ID of the AIO thread */
+  sem_t aiow_sem;                /* Used to wake up the idle AIO thread */
+  bool aiow_idle;                /* True: Waiting for submissions */
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  uint8_t aiow_prio;             /* Current priority of the AIO thread */
+#endif
+#if CONFIG_FS_AIO_COALESCE > 0
+  FAR uint8_t *aiow_buffer;      /* Buffer used to coalesce transfers */
+#endif
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The state of each AIO thread */
+
+static struct aio_worker_s g_aio_worker[CONFIG_FS_AIO_NTHREADS];
+
+/* The number of AIO threads that have been started */
+
+static uint8_t g_aio_nthreads;
+
+/* Submitted I/O that has not yet been started by an AIO thread.  The queue
+ * is protected by aio_lock() and is bounded by the number of pre-allocated
+ * AIO containers.
+ */
+
+static dq_queue_t g_aio_submitq;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_setpriority
+ *
+ * Description:
+ *   Set the priority of an AIO thread.
+ *
+ * Input Parameters:
+ *   worker - The AIO thread
+ *   prio   - The new priority of the thread
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+static void aio_setpriority(FAR struct aio_worker_s *worker, uint8_t prio)
+{
+  struct sched_param param;
+
+  if (prio != worker->aiow_prio)
+    {
+      param.sched_priority = prio;
+      if (sched_setparam(worker->aiow_pid, &param) == OK)
+        {
+          worker->aiow_prio = prio;
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: aio_reprioritize
+ *
+ * Description:
+ *   Set the priority of an AIO thread to the priority of the highest
+ *   priority client with submitted I/O, but never below the configured
+ *   priority of the AIO threads.
+ *
+ * Input Parameters:
+ *   worker - The AIO thread
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The caller holds the AIO lock.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+static void aio_reprioritize(FAR struct aio_worker_s *worker)
+{
+  FAR struct aio_container_s *aioc;
+  FAR dq_entry_t *entry;
+  uint8_t prio = CONFIG_FS_AIO_PRIORITY;
+
+  for (entry = dq_peek(&g_aio_submitq); entry != NULL; entry = dq_next(entry))
+    {
+      aioc = AIOC_FROM_QLINK(entry);
+      if (aioc->aioc_prio > prio)
+        {
+          prio = aioc->aioc_prio;
+        }
+    }
+
+  aio_setpriority(worker, prio);
+}
+#endif
+
+/****************************************************************************
+ * Name: aio_gather
+ *
+ * Description:
+ *   Remove submitted I/O that is adjacent to the I/O in batch[0] from the
+ *   submission queue and add it to the batch.  Reads are adjacent if they
+ *   are from the same file and the offset of one follows the end of the
+ *   other.  Writes are adjacent in the same way or if both append to the
+ *   same file.  Only I/O that fits together in the coalescing buffer is
+ *   gathered.
+ *
+ *   I/O for other files is skipped, but gathering stops at the first
+ *   non-adjacent I/O for the same file so that I/O to a file is still
+ *   started in the order that it was submitted.
+ *
+ * Input Parameters:
+ *   worker - The AIO thread that will perform the I/O
+ *   batch  - The batch of I/O.  batch[0] holds the first I/O.
+ *
+ * Returned Value:
+ *   The number of I/O operations in the batch.
+ *
+ * Assumptions:
+ *   The caller holds the AIO lock.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FS_AIO_COALESCE > 0
+static int aio_gather(FAR struct aio_worker_s *worker,
+                      FAR struct aio_container_s **batch)
+{
+  FAR struct aio_container_s *aioc = batch[0];
+  FAR struct aio_container_s *next;
+  FAR struct aiocb *aiocbp = aioc->aioc_aiocbp;
+  FAR struct file *filep;
+  FAR dq_entry_t *entry;
+  FAR dq_entry_t *flink;
+  size_t total;
+  off_t end;
+  bool append;
+  int nbatch = 1;
+
+  /* Only reads and writes on files can be coalesced */
+
+  if (worker->aiow_buffer == NULL ||
+      (aioc->aioc_opcode != LIO_READ && aioc->aioc_opcode != LIO_WRITE) ||
+#ifdef AIO_HAVE_PSOCK
+      aiocbp->aio_fildes >= CONFIG_NFILE_DESCRIPTORS ||
+#endif
+      aiocbp->aio_nbytes >= CONFIG_FS_AIO_COALESCE)
+    {
+      return 1;
+    }
+
+  filep  = aioc->u.aioc_filep;
+  append = (aioc->aioc_opcode == LIO_WRITE &&
+            (filep->f_oflags & O_APPEND) != 0);
+  total  = aiocbp->aio_nbytes;
+  end    = aiocbp->aio_offset + total;
+
+  for (entry = dq_peek(&g_aio_submitq);
+       entry != NULL && nbatch < CONFIG_FS_NAIOC;
+       entry = flink)
+    {
+      flink  = dq_next(entry);
+      next   = AIOC_FROM_QLINK(entry);
+      aiocbp = next->aioc_aiocbp;
+
+      /* Skip over I/O for other files */
+
+      if (next->u.ptr != (FAR void *)filep)
+        {
+          continue;
+        }
+
+      /* Stop at the first I/O for this file that cannot be coalesced */
+
+      if (next->aioc_opcode != aioc->aioc_opcode ||
+          (!append && aiocbp->aio_offset != end) ||
+          total + aiocbp->aio_nbytes > CONFIG_FS_AIO_COALESCE)
+        {
+          break;
+        }
+
+      dq_rem(entry, &g_aio_submitq);
+      batch[nbatch++] = next;
+
+      total += aiocbp->aio_nbytes;
+      end   += aiocbp->aio_nbytes;
+    }
+
+  return nbatch;
+}
+#endif
+
+/****************************************************************************
+ * Name: aio_transfer
+ *
+ * Description:
+ *   Perform a batch of adjacent reads or writes as a single transfer
+ *   through the coalescing buffer, then distribute the result among the
+ *   individual requests and notify each client.
+ *
+ * Input Parameters:
+ *   worker - The AIO thread that performs the I/O
+ *   batch  - The batch of I/O gathered by aio_gather()
+ *   nbatch - The number of I/O operations in the batch
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#if CONFIG_FS_AIO_COALESCE > 0
+static void aio_transfer(FAR struct aio_worker_s *worker,
+                         FAR struct aio_container_s **batch, int nbatch)
+{
+  FAR struct aio_container_s *aioc = batch[0];
+  FAR struct file *filep = aioc->u.aioc_filep;
+  FAR uint8_t *buffer = worker->aiow_buffer;
+  FAR struct aiocb *aiocbp;
+  ssize_t nxfer;
+  size_t remaining;
+  size_t total;
+  size_t xfer;
+  off_t offset;
+  uint8_t opcode;
+  pid_t pid;
+  int i;
+
+  opcode = aioc->aioc_opcode;
+  offset = aioc->aioc_aiocbp->aio_offset;
+
+  /* Perform the transfer */
+
+  for (i = 0, total = 0; i < nbatch; i++)
+    {
+      aiocbp = batch[i]->aioc_aiocbp;
+      if (opcode == LIO_WRITE)
+        {
+          memcpy(&buffer[total], (FAR const void *)aiocbp->aio_buf,
+                 aiocbp->aio_nbytes);
+        }
+
+      total += aiocbp->aio_nbytes;
+    }
+
+  if (opcode == LIO_READ)
+    {
+      nxfer = file_pread(filep, buffer, total, offset);
+    }
+  else if ((filep->f_oflags & O_APPEND) != 0)
+    {
+      nxfer = file_write(filep, buffer, total);
+    }
+  else
+    {
+      nxfer = file_pwrite(filep, buffer, total, offset);
+    }
+
+  if (nxfer < 0)
+    {
+      int errcode = get_errno();
+      ferr("ERROR: Coalesced transfer failed: %d\n", errcode);
+      DEBUGASSERT(errcode > 0);
+      nxfer = -errcode;
+    }
+
+  /* Distribute the result among the individual requests in order.  A short
+   * transfer completes the leading requests and leaves the trailing ones
+   * short or empty.
+   */
+
+  remaining = nxfer > 0 ? (size_t)nxfer : 0;
+
+  for (i = 0, total = 0; i < nbatch; i++)
+    {
+      aioc   = batch[i];
+      pid    = aioc->aioc_pid;
+      aiocbp = aioc_decant(aioc);
+
+      if (nxfer < 0)
+        {
+          aiocbp->aio_result = nxfer;
+        }
+      else
+        {
+          xfer = MIN(aiocbp->aio_nbytes, remaining);
+          if (opcode == LIO_READ && xfer > 0)
+            {
+              memcpy((FAR void *)aiocbp->aio_buf, &buffer[total], xfer);
+            }
+
+          aiocbp->aio_result = xfer;
+          remaining -= xfer;
+          total     += aiocbp->aio_nbytes;
+        }
+
+      /* Signal the client */
+
+      (void)aio_signal(pid, aiocbp);
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: aio_thread
+ *
+ * Description:
+ *   The AIO threads take submitted I/O from the submission queue and
+ *   perform it, coalescing adjacent I/O when possible.
+ *
+ * Input Parameters:
+ *   argc, argv (not used)
+ *
+ * Returned Value:
+ *   Does not return
+ *
+ ****************************************************************************/
+
+static int aio_thread(int argc, FAR char *argv[])
+{
+  FAR struct aio_container_s *batch[CONFIG_FS_NAIOC];
+  FAR struct aio_worker_s *worker;
+  FAR dq_entry_t *entry;
+  pid_t me = getpid();
+  int nbatch;
+  int i;
+
+  /* Find our state structure.  The threads were started with pre-emption
+   * disabled so the process IDs have all been assigned by now.
+   */
+
+  for (i = 0; i < CONFIG_FS_AIO_NTHREADS; i++)
+    {
+      if (g_aio_worker[i].aiow_pid == me)
+        {
+          break;
+        }
+    }
+
+  DEBUGASSERT(i < CONFIG_FS_AIO_NTHREADS);
+  worker = &g_aio_worker[i];
+
+#if CONFIG_FS_AIO_COALESCE > 0
+  /* Allocate the coalescing buffer.  If this fails, I/O will simply not be
+   * coalesced by this thread.
+   */
+
+  worker->aiow_buffer = (FAR uint8_t *)kmm_malloc(CONFIG_FS_AIO_COALESCE);
+  if (worker->aiow_buffer == NULL)
+    {
+      ferr("ERROR: Failed to allocate the coalescing buffer\n");
+    }
+#endif
+
+  /* Loop forever */
+
+  for (; ; )
+    {
+      aio_lock();
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+      /* Drop any priority boost that is no longer needed */
+
+      aio_reprioritize(worker);
+#endif
+
+      /* Wait until there is submitted I/O */
+
+      while ((entry = dq_remfirst(&g_aio_submitq)) == NULL)
+        {
+#ifdef CONFIG_PRIORITY_INHERITANCE
+          aio_setpriority(worker, CONFIG_FS_AIO_PRIORITY);
+#endif
+          worker->aiow_idle = true;
+          aio_unlock();
+
+          while (sem_wait(&worker->aiow_sem) < 0)
+            {
+              DEBUGASSERT(get_errno() == EINTR);
+            }
+
+          aio_lock();
+        }
+
+      worker->aiow_idle = false;
+
+      /* Gather any adjacent I/O that can be performed together with this
+       * I/O.
+       */
+
+      batch[0] = AIOC_FROM_QLINK(entry);
+      nbatch   = 1;
+
+#if CONFIG_FS_AIO_COALESCE > 0
+      nbatch   = aio_gather(worker, batch);
+#endif
+
+      aio_unlock();
+
+      /* Then perform the I/O.  A single I/O is performed by the worker
+       * function provided when it was submitted.
+       */
+
+#if CONFIG_FS_AIO_COALESCE > 0
+      if (nbatch > 1)
+        {
+          aio_transfer(worker, batch, nbatch);
+        }
+      else
+#endif
+        {
+          batch[0]->aioc_worker(batch[0]);
+        }
+    }
+
+  return OK; /* To keep some compilers happy */
+}
+
+/****************************************************************************
+ * Name: aio_start
+ *
+ * Description:
+ *   Start the AIO threads.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   Zero (OK) if at least one AIO thread was started.  Otherwise, a negated
+ *   errno value is returned.
+ *
+ * Assumptions:
+ *   The caller holds the AIO lock.
+ *
+ ****************************************************************************/
+
+static int aio_start(void)
+{
+  FAR struct aio_worker_s *worker;
+  pid_t pid;
+  int i;
+
+  /* Don't permit any of the threads to run until all of them have been
+   * started.
+   */
+
+  sched_lock();
+
+  for (i = 0; i < CONFIG_FS_AIO_NTHREADS; i++)
+    {
+      worker = &g_aio_worker[i];
+
+      /* The semaphore is used for signaling and, hence, should not have
+       * priority inheritance enabled.
+       */
+
+      (void)sem_init(&worker->aiow_sem, 0, 0);
+      (void)sem_setprotocol(&worker->aiow_sem, SEM_PRIO_NONE);
+#ifdef CONFIG_PRIORITY_INHERITANCE
+      worker->aiow_prio = CONFIG_FS_AIO_PRIORITY;
+#endif
+
+      pid = kernel_thread("aio", CONFIG_FS_AIO_PRIORITY,
+                          CONFIG_FS_AIO_STACKSIZE, (main_t)aio_thread,
+                          (FAR char * const *)NULL);
+      if (pid < 0)
+        {
+          int errcode = get_errno();
+          DEBUGASSERT(errcode > 0);
+
+          ferr("ERROR: kernel_thread %d failed: %d\n", i, errcode);
+          sem_destroy(&worker->aiow_sem);
+
+          if (i == 0)
+            {
+              sched_unlock();
+              return -errcode;
+            }
+
+          break;
+        }
+
+      worker->aiow_pid = pid;
+    }
+
+  g_aio_nthreads = i;
+  sched_unlock();
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_queue
+ *
+ * Description:
+ *   Add the asynchronous I/O to the submission queue and wake up an idle
+ *   AIO thread.  The AIO threads are started when the first I/O is
+ *   submitted.
+ *
+ * Input Parameters:
+ *   aioc   - The AIO control block container
+ *   worker - The function that performs the I/O on the AIO thread
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  Otherwise, -1 is returned and the errno is set
+ *   appropriately.
+ *
+ ****************************************************************************/
+
+int aio_queue(FAR struct aio_container_s *aioc, worker_t worker)
+{
+  FAR struct aio_worker_s *aiow;
+  int ret;
+  int i;
+
+  /* Prohibit context switches until we complete the queuing.  This also
+   * assures that, when several I/O operations are submitted together,
+   * all are queued before any AIO thread runs.
+   */
+
+  sched_lock();
+  aio_lock();
+
+  if (g_aio_nthreads == 0)
+    {
+      ret = aio_start();
+      if (ret < 0)
+        {
+          FAR struct aiocb *aiocbp = aioc->aioc_aiocbp;
+          DEBUGASSERT(aiocbp);
+
+          aio_unlock();
+          sched_unlock();
+
+          aiocbp->aio_result = ret;
+          set_errno(-ret);
+          return ERROR;
+        }
+    }
+
+  /* Add the I/O to the submission queue */
+
+  aioc->aioc_worker = worker;
+  dq_addlast(&aioc->aioc_qlink, &g_aio_submitq);
+
+  /* Find an idle AIO thread */
+
+  for (i = 0; i < g_aio_nthreads; i++)
+    {
+      aiow = &g_aio_worker[i];
+      if (aiow->aiow_idle)
+        {
+          /* Wake it up, raising its priority first if necessary */
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+          if (aioc->aioc_prio > aiow->aiow_prio)
+            {
+              aio_setpriority(aiow, aioc->aioc_prio);
+            }
+#endif
+
+          aiow->aiow_idle = false;
+          sem_post(&aiow->aiow_sem);
+          break;
+        }
+    }
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  /* If all of the AIO threads are busy, then make sure that they are
+   * running at least at the priority of this client so that they will get
+   * to this I/O.
+   */
+
+  if (i >= g_aio_nthreads)
+    {
+      for (i = 0; i < g_aio_nthreads; i++)
+        {
+          aiow = &g_aio_worker[i];
+          if (aioc->aioc_prio > aiow->aiow_prio)
+            {
+              aio_setpriority(aiow, aioc->aioc_prio);
+            }
+        }
+    }
+#endif
+
+  aio_unlock();
+  sched_unlock();
+  return OK;
+}
+
+/****************************************************************************
+ * Name: aio_dequeue
+ *
+ * Description:
+ *   Remove asynchronous I/O that has not yet been started from the
+ *   submission queue.
+ *
+ * Input Parameters:
+ *   aioc - Pointer to the AIO control block container
+ *
+ * Returned Value:
+ *   Zero (OK) if the I/O was removed from the queue.  -ENOENT is returned
+ *   if the I/O has already been started.
+ *
+ ****************************************************************************/
+
+int aio_dequeue(FAR struct aio_container_s *aioc)
+{
+  FAR dq_entry_t *entry;
+  int ret = -ENOENT;
+
+  aio_lock();
+
+  for (entry = dq_peek(&g_aio_submitq); entry != NULL; entry = dq_next(entry))
+    {
+      if (entry == &aioc->aioc_qlink)
+        {
+          dq_rem(entry, &g_aio_submitq);
+          ret = OK;
+          break;
+        }
+    }
+
+  aio_unlock();
+  return ret;
+}
+
+#endif /* CONFIG_FS_AIO_ENGINE */
@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/aio/aio_fsync.c
  *
- *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -76,6 +76,7 @@ static void aio_fsync_worker(FAR void *arg)
 {
   FAR struct aio_container_s *aioc = (FAR struct aio_container_s *)arg;
   FAR struct aiocb *aiocbp;
+  FAR void *ptr;
   pid_t pid;
 #ifdef CONFIG_PRIORITY_INHERITANCE
   uint8_t prio;
@@ -92,11 +93,12 @@ static void aio_fsync_worker(FAR void *arg)
 #ifdef CONFIG_PRIORITY_INHERITANCE
   prio   = aioc->aioc_prio;
 #endif
+  ptr    = aioc->u.ptr;
   aiocbp = aioc_decant(aioc);
 
   /* Perform the fsync using u.aioc_filep */
 
-  ret = file_fsync(aioc->u.aioc_filep);
+  ret = file_fsync((FAR struct file *)ptr);
   if (ret < 0)
     {
       int errcode = get_errno();
@@ -114,9 +116,9 @@ static void aio_fsync_worker(FAR void *arg)
   (void)aio_signal(pid, aiocbp);
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
-  /* Restore the low priority worker thread default priority */
+  /* Restore the worker thread default priority */
 
-  lpwork_restorepriority(prio);
+  aio_restorepriority(prio);
 #endif
 }
 
@@ -230,11 +232,15 @@ int aio_fsync(int op, FAR struct aiocb *aiocbp)
 
   /* Defer the work to the worker thread */
 
+  aioc->aioc_opcode = LIO_NOP;
   ret = aio_queue(aioc, aio_fsync_worker);
   if (ret < 0)
     {
-      /* The result and the errno have already been set */
+      /* The result and the errno have already been set.  Release the
+       * container and any completion queue slot that it reserved.
+       */
 
+      aioc_discard(aioc);
       return ERROR;
     }
 
@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/aio/aio_read.c
  *
- *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -76,6 +76,7 @@ static void aio_read_worker(FAR void *arg)
 {
   FAR struct aio_container_s *aioc = (FAR struct aio_container_s *)arg;
   FAR struct aiocb *aiocbp;
+  FAR void *ptr;
   pid_t pid;
 #ifdef CONFIG_PRIORITY_INHERITANCE
   uint8_t prio;
@@ -92,6 +93,7 @@ static void aio_read_worker(FAR void *arg)
 #ifdef CONFIG_PRIORITY_INHERITANCE
   prio   = aioc->aioc_prio;
 #endif
+  ptr    = aioc->u.ptr;
   aiocbp = aioc_decant(aioc);
 
 #if defined(AIO_HAVE_FILEP) && defined(AIO_HAVE_PSOCK)
@@ -107,7 +109,8 @@ static void aio_read_worker(FAR void *arg)
        *   aio_offset   - File offset
        */
 
-     nread = file_pread(aioc->u.aioc_filep, (FAR void *)aiocbp->aio_buf,
+     nread = file_pread((FAR struct file *)ptr,
+                        (FAR void *)aiocbp->aio_buf,
                         aiocbp->aio_nbytes, aiocbp->aio_offset);
     }
 #endif
@@ -123,7 +126,8 @@ static void aio_read_worker(FAR void *arg)
        *   aio_nbytes   - Length of transfer
        */
 
-      nread = psock_recv(aioc->u.aioc_psock, (FAR void *)aiocbp->aio_buf,
+      nread = psock_recv((FAR struct socket *)ptr,
+                         (FAR void *)aiocbp->aio_buf,
                          aiocbp->aio_nbytes, 0);
     }
 #endif
@@ -147,9 +151,9 @@ static void aio_read_worker(FAR void *arg)
   (void)aio_signal(pid, aiocbp);
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
-  /* Restore the low priority worker thread default priority */
+  /* Restore the worker thread default priority */
 
-  lpwork_restorepriority(prio);
+  aio_restorepriority(prio);
 #endif
 }
 
@@ -280,11 +284,15 @@ int aio_read(FAR struct aiocb *aiocbp)
 
   /* Defer the work to the worker thread */
 
+  aioc->aioc_opcode = LIO_READ;
   ret = aio_queue(aioc, aio_read_worker);
   if (ret < 0)
     {
-      /* The result and the errno have already been set */
+      /* The result and the errno have already been set.  Release the
+       * container and any completion queue slot that it reserved.
+       */
 
+      aioc_discard(aioc);
       return ERROR;
     }
 
@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/aio/aio_signal.c
  *
- *   Copyright (C) 2014-2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014-2015, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -42,6 +42,7 @@
 #include <sys/types.h>
 #include <sched.h>
 #include <signal.h>
+#include <semaphore.h>
 #include <aio.h>
 #include <assert.h>
 #include <errno.h>
@@ -71,7 +72,8 @@
  *   negated errno value is returned.
  *
  * Assumptions:
- *   This function runs only in the context of the worker thread.
+ *   This function runs in the context of the worker thread or, for
+ *   canceled I/O, in the context of aio_cancel().
  *
  ****************************************************************************/
 
@@ -88,6 +90,30 @@ int aio_signal(pid_t pid, FAR struct aiocb *aiocbp)
 
   ret = OK; /* Assume success */
 
+  /* Post the AIO control block to the client's completion queue.  A slot
+   * in the queue was reserved when the I/O was submitted.  No signal is
+   * sent in this case.
+   */
+
+  if (aiocbp->aio_sigevent.sigev_notify == SIGEV_AIOCQ)
+    {
+      FAR struct aiocq *cq =
+        (FAR struct aiocq *)aiocbp->aio_sigevent.sigev_value.sival_ptr;
+
+      DEBUGASSERT(cq != NULL);
+
+      aio_lock();
+      cq->aiocq_ring[cq->aiocq_tail] = aiocbp;
+      if (++cq->aiocq_tail >= cq->aiocq_nentries)
+        {
+          cq->aiocq_tail = 0;
+        }
+
+      aio_unlock();
+      sem_post(&cq->aiocq_ready);
+      return OK;
+    }
+
   /* Signal the client */
 
   if (aiocbp->aio_sigevent.sigev_notify == SIGEV_SIGNAL)
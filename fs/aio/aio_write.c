@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/aio/aio_write.c
  *
- *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -93,6 +93,7 @@ static void aio_write_worker(FAR void *arg)
 {
   FAR struct aio_container_s *aioc = (FAR struct aio_container_s *)arg;
   FAR struct aiocb *aiocbp;
+  FAR void *ptr;
   pid_t pid;
 #ifdef CONFIG_PRIORITY_INHERITANCE
   uint8_t prio;
@@ -112,6 +113,7 @@ static void aio_write_worker(FAR void *arg)
 #ifdef CONFIG_PRIORITY_INHERITANCE
   prio   = aioc->aioc_prio;
 #endif
+  ptr    = aioc->u.ptr;
   aiocbp = aioc_decant(aioc);
 
 #if defined(AIO_HAVE_FILEP) && defined(AIO_HAVE_PSOCK)
@@ -121,7 +123,7 @@ static void aio_write_worker(FAR void *arg)
     {
       /* Call fcntl(F_GETFL) to get the file open mode. */
 
-      oflags = file_fcntl(aioc->u.aioc_filep, F_GETFL);
+      oflags = file_fcntl((FAR struct file *)ptr, F_GETFL);
       if (oflags < 0)
         {
           int errcode = get_errno();
@@ -144,13 +146,13 @@ static void aio_write_worker(FAR void *arg)
         {
           /* Append to the current file position */
 
-          nwritten = file_write(aioc->u.aioc_filep,
+          nwritten = file_write((FAR struct file *)ptr,
                                 (FAR const void *)aiocbp->aio_buf,
                                 aiocbp->aio_nbytes);
         }
       else
         {
-          nwritten = file_pwrite(aioc->u.aioc_filep,
+          nwritten = file_pwrite((FAR struct file *)ptr,
                                  (FAR const void *)aiocbp->aio_buf,
                                  aiocbp->aio_nbytes,
                                  aiocbp->aio_offset);
@@ -169,7 +171,7 @@ static void aio_write_worker(FAR void *arg)
        *   aio_nbytes   - Length of transfer
        */
 
-      nwritten = psock_send(aioc->u.aioc_psock,
+      nwritten = psock_send((FAR struct socket *)ptr,
                             (FAR const void *)aiocbp->aio_buf,
                             aiocbp->aio_nbytes, 0);
     }
@@ -198,9 +200,9 @@ errout:
   (void)aio_signal(pid, aiocbp);
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
-  /* Restore the low priority worker thread default priority */
+  /* Restore the worker thread default priority */
 
-  lpwork_restorepriority(prio);
+  aio_restorepriority(prio);
 #endif
 }
 
@@ -333,11 +335,15 @@ int aio_write(FAR struct aiocb *aiocbp)
 
   /* Defer the work to the worker thread */
 
+  aioc->aioc_opcode = LIO_WRITE;
   ret = aio_queue(aioc, aio_write_worker);
   if (ret < 0)
     {
-      /* The result and the errno have already been set */
+      /* The result and the errno have already been set.  Release the
+       * container and any completion queue slot that it reserved.
+       */
 
+      aioc_discard(aioc);
       return ERROR;
     }
 
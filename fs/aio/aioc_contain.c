@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/aio/aioc_contain.c
  *
- *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -40,6 +40,8 @@
 #include <nuttx/config.h>
 
 #include <sched.h>
+#include <semaphore.h>
+#include <assert.h>
 #include <errno.h>
 
 #include <nuttx/fs/fs.h>
@@ -121,6 +123,31 @@ FAR struct aio_container_s *aio_contain(FAR struct aiocb *aiocbp)
     }
 #endif
 
+  /* If completion is reported through a completion queue, then reserve a
+   * slot in that queue now so that the completion can always be posted.
+   */
+
+  if (aiocbp->aio_sigevent.sigev_notify == SIGEV_AIOCQ)
+    {
+      FAR struct aiocq *cq =
+        (FAR struct aiocq *)aiocbp->aio_sigevent.sigev_value.sival_ptr;
+
+      if (cq == NULL)
+        {
+          set_errno(EINVAL);
+          return NULL;
+        }
+
+      if (sem_trywait(&cq->aiocq_free) < 0)
+        {
+          /* The completion queue is full.  sem_trywait() has already set
+           * the errno value to EAGAIN.
+           */
+
+          return NULL;
+        }
+    }
+
   /* Allocate the AIO control block container, waiting for one to become
    * available if necessary.  This should never fail.
    */
@@ -183,4 +210,36 @@ FAR struct aiocb *aioc_decant(FAR struct aio_container_s *aioc)
   return aiocbp;
 }
 
+/****************************************************************************
+ * Name: aioc_discard
+ *
+ * Description:
+ *   Undo aio_contain() for a request that could not be queued.  The
+ *   completion queue slot reserved by aio_contain(), if any, is given back
+ *   and the container is freed.
+ *
+ * Input Parameters:
+ *   aioc - Pointer to the AIO control block container
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void aioc_discard(FAR struct aio_container_s *aioc)
+{
+  FAR struct aiocb *aiocbp;
+
+  aiocbp = aioc_decant(aioc);
+  DEBUGASSERT(aiocbp);
+
+  if (aiocbp->aio_sigevent.sigev_notify == SIGEV_AIOCQ)
+    {
+      FAR struct aiocq *cq =
+        (FAR struct aiocq *)aiocbp->aio_sigevent.sigev_value.sival_ptr;
+
+      sem_post(&cq->aiocq_free);
+    }
+}
+
 #endif /* CONFIG_FS_AIO */
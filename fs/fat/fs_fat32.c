@@ -583,6 +583,11 @@ static ssize_t fat_read(FAR struct file *filep, FAR char *buffer,
           ff->ff_currentcluster   = cluster;
           ff->ff_currentsector    = fat_cluster2sector(fs, cluster);
           ff->ff_sectorsincluster = fs->fs_fatsecperclus;
+
+#if CONFIG_FAT_NCLUSTERRUNS > 0
+          fat_runadd(ff, SEC_NSECTORS(fs, filep->f_pos) / fs->fs_fatsecperclus,
+                     cluster);
+#endif
         }
 
 #ifdef CONFIG_FAT_DIRECT_RETRY /* Warning avoidance */
@@ -843,6 +848,11 @@ static ssize_t fat_write(FAR struct file *filep, FAR const char *buffer,
           ff->ff_currentcluster   = cluster;
           ff->ff_sectorsincluster = fs->fs_fatsecperclus;
           ff->ff_currentsector    = fat_cluster2sector(fs, cluster);
+
+#if CONFIG_FAT_NCLUSTERRUNS > 0
+          fat_runadd(ff, SEC_NSECTORS(fs, filep->f_pos) / fs->fs_fatsecperclus,
+                     cluster);
+#endif
         }
 
 #ifdef CONFIG_FAT_DIRECT_RETRY /* Warning avoidance */
@@ -1017,6 +1027,10 @@ static off_t fat_seek(FAR struct file *filep, off_t offset, int whence)
   int32_t cluster;
   off_t position;
   unsigned int clustersize;
+#if CONFIG_FAT_NCLUSTERRUNS > 0
+  uint32_t runindex;
+  uint32_t runcluster;
+#endif
   int ret;
 
   /* Sanity checks */
@@ -1139,6 +1153,18 @@ static off_t fat_seek(FAR struct file *filep, off_t offset, int whence)
        */
 
       clustersize = fs->fs_fatsecperclus * fs->fs_hwsectorsize;
+
+#if CONFIG_FAT_NCLUSTERRUNS > 0
+      /* Skip over the part of the cluster chain that is already known
+       * from the run cache.
+       */
+
+      runindex     = fat_runfind(ff, position / clustersize, &runcluster);
+      cluster      = runcluster;
+      filep->f_pos = (off_t)runindex * clustersize;
+      position    -= filep->f_pos;
+#endif
+
       for (; ; )
         {
           /* Skip over clusters prior to the one containing
@@ -1209,6 +1235,10 @@ static off_t fat_seek(FAR struct file *filep, off_t offset, int whence)
 
           filep->f_pos += clustersize;
           position     -= clustersize;
+
+#if CONFIG_FAT_NCLUSTERRUNS > 0
+          fat_runadd(ff, filep->f_pos / clustersize, cluster);
+#endif
         }
 
       /* We get here after we have found the sector containing
@@ -1502,6 +1532,12 @@ static int fat_dup(FAR const struct file *oldp, FAR struct file *newp)
   newff->ff_currentsector    = oldff->ff_currentsector;    /* Current sector */
   newff->ff_cachesector      = 0;                          /* Sector in file buffer */
 
+#if CONFIG_FAT_NCLUSTERRUNS > 0
+  newff->ff_nruns            = oldff->ff_nruns;            /* Known runs of the cluster chain */
+  memcpy(newff->ff_runs, oldff->ff_runs,
+         oldff->ff_nruns * sizeof(struct fat_run_s));
+#endif
+
   /* Attach the private date to the struct file instance */
 
   newp->f_priv = newff;
@@ -2055,6 +2091,21 @@ static int fat_unbind(FAR void *handle, FAR struct inode **blkdriver,
       fat_io_free(fs->fs_buffer, fs->fs_hwsectorsize);
     }
 
+#if CONFIG_FAT_FATCACHE_NSECTORS > 0
+  if (fs->fs_fatbuffer)
+    {
+      fat_io_free(fs->fs_fatbuffer,
+                  CONFIG_FAT_FATCACHE_NSECTORS * fs->fs_hwsectorsize);
+    }
+#endif
+
+#ifdef CONFIG_FAT_FREEMAP
+  if (fs->fs_freemap)
+    {
+      kmm_free(fs->fs_freemap);
+    }
+#endif
+
   sem_destroy(&fs->fs_sem);
   kmm_free(fs);
   return OK;
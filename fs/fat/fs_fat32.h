@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/fat/fs_fat32.h
  *
- *   Copyright (C) 2007-2009, 2011 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2011, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -55,6 +55,22 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Configuration ************************************************************/
+
+/* Number of sectors of the FAT held in a dedicated FAT sector cache.  Zero
+ * means that FAT sectors share the single fs_buffer with directory sectors.
+ */
+
+#ifndef CONFIG_FAT_FATCACHE_NSECTORS
+#  define CONFIG_FAT_FATCACHE_NSECTORS 0
+#endif
+
+/* Number of contiguous cluster runs remembered for each open file */
+
+#ifndef CONFIG_FAT_NCLUSTERRUNS
+#  define CONFIG_FAT_NCLUSTERRUNS 0
+#endif
+
 /****************************************************************************
  * These offsets describes the master boot record.
  *
@@ -713,6 +729,28 @@
  * Public Types
  ****************************************************************************/
 
+/* One sector of the FAT sector cache */
+
+#if CONFIG_FAT_FATCACHE_NSECTORS > 0
+struct fat_fatline_s
+{
+  off_t    fl_sector;              /* FAT sector in the line (0: none) */
+  uint32_t fl_age;                 /* Value of fs_fatclock at the last access */
+  bool     fl_dirty;               /* true: The line must be written to disk */
+};
+#endif
+
+/* A run of contiguous clusters in the cluster chain of a file */
+
+#if CONFIG_FAT_NCLUSTERRUNS > 0
+struct fat_run_s
+{
+  uint32_t fr_index;               /* Index of the first cluster in the file */
+  uint32_t fr_cluster;             /* First cluster of the run */
+  uint32_t fr_ncluster;            /* Number of contiguous clusters in the run */
+};
+#endif
+
 /* This structure represents the overall mountpoint state.  An instance of this
  * structure is retained as inode private data on each mountpoint that is
  * mounted with a fat32 filesystem.
@@ -747,6 +785,16 @@ struct fat_mountpt_s
   uint8_t  fs_fatsecperclus;       /* MBR: Sectors per allocation unit: 2**n, n=0..7 */
   uint8_t *fs_buffer;              /* This is an allocated buffer to hold one sector
                                     * from the device */
+#if CONFIG_FAT_FATCACHE_NSECTORS > 0
+  uint8_t  fs_fatlast;             /* Line of the last FAT sector accessed */
+  uint32_t fs_fatclock;            /* LRU clock of the FAT sector cache */
+  uint8_t *fs_fatbuffer;           /* Sector buffers of the FAT sector cache */
+  struct fat_fatline_s fs_fatline[CONFIG_FAT_FATCACHE_NSECTORS];
+#endif
+#ifdef CONFIG_FAT_FREEMAP
+  uint32_t *fs_freemap;            /* One bit per cluster, set if the cluster
+                                    * is free (NULL: not yet built) */
+#endif
 };
 
 /* This structure represents on open file under the mountpoint.  An instance
@@ -768,6 +816,10 @@ struct fat_file_s
   off_t    ff_currentsector;       /* Current sector being operated on */
   off_t    ff_cachesector;         /* Current sector in the file buffer */
   uint8_t *ff_buffer;              /* File buffer (for partial sector accesses) */
+#if CONFIG_FAT_NCLUSTERRUNS > 0
+  uint8_t  ff_nruns;               /* Number of valid entries in ff_runs */
+  struct fat_run_s ff_runs[CONFIG_FAT_NCLUSTERRUNS]; /* Leading runs of the chain */
+#endif
 };
 
 /* This structure holds the sequence of directory entries used by one
@@ -902,6 +954,14 @@ EXTERN int32_t fat_extendchain(struct fat_mountpt_s *fs, uint32_t cluster);
 
 #define fat_createchain(fs) fat_extendchain(fs, 0)
 
+/* Cache of the cluster runs of an open file */
+
+#if CONFIG_FAT_NCLUSTERRUNS > 0
+EXTERN void   fat_runadd(struct fat_file_s *ff, uint32_t index, uint32_t cluster);
+EXTERN uint32_t fat_runfind(struct fat_file_s *ff, uint32_t index,
+                            uint32_t *pcluster);
+#endif
+
 /* Help for traversing directory trees and accessing directory entries */
 
 EXTERN int    fat_nextdirentry(struct fat_mountpt_s *fs, struct fs_fatdir_s *dir);
@@ -924,6 +984,9 @@ EXTERN int    fat_remove(struct fat_mountpt_s *fs, const char *relpath, bool dir
 
 EXTERN int    fat_fscacheflush(struct fat_mountpt_s *fs);
 EXTERN int    fat_fscacheread(struct fat_mountpt_s *fs, off_t sector);
+#if CONFIG_FAT_FATCACHE_NSECTORS > 0
+EXTERN int    fat_fatcacheflush(struct fat_mountpt_s *fs);
+#endif
 EXTERN int    fat_ffcacheflush(struct fat_mountpt_s *fs, struct fat_file_s *ff);
 EXTERN int    fat_ffcacheread(struct fat_mountpt_s *fs, struct fat_file_s *ff, off_t sector);
 EXTERN int    fat_ffcacheinvalidate(struct fat_mountpt_s *fs, struct fat_file_s *ff);
@@ -1,7 +1,8 @@
 /****************************************************************************
  * fs/fat/fs_fat32util.c
  *
- *   Copyright (C) 2007-2009, 2011, 2013, 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2011, 2013, 2015, 2017 Gregory Nutt. All rights
+ *     reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * References:
@@ -63,6 +64,26 @@
 #include "inode/inode.h"
 #include "fs_fat32.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The sector buffer of line 'l' of the FAT sector cache */
+
+#define FAT_LINEBUFFER(f,l) (&(f)->fs_fatbuffer[(size_t)(l) * (f)->fs_hwsectorsize])
+
+/* Mark the FAT sector returned by the last fat_fatcacheread() as modified */
+
+#if CONFIG_FAT_FATCACHE_NSECTORS > 0
+#  define fat_fatcachedirty(f) ((f)->fs_fatline[(f)->fs_fatlast].fl_dirty = true)
+#else
+#  define fat_fatcachedirty(f) ((f)->fs_dirty = true)
+#endif
+
+/* Size in bytes of the free cluster map (one bit per cluster) */
+
+#define FAT_FREEMAPSIZE(f)  ((((f)->fs_nclusters + 31) >> 5) * sizeof(uint32_t))
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -249,21 +270,454 @@ static int fat_checkbootrecord(struct fat_mountpt_s *fs)
    * things from the boot record that we will need later.
    */
 
-  fs->fs_fatbase     += fs->fs_fatresvdseccount;
+  fs->fs_fatbase     += fs->fs_fatresvdseccount;
+
+  if (fs->fs_type == FSTYPE_FAT32)
+    {
+      fs->fs_rootbase = MBR_GETROOTCLUS(fs->fs_buffer);
+    }
+  else
+    {
+      fs->fs_rootbase = fs->fs_fatbase + ntotalfatsects;
+    }
+
+  fs->fs_database     = fs->fs_fatbase + ntotalfatsects + fs->fs_rootentcnt / DIRSEC_NDIRS(fs);
+  fs->fs_fsifreecount = 0xffffffff;
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_fatlineflush
+ *
+ * Description:
+ *   Write one line of the FAT sector cache to every copy of the FAT if it
+ *   is dirty.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FAT_FATCACHE_NSECTORS > 0
+static int fat_fatlineflush(struct fat_mountpt_s *fs, int ndx)
+{
+  struct fat_fatline_s *line = &fs->fs_fatline[ndx];
+  off_t sector;
+  int ret;
+  int i;
+
+  if (line->fl_dirty)
+    {
+      sector = line->fl_sector;
+      for (i = 0; i < fs->fs_fatnumfats; i++)
+        {
+          ret = fat_hwwrite(fs, FAT_LINEBUFFER(fs, ndx), sector, 1);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          sector += fs->fs_nfatsects;
+        }
+
+      line->fl_dirty = false;
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: fat_fatcacheread
+ *
+ * Description:
+ *   Get a sector of the FAT into the FAT sector cache, replacing the least
+ *   recently used sector if necessary, and return a pointer to the cached
+ *   sector.  If there is no dedicated FAT sector cache, the sector is read
+ *   into fs_buffer.
+ *
+ ****************************************************************************/
+
+static int fat_fatcacheread(struct fat_mountpt_s *fs, off_t sector,
+                            uint8_t **buffer)
+{
+#if CONFIG_FAT_FATCACHE_NSECTORS > 0
+  struct fat_fatline_s *line;
+  uint32_t oldest;
+  int victim;
+  int ret;
+  int i;
+
+  /* Consecutive FAT accesses usually refer to the same sector, so check the
+   * last line accessed first.
+   */
+
+  line = &fs->fs_fatline[fs->fs_fatlast];
+  if (line->fl_sector != sector)
+    {
+      /* Search the rest of the cache, remembering the least recently used
+       * line in case the sector is not there.  Unused lines have age zero.
+       */
+
+      oldest = UINT32_MAX;
+      victim = 0;
+
+      for (i = 0; i < CONFIG_FAT_FATCACHE_NSECTORS; i++)
+        {
+          line = &fs->fs_fatline[i];
+          if (line->fl_sector == sector)
+            {
+              break;
+            }
+
+          if (line->fl_age < oldest)
+            {
+              oldest = line->fl_age;
+              victim = i;
+            }
+        }
+
+      if (i >= CONFIG_FAT_FATCACHE_NSECTORS)
+        {
+          /* Not cached.  Write back the victim if it is dirty and read the
+           * sector in its place.
+           */
+
+          ret = fat_fatlineflush(fs, victim);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          line            = &fs->fs_fatline[victim];
+          line->fl_sector = 0;
+
+          ret = fat_hwread(fs, FAT_LINEBUFFER(fs, victim), sector, 1);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          line->fl_sector = sector;
+          i               = victim;
+        }
+
+      fs->fs_fatlast = i;
+    }
+
+  line->fl_age = ++fs->fs_fatclock;
+  *buffer      = FAT_LINEBUFFER(fs, fs->fs_fatlast);
+  return OK;
+
+#else
+  *buffer = fs->fs_buffer;
+  return fat_fscacheread(fs, sector);
+#endif
+}
+
+/****************************************************************************
+ * Name: fat_countfree
+ *
+ * Description:
+ *   Count the free clusters by examining every entry in the FAT.  If
+ *   freemap is not NULL, the bit of each free cluster is also set in it.
+ *
+ ****************************************************************************/
+
+static int fat_countfree(struct fat_mountpt_s *fs, uint32_t *freemap,
+                         uint32_t *pnfree)
+{
+  uint32_t nfree = 0;
+  uint32_t cluster;
+  bool     isfree;
+
+  if (fs->fs_type == FSTYPE_FAT12)
+    {
+      off_t next;
+
+      /* Examine every cluster in the fat */
+
+      for (cluster = 2; cluster < fs->fs_nclusters; cluster++)
+        {
+          next = fat_getcluster(fs, cluster);
+          if (next < 0)
+            {
+              return (int)next;
+            }
+
+          /* If the cluster is unassigned, then count it as free */
+
+          if (next == 0)
+            {
+              nfree++;
+              if (freemap)
+                {
+                  freemap[cluster >> 5] |= (uint32_t)1 << (cluster & 31);
+                }
+            }
+        }
+    }
+  else
+    {
+      uint8_t     *buffer;
+      off_t        fatsector;
+      unsigned int entsize;
+      unsigned int offset;
+      int          ret;
+
+      /* FAT16 and FAT32 differ only on the size of each entry.  Start with
+       * the entry of cluster 2; the first two entries are reserved.
+       */
+
+      entsize   = fs->fs_type == FSTYPE_FAT16 ? 2 : 4;
+      offset    = 2 * entsize;
+      fatsector = fs->fs_fatbase;
+
+      ret = fat_fatcacheread(fs, fatsector, &buffer);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      for (cluster = 2; cluster < fs->fs_nclusters; cluster++)
+        {
+          /* If we are starting a new sector, then read the new sector */
+
+          if (offset >= fs->fs_hwsectorsize)
+            {
+              ret = fat_fatcacheread(fs, ++fatsector, &buffer);
+              if (ret < 0)
+                {
+                  return ret;
+                }
+
+              offset = 0;
+            }
+
+          if (entsize == 2)
+            {
+              isfree = FAT_GETFAT16(buffer, offset) == 0;
+            }
+          else
+            {
+              isfree = (FAT_GETFAT32(buffer, offset) & 0x0fffffff) == 0;
+            }
+
+          offset += entsize;
+
+          if (isfree)
+            {
+              nfree++;
+              if (freemap)
+                {
+                  freemap[cluster >> 5] |= (uint32_t)1 << (cluster & 31);
+                }
+            }
+        }
+    }
+
+  *pnfree = nfree;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_freemapbuild
+ *
+ * Description:
+ *   Build the free cluster map from the FAT.  This also counts the free
+ *   clusters.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FAT_FREEMAP
+static int fat_freemapbuild(struct fat_mountpt_s *fs)
+{
+  uint32_t *freemap;
+  uint32_t nfree;
+  int ret;
+
+  freemap = (uint32_t *)kmm_zalloc(FAT_FREEMAPSIZE(fs));
+  if (!freemap)
+    {
+      return -ENOMEM;
+    }
+
+  ret = fat_countfree(fs, freemap, &nfree);
+  if (ret < 0)
+    {
+      kmm_free(freemap);
+      return ret;
+    }
+
+  fs->fs_freemap = freemap;
+
+  /* Now the free cluster count is known to be correct */
+
+  if (fs->fs_fsifreecount != nfree)
+    {
+      fs->fs_fsifreecount = nfree;
+      if (fs->fs_type == FSTYPE_FAT32)
+        {
+          fs->fs_fsidirty = true;
+        }
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: fat_freemapfind
+ *
+ * Description:
+ *   Find the first free cluster after 'start' in the free cluster map,
+ *   wrapping around to the beginning of the FAT.
+ *
+ * Return:
+ *   0: no free cluster, >=2: the free cluster number
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FAT_FREEMAP
+static uint32_t fat_freemapfind(struct fat_mountpt_s *fs, uint32_t start)
+{
+  uint32_t nwords = (fs->fs_nclusters + 31) >> 5;
+  uint32_t cluster;
+  uint32_t word;
+  uint32_t ndx;
+  uint32_t i;
+
+  cluster = start + 1;
+  if (cluster >= fs->fs_nclusters)
+    {
+      cluster = 2;
+    }
+
+  /* Skip the bits of the first word that precede 'cluster'.  Bits of
+   * reserved and non-existent clusters are never set.
+   */
+
+  ndx  = cluster >> 5;
+  word = fs->fs_freemap[ndx] & ((uint32_t)0xffffffff << (cluster & 31));
+
+  for (i = 0; i <= nwords; i++)
+    {
+      if (word != 0)
+        {
+          cluster = ndx << 5;
+          while ((word & 1) == 0)
+            {
+              word >>= 1;
+              cluster++;
+            }
+
+          return cluster;
+        }
+
+      if (++ndx >= nwords)
+        {
+          ndx = 0;
+        }
+
+      word = fs->fs_freemap[ndx];
+    }
+
+  return 0;
+}
+#endif
+
+/****************************************************************************
+ * Name: fat_findfree
+ *
+ * Description:
+ *   Find a free cluster, searching forward from the cluster following
+ *   'startcluster' and wrapping around to the beginning of the FAT.
+ *
+ * Return:
+ *   <0:error, 0: no free cluster, >=2: the free cluster number
+ *
+ ****************************************************************************/
+
+static int32_t fat_findfree(struct fat_mountpt_s *fs, uint32_t startcluster)
+{
+  off_t    startsector;
+  uint32_t newcluster;
+
+#ifdef CONFIG_FAT_FREEMAP
+  /* Build the free cluster map on the first allocation.  If there is not
+   * enough memory for it, fall back to searching the FAT.
+   */
+
+  if (!fs->fs_freemap)
+    {
+      int ret = fat_freemapbuild(fs);
+      if (ret < 0 && ret != -ENOMEM)
+        {
+          return ret;
+        }
+    }
+
+  if (fs->fs_freemap)
+    {
+      return (int32_t)fat_freemapfind(fs, startcluster);
+    }
+#endif
+
+  /* Loop until (1) we discover that there are not free clusters
+   * (return 0), an errors occurs (return -errno), or (3) we find
+   * the next cluster (return the new cluster number).
+   */
+
+  newcluster = startcluster;
+  for (; ; )
+    {
+      /* Examine the next cluster in the FAT */
+
+      newcluster++;
+      if (newcluster >= fs->fs_nclusters)
+        {
+          /* If we hit the end of the available clusters, then
+           * wrap back to the beginning because we might have
+           * started at a non-optimal place.  But don't continue
+           * past the start cluster.
+           */
+
+          newcluster = 2;
+          if (newcluster > startcluster)
+            {
+              /* We are back past the starting cluster, then there
+               * is no free cluster.
+               */
+
+              return 0;
+            }
+        }
+
+      /* We have a candidate cluster.  Check if the cluster number is
+       * mapped to a group of sectors.
+       */
+
+      startsector = fat_getcluster(fs, newcluster);
+      if (startsector == 0)
+        {
+          /* Found have found a free cluster break out */
+
+          return newcluster;
+        }
+      else if (startsector < 0)
+        {
+          /* Some error occurred, return the error number */
 
-  if (fs->fs_type == FSTYPE_FAT32)
-    {
-      fs->fs_rootbase = MBR_GETROOTCLUS(fs->fs_buffer);
-    }
-  else
-    {
-      fs->fs_rootbase = fs->fs_fatbase + ntotalfatsects;
-    }
+          return startsector;
+        }
 
-  fs->fs_database     = fs->fs_fatbase + ntotalfatsects + fs->fs_rootentcnt / DIRSEC_NDIRS(fs);
-  fs->fs_fsifreecount = 0xffffffff;
+      /* We wrap all the back to the starting cluster?  If so, then
+       * there are no free clusters.
+       */
 
-  return OK;
+      if (newcluster == startcluster)
+        {
+          return 0;
+        }
+    }
 }
 
 /****************************************************************************
@@ -541,6 +995,18 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
       goto errout;
     }
 
+#if CONFIG_FAT_FATCACHE_NSECTORS > 0
+  /* Allocate the buffers of the FAT sector cache */
+
+  fs->fs_fatbuffer = (FAR uint8_t *)
+    fat_io_alloc(CONFIG_FAT_FATCACHE_NSECTORS * fs->fs_hwsectorsize);
+  if (!fs->fs_fatbuffer)
+    {
+      ret = -ENOMEM;
+      goto errout_with_buffer;
+    }
+#endif
+
   /* Search FAT boot record on the drive.  First check at sector zero.  This
    * could be either the boot record or a partition that refers to the boot
    * record.
@@ -664,6 +1130,15 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
   return OK;
 
 errout_with_buffer:
+#if CONFIG_FAT_FATCACHE_NSECTORS > 0
+  if (fs->fs_fatbuffer)
+    {
+      fat_io_free(fs->fs_fatbuffer,
+                  CONFIG_FAT_FATCACHE_NSECTORS * fs->fs_hwsectorsize);
+      fs->fs_fatbuffer = 0;
+    }
+#endif
+
   fat_io_free(fs->fs_buffer, fs->fs_hwsectorsize);
   fs->fs_buffer = 0;
 
@@ -813,6 +1288,8 @@ off_t fat_cluster2sector(FAR struct fat_mountpt_s *fs,  uint32_t cluster)
 
 off_t fat_getcluster(struct fat_mountpt_s *fs, uint32_t clusterno)
 {
+  uint8_t *buffer;
+
   /* Verify that the cluster number is within range */
 
   if (clusterno >= 2 && clusterno < fs->fs_nclusters)
@@ -839,7 +1316,7 @@ off_t fat_getcluster(struct fat_mountpt_s *fs, uint32_t clusterno)
 
               /* Read the sector at this offset */
 
-              if (fat_fscacheread(fs, fatsector) < 0)
+              if (fat_fatcacheread(fs, fatsector, &buffer) < 0)
                 {
                   /* Read error */
 
@@ -849,7 +1326,7 @@ off_t fat_getcluster(struct fat_mountpt_s *fs, uint32_t clusterno)
               /* Get the first, LS byte of the cluster from the FAT */
 
               fatindex = fatoffset & SEC_NDXMASK(fs);
-              cluster  = fs->fs_buffer[fatindex];
+              cluster  = buffer[fatindex];
 
               /* With FAT12, the second byte of the cluster number may lie in
                * a different sector than the first byte.
@@ -861,7 +1338,7 @@ off_t fat_getcluster(struct fat_mountpt_s *fs, uint32_t clusterno)
                   fatsector++;
                   fatindex = 0;
 
-                  if (fat_fscacheread(fs, fatsector) < 0)
+                  if (fat_fatcacheread(fs, fatsector, &buffer) < 0)
                     {
                       /* Read error */
 
@@ -874,7 +1351,7 @@ off_t fat_getcluster(struct fat_mountpt_s *fs, uint32_t clusterno)
                * on the fact that the byte stream is little-endian.
                */
 
-              cluster |= (unsigned int)fs->fs_buffer[fatindex] << 8;
+              cluster |= (unsigned int)buffer[fatindex] << 8;
 
               /* Now, pick out the correct 12 bit cluster start sector value */
 
@@ -900,14 +1377,14 @@ off_t fat_getcluster(struct fat_mountpt_s *fs, uint32_t clusterno)
               off_t        fatsector = fs->fs_fatbase + SEC_NSECTORS(fs, fatoffset);
               unsigned int fatindex  = fatoffset & SEC_NDXMASK(fs);
 
-              if (fat_fscacheread(fs, fatsector) < 0)
+              if (fat_fatcacheread(fs, fatsector, &buffer) < 0)
                 {
                   /* Read error */
 
                   break;
                 }
 
-              return FAT_GETFAT16(fs->fs_buffer, fatindex);
+              return FAT_GETFAT16(buffer, fatindex);
             }
 
           case FSTYPE_FAT32 :
@@ -916,14 +1393,14 @@ off_t fat_getcluster(struct fat_mountpt_s *fs, uint32_t clusterno)
               off_t        fatsector = fs->fs_fatbase + SEC_NSECTORS(fs, fatoffset);
               unsigned int fatindex  = fatoffset & SEC_NDXMASK(fs);
 
-              if (fat_fscacheread(fs, fatsector) < 0)
+              if (fat_fatcacheread(fs, fatsector, &buffer) < 0)
                 {
                   /* Read error */
 
                   break;
                 }
 
-              return FAT_GETFAT32(fs->fs_buffer, fatindex) & 0x0fffffff;
+              return FAT_GETFAT32(buffer, fatindex) & 0x0fffffff;
             }
 
           default:
@@ -947,6 +1424,9 @@ off_t fat_getcluster(struct fat_mountpt_s *fs, uint32_t clusterno)
 int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
                    off_t nextcluster)
 {
+  uint8_t *buffer;
+  int ret;
+
   /* Verify that the cluster number is within range.  Zero erases the cluster. */
 
   if (clusterno == 0 || (clusterno >= 2 && clusterno < fs->fs_nclusters))
@@ -973,11 +1453,12 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
 
               /* Make sure that the sector at this offset is in the cache */
 
-              if (fat_fscacheread(fs, fatsector) < 0)
+              ret = fat_fatcacheread(fs, fatsector, &buffer);
+              if (ret < 0)
                 {
                   /* Read error */
 
-                  break;
+                  return ret;
                 }
 
               /* Get the LS byte first handling the 12-bit alignment within
@@ -989,7 +1470,7 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
                 {
                   /* Save the LS four bits of the next cluster */
 
-                  value = (fs->fs_buffer[fatindex] & 0x0f) | nextcluster << 4;
+                  value = (buffer[fatindex] & 0x0f) | nextcluster << 4;
                 }
               else
                 {
@@ -998,7 +1479,7 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
                   value = (uint8_t)nextcluster;
                 }
 
-              fs->fs_buffer[fatindex] = value;
+              buffer[fatindex] = value;
 
               /* With FAT12, the second byte of the cluster number may lie in
                * a different sector than the first byte.
@@ -1016,12 +1497,13 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
                    * just modified is written out.
                    */
 
-                  fs->fs_dirty = true;
-                  if (fat_fscacheread(fs, fatsector) < 0)
+                  fat_fatcachedirty(fs);
+                  ret = fat_fatcacheread(fs, fatsector, &buffer);
+                  if (ret < 0)
                     {
                       /* Read error */
 
-                      break;
+                      return ret;
                     }
                 }
 
@@ -1039,10 +1521,10 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
                 {
                   /* Save the MS four bits of the next cluster */
 
-                  value = (fs->fs_buffer[fatindex] & 0xf0) | ((nextcluster >> 8) & 0x0f);
+                  value = (buffer[fatindex] & 0xf0) | ((nextcluster >> 8) & 0x0f);
                 }
 
-              fs->fs_buffer[fatindex] = value;
+              buffer[fatindex] = value;
             }
           break;
 
@@ -1052,14 +1534,15 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
               off_t        fatsector = fs->fs_fatbase + SEC_NSECTORS(fs, fatoffset);
               unsigned int fatindex  = fatoffset & SEC_NDXMASK(fs);
 
-              if (fat_fscacheread(fs, fatsector) < 0)
+              ret = fat_fatcacheread(fs, fatsector, &buffer);
+              if (ret < 0)
                 {
                   /* Read error */
 
-                  break;
+                  return ret;
                 }
 
-              FAT_PUTFAT16(fs->fs_buffer, fatindex, nextcluster & 0xffff);
+              FAT_PUTFAT16(buffer, fatindex, nextcluster & 0xffff);
             }
           break;
 
@@ -1070,17 +1553,18 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
               unsigned int fatindex  = fatoffset & SEC_NDXMASK(fs);
               uint32_t     val;
 
-              if (fat_fscacheread(fs, fatsector) < 0)
+              ret = fat_fatcacheread(fs, fatsector, &buffer);
+              if (ret < 0)
                 {
                   /* Read error */
 
-                  break;
+                  return ret;
                 }
 
               /* Keep the top 4 bits */
 
-              val = FAT_GETFAT32(fs->fs_buffer, fatindex) & 0xf0000000;
-              FAT_PUTFAT32(fs->fs_buffer, fatindex, val | (nextcluster & 0x0fffffff));
+              val = FAT_GETFAT32(buffer, fatindex) & 0xf0000000;
+              FAT_PUTFAT32(buffer, fatindex, val | (nextcluster & 0x0fffffff));
             }
           break;
 
@@ -1090,7 +1574,24 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
 
       /* Mark the modified sector as "dirty" and return success */
 
-      fs->fs_dirty = true;
+      fat_fatcachedirty(fs);
+
+#ifdef CONFIG_FAT_FREEMAP
+      /* Keep the free cluster map in sync with the FAT */
+
+      if (fs->fs_freemap && clusterno >= 2)
+        {
+          if (nextcluster == 0)
+            {
+              fs->fs_freemap[clusterno >> 5] |= (uint32_t)1 << (clusterno & 31);
+            }
+          else
+            {
+              fs->fs_freemap[clusterno >> 5] &= ~((uint32_t)1 << (clusterno & 31));
+            }
+        }
+#endif
+
       return OK;
     }
 
@@ -1213,66 +1714,20 @@ int32_t fat_extendchain(struct fat_mountpt_s *fs, uint32_t cluster)
       startcluster = cluster;
     }
 
-  /* Loop until (1) we discover that there are not free clusters
-   * (return 0), an errors occurs (return -errno), or (3) we find
-   * the next cluster (return the new cluster number).
-   */
+  /* Find the next free cluster following the start cluster */
 
-  newcluster = startcluster;
-  for (; ; )
+  ret = fat_findfree(fs, startcluster);
+  if (ret <= 0)
     {
-      /* Examine the next cluster in the FAT */
-
-      newcluster++;
-      if (newcluster >= fs->fs_nclusters)
-        {
-          /* If we hit the end of the available clusters, then
-           * wrap back to the beginning because we might have
-           * started at a non-optimal place.  But don't continue
-           * past the start cluster.
-           */
-
-          newcluster = 2;
-          if (newcluster > startcluster)
-            {
-              /* We are back past the starting cluster, then there
-               * is no free cluster.
-               */
-
-              return 0;
-            }
-        }
-
-      /* We have a candidate cluster.  Check if the cluster number is
-       * mapped to a group of sectors.
-       */
-
-      startsector = fat_getcluster(fs, newcluster);
-      if (startsector == 0)
-        {
-          /* Found have found a free cluster break out */
-
-          break;
-        }
-      else if (startsector < 0)
-        {
-          /* Some error occurred, return the error number */
+      /* An error occurred (<0) or there are no free clusters (0) */
 
-          return startsector;
-        }
-
-      /* We wrap all the back to the starting cluster?  If so, then
-       * there are no free clusters.
-       */
-
-      if (newcluster == startcluster)
-        {
-          return 0;
-        }
+      return ret;
     }
 
-  /* We get here only if we break out with an available cluster
-   * number in 'newcluster'  Now mark that cluster as in-use.
+  newcluster = ret;
+
+  /* We get here only if we found an available cluster number in
+   * 'newcluster'.  Now mark that cluster as in-use.
    */
 
   ret = fat_putcluster(fs, newcluster, 0x0fffffff);
@@ -1571,6 +2026,34 @@ int fat_fscacheread(struct fat_mountpt_s *fs, off_t sector)
   return OK;
 }
 
+/****************************************************************************
+ * Name: fat_fatcacheflush
+ *
+ * Description:
+ *   Write all dirty sectors in the FAT sector cache to every copy of the
+ *   FAT.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FAT_FATCACHE_NSECTORS > 0
+int fat_fatcacheflush(struct fat_mountpt_s *fs)
+{
+  int ret;
+  int i;
+
+  for (i = 0; i < CONFIG_FAT_FATCACHE_NSECTORS; i++)
+    {
+      ret = fat_fatlineflush(fs, i);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: fat_ffcacheflush
  *
@@ -1700,6 +2183,16 @@ int fat_updatefsinfo(struct fat_mountpt_s *fs)
 {
   int ret;
 
+#if CONFIG_FAT_FATCACHE_NSECTORS > 0
+  /* Flush any dirty sectors from the FAT sector cache */
+
+  ret = fat_fatcacheflush(fs);
+  if (ret < 0)
+    {
+      return ret;
+    }
+#endif
+
   /* Flush the fs_buffer if it is dirty */
 
   ret = fat_fscacheflush(fs);
@@ -1748,6 +2241,7 @@ int fat_updatefsinfo(struct fat_mountpt_s *fs)
 int fat_nfreeclusters(struct fat_mountpt_s *fs, off_t *pfreeclusters)
 {
   uint32_t nfreeclusters;
+  int ret;
 
   /* If number of the first free cluster is valid, then just return that value. */
 
@@ -1757,90 +2251,40 @@ int fat_nfreeclusters(struct fat_mountpt_s *fs, off_t *pfreeclusters)
       return OK;
     }
 
-  /* Otherwise, we will have to count the number of free clusters */
+#ifdef CONFIG_FAT_FREEMAP
+  /* Building the free cluster map also counts the free clusters */
 
-  nfreeclusters = 0;
-  if (fs->fs_type == FSTYPE_FAT12)
+  if (!fs->fs_freemap)
     {
-      off_t sector;
-
-      /* Examine every cluster in the fat */
-
-      for (sector = 2; sector < fs->fs_nclusters; sector++)
+      ret = fat_freemapbuild(fs);
+      if (ret == OK)
         {
-
-          /* If the cluster is unassigned, then increment the count of free clusters */
-
-          if ((uint16_t)fat_getcluster(fs, sector) == 0)
-            {
-              nfreeclusters++;
-            }
+          *pfreeclusters = fs->fs_fsifreecount;
+          return OK;
         }
-    }
-  else
-    {
-      unsigned int cluster;
-      off_t        fatsector;
-      unsigned int offset;
-      int          ret;
-
-      fatsector    = fs->fs_fatbase;
-      offset       = fs->fs_hwsectorsize;
-
-      /* Examine each cluster in the fat */
-
-      for (cluster = fs->fs_nclusters; cluster > 0; cluster--)
+      else if (ret != -ENOMEM)
         {
-          /* If we are starting a new sector, then read the new sector in fs_buffer */
-
-          if (offset >= fs->fs_hwsectorsize)
-            {
-              ret = fat_fscacheread(fs, fatsector++);
-              if (ret < 0)
-                {
-                  return ret;
-                }
-
-              /* Reset the offset to the next FAT entry.
-               * Increment the sector number to read next time around.
-               */
-
-              offset = 0;
-              fatsector++;
-            }
-
-          /* FAT16 and FAT32 differ only on the size of each cluster start
-           * sector number in the FAT.
-           */
+          return ret;
+        }
+    }
+#endif
 
-          if (fs->fs_type == FSTYPE_FAT16)
-            {
-              if (FAT_GETFAT16(fs->fs_buffer, offset) == 0)
-                {
-                  nfreeclusters++;
-                }
-              offset += 2;
-            }
-          else
-            {
-              if (FAT_GETFAT32(fs->fs_buffer, offset) == 0)
-                {
-                  nfreeclusters++;
-                }
+  /* Otherwise, we will have to count the number of free clusters */
 
-              offset += 4;
-            }
-        }
+  ret = fat_countfree(fs, NULL, &nfreeclusters);
+  if (ret < 0)
+    {
+      return ret;
     }
 
-    fs->fs_fsifreecount = nfreeclusters;
-    if (fs->fs_type == FSTYPE_FAT32)
-      {
-        fs->fs_fsidirty = true;
-      }
+  fs->fs_fsifreecount = nfreeclusters;
+  if (fs->fs_type == FSTYPE_FAT32)
+    {
+      fs->fs_fsidirty = true;
+    }
 
-    *pfreeclusters = nfreeclusters;
-    return OK;
+  *pfreeclusters = nfreeclusters;
+  return OK;
 }
 
 /****************************************************************************
@@ -1885,3 +2329,113 @@ int fat_currentsector(struct fat_mountpt_s *fs, struct fat_file_s *ff,
 
   return -ENOSPC;
 }
+
+/****************************************************************************
+ * Name: fat_runadd
+ *
+ * Description:
+ *   Record that cluster number 'index' of the file's cluster chain is
+ *   'cluster'.  The run cache holds the leading runs of the chain, so the
+ *   cluster is remembered only if it immediately follows the last cluster
+ *   already known.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FAT_NCLUSTERRUNS > 0
+void fat_runadd(struct fat_file_s *ff, uint32_t index, uint32_t cluster)
+{
+  struct fat_run_s *run;
+
+  if (ff->ff_nruns == 0)
+    {
+      /* Every chain starts with the start cluster */
+
+      if (ff->ff_startcluster == 0)
+        {
+          return;
+        }
+
+      run              = &ff->ff_runs[0];
+      run->fr_index    = 0;
+      run->fr_cluster  = ff->ff_startcluster;
+      run->fr_ncluster = 1;
+      ff->ff_nruns     = 1;
+    }
+
+  run = &ff->ff_runs[ff->ff_nruns - 1];
+  if (index != run->fr_index + run->fr_ncluster)
+    {
+      /* Already known or not adjacent to the known part of the chain */
+
+      return;
+    }
+
+  if (cluster == run->fr_cluster + run->fr_ncluster)
+    {
+      /* The cluster extends the last run */
+
+      run->fr_ncluster++;
+    }
+  else if (ff->ff_nruns < CONFIG_FAT_NCLUSTERRUNS)
+    {
+      /* The cluster starts a new run */
+
+      run++;
+      run->fr_index    = index;
+      run->fr_cluster  = cluster;
+      run->fr_ncluster = 1;
+      ff->ff_nruns++;
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: fat_runfind
+ *
+ * Description:
+ *   Use the run cache to find cluster number 'index' of the file's cluster
+ *   chain, or the last known cluster before it.
+ *
+ * Return:
+ *   The number of the cluster returned in *pcluster.  This is 'index' if
+ *   that cluster is known; otherwise the cluster chain must be followed
+ *   from there.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FAT_NCLUSTERRUNS > 0
+uint32_t fat_runfind(struct fat_file_s *ff, uint32_t index,
+                     uint32_t *pcluster)
+{
+  struct fat_run_s *run;
+  int i;
+
+  /* Make sure that the start cluster is recorded */
+
+  if (ff->ff_nruns == 0)
+    {
+      fat_runadd(ff, 0, ff->ff_startcluster);
+      if (ff->ff_nruns == 0)
+        {
+          *pcluster = ff->ff_startcluster;
+          return 0;
+        }
+    }
+
+  for (i = 0; i < ff->ff_nruns; i++)
+    {
+      run = &ff->ff_runs[i];
+      if (index < run->fr_index + run->fr_ncluster)
+        {
+          *pcluster = run->fr_cluster + (index - run->fr_index);
+          return index;
+        }
+    }
+
+  /* Beyond the known part of the chain.  Return its last cluster. */
+
+  run       = &ff->ff_runs[ff->ff_nruns - 1];
+  *pcluster = run->fr_cluster + run->fr_ncluster - 1;
+  return run->fr_index + run->fr_ncluster - 1;
+}
+#endif
@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/inode/fs_filedetach.c
  *
- *   Copyright (C) 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -138,6 +138,12 @@ int file_detach(int fd, FAR struct file *filep)
       return -EBADF;
     }
 
+  /* The file structure is about to be vacated.  Remove it from any epoll
+   * interest lists.
+   */
+
+  epoll_release(parent);
+
   /* Duplicate the 'struct file' content into the user-provided file
    * structure.
    */
@@ -76,6 +76,7 @@ void inode_free(FAR struct inode *node)
 
       inode_free(node->i_peer);
       inode_free(node->i_child);
+      inode_hashremove(node);
 
 #ifdef CONFIG_PSEUDOFS_SOFTLINKS
       /* If the inode is a symbolic link, the free the path to the linked
@@ -0,0 +1,219 @@
+/****************************************************************************
+ * fs/inode/fs_inodehash.c
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <assert.h>
+
+#include <nuttx/fs/fs.h>
+
+#include "inode/inode.h"
+
+#if CONFIG_PSEUDOFS_HASHSIZE > 0
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#if (CONFIG_PSEUDOFS_HASHSIZE & (CONFIG_PSEUDOFS_HASHSIZE - 1)) != 0
+#  error CONFIG_PSEUDOFS_HASHSIZE must be a power of two
+#endif
+
+#define INODE_HASHMASK (CONFIG_PSEUDOFS_HASHSIZE - 1)
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Each inode in the pseudo-file system tree is in the hash chain selected
+ * by its parent inode and its name.
+ */
+
+static FAR struct inode *g_inode_hash[CONFIG_PSEUDOFS_HASHSIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_hash
+ *
+ * Description:
+ *   Return the hash chain index for the next name in the path 'name' (up
+ *   to the next '/' or the end of the string) under 'parent'.  This is the
+ *   32-bit FNV-1a hash of the name, seeded with the parent inode address.
+ *
+ ****************************************************************************/
+
+static unsigned int inode_hash(FAR struct inode *parent,
+                               FAR const char *name)
+{
+  uint32_t hash = 2166136261u ^ (uint32_t)((uintptr_t)parent >> 2);
+
+  while (*name != '\0' && *name != '/')
+    {
+      hash ^= (uint8_t)*name++;
+      hash *= 16777619u;
+    }
+
+  /* Fold the upper bits in since only the lower bits are used */
+
+  return (unsigned int)((hash ^ (hash >> 16)) & INODE_HASHMASK);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_hashfind
+ *
+ * Description:
+ *   Find the child of 'parent' (NULL for the root level) whose name matches
+ *   the next name in the path 'name' using the inode hash table.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore
+ *
+ ****************************************************************************/
+
+FAR struct inode *inode_hashfind(FAR struct inode *parent,
+                                 FAR const char *name)
+{
+  FAR struct inode *node;
+
+  for (node = g_inode_hash[inode_hash(parent, name)];
+       node != NULL;
+       node = node->i_hlink)
+    {
+      if (node->i_parent == parent && inode_compare(name, node) == 0)
+        {
+          return node;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: inode_hashinsert
+ *
+ * Description:
+ *   Add an inode that has just been linked under 'parent' (NULL for the
+ *   root level) to the inode hash table.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore
+ *
+ ****************************************************************************/
+
+void inode_hashinsert(FAR struct inode *parent, FAR struct inode *node)
+{
+  unsigned int ndx = inode_hash(parent, node->i_name);
+
+  node->i_parent    = parent;
+  node->i_hlink     = g_inode_hash[ndx];
+  g_inode_hash[ndx] = node;
+}
+
+/****************************************************************************
+ * Name: inode_hashremove
+ *
+ * Description:
+ *   Remove an inode from the inode hash table.  It is not an error if the
+ *   inode is not in the table.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore
+ *
+ ****************************************************************************/
+
+void inode_hashremove(FAR struct inode *node)
+{
+  FAR struct inode *prev = NULL;
+  FAR struct inode *curr;
+  unsigned int ndx;
+
+  ndx = inode_hash(node->i_parent, node->i_name);
+  for (curr = g_inode_hash[ndx]; curr != NULL; curr = curr->i_hlink)
+    {
+      if (curr == node)
+        {
+          if (prev != NULL)
+            {
+              prev->i_hlink = node->i_hlink;
+            }
+          else
+            {
+              g_inode_hash[ndx] = node->i_hlink;
+            }
+
+          node->i_hlink = NULL;
+          break;
+        }
+
+      prev = curr;
+    }
+}
+
+/****************************************************************************
+ * Name: inode_rehash
+ *
+ * Description:
+ *   The list of children has been moved to 'parent' from another inode.
+ *   Re-index each child under its new parent.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore
+ *
+ ****************************************************************************/
+
+void inode_rehash(FAR struct inode *parent)
+{
+  FAR struct inode *node;
+
+  for (node = parent->i_child; node != NULL; node = node->i_peer)
+    {
+      inode_hashremove(node);
+      inode_hashinsert(parent, node);
+    }
+}
+
+#endif /* CONFIG_PSEUDOFS_HASHSIZE > 0 */
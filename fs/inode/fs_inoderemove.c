@@ -88,16 +88,29 @@ FAR struct inode *inode_unlink(FAR const char *path)
   ret = inode_search(&desc);
   if (ret >= 0)
     {
+      FAR struct inode *peer = NULL;
+      FAR struct inode *curr;
+
       node = desc.node;
       DEBUGASSERT(node != NULL);
 
+      /* Find the peer node to the "left" of the node */
+
+      curr = desc.parent ? desc.parent->i_child : g_root_inode;
+      while (curr != node)
+        {
+          DEBUGASSERT(curr != NULL);
+          peer = curr;
+          curr = curr->i_peer;
+        }
+
       /* If peer is non-null, then remove the node from the right of
        * of that peer node.
        */
 
-      if (desc.peer != NULL)
+      if (peer != NULL)
         {
-          desc.peer->i_peer = node->i_peer;
+          peer->i_peer = node->i_peer;
         }
 
       /* If parent is non-null, then remove the node from head of
@@ -116,6 +129,7 @@ FAR struct inode *inode_unlink(FAR const char *path)
            g_root_inode = node->i_peer;
         }
 
+      inode_hashremove(node);
       node->i_peer = NULL;
     }
 
@@ -101,9 +101,21 @@ static FAR struct inode *inode_alloc(FAR const char *name)
  ****************************************************************************/
 
 static void inode_insert(FAR struct inode *node,
-                         FAR struct inode *peer,
                          FAR struct inode *parent)
 {
+  FAR struct inode *peer = NULL;
+  FAR struct inode *curr = parent ? parent->i_child : g_root_inode;
+
+  /* Peers are kept in order by name.  Find the peer node to the "left" of
+   * the new node.
+   */
+
+  while (curr != NULL && inode_compare(node->i_name, curr) > 0)
+    {
+      peer = curr;
+      curr = curr->i_peer;
+    }
+
   /* If peer is non-null, then new node simply goes to the right
    * of that peer node.
    */
@@ -131,6 +143,8 @@ static void inode_insert(FAR struct inode *node,
       node->i_peer = g_root_inode;
       g_root_inode = node;
     }
+
+  inode_hashinsert(parent, node);
 }
 
 /****************************************************************************
@@ -164,7 +178,6 @@ static void inode_insert(FAR struct inode *node,
 int inode_reserve(FAR const char *path, FAR struct inode **inode)
 {
   struct inode_search_s desc;
-  FAR struct inode *left;
   FAR struct inode *parent;
   FAR const char *name;
   int ret;
@@ -199,7 +212,6 @@ int inode_reserve(FAR const char *path, FAR struct inode **inode)
   /* Now we now where to insert the subtree */
 
   name   = desc.path;
-  left   = desc.peer;
   parent = desc.parent;
 
   for (; ; )
@@ -219,12 +231,11 @@ int inode_reserve(FAR const char *path, FAR struct inode **inode)
           node = inode_alloc(name);
           if (node != NULL)
             {
-              inode_insert(node, left, parent);
+              inode_insert(node, parent);
 
               /* Set up for the next time through the loop */
 
               name   = nextname;
-              left   = NULL;
               parent = node;
               continue;
             }
@@ -234,7 +245,7 @@ int inode_reserve(FAR const char *path, FAR struct inode **inode)
           node = inode_alloc(name);
           if (node != NULL)
             {
-              inode_insert(node, left, parent);
+              inode_insert(node, parent);
               *inode = node;
               ret = OK;
               break;
@@ -53,7 +53,8 @@
  * Private Function Prototypes
  ****************************************************************************/
 
-static int _inode_compare(FAR const char *fname, FAR struct inode *node);
+static FAR struct inode *_inode_child(FAR struct inode *parent,
+                                      FAR const char *name);
 #ifdef CONFIG_PSEUDOFS_SOFTLINKS
 static int _inode_linktarget(FAR struct inode *node,
                              FAR struct inode_search_s *desc);
@@ -71,79 +72,55 @@ FAR struct inode *g_root_inode = NULL;
  ****************************************************************************/
 
 /****************************************************************************
- * Name: _inode_compare
+ * Name: _inode_child
  *
  * Description:
- *   Compare two inode names
+ *   Find the child of 'parent' (or the root level inode if 'parent' is
+ *   NULL) whose name matches the next name in the path 'name'.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore
  *
  ****************************************************************************/
 
-static int _inode_compare(FAR const char *fname, FAR struct inode *node)
+static FAR struct inode *_inode_child(FAR struct inode *parent,
+                                      FAR const char *name)
 {
-  char *nname = node->i_name;
+#if CONFIG_PSEUDOFS_HASHSIZE > 0
+  return inode_hashfind(parent, name);
+#else
+  FAR struct inode *node = parent ? parent->i_child : g_root_inode;
 
-  if (!nname)
-    {
-      return 1;
-    }
-
-  if (!fname)
-    {
-      return -1;
-    }
-
-  for (; ; )
+  while (node != NULL)
     {
-      /* At end of node name? */
+      int result = inode_compare(name, node);
 
-      if (!*nname)
-        {
-          /* Yes.. also end of find name? */
-
-          if (!*fname || *fname == '/')
-            {
-              /* Yes.. return match */
-
-              return 0;
-            }
-          else
-            {
-              /* No... return find name > node name */
-
-              return 1;
-            }
-        }
-
-      /* At end of find name? */
+      /* Case 1:  The name is less than the name of the node.  Since the
+       * names are ordered, these means that there is no peer node with
+       * this name and that there can be no match in the fileystem.
+       */
 
-      else if (!*fname || *fname == '/')
+      if (result < 0)
         {
-          /* Yes... return find name < node name */
-
-          return -1;
+          return NULL;
         }
 
-      /* Check for non-matching characters */
+      /* Case 2: The names match */
 
-      else if (*fname > *nname)
+      else if (result == 0)
         {
-          return 1;
-        }
-      else if (*fname < *nname)
-        {
-          return -1;
+          return node;
         }
 
-      /* Not at the end of either string and all of the
-       * characters still match.  keep looking.
+      /* Case 3: The name is greater than the name of the node.  In this
+       * case, the name may still be in the list to the "right"
        */
 
-      else
-        {
-          fname++;
-          nname++;
-        }
+      node = node->i_peer;
     }
+
+  return NULL;
+#endif
 }
 
 /****************************************************************************
@@ -237,8 +214,7 @@ static int _inode_linktarget(FAR struct inode *node,
 static int _inode_search(FAR struct inode_search_s *desc)
 {
   FAR const char   *name;
-  FAR struct inode *node    = g_root_inode;
-  FAR struct inode *left    = NULL;
+  FAR struct inode *node    = NULL;
   FAR struct inode *above   = NULL;
   FAR const char   *relpath = NULL;
   int ret = -ENOENT;
@@ -273,157 +249,122 @@ static int _inode_search(FAR struct inode_search_s *desc)
       return -ENOSYS;
     }
 
-  /* Traverse the pseudo file system node tree until either (1) all nodes
-   * have been examined without finding the matching node, or (2) the
+  /* Traverse the pseudo file system node tree one level at a time until
+   * either (1) the next name is not found at some level, or (2) the
    * matching node is found.
    */
 
-  while (node != NULL)
+  for (; ; )
     {
-      int result = _inode_compare(name, node);
-
-      /* Case 1:  The name is less than the name of the node.
-       * Since the names are ordered, these means that there
-       * is no peer node with this name and that there can be
-       * no match in the fileystem.
-       */
-
-      if (result < 0)
+      node = _inode_child(above, name);
+      if (node == NULL)
         {
-          node = NULL;
           break;
         }
 
-      /* Case 2: the name is greater than the name of the node.
-       * In this case, the name may still be in the list to the
-       * "right"
+      /* Now there are three remaining possibilities:
+       *   (1) This is the node that we are looking for.
+       *   (2) The node we are looking for is "below" this one.
+       *   (3) This node is a mountpoint and will absorb all request
+       *       below this one
        */
 
-      else if (result > 0)
+      name = inode_nextname(name);
+      if (*name == '\0' || INODE_IS_MOUNTPT(node))
         {
-          /* Continue looking to the "right" of this inode. */
+          /* Either (1) we are at the end of the path, so this must be the
+           * node we are looking for or else (2) this node is a mountpoint
+           * and will handle the remaining part of the pathname
+           */
 
-          left = node;
-          node = node->i_peer;
+          relpath = name;
+          ret = OK;
+          break;
         }
 
-      /* The names match */
+      /* More nodes to be examined in the path "below" this one. */
 
-      else
+#ifdef CONFIG_PSEUDOFS_SOFTLINKS
+      /* Was the node a soft link?  If so, then we need need to continue
+       * below the target of the link, not the link itself.
+       */
+
+      if (INODE_IS_SOFTLINK(node))
         {
-          /* Now there are three remaining possibilities:
-           *   (1) This is the node that we are looking for.
-           *   (2) The node we are looking for is "below" this one.
-           *   (3) This node is a mountpoint and will absorb all request
-           *       below this one
+          int status;
+
+          /* If this intermediate inode in the is a soft link, then (1) get
+           * the name of the full path of the soft link, (2) recursively
+           * look-up the inode referenced by the soft link, and (3)
+           * continue searching with that inode instead.
            */
 
-          name = inode_nextname(name);
-          if (*name == '\0' || INODE_IS_MOUNTPT(node))
+          status = _inode_linktarget(node, desc);
+          if (status < 0)
             {
-              /* Either (1) we are at the end of the path, so this must be the
-               * node we are looking for or else (2) this node is a mountpoint
-               * and will handle the remaining part of the pathname
+              /* Probably means that the the target of the symbolic link
+               * does not exist.
                */
 
-              relpath = name;
-              ret = OK;
+              ret = status;
               break;
             }
           else
             {
-              /* More nodes to be examined in the path "below" this one. */
+              FAR struct inode *newnode = desc->node;
 
-#ifdef CONFIG_PSEUDOFS_SOFTLINKS
-              /* Was the node a soft link?  If so, then we need need to
-               * continue below the target of the link, not the link itself.
-               */
-
-              if (INODE_IS_SOFTLINK(node))
+              if (newnode != node)
                 {
-                  int status;
-
-                  /* If this intermediate inode in the is a soft link, then
-                   * (1) get the name of the full path of the soft link, (2)
-                   * recursively look-up the inode referenced by the soft
-                   * link, and (3) continue searching with that inode instead.
+                  /* The node was a valid symbolic link and we have jumped
+                   * to a different, spot in the the pseudo file system
+                   * tree.
                    */
 
-                  status = _inode_linktarget(node, desc);
-                  if (status < 0)
+                  /* Check if this took us to a mountpoint. */
+
+                  if (INODE_IS_MOUNTPT(newnode))
                     {
-                      /* Probably means that the the target of the symbolic
-                       * link does not exist.
+                      /* Return the mountpoint information.  NOTE that the
+                       * last path to the link target was already set by
+                       * _inode_linktarget().
                        */
 
-                      ret = status;
+                      node    = newnode;
+                      above   = NULL;
+                      relpath = name;
+
+                      ret     = OK;
                       break;
                     }
-                  else
-                    {
-                      FAR struct inode *newnode = desc->node;
-
-                      if (newnode != node)
-                        {
-                          /* The node was a valid symbolic link and we have
-                           * jumped to a different, spot in the the pseudo
-                           * file system tree.
-                           */
-
-                          /* Check if this took us to a mountpoint. */
-
-                          if (INODE_IS_MOUNTPT(newnode))
-                            {
-                              /* Return the mountpoint information.
-                               * NOTE that the last path to the link target
-                               * was already set by _inode_linktarget().
-                               */
 
-                              node    = newnode;
-                              above   = NULL;
-                              left    = NULL;
-                              relpath = name;
+                  /* Continue from this new inode. */
 
-                              ret     = OK;
-                              break;
-                            }
-
-                          /* Continue from this new inode. */
-
-                          node = newnode;
-                        }
-                    }
+                  node = newnode;
                 }
-#endif
-              /* Keep looking at the next level "down" */
-
-              above = node;
-              left  = NULL;
-              node  = node->i_child;
             }
         }
+#endif
+      /* Keep looking at the next level "down" */
+
+      above = node;
     }
 
-  /* The node may or may not be null as per one of the following four cases
-   * cases:
+  /* The node may or may not be null as per one of the following cases:
    *
    * With node = NULL
    *
-   *   (1) We went left past the final peer:  The new node name is larger
-   *       than any existing node name at that level.
-   *   (2) We broke out in the middle of the list of peers because the name
-   *       was not found in the ordered list.
-   *   (3) We went down past the final parent:  The new node name is
-   *       "deeper" than anything that we currently have in the tree.
+   *   (1) The name was not found among the children of 'above' (or among
+   *       the root level nodes if 'above' is NULL).  'name' then refers to
+   *       the first part of the path that does not exist.
    *
    * With node != NULL
    *
-   *   (4) When the node matching the full path is found
+   *   (2) When the node matching the full path is found, or
+   *   (3) When a mountpoint absorbing the remainder of the path is found.
    */
 
   desc->path    = name;
   desc->node    = node;
-  desc->peer    = left;
   desc->parent  = above;
   desc->relpath = relpath;
   return ret;
@@ -433,6 +374,82 @@ static int _inode_search(FAR struct inode_search_s *desc)
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: inode_compare
+ *
+ * Description:
+ *   Compare two inode names
+ *
+ ****************************************************************************/
+
+int inode_compare(FAR const char *fname, FAR struct inode *node)
+{
+  char *nname = node->i_name;
+
+  if (!nname)
+    {
+      return 1;
+    }
+
+  if (!fname)
+    {
+      return -1;
+    }
+
+  for (; ; )
+    {
+      /* At end of node name? */
+
+      if (!*nname)
+        {
+          /* Yes.. also end of find name? */
+
+          if (!*fname || *fname == '/')
+            {
+              /* Yes.. return match */
+
+              return 0;
+            }
+          else
+            {
+              /* No... return find name > node name */
+
+              return 1;
+            }
+        }
+
+      /* At end of find name? */
+
+      else if (!*fname || *fname == '/')
+        {
+          /* Yes... return find name < node name */
+
+          return -1;
+        }
+
+      /* Check for non-matching characters */
+
+      else if (*fname > *nname)
+        {
+          return 1;
+        }
+      else if (*fname < *nname)
+        {
+          return -1;
+        }
+
+      /* Not at the end of either string and all of the
+       * characters still match.  keep looking.
+       */
+
+      else
+        {
+          fname++;
+          nname++;
+        }
+    }
+}
+
 /****************************************************************************
  * Name: inode_search
  *
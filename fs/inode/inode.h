@@ -62,7 +62,6 @@
       { \
         (d)->path     = (p); \
         (d)->node     = NULL; \
-        (d)->peer     = NULL; \
         (d)->parent   = NULL; \
         (d)->relpath  = NULL; \
         (d)->linktgt  = NULL; \
@@ -85,7 +84,6 @@
       { \
         (d)->path     = (p); \
         (d)->node     = NULL; \
-        (d)->peer     = NULL; \
         (d)->parent   = NULL; \
         (d)->relpath  = NULL; \
       } \
@@ -132,7 +130,6 @@ struct inode_search_s
 {
   FAR const char *path;      /* Path of inode to find */
   FAR struct inode *node;    /* Pointer to the inode found */
-  FAR struct inode *peer;    /* Node to the "left" for the found inode */
   FAR struct inode *parent;  /* Node "above" the found inode */
   FAR const char *relpath;   /* Relative path into the mountpoint */
 #ifdef CONFIG_PSEUDOFS_SOFTLINKS
@@ -274,6 +271,89 @@ int inode_stat(FAR struct inode *inode, FAR struct stat *buf);
 
 void inode_free(FAR struct inode *node);
 
+/****************************************************************************
+ * Name: inode_compare
+ *
+ * Description:
+ *   Compare the next name in a path (terminated by '/' or NUL) with the
+ *   name of an inode.  Returns zero if they match, a negative value if the
+ *   path name sorts before the inode name, and a positive value otherwise.
+ *
+ ****************************************************************************/
+
+int inode_compare(FAR const char *fname, FAR struct inode *node);
+
+/****************************************************************************
+ * Name: inode_hashfind
+ *
+ * Description:
+ *   Find the child of 'parent' (NULL for the root level) whose name matches
+ *   the next name in the path 'name' using the inode hash table.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore
+ *
+ ****************************************************************************/
+
+#if CONFIG_PSEUDOFS_HASHSIZE > 0
+FAR struct inode *inode_hashfind(FAR struct inode *parent,
+                                 FAR const char *name);
+#endif
+
+/****************************************************************************
+ * Name: inode_hashinsert
+ *
+ * Description:
+ *   Add an inode that has just been linked under 'parent' (NULL for the
+ *   root level) to the inode hash table.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore
+ *
+ ****************************************************************************/
+
+#if CONFIG_PSEUDOFS_HASHSIZE > 0
+void inode_hashinsert(FAR struct inode *parent, FAR struct inode *node);
+#else
+#  define inode_hashinsert(p,n)
+#endif
+
+/****************************************************************************
+ * Name: inode_hashremove
+ *
+ * Description:
+ *   Remove an inode from the inode hash table.  It is not an error if the
+ *   inode is not in the table.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore
+ *
+ ****************************************************************************/
+
+#if CONFIG_PSEUDOFS_HASHSIZE > 0
+void inode_hashremove(FAR struct inode *node);
+#else
+#  define inode_hashremove(n)
+#endif
+
+/****************************************************************************
+ * Name: inode_rehash
+ *
+ * Description:
+ *   The list of children has been moved to 'parent' from another inode.
+ *   Re-index each child under its new parent.
+ *
+ * Assumptions:
+ *   The caller holds the g_inode_sem semaphore
+ *
+ ****************************************************************************/
+
+#if CONFIG_PSEUDOFS_HASHSIZE > 0
+void inode_rehash(FAR struct inode *parent);
+#else
+#  define inode_rehash(p)
+#endif
+
 /****************************************************************************
  * Name: inode_nextname
  *
@@ -79,6 +79,7 @@ extern const struct procfs_operations cpuload_operations;
 extern const struct procfs_operations kmm_operations;
 extern const struct procfs_operations module_operations;
 extern const struct procfs_operations uptime_operations;
+extern const struct procfs_operations wqueue_operations;
 
 /* This is not good.  These are implemented in other sub-systems.  Having to
  * deal with them here is not a good coupling. What is really needed is a
@@ -149,6 +150,10 @@ static const struct procfs_entry_s g_procfs_entries[] =
 #if !defined(CONFIG_FS_PROCFS_EXCLUDE_UPTIME)
   { "uptime",           &uptime_operations },
 #endif
+
+#if defined(CONFIG_SCHED_WORKSTATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_WQUEUE)
+  { "wqueue",           &wqueue_operations },
+#endif
 };
 
 #ifdef CONFIG_FS_PROCFS_REGISTER
@@ -61,7 +61,7 @@
 #include <nuttx/fs/procfs.h>
 #include <nuttx/fs/dirent.h>
 
-#ifdef CONFIG_SCHED_CPULOAD
+#if defined(CONFIG_SCHED_CPULOAD) || defined(CONFIG_SCHED_CPUACCT)
 #  include <nuttx/clock.h>
 #endif
 
@@ -105,6 +105,10 @@ enum proc_node_e
   PROC_LOADAVG,                       /* Average CPU utilization */
 #endif
   PROC_STACK,                         /* Task stack info */
+#ifdef CONFIG_SCHED_CPUACCT
+  PROC_SCHEDSTAT,                     /* Precise CPU accounting */
+  PROC_LATENCY,                       /* Scheduling latency histogram */
+#endif
   PROC_GROUP,                         /* Group directory */
   PROC_GROUP_STATUS,                  /* Task group status */
   PROC_GROUP_FD                       /* Group file descriptors */
@@ -171,6 +175,14 @@ static ssize_t proc_loadavg(FAR struct proc_file_s *procfile,
 static ssize_t proc_stack(FAR struct proc_file_s *procfile,
                  FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen,
                  off_t offset);
+#ifdef CONFIG_SCHED_CPUACCT
+static ssize_t proc_schedstat(FAR struct proc_file_s *procfile,
+                 FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen,
+                 off_t offset);
+static ssize_t proc_latency(FAR struct proc_file_s *procfile,
+                 FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen,
+                 off_t offset);
+#endif
 static ssize_t proc_groupstatus(FAR struct proc_file_s *procfile,
                  FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen,
                  off_t offset);
@@ -255,6 +267,18 @@ static const struct proc_node_s g_stack =
   "stack",        "stack",   (uint8_t)PROC_STACK,        DTYPE_FILE        /* Task stack info */
 };
 
+#ifdef CONFIG_SCHED_CPUACCT
+static const struct proc_node_s g_schedstat =
+{
+  "schedstat",    "schedstat", (uint8_t)PROC_SCHEDSTAT,  DTYPE_FILE        /* Precise CPU accounting */
+};
+
+static const struct proc_node_s g_latency =
+{
+  "latency",      "latency", (uint8_t)PROC_LATENCY,      DTYPE_FILE        /* Scheduling latency histogram */
+};
+#endif
+
 static const struct proc_node_s g_group =
 {
   "group",        "group",   (uint8_t)PROC_GROUP,        DTYPE_DIRECTORY   /* Group directory */
@@ -280,6 +304,10 @@ static FAR const struct proc_node_s * const g_nodeinfo[] =
   &g_loadavg,      /* Average CPU utilization */
 #endif
   &g_stack,        /* Task stack info */
+#ifdef CONFIG_SCHED_CPUACCT
+  &g_schedstat,    /* Precise CPU accounting */
+  &g_latency,      /* Scheduling latency histogram */
+#endif
   &g_group,        /* Group directory */
   &g_groupstatus,  /* Task group status */
   &g_groupfd       /* Group file descriptors */
@@ -296,6 +324,10 @@ static const struct proc_node_s * const g_level0info[] =
   &g_loadavg,      /* Average CPU utilization */
 #endif
   &g_stack,        /* Task stack info */
+#ifdef CONFIG_SCHED_CPUACCT
+  &g_schedstat,    /* Precise CPU accounting */
+  &g_latency,      /* Scheduling latency histogram */
+#endif
   &g_group,        /* Group directory */
 };
 #define PROC_NLEVEL0NODES (sizeof(g_level0info)/sizeof(FAR const struct proc_node_s * const))
@@ -763,6 +795,155 @@ static ssize_t proc_stack(FAR struct proc_file_s *procfile,
   return totalsize;
 }
 
+/****************************************************************************
+ * Name: proc_schedstat
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_CPUACCT
+static ssize_t proc_schedstat(FAR struct proc_file_s *procfile,
+                              FAR struct tcb_s *tcb, FAR char *buffer,
+                              size_t buflen, off_t offset)
+{
+  struct cpuacct_s acct;
+  FAR const char *label;
+  unsigned long value;
+  size_t remaining;
+  size_t linesize;
+  size_t copysize;
+  size_t totalsize;
+  int i;
+
+  /* Sample the counts for the thread.  This will fail only if the thread
+   * exited after the procfs entry was opened.
+   */
+
+  if (sched_cpuacct(procfile->pid, &acct) < 0)
+    {
+      return 0;
+    }
+
+  remaining = buflen;
+  totalsize = 0;
+
+  /* Show the total run time in seconds and microseconds */
+
+  linesize   = snprintf(procfile->line, STATUS_LINELEN, "%-12s%lu.%06lu\n",
+                        "RunTime:",
+                        (unsigned long)(acct.runtime / USEC_PER_SEC),
+                        (unsigned long)(acct.runtime % USEC_PER_SEC));
+  copysize   = procfs_memcpy(procfile->line, linesize, buffer, remaining, &offset);
+
+  totalsize += copysize;
+  buffer    += copysize;
+  remaining -= copysize;
+
+  /* Show the context switch counts and the worst case latency */
+
+  for (i = 0; i < 3 && totalsize < buflen; i++)
+    {
+      switch (i)
+        {
+          default:
+          case 0:
+            label = "Voluntary:";
+            value = acct.nvcsw;
+            break;
+
+          case 1:
+            label = "Preempted:";
+            value = acct.nivcsw;
+            break;
+
+          case 2:
+            label = "MaxLatency:";
+            value = acct.maxlatency;
+            break;
+        }
+
+      linesize   = snprintf(procfile->line, STATUS_LINELEN, "%-12s%lu\n",
+                            label, value);
+      copysize   = procfs_memcpy(procfile->line, linesize, buffer, remaining,
+                                 &offset);
+
+      totalsize += copysize;
+      buffer    += copysize;
+      remaining -= copysize;
+    }
+
+  return totalsize;
+}
+#endif
+
+/****************************************************************************
+ * Name: proc_latency
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_CPUACCT
+static ssize_t proc_latency(FAR struct proc_file_s *procfile,
+                            FAR struct tcb_s *tcb, FAR char *buffer,
+                            size_t buflen, off_t offset)
+{
+  struct cpuacct_s acct;
+  unsigned long lower;
+  size_t remaining;
+  size_t linesize;
+  size_t copysize;
+  size_t totalsize;
+  int i;
+
+  if (sched_cpuacct(procfile->pid, &acct) < 0)
+    {
+      return 0;
+    }
+
+  remaining = buflen;
+  totalsize = 0;
+
+  /* Show the header */
+
+  linesize   = snprintf(procfile->line, STATUS_LINELEN, "%-15s %s\n",
+                        "Latency (us)", "Count");
+  copysize   = procfs_memcpy(procfile->line, linesize, buffer, remaining, &offset);
+
+  totalsize += copysize;
+  buffer    += copysize;
+  remaining -= copysize;
+
+  /* Then one line for each histogram bucket.  Bucket 0 holds latencies
+   * below 2 microseconds; bucket n holds latencies in the range
+   * [2**n, 2**(n+1)).  The last bucket holds everything larger.
+   */
+
+  for (i = 0; i < CPUACCT_NBUCKETS && totalsize < buflen; i++)
+    {
+      lower = i > 0 ? 1ul << i : 0;
+
+      if (i < CPUACCT_NBUCKETS - 1)
+        {
+          linesize = snprintf(procfile->line, STATUS_LINELEN,
+                              "%7lu-%-7lu %lu\n", lower,
+                              (1ul << (i + 1)) - 1,
+                              (unsigned long)acct.latency[i]);
+        }
+      else
+        {
+          linesize = snprintf(procfile->line, STATUS_LINELEN,
+                              "%7lu+%-7s %lu\n", lower, "",
+                              (unsigned long)acct.latency[i]);
+        }
+
+      copysize   = procfs_memcpy(procfile->line, linesize, buffer, remaining,
+                                 &offset);
+
+      totalsize += copysize;
+      buffer    += copysize;
+      remaining -= copysize;
+    }
+
+  return totalsize;
+}
+#endif
+
 /****************************************************************************
  * Name: proc_groupstatus
  ****************************************************************************/
@@ -1180,6 +1361,16 @@ static ssize_t proc_read(FAR struct file *filep, FAR char *buffer,
       ret = proc_stack(procfile, tcb, buffer, buflen, filep->f_pos);
       break;
 
+#ifdef CONFIG_SCHED_CPUACCT
+    case PROC_SCHEDSTAT: /* Precise CPU accounting */
+      ret = proc_schedstat(procfile, tcb, buffer, buflen, filep->f_pos);
+      break;
+
+    case PROC_LATENCY: /* Scheduling latency histogram */
+      ret = proc_latency(procfile, tcb, buffer, buflen, filep->f_pos);
+      break;
+#endif
+
     case PROC_GROUP_STATUS: /* Task group status */
       ret = proc_groupstatus(procfile, tcb, buffer, buflen, filep->f_pos);
       break;
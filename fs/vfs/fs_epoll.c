@@ -42,190 +42,1194 @@
 #include <sys/epoll.h>
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
 #include <poll.h>
+#include <semaphore.h>
+#include <assert.h>
 #include <errno.h>
-#include <string.h>
 #include <debug.h>
 
+#include <nuttx/irq.h>
+#include <nuttx/clock.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/cancelpt.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/net/net.h>
+
+#include "inode/inode.h"
 
 #ifndef CONFIG_DISABLE_POLL
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define epoll_semgive(sem) sem_post(sem)
+
+/* Input flags that are not poll events */
+
+#define EPOLL_FLAGS (EPOLLET | EPOLLONESHOT)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One descriptor in the interest list.  The pollfd is registered with the
+ * driver for as long as the descriptor is armed.  It must be the first
+ * member:  epoll_callback() recovers the node from the pollfd pointer that
+ * the driver passes back.
+ *
+ * The node refers to the open file or socket structure, not to the
+ * descriptor number, so that a descriptor number that is reused after a
+ * close cannot be confused with the original.  epoll_release() removes the
+ * node before that structure is closed.
+ */
+
+struct epoll_head_s;
+struct epoll_node_s
+{
+  struct pollfd en_pfd;                 /* Registered with the driver */
+  FAR struct epoll_head_s *en_eph;      /* The epoll instance */
+  FAR struct epoll_node_s *en_flink;    /* Next in the interest list */
+  FAR struct epoll_node_s *en_rlink;    /* Next in the ready list */
+  FAR void *en_obj;                     /* The struct file or struct socket */
+  uint32_t en_events;                   /* Events and flags from epoll_ctl() */
+  epoll_data_t en_data;                 /* User data from epoll_ctl() */
+  bool en_socket;                       /* en_obj is a struct socket */
+  bool en_armed;                        /* The pollfd is set up */
+  bool en_ready;                        /* The node is in a ready list */
+};
+
+/* The state of one epoll instance, attached to the f_priv of its file
+ * descriptor.
+ *
+ * The ready list is modified by driver callbacks that may run in interrupt
+ * context so it is protected by a critical section.  Everything else is
+ * protected by eh_exclsem.  The list of all instances is protected by
+ * g_epoll_sem, which must be taken before eh_exclsem.
+ */
+
+struct epoll_head_s
+{
+  FAR struct epoll_head_s *eh_flink;    /* Next in g_epoll_heads */
+  sem_t eh_exclsem;                     /* Serializes epoll_ctl/wait */
+  sem_t eh_waitsem;                     /* Posted when an event is reported */
+  FAR struct epoll_node_s *eh_interest; /* All monitored descriptors */
+  FAR struct epoll_node_s *eh_rdhead;   /* Descriptors with pending events */
+  FAR struct epoll_node_s *eh_rdtail;
+  uint8_t eh_nwaiters;                  /* Threads blocked on eh_waitsem */
+  uint8_t eh_npost;                     /* Pending posts by epoll_callback() */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int epoll_do_close(FAR struct file *filep);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* All epoll instances.  epoll_release() searches these when a file or
+ * socket is closed.
+ */
+
+static sem_t g_epoll_sem = SEM_INITIALIZER(1);
+static FAR struct epoll_head_s *g_epoll_heads;
+
+static const struct file_operations g_epoll_ops =
+{
+  NULL,            /* open */
+  epoll_do_close,  /* close */
+  NULL,            /* read */
+  NULL,            /* write */
+  NULL,            /* seek */
+  NULL,            /* ioctl */
+  NULL             /* poll */
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+  , NULL           /* unlink */
+#endif
+};
+
+/* All epoll descriptors refer to this anonymous inode.  It is never
+ * inserted into the pseudo-file system tree and, since it holds a
+ * reference to itself, it is never freed.
+ */
+
+static struct inode g_epoll_inode =
+{
+  NULL,                   /* i_peer */
+  NULL,                   /* i_child */
+#if CONFIG_PSEUDOFS_HASHSIZE > 0
+  NULL,                   /* i_parent */
+  NULL,                   /* i_hlink */
+#endif
+  1,                      /* i_crefs */
+  FSNODEFLAG_TYPE_DRIVER, /* i_flags */
+  {
+    &g_epoll_ops          /* u */
+  },
+#ifdef CONFIG_FILE_MODE
+  0,                      /* i_mode */
+#endif
+  NULL,                   /* i_private */
+  { '\0' }                /* i_name */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: epoll_semtake
+ ****************************************************************************/
+
+static int epoll_semtake(FAR sem_t *sem)
+{
+  if (sem_wait(sem) < 0)
+    {
+      int errcode = get_errno();
+
+      /* The only case that an error should occur here is if the wait were
+       * awakened by a signal.
+       */
+
+      DEBUGASSERT(errcode == EINTR);
+      return -errcode;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: epoll_semtake_noint
+ *
+ * Description:
+ *   Take a semaphore, ignoring any signals.  Used by epoll_release() which
+ *   must not fail.
+ *
+ ****************************************************************************/
+
+static void epoll_semtake_noint(FAR sem_t *sem)
+{
+  while (sem_wait(sem) != 0)
+    {
+      /* The only case that an error should occur here is if the wait was
+       * awakened by a signal.
+       */
+
+      DEBUGASSERT(get_errno() == EINTR);
+    }
+}
+
+/****************************************************************************
+ * Name: epoll_object
+ *
+ * Description:
+ *   Map a file or socket descriptor to the struct file or struct socket
+ *   that it refers to.  NULL is returned if the descriptor is not open.
+ *
+ ****************************************************************************/
+
+static FAR void *epoll_object(int fd, FAR bool *socket)
+{
+  FAR struct file *filep;
+#if defined(CONFIG_NET) && CONFIG_NSOCKET_DESCRIPTORS > 0
+  FAR struct socket *psock;
+#endif
+
+  if ((unsigned int)fd < CONFIG_NFILE_DESCRIPTORS)
+    {
+      filep = fs_getfilep(fd);
+      if (filep != NULL && filep->f_inode != NULL)
+        {
+          *socket = false;
+          return filep;
+        }
+
+      return NULL;
+    }
+
+#if defined(CONFIG_NET) && CONFIG_NSOCKET_DESCRIPTORS > 0
+  psock = sockfd_socket(fd);
+  if (psock != NULL && psock->s_crefs > 0)
+    {
+      *socket = true;
+      return psock;
+    }
+#endif
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: epoll_fdpoll
+ *
+ * Description:
+ *   Set up or tear down the node's pollfd through the file or socket
+ *   structure that it refers to.
+ *
+ ****************************************************************************/
+
+static int epoll_fdpoll(FAR struct epoll_node_s *node, bool setup)
+{
+#if defined(CONFIG_NET) && CONFIG_NSOCKET_DESCRIPTORS > 0
+  if (node->en_socket)
+    {
+      return psock_poll((FAR struct socket *)node->en_obj, &node->en_pfd,
+                        setup);
+    }
+#endif
+
+  return file_poll((FAR struct file *)node->en_obj, &node->en_pfd, setup);
+}
+
+/****************************************************************************
+ * Name: epoll_head
+ *
+ * Description:
+ *   Map an epoll file descriptor to its instance.  On failure, the errno
+ *   value is set and NULL is returned.
+ *
+ ****************************************************************************/
+
+static FAR struct epoll_head_s *epoll_head(int epfd)
+{
+  FAR struct file *filep;
+
+  filep = fs_getfilep(epfd);
+  if (filep == NULL)
+    {
+      return NULL;
+    }
+
+  if (filep->f_inode == NULL)
+    {
+      set_errno(EBADF);
+      return NULL;
+    }
+
+  if (filep->f_inode != &g_epoll_inode || filep->f_priv == NULL)
+    {
+      set_errno(EINVAL);
+      return NULL;
+    }
+
+  return (FAR struct epoll_head_s *)filep->f_priv;
+}
+
+/****************************************************************************
+ * Name: epoll_queue
+ *
+ * Description:
+ *   Add a node to the tail of the ready list if it is not already there.
+ *   Must be called from within a critical section.
+ *
+ ****************************************************************************/
+
+static void epoll_queue(FAR struct epoll_head_s *eph,
+                        FAR struct epoll_node_s *node)
+{
+  if (!node->en_ready)
+    {
+      node->en_ready = true;
+      node->en_rlink = NULL;
+
+      if (eph->eh_rdtail != NULL)
+        {
+          eph->eh_rdtail->en_rlink = node;
+        }
+      else
+        {
+          eph->eh_rdhead = node;
+        }
+
+      eph->eh_rdtail = node;
+    }
+}
+
+/****************************************************************************
+ * Name: epoll_unqueue
+ *
+ * Description:
+ *   Remove a node from the ready list and discard any pending events.  The
+ *   node must already be disarmed.
+ *
+ ****************************************************************************/
+
+static void epoll_unqueue(FAR struct epoll_head_s *eph,
+                          FAR struct epoll_node_s *node)
+{
+  FAR struct epoll_node_s *prev = NULL;
+  FAR struct epoll_node_s *curr;
+  irqstate_t flags;
+
+  flags = enter_critical_section();
+  if (node->en_ready)
+    {
+      for (curr = eph->eh_rdhead; curr != NULL; curr = curr->en_rlink)
+        {
+          if (curr == node)
+            {
+              if (prev != NULL)
+                {
+                  prev->en_rlink = node->en_rlink;
+                }
+              else
+                {
+                  eph->eh_rdhead = node->en_rlink;
+                }
+
+              if (eph->eh_rdtail == node)
+                {
+                  eph->eh_rdtail = prev;
+                }
+
+              break;
+            }
+
+          prev = curr;
+        }
+
+      node->en_ready = false;
+    }
+
+  node->en_pfd.revents = 0;
+  leave_critical_section(flags);
+}
+
+/****************************************************************************
+ * Name: epoll_callback
+ *
+ * Description:
+ *   Called via poll_notify() when a driver reports events on a monitored
+ *   descriptor.  Queues the node and wakes up epoll_wait() if it is
+ *   blocked.  May run in interrupt context.
+ *
+ ****************************************************************************/
+
+static void epoll_callback(FAR struct pollfd *fds)
+{
+  FAR struct epoll_node_s *node = (FAR struct epoll_node_s *)fds;
+  FAR struct epoll_head_s *eph = node->en_eph;
+  irqstate_t flags;
+
+  flags = enter_critical_section();
+  epoll_queue(eph, node);
+
+  /* Only post when someone is waiting and has not already been posted.
+   * Otherwise the semaphore count would grow with every event.
+   */
+
+  if (eph->eh_nwaiters > 0 && eph->eh_npost == 0)
+    {
+      eph->eh_npost++;
+      epoll_semgive(&eph->eh_waitsem);
+    }
+
+  leave_critical_section(flags);
+}
+
+/****************************************************************************
+ * Name: epoll_arm
+ *
+ * Description:
+ *   Register the node's pollfd with the driver.  If the descriptor is
+ *   already ready, the driver will report it immediately.
+ *
+ ****************************************************************************/
+
+static int epoll_arm(FAR struct epoll_node_s *node)
+{
+  int ret;
+
+  DEBUGASSERT(!node->en_armed);
+
+  node->en_pfd.sem     = &node->en_eph->eh_waitsem;
+  node->en_pfd.events  = (pollevent_t)(node->en_events & ~EPOLL_FLAGS) |
+                         POLLERR | POLLHUP;
+  node->en_pfd.revents = 0;
+  node->en_pfd.priv    = NULL;
+  node->en_pfd.cb      = epoll_callback;
+
+  ret = epoll_fdpoll(node, true);
+  if (ret >= 0)
+    {
+      node->en_armed = true;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: epoll_disarm
+ *
+ * Description:
+ *   Tear down the node's pollfd.  Events reported up to this point remain
+ *   in en_pfd.revents.
+ *
+ ****************************************************************************/
+
+static void epoll_disarm(FAR struct epoll_node_s *node)
+{
+  if (node->en_armed)
+    {
+      (void)epoll_fdpoll(node, false);
+      node->en_armed = false;
+    }
+}
+
+/****************************************************************************
+ * Name: epoll_scan
+ *
+ * Description:
+ *   Drivers that have not been converted to poll_notify() post the
+ *   semaphore directly and so cannot tell us which descriptor became
+ *   ready.  When that happens, fall back to checking every armed
+ *   descriptor.  The poll is torn down and set up again since some drivers
+ *   only update revents on teardown.
+ *
+ ****************************************************************************/
+
+static void epoll_scan(FAR struct epoll_head_s *eph)
+{
+  FAR struct epoll_node_s *node;
+  irqstate_t flags;
+  pollevent_t revents;
+
+  for (node = eph->eh_interest; node != NULL; node = node->en_flink)
+    {
+      if (node->en_armed && !node->en_ready)
+        {
+          epoll_disarm(node);
+          revents = node->en_pfd.revents;
+          (void)epoll_arm(node);
+
+          if (revents != 0)
+            {
+              flags = enter_critical_section();
+              node->en_pfd.revents |= revents;
+              epoll_queue(eph, node);
+              leave_critical_section(flags);
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: epoll_drain
+ *
+ * Description:
+ *   Consume any posts of eh_waitsem that have not been waited for.  Posts
+ *   that were not made by epoll_callback() trigger a scan.
+ *
+ ****************************************************************************/
+
+static void epoll_drain(FAR struct epoll_head_s *eph)
+{
+  irqstate_t flags;
+  bool scan = false;
+
+  flags = enter_critical_section();
+  while (sem_trywait(&eph->eh_waitsem) == OK)
+    {
+      if (eph->eh_npost > 0)
+        {
+          eph->eh_npost--;
+        }
+      else
+        {
+          scan = true;
+        }
+    }
+
+  leave_critical_section(flags);
+
+  if (scan)
+    {
+      epoll_scan(eph);
+    }
+}
+
+/****************************************************************************
+ * Name: epoll_harvest
+ *
+ * Description:
+ *   Move up to maxevents entries from the ready list to the caller's
+ *   buffer.  The work done is proportional to the number of ready
+ *   descriptors, not to the size of the interest list.
+ *
+ *   Level-triggered descriptors are torn down and set up again so that
+ *   the driver reports their current state and queues them again if they
+ *   are still ready.  Edge-triggered descriptors remain armed and are
+ *   reported again only when the driver signals a new event.  One-shot
+ *   descriptors are disarmed.
+ *
+ ****************************************************************************/
+
+static int epoll_harvest(FAR struct epoll_head_s *eph,
+                         FAR struct epoll_event *evs, int maxevents)
+{
+  FAR struct epoll_node_s *list;
+  FAR struct epoll_node_s *node;
+  irqstate_t flags;
+  pollevent_t revents;
+  int count = 0;
+
+  /* Detach the ready list so that re-armed descriptors are not reported
+   * twice by this call.
+   */
+
+  flags = enter_critical_section();
+  list           = eph->eh_rdhead;
+  eph->eh_rdhead = NULL;
+  eph->eh_rdtail = NULL;
+  leave_critical_section(flags);
+
+  while (list != NULL && count < maxevents)
+    {
+      node = list;
+      list = node->en_rlink;
+
+      flags = enter_critical_section();
+      revents              = node->en_pfd.revents & node->en_pfd.events;
+      node->en_pfd.revents = 0;
+      node->en_ready       = false;
+      leave_critical_section(flags);
+
+      if ((node->en_events & EPOLLET) == 0)
+        {
+          /* Level-triggered:  The queued events may be stale.  Set up the
+           * poll again to get the current state.  This also queues the
+           * node again if it is still ready.
+           */
+
+          epoll_disarm(node);
+          if (epoll_arm(node) < 0)
+            {
+              revents = POLLERR;
+            }
+          else
+            {
+              flags   = enter_critical_section();
+              revents = node->en_pfd.revents & node->en_pfd.events;
+              leave_critical_section(flags);
+            }
+        }
+
+      if (revents == 0)
+        {
+          continue;
+        }
+
+      evs[count].events = revents;
+      evs[count].data   = node->en_data;
+      count++;
+
+      if ((node->en_events & EPOLLONESHOT) != 0)
+        {
+          epoll_disarm(node);
+          epoll_unqueue(eph, node);
+        }
+    }
+
+  /* Return any entries that did not fit to the head of the ready list */
+
+  if (list != NULL)
+    {
+      flags = enter_critical_section();
+      node = list;
+      while (node->en_rlink != NULL)
+        {
+          node = node->en_rlink;
+        }
+
+      node->en_rlink = eph->eh_rdhead;
+      if (eph->eh_rdhead == NULL)
+        {
+          eph->eh_rdtail = node;
+        }
+
+      eph->eh_rdhead = list;
+      leave_critical_section(flags);
+    }
+
+  return count;
+}
+
+/****************************************************************************
+ * Name: epoll_find
+ ****************************************************************************/
+
+static FAR struct epoll_node_s *epoll_find(FAR struct epoll_head_s *eph,
+                                           FAR void *obj,
+                                           FAR struct epoll_node_s **prev)
+{
+  FAR struct epoll_node_s *node;
+
+  *prev = NULL;
+  for (node = eph->eh_interest; node != NULL; node = node->en_flink)
+    {
+      if (node->en_obj == obj)
+        {
+          return node;
+        }
+
+      *prev = node;
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: epoll_do_close
+ *
+ * Description:
+ *   The close() method of the epoll file descriptor.  Tears down all
+ *   monitored descriptors and frees the instance.
+ *
+ ****************************************************************************/
+
+static int epoll_do_close(FAR struct file *filep)
+{
+  FAR struct epoll_head_s *eph = (FAR struct epoll_head_s *)filep->f_priv;
+  FAR struct epoll_head_s *prev;
+  FAR struct epoll_head_s *curr;
+  FAR struct epoll_node_s *node;
+  FAR struct epoll_node_s *next;
+
+  /* A duplicated descriptor does not own the instance */
+
+  if (eph == NULL)
+    {
+      return OK;
+    }
+
+  /* Remove the instance from the list searched by epoll_release() */
+
+  epoll_semtake_noint(&g_epoll_sem);
+  for (prev = NULL, curr = g_epoll_heads; curr != NULL; curr = curr->eh_flink)
+    {
+      if (curr == eph)
+        {
+          if (prev != NULL)
+            {
+              prev->eh_flink = eph->eh_flink;
+            }
+          else
+            {
+              g_epoll_heads = eph->eh_flink;
+            }
+
+          break;
+        }
+
+      prev = curr;
+    }
+
+  epoll_semgive(&g_epoll_sem);
+
+  for (node = eph->eh_interest; node != NULL; node = next)
+    {
+      next = node->en_flink;
+      epoll_disarm(node);
+      kmm_free(node);
+    }
+
+  sem_destroy(&eph->eh_exclsem);
+  sem_destroy(&eph->eh_waitsem);
+  kmm_free(eph);
+
+  filep->f_priv = NULL;
+  return OK;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
 /****************************************************************************
- * Name: epoll_create
+ * Name: epoll_create1
  *
  * Description:
+ *   Create an epoll instance and return a file descriptor that refers to
+ *   it.  The descriptor is released with close().
  *
  * Input Parameters:
+ *   flags - Zero or EPOLL_CLOEXEC
  *
  * Returned Value:
+ *   A new file descriptor on success; -1 (ERROR) on failure with the errno
+ *   value set appropriately.
  *
  ****************************************************************************/
 
-int epoll_create(int size)
+int epoll_create1(int flags)
 {
-  FAR struct epoll_head *eph =
-    (FAR struct epoll_head *)kmm_malloc(sizeof(struct epoll_head));
+  FAR struct epoll_head_s *eph;
+  FAR struct file *filep;
+  int errcode;
+  int fd;
 
-  eph->size = size;
-  eph->occupied = 0;
-  eph->evs = kmm_malloc(sizeof(struct epoll_event) * eph->size);
+  if ((flags & ~EPOLL_CLOEXEC) != 0)
+    {
+      errcode = EINVAL;
+      goto errout;
+    }
 
-  /* REVISIT: This will not work on machines where:
-   * sizeof(struct epoll_head *) > sizeof(int)
+  eph = (FAR struct epoll_head_s *)kmm_zalloc(sizeof(struct epoll_head_s));
+  if (eph == NULL)
+    {
+      errcode = ENOMEM;
+      goto errout;
+    }
+
+  /* The wait semaphore is used for signaling and, hence, should not have
+   * priority inheritance enabled.
    */
 
-  return (int)((intptr_t)eph);
+  sem_init(&eph->eh_exclsem, 0, 1);
+  sem_init(&eph->eh_waitsem, 0, 0);
+  sem_setprotocol(&eph->eh_waitsem, SEM_PRIO_NONE);
+
+  /* Allocate a file descriptor that refers to the epoll inode */
+
+  inode_addref(&g_epoll_inode);
+  fd = files_allocate(&g_epoll_inode, O_RDOK, 0, 0);
+  if (fd < 0)
+    {
+      errcode = EMFILE;
+      goto errout_with_inode;
+    }
+
+  filep = fs_getfilep(fd);
+  DEBUGASSERT(filep != NULL);
+  filep->f_priv = eph;
+
+  epoll_semtake_noint(&g_epoll_sem);
+  eph->eh_flink = g_epoll_heads;
+  g_epoll_heads = eph;
+  epoll_semgive(&g_epoll_sem);
+
+  return fd;
+
+errout_with_inode:
+  inode_release(&g_epoll_inode);
+  sem_destroy(&eph->eh_exclsem);
+  sem_destroy(&eph->eh_waitsem);
+  kmm_free(eph);
+
+errout:
+  set_errno(errcode);
+  return ERROR;
 }
 
 /****************************************************************************
- * Name: epoll_close
+ * Name: epoll_create
  *
  * Description:
+ *   Create an epoll instance.  The size is only a hint and must be greater
+ *   than zero; the interest list grows as needed.
  *
  * Input Parameters:
+ *   size - Hint at the number of descriptors to be monitored
  *
  * Returned Value:
+ *   A new file descriptor on success; -1 (ERROR) on failure with the errno
+ *   value set appropriately.
  *
  ****************************************************************************/
 
-void epoll_close(int epfd)
+int epoll_create(int size)
 {
-  /* REVISIT: This will not work on machines where:
-   * sizeof(struct epoll_head *) > sizeof(int)
-   */
+  if (size <= 0)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
 
-  FAR struct epoll_head *eph = (FAR struct epoll_head *)((intptr_t)epfd);
+  return epoll_create1(0);
+}
 
-  kmm_free(eph->evs);
-  kmm_free(eph);
+/****************************************************************************
+ * Name: epoll_close
+ *
+ * Description:
+ *   Retained for compatibility.  Equivalent to close(epfd).
+ *
+ ****************************************************************************/
+
+void epoll_close(int epfd)
+{
+  (void)close(epfd);
 }
 
 /****************************************************************************
  * Name: epoll_ctl
  *
  * Description:
+ *   Add, modify or remove a descriptor in the interest list.  The
+ *   descriptor is registered with its driver once, when it is added, and
+ *   stays registered until it is removed or closed.
  *
  * Input Parameters:
+ *   epfd - The epoll file descriptor
+ *   op   - EPOLL_CTL_ADD, EPOLL_CTL_DEL or EPOLL_CTL_MOD
+ *   fd   - The file or socket descriptor of interest
+ *   ev   - The events of interest and the user data (ignored for DEL)
  *
  * Returned Value:
+ *   Zero (OK) on success; -1 (ERROR) on failure with the errno value set
+ *   appropriately.
  *
  ****************************************************************************/
 
-int epoll_ctl(int epfd, int op, int fd, struct epoll_event *ev)
+int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev)
 {
-  /* REVISIT: This will not work on machines where:
-   * sizeof(struct epoll_head *) > sizeof(int)
+  FAR struct epoll_head_s *eph;
+  FAR struct epoll_node_s *node;
+  FAR struct epoll_node_s *prev;
+  FAR void *obj;
+  bool socket = false;
+  int errcode = OK;
+  int ret;
+
+  eph = epoll_head(epfd);
+  if (eph == NULL)
+    {
+      return ERROR;
+    }
+
+  if (fd < 0 || fd == epfd || (op != EPOLL_CTL_DEL && ev == NULL))
+    {
+      errcode = EINVAL;
+      goto errout;
+    }
+
+  /* g_epoll_sem keeps the descriptor from being closed, and so released
+   * from the interest lists, between the lookup and the update.
    */
 
-  FAR struct epoll_head *eph = (FAR struct epoll_head *)((intptr_t)epfd);
+  ret = epoll_semtake(&g_epoll_sem);
+  if (ret < 0)
+    {
+      errcode = -ret;
+      goto errout;
+    }
+
+  ret = epoll_semtake(&eph->eh_exclsem);
+  if (ret < 0)
+    {
+      epoll_semgive(&g_epoll_sem);
+      errcode = -ret;
+      goto errout;
+    }
+
+  obj = epoll_object(fd, &socket);
+  if (obj == NULL)
+    {
+      errcode = EBADF;
+      goto errout_with_sems;
+    }
+
+  node = epoll_find(eph, obj, &prev);
 
   switch (op)
     {
       case EPOLL_CTL_ADD:
-        finfo("%08x CTL ADD(%d): fd=%d ev=%08x\n",
-              epfd, eph->occupied, fd, ev->events);
+        finfo("%d CTL ADD: fd=%d ev=%08x\n", epfd, fd, ev->events);
 
-        eph->evs[eph->occupied].events = ev->events | POLLERR | POLLHUP;
-        eph->evs[eph->occupied++].data.fd = fd;
-        return 0;
+        if (node != NULL)
+          {
+            errcode = EEXIST;
+            break;
+          }
+
+        node = (FAR struct epoll_node_s *)
+          kmm_zalloc(sizeof(struct epoll_node_s));
+        if (node == NULL)
+          {
+            errcode = ENOMEM;
+            break;
+          }
+
+        node->en_eph    = eph;
+        node->en_obj    = obj;
+        node->en_socket = socket;
+        node->en_pfd.fd = fd;
+        node->en_events = ev->events;
+        node->en_data   = ev->data;
+
+        ret = epoll_arm(node);
+        if (ret < 0)
+          {
+            kmm_free(node);
+            errcode = -ret;
+            break;
+          }
+
+        node->en_flink   = eph->eh_interest;
+        eph->eh_interest = node;
+        break;
 
       case EPOLL_CTL_DEL:
-        {
-          int i;
+        finfo("%d CTL DEL: fd=%d\n", epfd, fd);
 
-          for (i = 0; i < eph->occupied; i++)
-            {
-              if (eph->evs[i].data.fd == fd)
-                {
-                  if (i != eph->occupied-1)
-                    {
-                      memmove(&eph->evs[i], &eph->evs[i + 1],
-                              eph->occupied - i);
-                    }
-
-                  eph->occupied--;
-                  return 0;
-                }
-            }
+        if (node == NULL)
+          {
+            errcode = ENOENT;
+            break;
+          }
 
-          return -ENOENT;
-        }
+        if (prev != NULL)
+          {
+            prev->en_flink = node->en_flink;
+          }
+        else
+          {
+            eph->eh_interest = node->en_flink;
+          }
+
+        epoll_disarm(node);
+        epoll_unqueue(eph, node);
+        kmm_free(node);
+        break;
 
       case EPOLL_CTL_MOD:
-        {
-          int i;
+        finfo("%d CTL MOD: fd=%d ev=%08x\n", epfd, fd, ev->events);
 
-          finfo("%08x CTL MOD(%d): fd=%d ev=%08x\n",
-                epfd, eph->occupied, fd, ev->events);
+        if (node == NULL)
+          {
+            errcode = ENOENT;
+            break;
+          }
 
-          for (i = 0; i < eph->occupied; i++)
-            {
-              if (eph->evs[i].data.fd == fd)
-                {
-                  eph->evs[i].events = ev->events | POLLERR | POLLHUP;
-                  return 0;
-                }
-            }
+        epoll_disarm(node);
+        epoll_unqueue(eph, node);
 
-          return -ENOENT;
-        }
+        node->en_events = ev->events;
+        node->en_data   = ev->data;
+
+        ret = epoll_arm(node);
+        if (ret < 0)
+          {
+            errcode = -ret;
+          }
+        break;
+
+      default:
+        errcode = EINVAL;
+        break;
+    }
+
+errout_with_sems:
+  epoll_semgive(&eph->eh_exclsem);
+  epoll_semgive(&g_epoll_sem);
+
+  if (errcode != OK)
+    {
+      goto errout;
     }
 
-  return -EINVAL;
+  return OK;
+
+errout:
+  set_errno(errcode);
+  return ERROR;
 }
 
 /****************************************************************************
  * Name: epoll_wait
  *
  * Description:
+ *   Wait for events on the descriptors in the interest list.  Only the
+ *   ready list is examined, so the cost of each call is proportional to
+ *   the number of ready descriptors.
  *
  * Input Parameters:
+ *   epfd      - The epoll file descriptor
+ *   evs       - The buffer that receives the events
+ *   maxevents - The capacity of evs
+ *   timeout   - The time to wait in milliseconds; zero means return
+ *               immediately and a negative value means wait forever.
  *
  * Returned Value:
+ *   The number of events returned (zero on timeout) on success; -1
+ *   (ERROR) on failure with the errno value set appropriately.
  *
  ****************************************************************************/
 
 int epoll_wait(int epfd, FAR struct epoll_event *evs, int maxevents,
                int timeout)
 {
-  /* REVISIT: This will not work on machines where:
-   * sizeof(struct epoll_head *) > sizeof(int)
-   */
+  FAR struct epoll_head_s *eph;
+  irqstate_t flags;
+  systime_t start;
+  bool scan;
+  int count;
+  int ret;
 
-  FAR struct epoll_head *eph = (FAR struct epoll_head *)((intptr_t)epfd);
-  int rc;
-  int i;
+  /* epoll_wait() is a cancellation point */
 
-  rc = poll((FAR struct pollfd *)eph->evs, eph->occupied, timeout);
+  (void)enter_cancellation_point();
+
+  eph = epoll_head(epfd);
+  if (eph == NULL)
+    {
+      leave_cancellation_point();
+      return ERROR;
+    }
 
-  if (rc <= 0)
+  if (evs == NULL || maxevents <= 0)
     {
-      if (rc < 0)
+      ret = -EINVAL;
+      goto errout;
+    }
+
+  start = clock_systimer();
+  for (; ; )
+    {
+      ret = epoll_semtake(&eph->eh_exclsem);
+      if (ret < 0)
+        {
+          goto errout;
+        }
+
+      epoll_drain(eph);
+      count = epoll_harvest(eph, evs, maxevents);
+      if (count > 0 || timeout == 0)
+        {
+          epoll_semgive(&eph->eh_exclsem);
+          break;
+        }
+
+      /* Nothing is ready.  Announce that we are waiting so that the next
+       * event posts the semaphore, unless one arrived in the meantime.
+       */
+
+      flags = enter_critical_section();
+      if (eph->eh_rdhead != NULL)
+        {
+          leave_critical_section(flags);
+          epoll_semgive(&eph->eh_exclsem);
+          continue;
+        }
+
+      eph->eh_nwaiters++;
+      leave_critical_section(flags);
+      epoll_semgive(&eph->eh_exclsem);
+
+      if (timeout > 0)
         {
-          ferr("ERROR: %08x poll fail: %d for %d, %d msecs\n",
-               epfd, rc, eph->occupied, timeout);
+          ret = sem_tickwait(&eph->eh_waitsem, start, MSEC2TICK(timeout));
+        }
+      else
+        {
+          ret = epoll_semtake(&eph->eh_waitsem);
+        }
+
+      flags = enter_critical_section();
+      eph->eh_nwaiters--;
 
-          for (i = 0; i < eph->occupied; i++)
+      scan = false;
+      if (ret >= 0)
+        {
+          if (eph->eh_npost > 0)
+            {
+              eph->eh_npost--;
+            }
+          else
             {
-              ferr("  %02d: fd=%d\n", i, eph->evs[i].data.fd);
+              scan = true;
             }
         }
 
-      return rc;
+      leave_critical_section(flags);
+
+      if (ret == -ETIMEDOUT)
+        {
+          /* Make one final non-blocking pass */
+
+          timeout = 0;
+        }
+      else if (ret < 0)
+        {
+          goto errout;
+        }
+      else if (scan)
+        {
+          ret = epoll_semtake(&eph->eh_exclsem);
+          if (ret < 0)
+            {
+              goto errout;
+            }
+
+          epoll_scan(eph);
+          epoll_semgive(&eph->eh_exclsem);
+        }
     }
 
-  for (i = 0; i < rc; i++)
+  leave_cancellation_point();
+  return count;
+
+errout:
+  leave_cancellation_point();
+  set_errno(-ret);
+  return ERROR;
+}
+
+/****************************************************************************
+ * Name: epoll_release
+ *
+ * Description:
+ *   Remove a file or socket from every epoll interest list.  This is called
+ *   when the struct file or struct socket is about to be closed so that no
+ *   driver is left with a pollfd that refers to a freed node.
+ *
+ * Input Parameters:
+ *   obj - The struct file or struct socket being closed
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void epoll_release(FAR void *obj)
+{
+  FAR struct epoll_head_s *eph;
+  FAR struct epoll_node_s *node;
+  FAR struct epoll_node_s *prev;
+
+  epoll_semtake_noint(&g_epoll_sem);
+  for (eph = g_epoll_heads; eph != NULL; eph = eph->eh_flink)
     {
-      evs[i].data.fd = (pollevent_t)eph->evs[i].data.fd;
-      evs[i].events = (pollevent_t)eph->evs[i].revents;
+      epoll_semtake_noint(&eph->eh_exclsem);
+
+      node = epoll_find(eph, obj, &prev);
+      if (node != NULL)
+        {
+          if (prev != NULL)
+            {
+              prev->en_flink = node->en_flink;
+            }
+          else
+            {
+              eph->eh_interest = node->en_flink;
+            }
+
+          epoll_disarm(node);
+          epoll_unqueue(eph, node);
+          kmm_free(node);
+        }
+
+      epoll_semgive(&eph->eh_exclsem);
     }
 
-  return rc;
+  epoll_semgive(&g_epoll_sem);
 }
 
 #endif /* CONFIG_DISABLE_POLL */
@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/vfs/fs_fcntl.c
  *
- *   Copyright (C) 2009, 2012-2014, 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2009, 2012-2014, 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -47,6 +47,7 @@
 #include <nuttx/sched.h>
 #include <nuttx/cancelpt.h>
 #include <nuttx/fs/fs.h>
+#include <nuttx/fs/ioctl.h>
 #include <nuttx/net/net.h>
 
 #include "inode/inode.h"
@@ -195,6 +196,29 @@ int file_vfcntl(FAR struct file *filep, int cmd, va_list ap)
         errcode = ENOSYS; /* Not implemented */
         break;
 
+      case F_GETPIPE_SZ:
+        /* Return the size of the buffer of the pipe or FIFO referred to by
+         * fd (linux).
+         */
+
+        {
+          ret = file_ioctl(filep, PIPEIOC_GETSIZE, 0);
+        }
+        break;
+
+      case F_SETPIPE_SZ:
+        /* Change the size of the buffer of the pipe or FIFO referred to by
+         * fd to the third argument, arg, taken as an integer (linux).  The
+         * new buffer size is returned.  The operation fails with EBUSY if
+         * more data than that is already buffered in the pipe.
+         */
+
+        {
+          ret = file_ioctl(filep, PIPEIOC_SETSIZE,
+                           (unsigned long)va_arg(ap, int));
+        }
+        break;
+
       default:
         errcode = EINVAL;
         break;
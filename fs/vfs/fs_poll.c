@@ -1,7 +1,7 @@
 /****************************************************************************
  * fs/vfs/fs_poll.c
  *
- *   Copyright (C) 2008-2009, 2012-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2008-2009, 2012-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -150,6 +150,7 @@ static inline int poll_setup(FAR struct pollfd *fds, nfds_t nfds, sem_t *sem)
       fds[i].sem     = sem;
       fds[i].revents = 0;
       fds[i].priv    = NULL;
+      fds[i].cb      = NULL;
 
       /* Check for invalid descriptors. "If the value of fd is less than 0,
        * events shall be ignored, and revents shall be set to 0 in that entry
@@ -244,6 +245,38 @@ static inline int poll_teardown(FAR struct pollfd *fds, nfds_t nfds, int *count,
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Function: poll_notify
+ *
+ * Description:
+ *   Report the events currently accumulated in fds->revents to the poller.
+ *   Drivers call this instead of posting fds->sem directly.  If the poller
+ *   registered a callback then it is invoked with the pollfd so that the
+ *   poller learns which descriptor became ready; otherwise the semaphore is
+ *   posted as before.
+ *
+ *   This function may be called from interrupt handlers.
+ *
+ * Input Parameters:
+ *   fds - The pollfd with the updated revents
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void poll_notify(FAR struct pollfd *fds)
+{
+  if (fds->cb != NULL)
+    {
+      fds->cb(fds);
+    }
+  else
+    {
+      poll_semgive(fds->sem);
+    }
+}
+
 /****************************************************************************
  * Function: file_poll
  *
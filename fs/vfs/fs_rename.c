@@ -247,6 +247,10 @@ next_subdir:
 #endif
   newinode->i_private = oldinode->i_private; /* Per inode driver private data */
 
+  /* The children of the old inode now belong to the new inode */
+
+  inode_rehash(newinode);
+
 #ifdef CONFIG_PSEUDOFS_SOFTLINKS
   /* Prevent the link target string from being deallocated.  The pointer to
    * the allocated link target path was copied above (under the guise of
@@ -39,7 +39,12 @@
 
 #include <nuttx/config.h>
 
+#include <sys/types.h>
 #include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -47,9 +52,282 @@
 #include <assert.h>
 
 #include <nuttx/sched.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/ioctl.h>
 #include <nuttx/net/net.h>
 
-#if CONFIG_NFILE_DESCRIPTORS > 0 && CONFIG_NET_SENDFILE
+#include "inode/inode.h"
+
+#if CONFIG_NFILE_DESCRIPTORS > 0 && defined(CONFIG_FS_SENDFILE)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_LIB_SENDFILE_BUFSIZE
+#  define CONFIG_LIB_SENDFILE_BUFSIZE 512
+#endif
+
+#if CONFIG_NSOCKET_DESCRIPTORS > 0 && defined(CONFIG_NET)
+#  define HAVE_SOCKET_OUTPUT 1
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The destination of the transfer:  Either a file or a socket */
+
+struct sendfile_out_s
+{
+  FAR struct file *filep;      /* Output file (if not a socket) */
+#ifdef HAVE_SOCKET_OUTPUT
+  FAR struct socket *psock;    /* Output socket (if not a file) */
+#endif
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sendfile_write
+ *
+ * Description:
+ *   Write all of 'nbytes' to the output file or socket.
+ *
+ * Returned Value:
+ *   The number of bytes written.  This will be less than 'nbytes' only if
+ *   an error occurs after some data has already been written.  If no data
+ *   could be written, -1 is returned with the errno value set.
+ *
+ ****************************************************************************/
+
+static ssize_t sendfile_write(FAR struct sendfile_out_s *out,
+                              FAR const uint8_t *buffer, size_t nbytes)
+{
+  ssize_t nwritten;
+  size_t ntotal = 0;
+
+  while (ntotal < nbytes)
+    {
+#ifdef HAVE_SOCKET_OUTPUT
+      if (out->psock != NULL)
+        {
+          nwritten = psock_send(out->psock, &buffer[ntotal],
+                                nbytes - ntotal, 0);
+        }
+      else
+#endif
+        {
+          nwritten = file_write(out->filep, &buffer[ntotal],
+                                nbytes - ntotal);
+        }
+
+      if (nwritten < 0)
+        {
+          /* The errno value has already been set.  Report the partial
+           * transfer, if there was one.
+           */
+
+          return ntotal > 0 ? (ssize_t)ntotal : ERROR;
+        }
+
+      ntotal += nwritten;
+    }
+
+  return ntotal;
+}
+
+/****************************************************************************
+ * Name: sendfile_mmap
+ *
+ * Description:
+ *   Get the memory mapped image of a file, if the file system supports
+ *   that and the image cannot change while it is being sent.
+ *
+ *   Only ROMFS images are used.  tmpfs also supports FIOC_MMAP but a
+ *   concurrent write or truncation may reallocate or free the file data
+ *   while the (possibly blocking) write is still reading from it.
+ *
+ * Returned Value:
+ *   Zero (OK) on success with the address and size of the file image
+ *   returned.  A negated errno value is returned if the file cannot be
+ *   mapped.  The errno variable is not modified in either case.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_DISABLE_MOUNTPOINT
+static int sendfile_mmap(FAR struct file *filep,
+                         FAR const uint8_t **image, FAR off_t *size)
+{
+  FAR struct inode *inode = filep->f_inode;
+  FAR const struct mountpt_operations *mops;
+  FAR void *addr = NULL;
+  struct statfs fsbuf;
+  struct stat buf;
+  int ret;
+
+  /* Only mounted file systems may provide FIOC_MMAP.  Character and block
+   * drivers may interpret the command differently.
+   */
+
+  if (inode == NULL || !INODE_IS_MOUNTPT(inode))
+    {
+      return -ENOSYS;
+    }
+
+  mops = inode->u.i_mops;
+  if (mops == NULL || mops->ioctl == NULL || mops->fstat == NULL ||
+      mops->statfs == NULL)
+    {
+      return -ENOSYS;
+    }
+
+  /* Is this a ROMFS file system? */
+
+  ret = mops->statfs(inode, &fsbuf);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (fsbuf.f_type != ROMFS_MAGIC)
+    {
+      return -ENOSYS;
+    }
+
+  /* Get the address of the file image.  This fails if the ROMFS image is
+   * not directly addressable (XIP).
+   */
+
+  ret = mops->ioctl(filep, FIOC_MMAP, (unsigned long)((uintptr_t)&addr));
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (addr == NULL)
+    {
+      return -ENOSYS;
+    }
+
+  /* Get the size of the file */
+
+  ret = mops->fstat(filep, &buf);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  *image = (FAR const uint8_t *)addr;
+  *size  = buf.st_size;
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: sendfile_copy
+ *
+ * Description:
+ *   Transfer the file through a single kernel buffer.  Data is read from
+ *   'offset' if 'offset' is not NULL; otherwise it is read from the
+ *   current file position.
+ *
+ ****************************************************************************/
+
+static ssize_t sendfile_copy(FAR struct sendfile_out_s *out,
+                             FAR struct file *infile, FAR off_t *offset,
+                             size_t count)
+{
+  FAR uint8_t *iobuffer;
+  ssize_t nread;
+  ssize_t nwritten;
+  size_t ntransferred = 0;
+  size_t chunk;
+  int errcode = OK;
+
+  iobuffer = (FAR uint8_t *)kmm_malloc(CONFIG_LIB_SENDFILE_BUFSIZE);
+  if (iobuffer == NULL)
+    {
+      set_errno(ENOMEM);
+      return ERROR;
+    }
+
+  while (ntransferred < count)
+    {
+      chunk = count - ntransferred;
+      if (chunk > CONFIG_LIB_SENDFILE_BUFSIZE)
+        {
+          chunk = CONFIG_LIB_SENDFILE_BUFSIZE;
+        }
+
+      if (offset != NULL)
+        {
+          nread = file_pread(infile, iobuffer, chunk,
+                             *offset + ntransferred);
+        }
+      else
+        {
+          nread = file_read(infile, iobuffer, chunk);
+        }
+
+      if (nread <= 0)
+        {
+          /* End-of-file or a read error.  The errno value has already been
+           * set in the latter case.
+           */
+
+          if (nread < 0)
+            {
+              errcode = get_errno();
+            }
+
+          break;
+        }
+
+      nwritten = sendfile_write(out, iobuffer, nread);
+      if (nwritten < 0)
+        {
+          errcode = get_errno();
+          break;
+        }
+
+      ntransferred += nwritten;
+
+      /* If the write was short, then the remaining data has been read but
+       * not sent.  Return the file position to the first byte not sent.
+       */
+
+      if (nwritten < nread)
+        {
+          if (offset == NULL)
+            {
+              (void)file_seek(infile, nwritten - nread, SEEK_CUR);
+            }
+
+          break;
+        }
+    }
+
+  kmm_free(iobuffer);
+
+  /* Report the error only if nothing was transferred */
+
+  if (ntransferred == 0 && errcode != OK)
+    {
+      set_errno(errcode);
+      return ERROR;
+    }
+
+  if (offset != NULL)
+    {
+      *offset += ntransferred;
+    }
+
+  return ntransferred;
+}
 
 /****************************************************************************
  * Public Functions
@@ -60,12 +338,17 @@
  *
  * Description:
  *   sendfile() copies data between one file descriptor and another.
- *   Used with file descriptors it basically just wraps a sequence of
- *   reads() and writes() to perform a copy.
+ *   The copy is performed entirely within the OS:
  *
- *   If the destination descriptor is a socket, it gives a better
- *   performance than simple reds() and writes(). The data is read directly
- *   into the net buffer and the whole tcp window is filled if possible.
+ *   - If the input file is memory mapped (ROMFS in XIP mode), the data
+ *     is written to the output file or socket directly from the mapped
+ *     memory with no intermediate buffer.
+ *   - If the destination descriptor is a TCP socket, the data is read
+ *     directly into the net buffer and the whole tcp window is filled if
+ *     possible (CONFIG_NET_SENDFILE).
+ *   - Otherwise, the data is copied through a single kernel buffer of
+ *     size CONFIG_LIB_SENDFILE_BUFSIZE.  Only socket input falls back to
+ *     the read()/write() loop of lib_sendfile().
  *
  *   NOTE: This interface is *not* specified in POSIX.1-2001, or other
  *   standards.  The implementation here is very similar to the Linux
@@ -102,41 +385,115 @@
 
 ssize_t sendfile(int outfd, int infd, off_t *offset, size_t count)
 {
-#if defined(CONFIG_NET_TCP) && CONFIG_NSOCKET_DESCRIPTORS > 0
-  /* Check the destination file descriptor:  Is it a (probable) file
-   * descriptor?  Check the source file:  Is it a normal file?
+  struct sendfile_out_s out;
+  FAR struct file *infile;
+#ifndef CONFIG_DISABLE_MOUNTPOINT
+  FAR const uint8_t *image;
+  off_t startpos;
+  off_t size;
+  ssize_t ret;
+#endif
+
+  /* Is the source a socket?  The generic lib_sendfile() handles that
+   * case.
    */
 
-  if ((unsigned int)outfd >= CONFIG_NFILE_DESCRIPTORS &&
-      (unsigned int)infd < CONFIG_NFILE_DESCRIPTORS)
+  if ((unsigned int)infd >= CONFIG_NFILE_DESCRIPTORS)
     {
-      FAR struct file *filep;
+      return lib_sendfile(outfd, infd, offset, count);
+    }
 
-      /* This appears to be a file-to-socket transfer.  Get the file
-       * structure.
-       */
+  infile = fs_getfilep(infd);
+  if (infile == NULL)
+    {
+      /* The errno value has already been set */
 
-      filep = fs_getfilep(infd);
-      if (!filep)
+      return ERROR;
+    }
+
+  /* Get the destination file or socket */
+
+  out.filep = NULL;
+#ifdef HAVE_SOCKET_OUTPUT
+  out.psock = NULL;
+
+  if ((unsigned int)outfd >= CONFIG_NFILE_DESCRIPTORS)
+    {
+      out.psock = sockfd_socket(outfd);
+      if (out.psock == NULL || out.psock->s_crefs <= 0)
+        {
+          set_errno(EBADF);
+          return ERROR;
+        }
+    }
+  else
+#endif
+    {
+      out.filep = fs_getfilep(outfd);
+      if (out.filep == NULL)
         {
-          /* The errno value has already been set */
+          return ERROR;
+        }
+    }
+
+#ifndef CONFIG_DISABLE_MOUNTPOINT
+  /* Can the file be memory mapped?  If so, write the data directly from
+   * the file image.
+   */
 
+  if (sendfile_mmap(infile, &image, &size) == OK)
+    {
+      startpos = (offset != NULL) ? *offset : infile->f_pos;
+      if (startpos < 0)
+        {
+          set_errno(EINVAL);
           return ERROR;
         }
 
-      /* Then let net_sendfile do the work. */
+      if (startpos >= size)
+        {
+          return 0;
+        }
+
+      if (count > (size_t)(size - startpos))
+        {
+          count = size - startpos;
+        }
+
+      ret = sendfile_write(&out, &image[startpos], count);
+      if (ret > 0)
+        {
+          /* Update the offset or the file position */
+
+          if (offset != NULL)
+            {
+              *offset += ret;
+            }
+          else
+            {
+              (void)file_seek(infile, startpos + ret, SEEK_SET);
+            }
+        }
 
-      return net_sendfile(outfd, filep, offset, count);
+      return ret;
     }
-  else
 #endif
-    {
-      /* No... then this is probably a file-to-file transfer.  The generic
-       * lib_sendfile() can handle that case.
-       */
 
-      return lib_sendfile(outfd, infd, offset, count);
+#if defined(HAVE_SOCKET_OUTPUT) && defined(CONFIG_NET_SENDFILE)
+  /* Is the destination a TCP socket?  net_sendfile() reads the file
+   * directly into the network buffer.
+   */
+
+  if (out.psock != NULL && out.psock->s_type == SOCK_STREAM &&
+      (out.psock->s_domain == PF_INET || out.psock->s_domain == PF_INET6))
+    {
+      return net_sendfile(outfd, infile, offset, count);
     }
+#endif
+
+  /* Otherwise, copy the data through a kernel buffer */
+
+  return sendfile_copy(&out, infile, offset, count);
 }
 
-#endif /* CONFIG_NFILE_DESCRIPTORS > 0 && CONFIG_NET_SENDFILE */
+#endif /* CONFIG_NFILE_DESCRIPTORS > 0 && CONFIG_FS_SENDFILE */
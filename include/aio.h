@@ -1,7 +1,7 @@
 /****************************************************************************
  * include/aio.h
  *
- *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -43,7 +43,9 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdint.h>
 #include <signal.h>
+#include <semaphore.h>
 #include <time.h>
 
 #include <nuttx/wqueue.h>
@@ -113,6 +115,18 @@
 #define LIO_NOWAIT      0
 #define LIO_WAIT        1
 
+/* Non-standard aio_sigevent notification method
+ *
+ * SIGEV_AIOCQ     - The completed AIO control block is posted to the
+ *                   completion queue referenced by
+ *                   aio_sigevent.sigev_value.sival_ptr (see aio_cqinit()).
+ *                   No signal is sent, not even SIGPOLL, so these requests
+ *                   cannot be waited for with aio_suspend() or with
+ *                   lio_listio(LIO_WAIT).
+ */
+
+#define SIGEV_AIOCQ     4
+
 /****************************************************************************
  * Type Definitions
  ****************************************************************************/
@@ -141,6 +155,24 @@ struct aiocb
   FAR void *aio_priv;            /* Used by signal handlers */
 };
 
+/* A completion queue (non-standard).  Completed AIO control blocks whose
+ * aio_sigevent.sigev_notify is SIGEV_AIOCQ are posted to a ring of
+ * caller-provided storage, from which they are reaped with aio_cqwait().
+ * A slot in the ring is reserved when the I/O is submitted, so the
+ * submission fails with EAGAIN rather than overflowing the ring.  Only one
+ * thread may reap completions from a given queue.
+ */
+
+struct aiocq
+{
+  sem_t aiocq_ready;             /* Counts completions in the ring */
+  sem_t aiocq_free;              /* Counts unreserved slots in the ring */
+  FAR struct aiocb **aiocq_ring; /* Caller-provided ring storage */
+  uint16_t aiocq_nentries;       /* Number of slots in the ring */
+  volatile uint16_t aiocq_head;  /* Index of the oldest completion */
+  volatile uint16_t aiocq_tail;  /* Index where the next completion goes */
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -168,6 +200,13 @@ int aio_write(FAR struct aiocb *aiocbp);
 int lio_listio(int mode, FAR struct aiocb *const list[], int nent,
                FAR struct sigevent *sig);
 
+/* Non-standard completion queue interfaces */
+
+int aio_cqinit(FAR struct aiocq *cq, FAR struct aiocb **ring, int nentries);
+int aio_cqdestroy(FAR struct aiocq *cq);
+int aio_cqwait(FAR struct aiocq *cq, FAR struct aiocb *list[], int nent,
+               FAR const struct timespec *timeout);
+
 #undef EXTERN
 #ifdef __cplusplus
 }
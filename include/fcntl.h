@@ -1,7 +1,7 @@
 /********************************************************************************
  * include/fcntl.h
  *
- *   Copyright (C) 2007-2009, 2012 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2012, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -108,6 +108,8 @@
 #define F_SETLKW    12 /* Like F_SETLK, but wait for lock to become available */
 #define F_SETOWN    13 /* Set pid that will receive SIGIO and SIGURG signals for fd */
 #define F_SETSIG    14 /* Set the signal to be sent */
+#define F_GETPIPE_SZ 15 /* Get the size of the pipe or FIFO buffer (linux) */
+#define F_SETPIPE_SZ 16 /* Set the size of the pipe or FIFO buffer (linux) */
 
 /* For posix fcntl() and lockf() */
 
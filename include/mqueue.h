@@ -1,7 +1,7 @@
 /********************************************************************************
  * include/mqueue.h
  *
- *   Copyright (C) 2007, 2008 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2008, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -40,6 +40,8 @@
  * Included Files
  ********************************************************************************/
 
+#include <nuttx/config.h>
+
 #include <sys/types.h>
 #include <signal.h>
 #include "queue.h"
@@ -98,6 +100,17 @@ int     mq_setattr(mqd_t mqdes, FAR const struct mq_attr *mq_stat,
                    FAR struct mq_attr *oldstat);
 int     mq_getattr(mqd_t mqdes, FAR struct mq_attr *mq_stat);
 
+#ifdef CONFIG_MQ_LOAN
+/* Non-standard interfaces that exchange ownership of message buffers in
+ * the message queue's arena instead of copying message data.
+ */
+
+FAR void *mq_loan(mqd_t mqdes);
+int     mq_loansend(mqd_t mqdes, FAR void *buf, size_t msglen, int prio);
+ssize_t mq_loanreceive(mqd_t mqdes, FAR void **buf, FAR int *prio);
+int     mq_loanreturn(mqd_t mqdes, FAR void *buf);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
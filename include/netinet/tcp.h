@@ -0,0 +1,103 @@
+/****************************************************************************
+ * include/netinet/tcp.h
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NETINET_TCP_H
+#define __INCLUDE_NETINET_TCP_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* TCP protocol-level socket options.  These are used with the 'level'
+ * IPPROTO_TCP in getsockopt() and setsockopt().
+ */
+
+#define TCP_INFO           11 /* Get information about the connection (get).
+                               * arg: struct tcp_info */
+#define TCP_CONGESTION     13 /* Congestion control algorithm (get/set).
+                               * arg: char array with the algorithm name */
+
+/* The maximum length of a congestion control algorithm name, including
+ * the NUL terminator.
+ */
+
+#define TCP_CA_NAME_MAX    16
+
+/* Values for the tcpi_ca_state field of struct tcp_info */
+
+#define TCP_CA_OPEN        0  /* Normal operation */
+#define TCP_CA_RECOVERY    3  /* Fast recovery after a fast retransmit */
+#define TCP_CA_LOSS        4  /* Recovery after a retransmission timeout */
+
+/****************************************************************************
+ * Public Type Definitions
+ ****************************************************************************/
+
+/* Returned by the TCP_INFO socket option.  Times are in microseconds;
+ * window sizes and thresholds are in bytes.
+ */
+
+struct tcp_info
+{
+  uint8_t  tcpi_state;         /* TCP connection state */
+  uint8_t  tcpi_ca_state;      /* Congestion control state, TCP_CA_* */
+  uint8_t  tcpi_retransmits;   /* Consecutive retransmission timeouts */
+  uint8_t  tcpi_reserved;
+  uint32_t tcpi_rto;           /* Retransmission timeout */
+  uint32_t tcpi_snd_mss;       /* Maximum segment size */
+  uint32_t tcpi_rtt;           /* Smoothed round trip time */
+  uint32_t tcpi_rttvar;        /* Round trip time variation */
+  uint32_t tcpi_snd_ssthresh;  /* Slow start threshold */
+  uint32_t tcpi_snd_cwnd;      /* Congestion window */
+  uint32_t tcpi_snd_wnd;       /* Receiver's advertised window */
+  uint32_t tcpi_unacked;       /* Bytes sent but not yet ACKed */
+  uint32_t tcpi_total_retrans; /* Retransmission timeouts since connected */
+  uint32_t tcpi_fast_retrans;  /* Fast retransmissions since connected */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#endif /* __INCLUDE_NETINET_TCP_H */
@@ -68,6 +68,14 @@
 #define __FS_FLAG_LBF   (1 << 2) /* Line buffered */
 #define __FS_FLAG_UBF   (1 << 3) /* Buffer allocated by caller of setvbuf */
 
+/* Size of the pseudo-file system inode hash table.  Zero disables the hash
+ * and inodes are found by searching the ordered lists of peers.
+ */
+
+#ifndef CONFIG_PSEUDOFS_HASHSIZE
+#  define CONFIG_PSEUDOFS_HASHSIZE 0
+#endif
+
 /* Inode i_flag values:
  *
  *   Bit 0-3: Inode type (Bit 4 indicates internal OS types)
@@ -341,6 +349,10 @@ struct inode
 {
   FAR struct inode *i_peer;     /* Link to same level inode */
   FAR struct inode *i_child;    /* Link to lower level inode */
+#if CONFIG_PSEUDOFS_HASHSIZE > 0
+  FAR struct inode *i_parent;   /* Link to upper level inode */
+  FAR struct inode *i_hlink;    /* Link to next inode in hash chain */
+#endif
   int16_t           i_crefs;    /* References to inode */
   uint16_t          i_flags;    /* Flags for inode */
   union inode_ops_u u;          /* Inode operations */
@@ -828,7 +840,7 @@ int lib_flushall(FAR struct streamlist *list);
  *
  ****************************************************************************/
 
-#ifdef CONFIG_NET_SENDFILE
+#ifdef CONFIG_FS_SENDFILE
 ssize_t lib_sendfile(int outfd, int infd, off_t *offset, size_t count);
 #endif
 
@@ -1019,6 +1031,48 @@ int file_poll(FAR struct file *filep, FAR struct pollfd *fds, bool setup);
 int fdesc_poll(int fd, FAR struct pollfd *fds, bool setup);
 #endif
 
+/****************************************************************************
+ * Function: poll_notify
+ *
+ * Description:
+ *   Report the events accumulated in fds->revents to the poller, either by
+ *   invoking the poller's callback or by posting fds->sem.  Drivers should
+ *   use this rather than posting fds->sem directly.  May be called from
+ *   interrupt handlers.
+ *
+ * Input Parameters:
+ *   fds - The pollfd with the updated revents
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_DISABLE_POLL
+void poll_notify(FAR struct pollfd *fds);
+#endif
+
+/****************************************************************************
+ * Function: epoll_release
+ *
+ * Description:
+ *   Remove a file or socket from every epoll interest list.  Must be called
+ *   before the struct file or struct socket is closed.
+ *
+ * Input Parameters:
+ *   obj - The struct file or struct socket being closed
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#if !defined(CONFIG_DISABLE_POLL) && CONFIG_NFILE_DESCRIPTORS > 0
+void epoll_release(FAR void *obj);
+#else
+#  define epoll_release(obj)
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
@@ -1,7 +1,7 @@
 /****************************************************************************
  * include/nuttx/fs/ioctl.h
  *
- *   Copyright (C) 2008, 2009, 2011-2014 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2008, 2009, 2011-2014, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -329,6 +329,16 @@
                                              *       (default)
                                              *     1=fre when empty
                                              * OUT: None */
+#define PIPEIOC_GETSIZE   _PIPEIOC(0x0002)  /* Get buffer size
+                                             * IN: None
+                                             * OUT: Buffer size in bytes
+                                             *      (returned value) */
+#define PIPEIOC_SETSIZE   _PIPEIOC(0x0003)  /* Set buffer size
+                                             * IN: unsigned long integer
+                                             *     New buffer size in
+                                             *     bytes
+                                             * OUT: New buffer size in
+                                             *      bytes (returned value) */
 
 /* RTC driver ioctl definitions *********************************************/
 /* (see nuttx/include/rtc.h */
@@ -46,6 +46,10 @@
 #include <stdbool.h>
 #include <semaphore.h>
 
+#if defined(CONFIG_MM_CHUNKCACHE) && defined(CONFIG_SMP)
+#  include <nuttx/spinlock.h>
+#endif
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -160,10 +164,52 @@
 #define MM_MAX_CHUNK     (1 << MM_MAX_SHIFT)
 #define MM_NNODES        (MM_MAX_SHIFT - MM_MIN_SHIFT + 1)
 
+/* The optional two-level segregated fit (TLSF) free list divides each
+ * power-of-two size class (the "first level") into 2**MM_TLSF_SLBITS
+ * linear subclasses (the "second level").  Non-empty lists are tracked in
+ * bitmaps so that a suitable free chunk can be found in constant time.
+ */
+
+#ifdef CONFIG_MM_TLSF
+#  ifndef CONFIG_MM_TLSF_SLBITS
+#    define CONFIG_MM_TLSF_SLBITS 3
+#  endif
+
+#  define MM_TLSF_SLBITS  CONFIG_MM_TLSF_SLBITS
+#  define MM_TLSF_SLCOUNT (1 << MM_TLSF_SLBITS)
+#  define MM_TLSF_SLMASK  (MM_TLSF_SLCOUNT - 1)
+#endif
+
 #define MM_GRAN_MASK     (MM_MIN_CHUNK-1)
 #define MM_ALIGN_UP(a)   (((a) + MM_GRAN_MASK) & ~MM_GRAN_MASK)
 #define MM_ALIGN_DOWN(a) ((a) & ~MM_GRAN_MASK)
 
+/* The optional chunk cache holds recently freed, small chunks in per-CPU
+ * "magazines," one per chunk size class.  There is one size class for each
+ * multiple of MM_MIN_CHUNK up to the chunk size needed to hold an
+ * allocation of CONFIG_MM_CHUNKCACHE_MAXSIZE bytes.
+ */
+
+#ifdef CONFIG_MM_CHUNKCACHE
+#  ifndef CONFIG_MM_CHUNKCACHE_MAXSIZE
+#    define CONFIG_MM_CHUNKCACHE_MAXSIZE 128
+#  endif
+
+#  ifndef CONFIG_MM_CHUNKCACHE_DEPTH
+#    define CONFIG_MM_CHUNKCACHE_DEPTH 16
+#  endif
+
+#  define MM_CACHE_MAXCHUNK \
+     MM_ALIGN_UP(CONFIG_MM_CHUNKCACHE_MAXSIZE + SIZEOF_MM_ALLOCNODE)
+#  define MM_CACHE_NCLASSES (MM_CACHE_MAXCHUNK >> MM_MIN_SHIFT)
+
+#  ifdef CONFIG_SMP
+#    define MM_CACHE_NCPUS  CONFIG_SMP_NCPUS
+#  else
+#    define MM_CACHE_NCPUS  1
+#  endif
+#endif
+
 /* An allocated chunk is distinguished from a free chunk by bit 31 (or 15)
  * of the 'preceding' chunk size.  If set, then this is an allocated chunk.
  */
@@ -230,6 +276,19 @@ struct mm_freenode_s
 #define CHECK_FREENODE_SIZE \
   DEBUGASSERT(sizeof(struct mm_freenode_s) == SIZEOF_MM_FREENODE)
 
+/* This describes the chunk cache of one CPU */
+
+#ifdef CONFIG_MM_CHUNKCACHE
+struct mm_cache_s
+{
+#ifdef CONFIG_SMP
+  spinlock_t mc_lock;              /* Needed only by mm_cacheflush() */
+#endif
+  uint8_t mc_count[MM_CACHE_NCLASSES];
+  FAR void *mc_mem[MM_CACHE_NCLASSES][CONFIG_MM_CHUNKCACHE_DEPTH];
+};
+#endif
+
 /* This describes one heap (possibly with multiple regions) */
 
 struct mm_heap_s
@@ -255,12 +314,32 @@ struct mm_heap_s
   int mm_nregions;
 #endif
 
+#ifdef CONFIG_MM_TLSF
+  /* Free nodes are maintained in segregated, doubly linked lists, one per
+   * first/second level size class.  Bit 'fl' of mm_flbitmap is set if any
+   * list in first level class 'fl' is non-empty; bit 'sl' of
+   * mm_slbitmap[fl] is set if mm_freelist[fl][sl] is non-empty.
+   */
+
+  uint32_t mm_flbitmap;
+  uint32_t mm_slbitmap[MM_NNODES];
+  FAR struct mm_freenode_s *mm_freelist[MM_NNODES][MM_TLSF_SLCOUNT];
+#else
   /* All free nodes are maintained in a doubly linked list.  This
    * array provides some hooks into the list at various points to
    * speed searches for free nodes.
    */
 
   struct mm_freenode_s mm_nodelist[MM_NNODES];
+#endif
+
+#ifdef CONFIG_MM_CHUNKCACHE
+  /* Small chunks that have been freed but not yet returned to the free
+   * lists.  These may be accessed without holding mm_semaphore.
+   */
+
+  struct mm_cache_s mm_cache[MM_CACHE_NCPUS];
+#endif
 };
 
 /****************************************************************************
@@ -376,6 +455,7 @@ FAR void *kmm_malloc(size_t size);
 /* Functions contained in mm_free.c *****************************************/
 
 void mm_free(FAR struct mm_heap_s *heap, FAR void *mem);
+void mm_freechunk(FAR struct mm_heap_s *heap, FAR void *mem);
 
 /* Functions contained in kmm_free.c ****************************************/
 
@@ -504,9 +584,31 @@ void mm_shrinkchunk(FAR struct mm_heap_s *heap,
 void mm_addfreechunk(FAR struct mm_heap_s *heap,
                      FAR struct mm_freenode_s *node);
 
+/* Functions contained in mm_delfreechunk.c *********************************/
+
+void mm_delfreechunk(FAR struct mm_heap_s *heap,
+                     FAR struct mm_freenode_s *node);
+
+/* Functions contained in mm_findfreechunk.c ********************************/
+
+FAR struct mm_freenode_s *mm_findfreechunk(FAR struct mm_heap_s *heap,
+                                           size_t size);
+
+/* Functions contained in mm_cache.c ****************************************/
+
+#ifdef CONFIG_MM_CHUNKCACHE
+void mm_cacheinitialize(FAR struct mm_heap_s *heap);
+FAR void *mm_cachealloc(FAR struct mm_heap_s *heap, size_t size);
+bool mm_cachefree(FAR struct mm_heap_s *heap, FAR void *mem);
+int  mm_cacheflush(FAR struct mm_heap_s *heap);
+#endif
+
 /* Functions contained in mm_size2ndx.c.c ***********************************/
 
 int mm_size2ndx(size_t size);
+#ifdef CONFIG_MM_TLSF
+void mm_size2tlsf(size_t size, FAR int *fl, FAR int *sl);
+#endif
 
 #undef EXTERN
 #ifdef __cplusplus
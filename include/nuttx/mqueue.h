@@ -1,7 +1,7 @@
 /****************************************************************************
  * include/nuttx/mqueue.h
  *
- *   Copyright (C) 2007, 2009, 2011, 2014-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2009, 2011, 2014-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -56,6 +56,16 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+#ifdef CONFIG_MQ_ARENA
+/* With per-queue message arenas, queued messages are kept in priority
+ * buckets.  Message priorities 0 through MQ_NBUCKETS-2 each have a bucket
+ * of their own; all higher priorities share the last bucket, which is
+ * kept in priority order.
+ */
+
+#  define MQ_NBUCKETS 32
+#endif
+
 /****************************************************************************
  * Public Type Declarations
  ****************************************************************************/
@@ -67,12 +77,19 @@ struct mq_des; /* forward reference */
 struct mqueue_inode_s
 {
   FAR struct inode *inode;    /* Containing inode */
+#ifdef CONFIG_MQ_ARENA
+  sq_queue_t msglist[MQ_NBUCKETS]; /* Message lists, one per priority bucket */
+  uint32_t prioset;           /* Set of non-empty priority buckets */
+  sq_queue_t msgfree;         /* Free messages in the arena */
+  FAR uint8_t *arena;         /* Start of the message arena */
+#else
   sq_queue_t msglist;         /* Prioritized message list */
+#endif
   int16_t maxmsgs;            /* Maximum number of messages in the queue */
   int16_t nmsgs;              /* Number of message in the queue */
   int16_t nwaitnotfull;       /* Number tasks waiting for not full */
   int16_t nwaitnotempty;      /* Number tasks waiting for not empty */
-#if CONFIG_MQ_MAXMSGSIZE < 256
+#if CONFIG_MQ_MAXMSGSIZE < 256 && !defined(CONFIG_MQ_ARENA)
   uint8_t maxmsgsize;         /* Max size of message in message queue */
 #else
   uint16_t maxmsgsize;        /* Max size of message in message queue */
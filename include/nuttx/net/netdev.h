@@ -3,7 +3,7 @@
  * Defines architecture-specific device driver interfaces to the NuttX
  * network.
  *
- *   Copyright (C) 2007, 2009, 2011-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2009, 2011-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Derived largely from portions of uIP with has a similar BSD-styple license:
@@ -341,6 +341,35 @@ struct net_driver_s
 
 typedef int (*devif_poll_callback_t)(FAR struct net_driver_s *dev);
 
+#ifdef CONFIG_NETDEV_PKTQUEUE
+/* A packet descriptor in a TX or RX packet queue.  Each descriptor owns one
+ * packet buffer at all times, whether or not the descriptor currently holds
+ * a packet.  The buffer that is owned by a descriptor may change each time
+ * that a packet is moved between the queue and d_buf.  Each buffer must be
+ * able to hold an MTU-sized packet plus CONFIG_NET_GUARDSIZE bytes.
+ */
+
+struct netdev_pktdesc_s
+{
+  FAR uint8_t *pd_buf;          /* Packet buffer owned by this descriptor */
+  uint16_t pd_len;              /* Length of the packet in pd_buf */
+};
+
+/* A ring of packet descriptors.  pq_head and pq_tail are free-running
+ * counts of the packets removed from and added to the ring; the number of
+ * queued packets is their difference.  One side of the ring adds packets
+ * at the tail and the other side removes them from the head.
+ */
+
+struct netdev_pktq_s
+{
+  FAR struct netdev_pktdesc_s *pq_desc; /* Array of pq_size descriptors */
+  uint16_t pq_size;             /* Number of descriptors (a power of 2) */
+  volatile uint16_t pq_head;    /* Count of packets removed from the ring */
+  volatile uint16_t pq_tail;    /* Count of packets added to the ring */
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -510,6 +539,68 @@ int devif_timer(FAR struct net_driver_s *dev, devif_poll_callback_t callback);
 void neighbor_out(FAR struct net_driver_s *dev);
 #endif /* CONFIG_NET_IPv6 */
 
+#ifdef CONFIG_NETDEV_PKTQUEUE
+/****************************************************************************
+ * Queued packet interface
+ *
+ * A driver that selects the queued packet interface provides rings of
+ * packet descriptors for transmission and/or reception.  The packet in d_buf
+ * is moved into or out of a ring by exchanging d_buf with the buffer owned
+ * by the descriptor so that no packet data is copied.  A driver with rings
+ * of NTX and NRX descriptors must therefore provide NTX + NRX + 1 packet
+ * buffers:  One for each descriptor and one for d_buf.
+ *
+ * Transmission:  The driver's devif_poll() callback performs any link
+ * layer output as usual, calls netdev_pktq_put() to queue the packet in d_buf,
+ * and returns netdev_pktq_full().  Polling then continues until all
+ * connections have been polled or until the TX ring is full.  The driver
+ * sends the packet at netdev_pktq_head(), calls netdev_pktq_remove() once
+ * the buffer is no longer in use, and polls again when descriptors have been
+ * freed.
+ *
+ * Reception:  The driver (perhaps in an interrupt handler) receives the
+ * packet into the buffer of netdev_pktq_tail() and calls netdev_pktq_commit().
+ * Later, on the work queue, it calls netdev_rxqueue_process() to dispatch
+ * up to CONFIG_NETDEV_RXBUDGET packets with the network locked only once.
+ *
+ * The buffer owned by a descriptor changes whenever a packet is moved
+ * through it.  A DMA descriptor must be reloaded from pd_buf each time that
+ * the descriptor is reused.  Each ring has a single producer and a single
+ * consumer, which may run concurrently (for example, an interrupt handler
+ * and the work queue) without further locking.  netdev_pktq_commit() and
+ * netdev_pktq_remove() are the only operations that modify the ring indices
+ * seen by the other side.  They issue a full memory barrier before the
+ * index is updated so that the descriptor is handed over only when it has
+ * been completely written or read.  netdev_pktq_head() and
+ * netdev_pktq_tail() issue the same barrier so that the descriptor is
+ * accessed only after the index that made it available; each side must
+ * therefore check netdev_pktq_empty() or netdev_pktq_full() before it
+ * gets the descriptor.
+ *
+ ****************************************************************************/
+
+#define netdev_pktq_count(q) ((uint16_t)((q)->pq_tail - (q)->pq_head))
+#define netdev_pktq_empty(q) ((q)->pq_head == (q)->pq_tail)
+#define netdev_pktq_full(q)  (netdev_pktq_count(q) >= (q)->pq_size)
+
+int netdev_pktq_init(FAR struct netdev_pktq_s *pktq,
+                     FAR struct netdev_pktdesc_s *desc, uint16_t ndesc);
+FAR struct netdev_pktdesc_s *
+netdev_pktq_head(FAR struct netdev_pktq_s *pktq);
+FAR struct netdev_pktdesc_s *
+netdev_pktq_tail(FAR struct netdev_pktq_s *pktq);
+void netdev_pktq_commit(FAR struct netdev_pktq_s *pktq);
+void netdev_pktq_remove(FAR struct netdev_pktq_s *pktq);
+int netdev_pktq_put(FAR struct net_driver_s *dev,
+                    FAR struct netdev_pktq_s *pktq);
+int netdev_pktq_get(FAR struct net_driver_s *dev,
+                    FAR struct netdev_pktq_s *pktq);
+int netdev_rxqueue_process(FAR struct net_driver_s *dev,
+                           FAR struct netdev_pktq_s *rxq,
+                           FAR struct netdev_pktq_s *txq,
+                           devif_poll_callback_t input, int budget);
+#endif
+
 /****************************************************************************
  * Carrier detection
  *
@@ -6,7 +6,7 @@
  * macros that are used by internal network structures, TCP/IP header
  * structures and function declarations.
  *
- *   Copyright (C) 2007, 2009-2010, 2012-2014 Gregory Nutt. All rights
+ *   Copyright (C) 2007, 2009-2010, 2012-2014, 2017 Gregory Nutt. All rights
  *      reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
@@ -76,8 +76,19 @@
 #define TCP_OPT_END       0   /* End of TCP options list */
 #define TCP_OPT_NOOP      1   /* "No-operation" TCP option */
 #define TCP_OPT_MSS       2   /* Maximum segment size TCP option */
+#define TCP_OPT_WS        3   /* Window scale TCP option (RFC 7323) */
+#define TCP_OPT_SACKPERM  4   /* SACK permitted TCP option (RFC 2018) */
+#define TCP_OPT_SACK      5   /* SACK TCP option (RFC 2018) */
+#define TCP_OPT_TS        8   /* Timestamps TCP option (RFC 7323) */
 
 #define TCP_OPT_MSS_LEN   4   /* Length of TCP MSS option. */
+#define TCP_OPT_WS_LEN    3   /* Length of TCP window scale option */
+#define TCP_OPT_SACKPERM_LEN 2 /* Length of TCP SACK permitted option */
+#define TCP_OPT_TS_LEN    10  /* Length of TCP timestamps option */
+
+#define TCP_OPT_SACK_BLKLEN 8 /* Length of one block in the SACK option */
+#define TCP_MAX_WS        14  /* Maximum window scale shift count */
+#define TCP_MAX_OPTLEN    40  /* Maximum length of the TCP options */
 
 /* The TCP states used in the struct tcp_conn_s tcpstateflags field */
 
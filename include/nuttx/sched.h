@@ -1,7 +1,7 @@
 /********************************************************************************
  * include/nuttx/sched.h
  *
- *   Copyright (C) 2007-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -123,6 +123,13 @@
 #  define CONFIG_SCHED_SPORADIC_MAXREPL 3
 #endif
 
+/* CPU accounting.  Bucket 0 of the latency histogram holds latencies of
+ * less than 2 microseconds; bucket n holds latencies of 2**n up to
+ * 2**(n+1) microseconds; the last bucket holds all longer latencies.
+ */
+
+#define CPUACCT_NBUCKETS           16
+
 /* Task Management Definitions **************************************************/
 /* Special task IDS.  Any negative PID is invalid. */
 
@@ -307,6 +314,25 @@ struct sporadic_s
 
 #endif /* CONFIG_SCHED_SPORADIC */
 
+/* struct cpuacct_s **************************************************************/
+
+#ifdef CONFIG_SCHED_CPUACCT
+/* This structure holds the CPU accounting data for one thread.  All times are
+ * in microseconds.
+ */
+
+struct cpuacct_s
+{
+  uint64_t  runtime;                /* Total time that the thread has run       */
+  uint64_t  switchin;               /* Time that the thread last started to run */
+  uint64_t  readytime;              /* Time thread became ready (0=not waiting) */
+  uint32_t  maxlatency;             /* Longest wait from ready to running       */
+  uint32_t  nvcsw;                  /* Number of voluntary context switches     */
+  uint32_t  nivcsw;                 /* Number of involuntary context switches   */
+  uint32_t  latency[CPUACCT_NBUCKETS]; /* Histogram of ready-to-run latencies   */
+};
+#endif
+
 /* struct child_status_s *********************************************************/
 /* This structure is used to maintain information about child tasks.  pthreads
  * work differently, they have join information.  This is only for child tasks.
@@ -597,6 +623,10 @@ struct tcb_s
 
   FAR struct wdog_s *waitdog;            /* All timed waits use this timer      */
 
+#ifdef CONFIG_SCHED_CPUACCT
+  struct cpuacct_s acct;                 /* CPU accounting data                 */
+#endif
+
   /* Stack-Related Fields *******************************************************/
 
   size_t    adj_stack_size;              /* Stack size after adjustment         */
@@ -849,7 +879,7 @@ void task_vforkabort(FAR struct task_tcb_s *child, int errcode);
  ********************************************************************************/
 
 #if CONFIG_RR_INTERVAL > 0 || defined(CONFIG_SCHED_SPORADIC) || \
-    defined(CONFIG_SCHED_INSTRUMENTATION)
+    defined(CONFIG_SCHED_INSTRUMENTATION) || defined(CONFIG_SCHED_CPUACCT)
 void sched_resume_scheduler(FAR struct tcb_s *tcb);
 #else
 #  define sched_resume_scheduler(tcb)
@@ -871,12 +901,36 @@ void sched_resume_scheduler(FAR struct tcb_s *tcb);
  *
  ********************************************************************************/
 
-#if defined(CONFIG_SCHED_SPORADIC) || defined(CONFIG_SCHED_INSTRUMENTATION)
+#if defined(CONFIG_SCHED_SPORADIC) || defined(CONFIG_SCHED_INSTRUMENTATION) || \
+    defined(CONFIG_SCHED_CPUACCT)
 void sched_suspend_scheduler(FAR struct tcb_s *tcb);
 #else
 #  define sched_suspend_scheduler(tcb)
 #endif
 
+/********************************************************************************
+ * Name: sched_cpuacct
+ *
+ * Description:
+ *   Return the CPU accounting data for the thread with the selected PID.  The
+ *   run time includes the time that the thread has been running since it was
+ *   last switched in.
+ *
+ * Input Parameters:
+ *   pid  - The task ID of the thread of interest.  pid == 0 is the IDLE thread.
+ *   acct - The location to return the CPU accounting data
+ *
+ * Returned Value:
+ *   OK (0) on success; a negated errno value on failure.  The only reason
+ *   that this function can fail is if 'pid' no longer refers to a valid
+ *   thread.
+ *
+ ********************************************************************************/
+
+#ifdef CONFIG_SCHED_CPUACCT
+int sched_cpuacct(pid_t pid, FAR struct cpuacct_s *acct);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
@@ -1,7 +1,7 @@
 /****************************************************************************
  * include/nuttx/sched_note.h
  *
- *   Copyright (C) 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -106,9 +106,22 @@ enum note_type_e
   NOTE_SPINLOCK_UNLOCK = 16,
   NOTE_SPINLOCK_ABORT  = 17
 #endif
+#ifdef CONFIG_SCHED_INSTRUMENTATION_IRQHANDLER
+  ,
+  NOTE_IRQ_ENTER       = 18,
+  NOTE_IRQ_LEAVE       = 19
+#endif
+#ifdef CONFIG_SCHED_NOTE_LOCKFREE
+  ,
+  NOTE_DROPPED         = 20
+#endif
 };
 
-/* This structure provides the common header of each note */
+/* This structure provides the common header of each note.  With
+ * CONFIG_SCHED_NOTE_LOCKFREE, nc_systime holds the time in microseconds
+ * (with the resolution of the platform timer in tickless mode);
+ * otherwise, it holds the system timer count.
+ */
 
 struct note_common_s
 {
@@ -234,6 +247,48 @@ struct note_spinlock_s
   uint8_t nsp_value;            /* Value of spinlock */
 };
 #endif /* CONFIG_SCHED_INSTRUMENTATION_SPINLOCKS */
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_IRQHANDLER
+/* This is the specific form of the NOTE_IRQ_ENTER/LEAVE note */
+
+struct note_irqhandler_s
+{
+  struct note_common_s nih_cmn; /* Common note parameters */
+  uint8_t nih_irq[2];           /* IRQ number */
+};
+#endif /* CONFIG_SCHED_INSTRUMENTATION_IRQHANDLER */
+
+#ifdef CONFIG_SCHED_NOTE_LOCKFREE
+/* This is the specific form of the NOTE_DROPPED note.  It is generated by
+ * the reader when notes were lost because a CPU's buffer was full.
+ */
+
+struct note_dropped_s
+{
+  struct note_common_s ndr_cmn; /* Common note parameters */
+  uint8_t ndr_count[4];         /* Number of notes lost on this CPU */
+};
+
+/* The /dev/note driver begins each stream with this header.  It describes
+ * the parts of the note format that depend on the target configuration
+ * so that host tools like tools/note2trace.c can decode the notes that
+ * follow.
+ */
+
+#define NOTE_STREAM_MAGIC     "NXNT"
+#define NOTE_STREAM_VERSION   1
+
+#define NOTE_STREAM_SMP       (1 << 0) /* Notes include nc_cpu */
+
+struct note_stream_s
+{
+  uint8_t nhd_magic[4];         /* NOTE_STREAM_MAGIC */
+  uint8_t nhd_version;          /* NOTE_STREAM_VERSION */
+  uint8_t nhd_flags;            /* See NOTE_STREAM_* definitions */
+  uint8_t nhd_ncpus;            /* Number of CPUs */
+  uint8_t nhd_ptrsize;          /* Size of a pointer (in spinlock notes) */
+};
+#endif /* CONFIG_SCHED_NOTE_LOCKFREE */
 #endif /* CONFIG_SCHED_INSTRUMENTATION_BUFFER */
 
 /****************************************************************************
@@ -305,6 +360,12 @@ void sched_note_spinabort(FAR struct tcb_s *tcb, FAR volatile void *spinlock);
 #  define sched_note_spinabort(t,s)
 #endif
 
+#ifdef CONFIG_SCHED_INSTRUMENTATION_IRQHANDLER
+void sched_note_irqhandler(int irq, bool enter);
+#else
+#  define sched_note_irqhandler(i,e)
+#endif
+
 /****************************************************************************
  * Name: sched_note_get
  *
@@ -312,6 +373,10 @@ void sched_note_spinabort(FAR struct tcb_s *tcb, FAR volatile void *spinlock);
  *   Remove the next note from the tail of the circular buffer.  The note
  *   is also removed from the circular buffer to make room for futher notes.
  *
+ *   With CONFIG_SCHED_NOTE_LOCKFREE, the oldest note from any of the
+ *   per-CPU buffers is returned.  Notes are removed without entering a
+ *   critical section, but there must be only one reader at a time.
+ *
  * Input Parameters:
  *   buffer - Location to return the next note
  *   buflen - The length of the user provided buffer.
@@ -387,6 +452,7 @@ int note_register(void);
 #  define sched_note_spinlocked(t,s)
 #  define sched_note_spinunlock(t,s)
 #  define sched_note_spinabort(t,s)
+#  define sched_note_irqhandler(i,e)
 
 #endif /* CONFIG_SCHED_INSTRUMENTATION */
 #endif /* __INCLUDE_NUTTX_SCHED_NOTE_H */
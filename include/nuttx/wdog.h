@@ -143,6 +143,11 @@ struct wdog_s
   uint8_t            flags;      /* See WDOGF_* definitions above */
   uint8_t            argc;       /* The number of parameters to pass */
   wdparm_t           parm[CONFIG_MAX_WDOGPARMS];
+#ifdef CONFIG_WDOG_TIMERWHEEL
+  FAR struct wdog_s *prev;       /* Support for doubly linked wheel slots */
+  uint32_t           expire;     /* Wheel time when the watchdog expires */
+  uint8_t            slot;       /* Index of the wheel slot holding the wdog */
+#endif
 };
 
 /* Watchdog 'handle' */
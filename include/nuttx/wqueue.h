@@ -1,7 +1,7 @@
 /****************************************************************************
  * include/nuttx/wqueue.h
  *
- *   Copyright (C) 2009, 2011-2014 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2009, 2011-2014, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -294,7 +294,27 @@ struct work_s
   FAR void *arg;         /* Callback argument */
   systime_t qtime;       /* Time work queued */
   systime_t delay;       /* Delay until work performed */
+#ifdef CONFIG_SCHED_LPWORK_PERCPU
+  int8_t    cpu;         /* CPU whose ready queue receives LPWORK work */
+#endif
+};
+
+/* Work queue statistics.  Latencies are measured in clock ticks from the
+ * time that work became ready to run (i.e., when it was queued or when its
+ * delay expired) until the worker callback was invoked.
+ */
+
+#ifdef CONFIG_SCHED_WORKSTATS
+struct work_stats_s
+{
+  uint32_t  nready;      /* Number of queued work items that are ready */
+  uint32_t  ndelayed;    /* Number of queued work items still delayed */
+  uint32_t  maxdepth;    /* High water mark of nready + ndelayed */
+  uint32_t  nrun;        /* Number of work items performed */
+  systime_t maxlatency;  /* Longest latency observed */
+  systime_t totlatency;  /* Sum of the latencies of all performed work */
 };
+#endif
 
 /****************************************************************************
  * Public Data
@@ -363,6 +383,38 @@ int work_usrstart(void);
 int work_queue(int qid, FAR struct work_s *work, worker_t worker,
                FAR void *arg, systime_t delay);
 
+/****************************************************************************
+ * Name: work_queue_cpu
+ *
+ * Description:
+ *   Queue work to be performed at a later time, like work_queue(), but with
+ *   a hint of the CPU that should perform the work.  The hint is used only
+ *   for the low-priority work queue when CONFIG_SCHED_LPWORK_PERCPU is
+ *   selected.  The work may still be performed on another CPU if the
+ *   preferred CPU is busy.
+ *
+ * Input parameters:
+ *   qid    - The work queue ID
+ *   work   - The work structure to queue
+ *   worker - The worker callback to be invoked.
+ *   arg    - The argument that will be passed to the worker callback.
+ *   delay  - Delay (in clock ticks) from the time queue until the worker
+ *            is invoked. Zero means to perform the work immediately.
+ *   cpu    - The preferred CPU, or -1 to use the current CPU.
+ *
+ * Returned Value:
+ *   Zero on success, a negated errno on failure
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_LPWORK_PERCPU
+int work_queue_cpu(int qid, FAR struct work_s *work, worker_t worker,
+                   FAR void *arg, systime_t delay, int cpu);
+#else
+#  define work_queue_cpu(qid,work,worker,arg,delay,cpu) \
+     work_queue(qid,work,worker,arg,delay)
+#endif
+
 /****************************************************************************
  * Name: work_cancel
  *
@@ -403,6 +455,27 @@ int work_cancel(int qid, FAR struct work_s *work);
 
 int work_signal(int qid);
 
+/****************************************************************************
+ * Name: work_stats
+ *
+ * Description:
+ *   Return a snapshot of the statistics of a kernel work queue.
+ *
+ * Input parameters:
+ *   qid   - The work queue ID (must be HPWORK or LPWORK)
+ *   stats - The location to return the statistics
+ *
+ * Returned Value:
+ *   Zero on success, a negated errno on failure
+ *
+ *   -EINVAL - An invalid work queue was specified
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_WORKSTATS
+int work_stats(int qid, FAR struct work_stats_s *stats);
+#endif
+
 /****************************************************************************
  * Name: work_available
  *
@@ -103,6 +103,14 @@ typedef unsigned int nfds_t;
 
 typedef uint8_t pollevent_t;
 
+/* In-kernel pollers (such as epoll) may provide a callback that is invoked
+ * instead of posting the semaphore when an event is reported.  This tells
+ * the poller which pollfd became ready, not just that something did.
+ */
+
+struct pollfd;
+typedef CODE void (*pollcb_t)(FAR struct pollfd *fds);
+
 /* This is the Nuttx variant of the standard pollfd structure. */
 
 struct pollfd
@@ -112,6 +120,7 @@ struct pollfd
   pollevent_t events;   /* The input event flags */
   pollevent_t revents;  /* The output event flags */
   FAR void   *priv;     /* For use by drivers */
+  pollcb_t    cb;       /* Notification callback (kernel use only) */
 };
 
 /****************************************************************************
@@ -1,5 +1,5 @@
 /****************************************************************************
- * fs/vfs/fs_epoll.c
+ * include/sys/epoll.h
  *
  *   Copyright (C) 2015 Anton D. Kachalov. All rights reserved.
  *   Author: Anton D. Kachalov <mouse@mayc.ru>
@@ -40,6 +40,9 @@
  * Included Files
  ****************************************************************************/
 
+#include <nuttx/config.h>
+
+#include <stdint.h>
 #include <poll.h>
 
 /****************************************************************************
@@ -50,6 +53,27 @@
 #define EPOLL_CTL_DEL 2 /* Remove a file descriptor from the interface.  */
 #define EPOLL_CTL_MOD 3 /* Change file descriptor epoll_event structure.  */
 
+/* Flags for epoll_create1().  NuttX does not support exec() so the
+ * close-on-exec flag is accepted but has no effect.
+ */
+
+#define EPOLL_CLOEXEC (1 << 0)
+
+/* Input flags that modify how events are reported.  These are not poll
+ * events and are never returned in the events field by epoll_wait().
+ *
+ *   EPOLLONESHOT
+ *     Report the descriptor once, then disable it until it is re-armed with
+ *     EPOLL_CTL_MOD.
+ *   EPOLLET
+ *     Edge-triggered:  Report the descriptor only when new events are
+ *     signaled by the driver, not every time epoll_wait() is called while
+ *     the descriptor remains ready.
+ */
+
+#define EPOLLONESHOT  (1u << 30)
+#define EPOLLET       (1u << 31)
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -76,35 +100,52 @@ enum EPOLL_EVENTS
 #define EPOLLHUP EPOLLHUP
   };
 
+/* User data that is returned unmodified by epoll_wait() */
+
 typedef union poll_data
 {
-  int          fd;       /* The descriptor being polled */
+  FAR void    *ptr;
+  int          fd;
+  uint32_t     u32;
+#ifdef __INT64_DEFINED
+  uint64_t     u64;
+#endif
 } epoll_data_t;
 
 struct epoll_event
 {
-  epoll_data_t data;
-  FAR sem_t   *sem;      /* Pointer to semaphore used to post output event */
-  pollevent_t  events;   /* The input event flags */
-  pollevent_t  revents;  /* The output event flags */
-  FAR void    *priv;     /* For use by drivers */
-};
-
-struct epoll_head
-{
-  int size;
-  int occupied;
-  FAR struct epoll_event *evs;
+  uint32_t     events;   /* Input: Events of interest; Output: Events ready */
+  epoll_data_t data;     /* User data returned with the event */
 };
 
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
 
+#undef EXTERN
+#if defined(__cplusplus)
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
 int epoll_create(int size);
-int epoll_ctl(int epfd, int op, int fd, struct epoll_event *ev);
-int epoll_wait(int epfd, struct epoll_event *evs, int maxevents, int timeout);
+int epoll_create1(int flags);
+int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev);
+int epoll_wait(int epfd, FAR struct epoll_event *evs, int maxevents,
+               int timeout);
+
+/* epoll_close() is retained for compatibility.  It is equivalent to
+ * close(epfd).
+ */
 
 void epoll_close(int epfd);
 
+#undef EXTERN
+#if defined(__cplusplus)
+}
+#endif
+
 #endif /* __INCLUDE_SYS_EPOLL_H */
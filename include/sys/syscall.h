@@ -355,8 +355,8 @@
 #    define __SYS_sendfile             (__SYS_fs_fdopen+0)
 #  endif
 
-#  if defined(CONFIG_NET_SENDFILE)
-#    define SYS_sendfile,              __SYS_sendfile
+#  if defined(CONFIG_FS_SENDFILE)
+#    define SYS_sendfile               __SYS_sendfile
 #    define __SYS_mountpoint           (__SYS_sendfile+1)
 #  else
 #    define __SYS_mountpoint           __SYS_sendfile
@@ -516,7 +516,12 @@
 #  define SYS_sendto                   (__SYS_network+8)
 #  define SYS_setsockopt               (__SYS_network+9)
 #  define SYS_socket                   (__SYS_network+10)
-#  define SYS_nnetsocket               (__SYS_network+11)
+#  ifdef CONFIG_NET_LOCAL_DIRECT
+#    define SYS_socketpair             (__SYS_network+11)
+#    define SYS_nnetsocket             (__SYS_network+12)
+#  else
+#    define SYS_nnetsocket             (__SYS_network+11)
+#  endif
 #else
 #  define SYS_nnetsocket               __SYS_network
 #endif
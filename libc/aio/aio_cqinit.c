@@ -0,0 +1,131 @@
+/****************************************************************************
+ * libc/aio/aio_cqinit.c
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <limits.h>
+#include <semaphore.h>
+#include <aio.h>
+#include <errno.h>
+
+#include <nuttx/semaphore.h>
+
+#ifdef CONFIG_FS_AIO
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_cqinit
+ *
+ * Description:
+ *   Initialize an AIO completion queue (non-standard).  Completions of I/O
+ *   submitted with aio_sigevent.sigev_notify set to SIGEV_AIOCQ and
+ *   aio_sigevent.sigev_value.sival_ptr referring to the queue are posted to
+ *   the queue instead of being signalled.  They are reaped with
+ *   aio_cqwait().
+ *
+ *   Each submission reserves one entry in the ring until its completion is
+ *   reaped; a submission that would overflow the ring fails with EAGAIN.
+ *
+ * Input Parameters:
+ *   cq       - The completion queue to be initialized
+ *   ring     - Storage for the ring of completed AIO control blocks.  This
+ *              storage must persist as long as the completion queue is
+ *              used.
+ *   nentries - The number of entries in the ring
+ *
+ * Returned Value:
+ *   Zero (OK) on success.  Otherwise, -1 (ERROR) is returned and the errno
+ *   is set to indicate the error:
+ *
+ *   EINVAL - A NULL cq or ring, or an invalid nentries.
+ *
+ ****************************************************************************/
+
+int aio_cqinit(FAR struct aiocq *cq, FAR struct aiocb **ring, int nentries)
+{
+  if (cq == NULL || ring == NULL || nentries <= 0 ||
+      nentries > SEM_VALUE_MAX || nentries > UINT16_MAX)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  /* The semaphores are used for signaling and, hence, should not have
+   * priority inheritance enabled.
+   */
+
+  (void)sem_init(&cq->aiocq_ready, 0, 0);
+  (void)sem_setprotocol(&cq->aiocq_ready, SEM_PRIO_NONE);
+  (void)sem_init(&cq->aiocq_free, 0, nentries);
+  (void)sem_setprotocol(&cq->aiocq_free, SEM_PRIO_NONE);
+
+  cq->aiocq_ring     = ring;
+  cq->aiocq_nentries = nentries;
+  cq->aiocq_head     = 0;
+  cq->aiocq_tail     = 0;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: aio_cqdestroy
+ *
+ * Description:
+ *   Release the resources used by an AIO completion queue (non-standard).
+ *   There must be no submitted I/O that will complete to the queue.
+ *
+ * Input Parameters:
+ *   cq - The completion queue to be destroyed
+ *
+ * Returned Value:
+ *   Zero (OK) is always returned.
+ *
+ ****************************************************************************/
+
+int aio_cqdestroy(FAR struct aiocq *cq)
+{
+  (void)sem_destroy(&cq->aiocq_ready);
+  (void)sem_destroy(&cq->aiocq_free);
+  return OK;
+}
+
+#endif /* CONFIG_FS_AIO */
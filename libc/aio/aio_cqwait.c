@@ -0,0 +1,150 @@
+/****************************************************************************
+ * libc/aio/aio_cqwait.c
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <semaphore.h>
+#include <time.h>
+#include <aio.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <nuttx/clock.h>
+
+#ifdef CONFIG_FS_AIO
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_cqwait
+ *
+ * Description:
+ *   Reap completed asynchronous I/O from a completion queue
+ *   (non-standard).  The calling thread is suspended until at least one
+ *   I/O operation has completed to the queue, until a signal interrupts
+ *   the function, or until the time interval specified by 'timeout' has
+ *   passed.  Then up to 'nent' completed AIO control blocks are returned
+ *   without further waiting, in the order in which they completed.
+ *
+ *   Only one thread may reap completions from a completion queue.
+ *
+ * Input Parameters:
+ *   cq      - The completion queue (see aio_cqinit())
+ *   list    - Receives the completed AIO control blocks
+ *   nent    - The maximum number of AIO control blocks to return
+ *   timeout - The maximum time to wait, or NULL to wait indefinitely.  A
+ *             zero timeout only polls the queue.
+ *
+ * Returned Value:
+ *   The number of completed AIO control blocks returned in list[].  The
+ *   result of each I/O is available through aio_error() and aio_return().
+ *   Otherwise, -1 (ERROR) is returned and the errno is set to indicate
+ *   the error:
+ *
+ *   EAGAIN    - No I/O has completed and the timeout was zero.
+ *   ETIMEDOUT - No I/O completed before the timeout expired.
+ *   EINTR     - A signal interrupted the wait.
+ *
+ ****************************************************************************/
+
+int aio_cqwait(FAR struct aiocq *cq, FAR struct aiocb *list[], int nent,
+               FAR const struct timespec *timeout)
+{
+  struct timespec abstime;
+  int ret;
+  int n;
+
+  DEBUGASSERT(cq != NULL && list != NULL && nent > 0);
+
+  /* Wait for the first completion */
+
+  if (timeout == NULL)
+    {
+      ret = sem_wait(&cq->aiocq_ready);
+    }
+  else if (timeout->tv_sec == 0 && timeout->tv_nsec == 0)
+    {
+      ret = sem_trywait(&cq->aiocq_ready);
+    }
+  else
+    {
+      /* sem_timedwait() needs an absolute time */
+
+      (void)clock_gettime(CLOCK_REALTIME, &abstime);
+      abstime.tv_sec  += timeout->tv_sec;
+      abstime.tv_nsec += timeout->tv_nsec;
+      if (abstime.tv_nsec >= NSEC_PER_SEC)
+        {
+          abstime.tv_sec++;
+          abstime.tv_nsec -= NSEC_PER_SEC;
+        }
+
+      ret = sem_timedwait(&cq->aiocq_ready, &abstime);
+    }
+
+  if (ret < 0)
+    {
+      /* The errno value has already been set */
+
+      return ERROR;
+    }
+
+  /* Then reap that completion and any others that are already available,
+   * releasing each ring entry for re-use by the next submission.
+   */
+
+  n = 0;
+  do
+    {
+      list[n++] = cq->aiocq_ring[cq->aiocq_head];
+      if (++cq->aiocq_head >= cq->aiocq_nentries)
+        {
+          cq->aiocq_head = 0;
+        }
+
+      (void)sem_post(&cq->aiocq_free);
+    }
+  while (n < nent && sem_trywait(&cq->aiocq_ready) == OK);
+
+  return n;
+}
+
+#endif /* CONFIG_FS_AIO */
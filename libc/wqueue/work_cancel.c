@@ -108,18 +108,24 @@ static int work_qcancel(FAR struct usr_wqueue_s *wqueue, FAR struct work_s *work
 
   if (work->worker != NULL)
     {
+      /* Work with a non-zero delay is still in the delayed work queue.
+       * The delay is cleared when the work is moved to the ready queue.
+       */
+
+      FAR dq_queue_t *q = work->delay > 0 ? &wqueue->delayq : &wqueue->q;
+
       /* A little test of the integrity of the work queue */
 
       DEBUGASSERT(work->dq.flink != NULL ||
-                  (FAR dq_entry_t *)work == wqueue->q.tail);
+                  (FAR dq_entry_t *)work == q->tail);
       DEBUGASSERT(work->dq.blink != NULL ||
-                  (FAR dq_entry_t *)work == wqueue->q.head);
+                  (FAR dq_entry_t *)work == q->head);
 
       /* Remove the entry from the work queue and make sure that it is
        * marked as available (i.e., the worker field is nullified).
        */
 
-      dq_rem((FAR dq_entry_t *)work, &wqueue->q);
+      dq_rem((FAR dq_entry_t *)work, q);
       work->worker = NULL;
       ret = OK;
     }
@@ -105,7 +105,35 @@ static int work_qqueue(FAR struct usr_wqueue_s *wqueue,
 
   work->qtime  = clock_systimer(); /* Time work queued */
 
-  dq_addlast((FAR dq_entry_t *)work, &wqueue->q);
+  if (delay == 0)
+    {
+      /* The work is ready to run now */
+
+      dq_addlast((FAR dq_entry_t *)work, &wqueue->q);
+    }
+  else
+    {
+      FAR struct work_s *curr;
+
+      /* Insert the work into the delayed work queue, ordered by the time
+       * of expiration.  Search backward from the tail of the queue.
+       */
+
+      for (curr  = (FAR struct work_s *)wqueue->delayq.tail;
+           curr != NULL && WORK_REMAINING(curr, work->qtime) > delay;
+           curr  = (FAR struct work_s *)curr->dq.blink);
+
+      if (curr == NULL)
+        {
+          dq_addfirst((FAR dq_entry_t *)work, &wqueue->delayq);
+        }
+      else
+        {
+          dq_addafter((FAR dq_entry_t *)curr, (FAR dq_entry_t *)work,
+                      &wqueue->delayq);
+        }
+    }
+
   kill(wqueue->pid, SIGWORK);   /* Wake up the worker thread */
 
   work_unlock();
@@ -100,6 +100,39 @@ pthread_mutex_t g_usrmutex;
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: work_expire
+ *
+ * Description:
+ *   Move all delayed work whose delay has elapsed to the tail of the ready
+ *   queue.  The time that the work became ready is saved in qtime and the
+ *   delay is cleared.
+ *
+ * Input parameters:
+ *   wqueue - Describes the work queue to be processed
+ *   ctick  - The current time in clock ticks
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+static void work_expire(FAR struct usr_wqueue_s *wqueue, systime_t ctick)
+{
+  FAR struct work_s *work;
+
+  while ((work = (FAR struct work_s *)wqueue->delayq.head) != NULL &&
+         WORK_REMAINING(work, ctick) == 0)
+    {
+      (void)dq_remfirst(&wqueue->delayq);
+
+      work->qtime += work->delay;
+      work->delay  = 0;
+
+      dq_addlast((FAR dq_entry_t *)work, &wqueue->q);
+    }
+}
+
 /****************************************************************************
  * Name: work_process
  *
@@ -119,13 +152,12 @@ pthread_mutex_t g_usrmutex;
 
 void work_process(FAR struct usr_wqueue_s *wqueue)
 {
-  volatile FAR struct work_s *work;
+  FAR struct work_s *work;
   worker_t  worker;
   FAR void *arg;
   systime_t elapsed;
   systime_t remaining;
   systime_t stick;
-  systime_t ctick;
   systime_t next;
   int ret;
 
@@ -146,109 +178,75 @@ void work_process(FAR struct usr_wqueue_s *wqueue)
 
   stick = clock_systimer();
 
-  /* And check each entry in the work queue.  Since we have locked the
-   * work queue we know:  (1) we will not be suspended unless we do
-   * so ourselves, and (2) there will be no changes to the work queue
+  /* Perform all of the work that is ready to run.  Since we have locked the
+   * work queue we know:  (1) we will not be suspended unless we do so
+   * ourselves, and (2) there will be no changes to the work queue.
    */
 
-  work = (FAR struct work_s *)wqueue->q.head;
-  while (work)
+  for (; ; )
     {
-      /* Is this work ready?  It is ready if there is no delay or if
-       * the delay has elapsed. qtime is the time that the work was added
-       * to the work queue.  It will always be greater than or equal to
-       * zero.  Therefore a delay of zero will always execute immediately.
+      /* First, move any delayed work that has become ready to the ready
+       * queue.  Then take the work at the head of the ready queue.
        */
 
-      ctick   = clock_systimer();
-      elapsed = ctick - work->qtime;
-      if (elapsed >= work->delay)
-        {
-          /* Remove the ready-to-execute work from the list */
-
-          (void)dq_rem((struct dq_entry_s *)work, &wqueue->q);
-
-          /* Extract the work description from the entry (in case the work
-           * instance by the re-used after it has been de-queued).
-           */
+      work_expire(wqueue, clock_systimer());
 
-          worker = work->worker;
-
-          /* Check for a race condition where the work may be nullified
-           * before it is removed from the queue.
-           */
+      work = (FAR struct work_s *)dq_remfirst(&wqueue->q);
+      if (work == NULL)
+        {
+          break;
+        }
 
-          if (worker != NULL)
-            {
-              /* Extract the work argument (before unlocking the work queue) */
+      /* Extract the work description from the entry (in case the work
+       * instance by the re-used after it has been de-queued).
+       */
 
-              arg = work->arg;
+      worker = work->worker;
 
-              /* Mark the work as no longer being queued */
+      /* Check for a race condition where the work may be nullified
+       * before it is removed from the queue.
+       */
 
-              work->worker = NULL;
+      if (worker != NULL)
+        {
+          /* Extract the work argument (before unlocking the work queue) */
 
-              /* Do the work.  Unlock the the work queue while the work is being
-               * performed... we don't have any idea how long this will take!
-               */
+          arg = work->arg;
 
-              work_unlock();
-              worker(arg);
+          /* Mark the work as no longer being queued */
 
-              /* Now, unfortunately, since we unlocked the work queue we don't
-               * know the state of the work list and we will have to start
-               * back at the head of the list.
-               */
+          work->worker = NULL;
 
-              ret = work_lock();
-              if (ret < 0)
-                {
-                  /* Break out earlier if we were awakened by a signal */
+          /* Do the work.  Unlock the the work queue while the work is being
+           * performed... we don't have any idea how long this will take!
+           */
 
-                  return;
-                }
+          work_unlock();
+          worker(arg);
 
-              work = (FAR struct work_s *)wqueue->q.head;
-            }
-          else
+          ret = work_lock();
+          if (ret < 0)
             {
-              /* Cancelled.. Just move to the next work in the list with
-               * the work queue still locked.
-               */
+              /* Break out earlier if we were awakened by a signal */
 
-              work = (FAR struct work_s *)work->dq.flink;
+              return;
             }
         }
-      else /* elapsed < work->delay */
-        {
-          /* This one is not ready.
-           *
-           * NOTE that elapsed is relative to the the current time,
-           * not the time of beginning of this queue processing pass.
-           * So it may need an adjustment.
-           */
-
-          elapsed += (ctick - stick);
-          if (elapsed > work->delay)
-            {
-              /* The delay has expired while we are processing */
-
-              elapsed = work->delay;
-            }
-
-          /* Will it be ready before the next scheduled wakeup interval? */
-
-          remaining = work->delay - elapsed;
-          if (remaining < next)
-            {
-              /* Yes.. Then schedule to wake up when the work is ready */
+    }
 
-              next = remaining;
-            }
+  /* Will the next delayed work be ready before the next scheduled wakeup
+   * interval?  Only the head of the delayed work queue needs to be checked.
+   */
 
-          /* Then try the next in the list. */
+  work = (FAR struct work_s *)wqueue->delayq.head;
+  if (work != NULL)
+    {
+      remaining = WORK_REMAINING(work, clock_systimer());
+      if (remaining < next)
+        {
+          /* Yes.. Then schedule to wake up when the work is ready */
 
-          work = (FAR struct work_s *)work->dq.flink;
+          next = remaining;
         }
     }
 
@@ -345,6 +343,7 @@ int work_usrstart(void)
 
   g_usrwork.delay = CONFIG_LIB_USRWORKPERIOD / USEC_PER_TICK;
   dq_init(&g_usrwork.q);
+  dq_init(&g_usrwork.delayq);
 
 #ifdef CONFIG_BUILD_PROTECTED
   {
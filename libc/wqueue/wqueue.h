@@ -53,6 +53,13 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Return the number of clock ticks remaining before delayed work 'w' is
+ * ready to run at time 'now'.
+ */
+
+#define WORK_REMAINING(w,now) \
+  (((now) - (w)->qtime) >= (w)->delay ? 0 : (w)->delay - ((now) - (w)->qtime))
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
@@ -62,7 +69,8 @@
 struct usr_wqueue_s
 {
   uint32_t          delay;  /* Delay between polling cycles (ticks) */
-  struct dq_queue_s q;      /* The queue of pending work */
+  struct dq_queue_s q;      /* The queue of work that is ready to run */
+  struct dq_queue_s delayq; /* Delayed work, ordered by expiration */
   pid_t             pid;    /* The task ID of the worker thread(s) */
 };
 
@@ -52,10 +52,56 @@
  *   Add a free chunk to the node next.  It is assumed that the caller holds
  *   the mm semaphore
  *
+ *   With CONFIG_MM_TLSF, the chunk is added to the head of its segregated
+ *   list in constant time.  Otherwise, the chunk is inserted in size order
+ *   so that mm_findfreechunk() will return the best fitting chunk.
+ *
  ****************************************************************************/
 
 void mm_addfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
 {
+#ifdef CONFIG_MM_TLSF
+  FAR struct mm_freenode_s *next;
+  int fl;
+  int sl;
+
+  /* A free chunk smaller than MM_MIN_CHUNK (a fragment left by
+   * mm_memalign(), for example) can never satisfy an allocation.  It is not
+   * added to any list but will be recovered when an adjacent chunk is freed
+   * and merged with it.
+   */
+
+  if (node->size < MM_MIN_CHUNK)
+    {
+      node->flink = NULL;
+      node->blink = NULL;
+      return;
+    }
+
+  /* Convert the size to a pair of free list indices */
+
+  mm_size2tlsf(node->size, &fl, &sl);
+
+  /* Every chunk in the list is interchangeable, so just add the new node at
+   * the head of the list.
+   */
+
+  next                      = heap->mm_freelist[fl][sl];
+  node->blink               = NULL;
+  node->flink               = next;
+  heap->mm_freelist[fl][sl] = node;
+
+  if (next)
+    {
+      next->blink = node;
+    }
+
+  /* Mark the list as non-empty */
+
+  heap->mm_slbitmap[fl] |= (uint32_t)1 << sl;
+  heap->mm_flbitmap     |= (uint32_t)1 << fl;
+
+#else
   FAR struct mm_freenode_s *next;
   FAR struct mm_freenode_s *prev;
 
@@ -81,4 +127,5 @@ void mm_addfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
 
       next->blink = node;
     }
+#endif
 }
@@ -0,0 +1,305 @@
+/****************************************************************************
+ * mm/mm_heap/mm_cache.c
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/arch.h>
+#include <nuttx/mm/mm.h>
+
+#ifdef CONFIG_MM_CHUNKCACHE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* When a magazine is full, this many chunks are returned to the heap in one
+ * batch, holding the MM semaphore only once.
+ */
+
+#define MM_CACHE_NDRAIN ((CONFIG_MM_CHUNKCACHE_DEPTH + 1) / 2)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_cachelock and mm_cacheunlock
+ *
+ * Description:
+ *   Get exclusive access to the chunk cache of the current CPU.  Local
+ *   interrupts are disabled so that the caller cannot be preempted or
+ *   migrated to another CPU.  In the SMP case, the per-CPU spinlock is also
+ *   taken; it is contended only by mm_cacheflush().
+ *
+ ****************************************************************************/
+
+static inline FAR struct mm_cache_s *mm_cachelock(FAR struct mm_heap_s *heap,
+                                                  FAR irqstate_t *flags)
+{
+  FAR struct mm_cache_s *cache;
+
+  *flags = up_irq_save();
+  cache  = &heap->mm_cache[up_cpu_index()];
+
+#ifdef CONFIG_SMP
+  spin_lock(&cache->mc_lock);
+#endif
+  return cache;
+}
+
+static inline void mm_cacheunlock(FAR struct mm_cache_s *cache,
+                                  irqstate_t flags)
+{
+#ifdef CONFIG_SMP
+  spin_unlock(&cache->mc_lock);
+#endif
+  up_irq_restore(flags);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_cacheinitialize
+ *
+ * Description:
+ *   Initialize the (empty) chunk caches of the selected heap.
+ *
+ ****************************************************************************/
+
+void mm_cacheinitialize(FAR struct mm_heap_s *heap)
+{
+#ifdef CONFIG_SMP
+  int cpu;
+#endif
+
+  memset(heap->mm_cache, 0, sizeof(heap->mm_cache));
+
+#ifdef CONFIG_SMP
+  for (cpu = 0; cpu < MM_CACHE_NCPUS; cpu++)
+    {
+      spin_initialize(&heap->mm_cache[cpu].mc_lock, SP_UNLOCKED);
+    }
+#endif
+}
+
+/****************************************************************************
+ * Name: mm_cachealloc
+ *
+ * Description:
+ *   Try to satisfy a small allocation from the chunk cache of the current
+ *   CPU without taking the MM semaphore.
+ *
+ * Returned Value:
+ *   The allocated memory or NULL if the request is not small enough to be
+ *   cached or if there is no cached chunk of the required size class.
+ *
+ ****************************************************************************/
+
+FAR void *mm_cachealloc(FAR struct mm_heap_s *heap, size_t size)
+{
+  FAR struct mm_cache_s *cache;
+  FAR void *ret = NULL;
+  irqstate_t flags;
+  int ndx;
+
+  if (size > CONFIG_MM_CHUNKCACHE_MAXSIZE)
+    {
+      return NULL;
+    }
+
+  /* Convert the request into a size class index */
+
+  ndx = (MM_ALIGN_UP(size + SIZEOF_MM_ALLOCNODE) >> MM_MIN_SHIFT) - 1;
+
+  cache = mm_cachelock(heap, &flags);
+  if (cache->mc_count[ndx] > 0)
+    {
+      ret = cache->mc_mem[ndx][--cache->mc_count[ndx]];
+    }
+
+  mm_cacheunlock(cache, flags);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: mm_cachefree
+ *
+ * Description:
+ *   Try to hold a freed chunk in the chunk cache of the current CPU.  If the
+ *   magazine for its size class is full, the oldest half of the magazine is
+ *   first returned to the heap.
+ *
+ * Returned Value:
+ *   true if the chunk is now held in the cache; false if the chunk is not
+ *   small enough to be cached and must be freed normally.
+ *
+ ****************************************************************************/
+
+bool mm_cachefree(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+  FAR struct mm_allocnode_s *node;
+  FAR struct mm_cache_s *cache;
+  FAR void *drain[MM_CACHE_NDRAIN];
+  irqstate_t flags;
+  int ndrain = 0;
+  int count;
+  int ndx;
+  int i;
+
+  /* The chunk size class is determined from the actual chunk size.  This
+   * may be larger than the size originally requested, but it is never
+   * smaller than the size of the class.
+   */
+
+  node = (FAR struct mm_allocnode_s *)((FAR char *)mem - SIZEOF_MM_ALLOCNODE);
+  DEBUGASSERT((node->preceding & MM_ALLOC_BIT) != 0);
+
+  if (node->size < MM_MIN_CHUNK || node->size > MM_CACHE_MAXCHUNK)
+    {
+      return false;
+    }
+
+  ndx   = (node->size >> MM_MIN_SHIFT) - 1;
+  cache = mm_cachelock(heap, &flags);
+  count = cache->mc_count[ndx];
+
+  if (count >= CONFIG_MM_CHUNKCACHE_DEPTH)
+    {
+      /* The magazine is full.  Remove the oldest chunks (at the bottom of
+       * the magazine) so that they can be returned to the heap.
+       */
+
+      ndrain = MM_CACHE_NDRAIN;
+      memcpy(drain, cache->mc_mem[ndx], ndrain * sizeof(FAR void *));
+
+      count -= ndrain;
+      memmove(cache->mc_mem[ndx], &cache->mc_mem[ndx][ndrain],
+              count * sizeof(FAR void *));
+    }
+
+  cache->mc_mem[ndx][count] = mem;
+  cache->mc_count[ndx]      = count + 1;
+  mm_cacheunlock(cache, flags);
+
+  /* Return any drained chunks to the heap in one batch */
+
+  if (ndrain > 0)
+    {
+      mm_takesemaphore(heap);
+      for (i = 0; i < ndrain; i++)
+        {
+          mm_freechunk(heap, drain[i]);
+        }
+
+      mm_givesemaphore(heap);
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: mm_cacheflush
+ *
+ * Description:
+ *   Return all chunks held in the chunk caches of all CPUs to the heap.
+ *   This is done when an allocation cannot otherwise be satisfied.
+ *
+ * Returned Value:
+ *   The number of chunks returned to the heap.
+ *
+ ****************************************************************************/
+
+int mm_cacheflush(FAR struct mm_heap_s *heap)
+{
+  FAR struct mm_cache_s *cache;
+  FAR void *mem;
+  irqstate_t flags;
+  int nflushed = 0;
+  int cpu;
+  int ndx;
+
+  mm_takesemaphore(heap);
+
+  for (cpu = 0; cpu < MM_CACHE_NCPUS; cpu++)
+    {
+      cache = &heap->mm_cache[cpu];
+
+      for (ndx = 0; ndx < MM_CACHE_NCLASSES; ndx++)
+        {
+          /* Remove the chunks one at a time so that interrupts are not
+           * disabled for the entire flush.
+           */
+
+          for (; ; )
+            {
+              flags = up_irq_save();
+#ifdef CONFIG_SMP
+              spin_lock(&cache->mc_lock);
+#endif
+              mem = NULL;
+              if (cache->mc_count[ndx] > 0)
+                {
+                  mem = cache->mc_mem[ndx][--cache->mc_count[ndx]];
+                }
+
+              mm_cacheunlock(cache, flags);
+
+              if (mem == NULL)
+                {
+                  break;
+                }
+
+              mm_freechunk(heap, mem);
+              nflushed++;
+            }
+        }
+    }
+
+  mm_givesemaphore(heap);
+  return nflushed;
+}
+
+#endif /* CONFIG_MM_CHUNKCACHE */
@@ -0,0 +1,147 @@
+/****************************************************************************
+ * mm/mm_heap/mm_findfreechunk.c
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <strings.h>
+#include <assert.h>
+
+#include <nuttx/mm/mm.h>
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_findfreechunk
+ *
+ * Description:
+ *   Find a free chunk that is large enough to hold 'size' bytes (including
+ *   the allocated node header).  The chunk is not removed from the free
+ *   node list.  It is assumed that the caller holds the mm semaphore.
+ *
+ *   Without CONFIG_MM_TLSF, this is a search of the size-ordered node list
+ *   so the smallest chunk that satisfies the request is returned.  The
+ *   search time is proportional to the number of free chunks.
+ *
+ *   With CONFIG_MM_TLSF, the request is rounded up to the next second
+ *   level size class boundary so that the first chunk of any non-empty
+ *   list at or above that class is large enough.  That list is then found
+ *   with two bit searches, in constant time.  The only exception is a
+ *   request of MM_MAX_CHUNK or more which must still search the single list
+ *   of very large chunks.
+ *
+ * Returned Value:
+ *   The free chunk or NULL if no chunk is large enough.
+ *
+ ****************************************************************************/
+
+FAR struct mm_freenode_s *mm_findfreechunk(FAR struct mm_heap_s *heap,
+                                           size_t size)
+{
+  FAR struct mm_freenode_s *node;
+#ifdef CONFIG_MM_TLSF
+  size_t mapsize = size;
+  uint32_t bitmap;
+  int fl;
+  int sl;
+
+  /* Round the size up to the next second level boundary */
+
+  if (size < MM_MAX_CHUNK)
+    {
+      int msb = flsl((long)size) - 1;
+      if (msb > MM_TLSF_SLBITS)
+        {
+          mapsize += ((size_t)1 << (msb - MM_TLSF_SLBITS)) - 1;
+        }
+    }
+
+  mm_size2tlsf(mapsize, &fl, &sl);
+
+  /* Look for a non-empty list in the same first level class */
+
+  bitmap = heap->mm_slbitmap[fl] & (~(uint32_t)0 << sl);
+  if (bitmap == 0)
+    {
+      /* None.. look for any larger first level class */
+
+      bitmap = heap->mm_flbitmap & (~(uint32_t)0 << (fl + 1));
+      if (bitmap == 0)
+        {
+          return NULL;
+        }
+
+      fl     = ffsl((long)bitmap) - 1;
+      bitmap = heap->mm_slbitmap[fl];
+    }
+
+  sl   = ffsl((long)bitmap) - 1;
+  node = heap->mm_freelist[fl][sl];
+  DEBUGASSERT(node != NULL);
+
+  /* Chunks in the list of very large chunks are not all of the same size
+   * class.  Those chunks are all at least MM_MAX_CHUNK in size, so a search
+   * is needed only if the request is that large.
+   */
+
+  if (size >= MM_MAX_CHUNK)
+    {
+      for (; node && node->size < size; node = node->flink);
+    }
+
+#else
+  int ndx;
+
+  /* Get the location in the node list to start the search. */
+
+  ndx = mm_size2ndx(size);
+
+  /* Search for a large enough chunk in the list of nodes. This list is
+   * ordered by size, but will have occasional zero sized nodes as we visit
+   * other mm_nodelist[] entries.
+   */
+
+  for (node = heap->mm_nodelist[ndx].flink;
+       node && node->size < size;
+       node = node->flink);
+#endif
+
+  return node;
+}
@@ -71,7 +71,6 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 {
   FAR struct mm_freenode_s *node;
   void *ret = NULL;
-  int ndx;
 
   /* Handle bad sizes */
 
@@ -80,6 +79,19 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
       return NULL;
     }
 
+#ifdef CONFIG_MM_CHUNKCACHE
+  /* Small allocations may be satisfied from the per-CPU chunk cache without
+   * taking the MM semaphore.
+   */
+
+  ret = mm_cachealloc(heap, size);
+  if (ret != NULL)
+    {
+      minfo("Allocated %p from cache, size %d\n", ret, size);
+      return ret;
+    }
+#endif
+
   /* Adjust the size to account for (1) the size of the allocated node and
    * (2) to make sure that it is an even multiple of our granule size.
    */
@@ -90,33 +102,23 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
   mm_takesemaphore(heap);
 
-  /* Get the location in the node list to start the search. Special case
-   * really big allocations
-   */
+  /* Find a free chunk that satisfies the request */
 
-  if (size >= MM_MAX_CHUNK)
-    {
-      ndx = MM_NNODES-1;
-    }
-  else
-    {
-      /* Convert the request size into a nodelist index */
-
-      ndx = mm_size2ndx(size);
-    }
+  node = mm_findfreechunk(heap, size);
 
-  /* Search for a large enough chunk in the list of nodes. This list is
-   * ordered by size, but will have occasional zero sized nodes as we visit
-   * other mm_nodelist[] entries.
+#ifdef CONFIG_MM_CHUNKCACHE
+  /* If no chunk is large enough, return all cached chunks to the heap and
+   * try again.
    */
 
-  for (node = heap->mm_nodelist[ndx].flink;
-       node && node->size < size;
-       node = node->flink);
+  if (node == NULL && mm_cacheflush(heap) > 0)
+    {
+      node = mm_findfreechunk(heap, size);
+    }
+#endif
 
-  /* If we found a node with non-zero size, then this is one to use. Since
-   * the list is ordered, we know that is must be best fitting chunk
-   * available.
+  /* If we found a node with non-zero size, then this is one to use.  With
+   * the best fit node list, this is the smallest chunk available.
    */
 
   if (node)
@@ -125,16 +127,9 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
       FAR struct mm_freenode_s *next;
       size_t remaining;
 
-      /* Remove the node.  There must be a predecessor, but there may not be
-       * a successor node.
-       */
+      /* Remove the node from the free node list */
 
-      DEBUGASSERT(node->blink);
-      node->blink->flink = node->flink;
-      if (node->flink)
-        {
-          node->flink->blink = node->blink;
-        }
+      mm_delfreechunk(heap, node);
 
       /* Check if we have to split the free node into one of the allocated
        * size and another smaller freenode.  In some cases, the remaining
@@ -39,6 +39,9 @@
 
 #include <nuttx/config.h>
 
+#include <strings.h>
+#include <assert.h>
+
 #include <nuttx/mm/mm.h>
 
 /****************************************************************************
@@ -71,3 +74,47 @@ int mm_size2ndx(size_t size)
 
   return ndx;
 }
+
+/****************************************************************************
+ * Name: mm_size2tlsf
+ *
+ * Description:
+ *    Convert the size to a pair of TLSF first and second level indices.
+ *    The first level index is the power-of-two size class (as returned by
+ *    mm_size2ndx()); the second level index is taken from the
+ *    MM_TLSF_SLBITS bits that follow the most significant bit of the size.
+ *
+ *    All chunks of MM_MAX_CHUNK or larger map to the single list at
+ *    [MM_NNODES-1][0].
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MM_TLSF
+void mm_size2tlsf(size_t size, FAR int *fl, FAR int *sl)
+{
+  int msb;
+
+  DEBUGASSERT(size >= MM_MIN_CHUNK);
+
+  if (size >= MM_MAX_CHUNK)
+    {
+      *fl = MM_NNODES - 1;
+      *sl = 0;
+      return;
+    }
+
+  /* Get the bit number of the most significant bit of the size */
+
+  msb = flsl((long)size) - 1;
+  *fl = msb - MM_MIN_SHIFT;
+
+  if (msb >= MM_TLSF_SLBITS)
+    {
+      *sl = (int)(size >> (msb - MM_TLSF_SLBITS)) & MM_TLSF_SLMASK;
+    }
+  else
+    {
+      *sl = (int)(size << (MM_TLSF_SLBITS - msb)) & MM_TLSF_SLMASK;
+    }
+}
+#endif
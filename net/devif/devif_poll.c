@@ -1,7 +1,8 @@
 /****************************************************************************
  * net/devif/devif_poll.c
  *
- *   Copyright (C) 2007-2010, 2012, 2014, 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2010, 2012, 2014, 2016-2017 Gregory Nutt. All rights
+ *     reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -322,7 +323,10 @@ static int devif_poll_udp_connections(FAR struct net_driver_s *dev,
  * Function: devif_poll_tcp_connections
  *
  * Description:
- *   Poll all UDP connections for available packets to send.
+ *   Poll all TCP connections for available packets to send.  If
+ *   CONFIG_NET_TCP_READYLIST is selected, only the connections in the ready
+ *   list are polled and a connection is removed from the list when it has
+ *   nothing to send.
  *
  * Assumptions:
  *   This function is called from the MAC device driver and may be called
@@ -337,6 +341,43 @@ static inline int devif_poll_tcp_connections(FAR struct net_driver_s *dev,
   FAR struct tcp_conn_s *conn  = NULL;
   int bstop = 0;
 
+#ifdef CONFIG_NET_TCP_READYLIST
+  FAR struct tcp_conn_s *next;
+
+  /* Traverse the TCP connections that may have output */
+
+  conn = tcp_nextready(NULL);
+  while (!bstop && conn != NULL)
+    {
+      /* Perform the TCP TX poll */
+
+      tcp_poll(dev, conn);
+
+      /* If the poll produced nothing, there is nothing more to send until
+       * the next event on the connection.  A connection bound to a
+       * different device must wait for the poll from that device.
+       */
+
+      next = tcp_nextready(conn);
+      if (dev->d_len == 0
+#ifdef CONFIG_NETDEV_MULTINIC
+          && (conn->dev == NULL || conn->dev == dev)
+#endif
+         )
+        {
+          tcp_readyrem(conn);
+        }
+
+      /* Perform any necessary conversions on outgoing packets */
+
+      devif_packet_conversion(dev, DEVIF_TCP);
+
+      /* Call back into the driver */
+
+      bstop = callback(dev);
+      conn  = next;
+    }
+#else
   /* Traverse all of the active TCP connections and perform the poll action */
 
   while (!bstop && (conn = tcp_nextconn(conn)))
@@ -353,6 +394,7 @@ static inline int devif_poll_tcp_connections(FAR struct net_driver_s *dev,
 
       bstop = callback(dev);
     }
+#endif
 
   return bstop;
 }
@@ -389,6 +431,15 @@ static inline int devif_poll_tcp_timer(FAR struct net_driver_s *dev,
 
       tcp_timer(dev, conn, hsec);
 
+      /* A retransmission may be followed by more data.  Make sure that the
+       * connection is polled after the driver sends this packet.
+       */
+
+      if (dev->d_len > 0)
+        {
+          tcp_readyadd(conn);
+        }
+
       /* Perform any necessary conversions on outgoing packets */
 
       devif_packet_conversion(dev, DEVIF_TCP);
@@ -268,15 +268,25 @@ void icmpv6_input(FAR struct net_driver_s *dev)
         /* ICMPv6 echo (i.e., ping) processing. This is simple, we only
          * change the ICMPv6 type from ECHO to ECHO_REPLY and update the
          * ICMPv6 checksum before we return the packet.
+         *
+         * The checksum also covers the addresses in the IPv6 pseudo-header.
+         * Swapping the source and destination addresses does not change
+         * the sum, but the new source address is our address which may
+         * differ from the old destination address (a multicast address,
+         * for example).  Only the type and that address need to be
+         * accounted for.
          */
 
+        icmp->chksum = net_chksum_adjust(icmp->chksum, icmp->destipaddr,
+                                         dev->d_ipv6addr, 8);
+        icmp->chksum = net_chksum_adjust16(icmp->chksum,
+                                           HTONS(ICMPv6_ECHO_REQUEST << 8),
+                                           HTONS(ICMPv6_ECHO_REPLY << 8));
+
         icmp->type = ICMPv6_ECHO_REPLY;
 
         net_ipv6addr_copy(icmp->destipaddr, icmp->srcipaddr);
         net_ipv6addr_copy(icmp->srcipaddr, dev->d_ipv6addr);
-
-        icmp->chksum = 0;
-        icmp->chksum = ~icmpv6_chksum(dev);
       }
       break;
 
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/loal.h
  *
- *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -74,6 +74,16 @@
 #define LOCAL_SYNC_BYTE   0x42     /* Byte in sync sequence */
 #define LOCAL_END_BYTE    0xbd     /* End of sync seqence */
 
+/* Direct connection buffers */
+
+#ifdef CONFIG_NET_LOCAL_DIRECT
+#  ifndef CONFIG_NET_LOCAL_BUFSIZE
+#    define CONFIG_NET_LOCAL_BUFSIZE 1024
+#  endif
+
+#  define LOCAL_BUFFER_NPOLLWAITERS 2
+#endif
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
@@ -107,6 +117,41 @@ enum local_state_s
   LOCAL_STATE_DISCONNECTED     /* Peer disconnected */
 };
 
+#ifdef CONFIG_NET_LOCAL_DIRECT
+/* With CONFIG_NET_LOCAL_DIRECT, each direction of a connection is a ring
+ * buffer shared by the two endpoints, rather than a pair of named FIFOs.
+ * Data is copied directly from the sender's buffer into the ring buffer
+ * and from the ring buffer into the receiver's buffer.  In SOCK_DGRAM
+ * buffers, each message is preceded by its 16-bit length.
+ *
+ * A bound SOCK_DGRAM socket owns the buffer of its incoming messages.
+ * Senders hold a temporary reference while they copy a message into it.
+ *
+ * All fields are protected by the network lock.
+ */
+
+struct local_buffer_s
+{
+  sem_t lb_rdsem;              /* Readers wait here for data */
+  sem_t lb_wrsem;              /* Writers wait here for space */
+  uint16_t lb_head;            /* Index of the next byte to read */
+  uint16_t lb_count;           /* Number of bytes in the buffer */
+  uint16_t lb_crefs;           /* Reference count on the buffer */
+  bool lb_closed;              /* An endpoint has been closed */
+
+#ifdef HAVE_LOCAL_POLL
+  /* Poll structures of threads waiting for the buffer to become readable
+   * (lb_rdfds) or writable (lb_wrfds).
+   */
+
+  struct pollfd *lb_rdfds[LOCAL_BUFFER_NPOLLWAITERS];
+  struct pollfd *lb_wrfds[LOCAL_BUFFER_NPOLLWAITERS];
+#endif
+
+  uint8_t lb_data[CONFIG_NET_LOCAL_BUFSIZE];
+};
+#endif
+
 /* Representation of a local connection.  There are four types of
  * connection structures:
  *
@@ -129,7 +174,9 @@ struct local_conn_s
 {
   /* lc_node supports a doubly linked list: Listening SOCK_STREAM servers
    * will be linked into a list of listeners; SOCK_STREAM clients will be
-   * linked to the lc_waiters and lc_conn lists.
+   * linked to the lc_waiters and lc_conn lists.  With
+   * CONFIG_NET_LOCAL_DIRECT, bound SOCK_DGRAM sockets are linked into a
+   * list of receivers.
    */
 
   dq_entry_t lc_node;          /* Supports a doubly linked list */
@@ -140,8 +187,13 @@ struct local_conn_s
   uint8_t lc_proto;            /* SOCK_STREAM or SOCK_DGRAM */
   uint8_t lc_type;             /* See enum local_type_e */
   uint8_t lc_state;            /* See enum local_state_e */
+#ifdef CONFIG_NET_LOCAL_DIRECT
+  FAR struct local_buffer_s *lc_inbuf;  /* Incoming data (peers, receivers) */
+  FAR struct local_buffer_s *lc_outbuf; /* Outgoing data (peers) */
+#else
   int16_t lc_infd;             /* File descriptor of read-only FIFO (peers) */
   int16_t lc_outfd;            /* File descriptor of write-only FIFO (peers) */
+#endif
   char lc_path[UNIX_PATH_MAX]; /* Path assigned by bind() */
   int32_t lc_instance_id;      /* Connection instance ID for stream
                                 * server<->client connection pair */
@@ -210,6 +262,12 @@ extern "C"
 EXTERN dq_queue_t g_local_listeners;
 #endif
 
+#if defined(CONFIG_NET_LOCAL_DIRECT) && defined(CONFIG_NET_LOCAL_DGRAM)
+/* A list of all bound SOCK_DGRAM connections */
+
+EXTERN dq_queue_t g_local_receivers;
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -401,6 +459,7 @@ ssize_t psock_local_sendto(FAR struct socket *psock, FAR const void *buf,
                            socklen_t tolen);
 #endif
 
+#ifndef CONFIG_NET_LOCAL_DIRECT
 /****************************************************************************
  * Name: local_send_packet
  *
@@ -419,6 +478,7 @@ ssize_t psock_local_sendto(FAR struct socket *psock, FAR const void *buf,
  ****************************************************************************/
 
 int local_send_packet(int fd, FAR const uint8_t *buf, size_t len);
+#endif
 
 /****************************************************************************
  * Function: psock_recvfrom
@@ -452,6 +512,7 @@ ssize_t psock_local_recvfrom(FAR struct socket *psock, FAR void *buf,
                              size_t len, int flags, FAR struct sockaddr *from,
                              FAR socklen_t *fromlen);
 
+#ifndef CONFIG_NET_LOCAL_DIRECT
 /****************************************************************************
  * Name: local_fifo_read
  *
@@ -473,6 +534,7 @@ ssize_t psock_local_recvfrom(FAR struct socket *psock, FAR void *buf,
  ****************************************************************************/
 
 int local_fifo_read(int fd, FAR uint8_t *buf, size_t *len);
+#endif
 
 /****************************************************************************
  * Name: local_getaddr
@@ -494,6 +556,7 @@ int local_fifo_read(int fd, FAR uint8_t *buf, size_t *len);
 int local_getaddr(FAR struct local_conn_s *conn, FAR struct sockaddr *addr,
                   FAR socklen_t *addrlen);
 
+#ifndef CONFIG_NET_LOCAL_DIRECT
 /****************************************************************************
  * Name: local_sync
  *
@@ -632,7 +695,137 @@ int local_open_receiver(FAR struct local_conn_s *conn, bool nonblock);
 int local_open_sender(FAR struct local_conn_s *conn, FAR const char *path,
                       bool nonblock);
 #endif
+#endif /* !CONFIG_NET_LOCAL_DIRECT */
+
+/****************************************************************************
+ * Name: local_buffer_create
+ *
+ * Description:
+ *   Allocate the two buffers of a directly connected pair of sockets and
+ *   attach them to 'conn'.  The peer attaches the same buffers with
+ *   local_buffer_share().
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_DIRECT
+int local_buffer_create(FAR struct local_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Name: local_buffer_share
+ *
+ * Description:
+ *   Attach the buffers created for 'peer' to 'conn', crossing the incoming
+ *   and outgoing directions.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_DIRECT
+void local_buffer_share(FAR struct local_conn_s *conn,
+                        FAR struct local_conn_s *peer);
+#endif
+
+/****************************************************************************
+ * Name: local_buffer_alloc and local_buffer_release
+ *
+ * Description:
+ *   Allocate a buffer with one reference and release a reference on a
+ *   buffer.  The buffer is freed when the last reference is released.
+ *
+ ****************************************************************************/
 
+#ifdef CONFIG_NET_LOCAL_DIRECT
+FAR struct local_buffer_s *local_buffer_alloc(void);
+void local_buffer_release(FAR struct local_buffer_s *buf);
+#endif
+
+/****************************************************************************
+ * Name: local_buffer_close
+ *
+ * Description:
+ *   Detach the buffers from a connection that is being closed.  Threads
+ *   waiting on the other end of each buffer are awakened:  Readers will
+ *   receive end-of-file after any remaining data and writers will fail
+ *   with EPIPE.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_DIRECT
+void local_buffer_close(FAR struct local_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Name: local_buffer_write
+ *
+ * Description:
+ *   Copy data into a buffer, waiting for space as necessary unless
+ *   'nonblock' is true.  If 'message' is true, the data is a SOCK_DGRAM
+ *   message that is written in its entirety or not at all.
+ *
+ * Returned Value:
+ *   The number of bytes written on success; a negated errno value on
+ *   failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_DIRECT
+ssize_t local_buffer_write(FAR struct local_buffer_s *buf,
+                           FAR const uint8_t *data, size_t len,
+                           bool message, bool nonblock);
+#endif
+
+/****************************************************************************
+ * Name: local_buffer_read
+ *
+ * Description:
+ *   Copy data out of a buffer, waiting for data unless 'nonblock' is true.
+ *   If 'message' is true, one SOCK_DGRAM message is read and any part of
+ *   it that does not fit in 'data' is discarded.
+ *
+ * Returned Value:
+ *   The number of bytes read on success (zero at end-of-file); a negated
+ *   errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_DIRECT
+ssize_t local_buffer_read(FAR struct local_buffer_s *buf, FAR uint8_t *data,
+                          size_t len, bool message, bool nonblock);
+#endif
+
+/****************************************************************************
+ * Name: psock_local_pair
+ *
+ * Description:
+ *   Connect two new, unbound Unix domain sockets to each other.  This
+ *   implements the Unix domain part of socketpair().
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_DIRECT
+int psock_local_pair(FAR struct socket *psock0, FAR struct socket *psock1);
+#endif
+
+/****************************************************************************
+ * Name: local_buffer_pollsetup and local_buffer_pollteardown
+ *
+ * Description:
+ *   Setup and teardown monitoring of events on a directly connected Unix
+ *   domain socket.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_LOCAL_DIRECT) && defined(HAVE_LOCAL_POLL)
+int local_buffer_pollsetup(FAR struct socket *psock, FAR struct pollfd *fds);
+int local_buffer_pollteardown(FAR struct socket *psock,
+                              FAR struct pollfd *fds);
+#endif
 
 /****************************************************************************
  * Name: local_accept_pollnotify
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_accept.c
  *
- *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -172,6 +172,12 @@ int psock_local_accept(FAR struct socket *psock, FAR struct sockaddr *addr,
               conn->lc_path[UNIX_PATH_MAX-1] = '\0';
               conn->lc_instance_id = client->lc_instance_id;
 
+#ifdef CONFIG_NET_LOCAL_DIRECT
+              /* Share the buffers that the client created */
+
+              local_buffer_share(conn, client);
+              ret = OK;
+#else
               /* Open the server-side write-only FIFO.  This should not
                * block.
                */
@@ -183,8 +189,10 @@ int psock_local_accept(FAR struct socket *psock, FAR struct sockaddr *addr,
                    nerr("ERROR: Failed to open write-only FIFOs for %s: %d\n",
                         conn->lc_path, ret);
                 }
+#endif
             }
 
+#ifndef CONFIG_NET_LOCAL_DIRECT
           /* Do we have a connection?  Is the write-side FIFO opened? */
 
           if (ret == OK)
@@ -204,12 +212,15 @@ int psock_local_accept(FAR struct socket *psock, FAR struct sockaddr *addr,
                         conn->lc_path, ret);
                 }
             }
+#endif
 
           /* Do we have a connection?  Are the FIFOs opened? */
 
           if (ret == OK)
             {
+#ifndef CONFIG_NET_LOCAL_DIRECT
               DEBUGASSERT(conn->lc_infd >= 0);
+#endif
 
               /* Return the address family */
 
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_bind.c
  *
- *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -42,12 +42,76 @@
 
 #include <sys/socket.h>
 #include <string.h>
+#include <errno.h>
+#include <queue.h>
 #include <assert.h>
 
 #include <nuttx/net/net.h>
 
 #include "local/local.h"
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: local_bind_receiver
+ *
+ * Description:
+ *   Make a SOCK_DGRAM socket bound to a path name available to senders.
+ *   With CONFIG_NET_LOCAL_DIRECT, the receiver owns the buffer that holds
+ *   its incoming messages.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_LOCAL_DIRECT) && defined(CONFIG_NET_LOCAL_DGRAM)
+static int local_bind_receiver(FAR struct local_conn_s *conn,
+                               FAR const char *path)
+{
+  FAR struct local_conn_s *receiver;
+
+  if (conn->lc_inbuf != NULL)
+    {
+      /* Already bound or connected */
+
+      return -EINVAL;
+    }
+
+  net_lock();
+
+  /* Verify that the address is not already in use */
+
+  for (receiver = (FAR struct local_conn_s *)g_local_receivers.head;
+       receiver;
+       receiver = (FAR struct local_conn_s *)dq_next(&receiver->lc_node))
+    {
+      if (strncmp(receiver->lc_path, path, UNIX_PATH_MAX-1) == 0)
+        {
+          net_unlock();
+          return -EADDRINUSE;
+        }
+    }
+
+  conn->lc_inbuf = local_buffer_alloc();
+  if (conn->lc_inbuf == NULL)
+    {
+      net_unlock();
+      return -ENOMEM;
+    }
+
+  /* Senders look the receiver up by its path, so the path must be in
+   * place before the connection is added to the list.
+   */
+
+  (void)strncpy(conn->lc_path, path, UNIX_PATH_MAX-1);
+  conn->lc_path[UNIX_PATH_MAX-1] = '\0';
+
+  dq_addlast(&conn->lc_node, &g_local_receivers);
+  net_unlock();
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -103,12 +167,28 @@ int psock_local_bind(FAR struct socket *psock,
         {
           /* This is an normal, pathname Unix domain socket */
 
-          conn->lc_type = LOCAL_TYPE_PATHNAME;
-
-          /* Copy the path into the connection structure */
-
-          (void)strncpy(conn->lc_path, unaddr->sun_path, UNIX_PATH_MAX-1);
-          conn->lc_path[UNIX_PATH_MAX-1] = '\0';
+#if defined(CONFIG_NET_LOCAL_DIRECT) && defined(CONFIG_NET_LOCAL_DGRAM)
+          if (psock->s_type == SOCK_DGRAM)
+            {
+              /* This also copies the path into the connection structure */
+
+              int ret = local_bind_receiver(conn, unaddr->sun_path);
+              if (ret < 0)
+                {
+                  return ret;
+                }
+            }
+          else
+#endif
+            {
+              /* Copy the path into the connection structure */
+
+              (void)strncpy(conn->lc_path, unaddr->sun_path,
+                            UNIX_PATH_MAX-1);
+              conn->lc_path[UNIX_PATH_MAX-1] = '\0';
+            }
+
+          conn->lc_type        = LOCAL_TYPE_PATHNAME;
           conn->lc_instance_id = -1;
         }
     }
@@ -0,0 +1,761 @@
+/****************************************************************************
+ * net/local/local_buffer.c
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_LOCAL_DIRECT)
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/net/net.h>
+
+#include "local/local.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef MIN
+#  define MIN(a,b) ((a) < (b) ? (a) : (b))
+#endif
+
+/* SOCK_DGRAM messages are preceded by their length in the buffer */
+
+#define LOCAL_MSGHDR_SIZE sizeof(uint16_t)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: local_buffer_wakeup
+ *
+ * Description:
+ *   Wake up all threads waiting on the read or write semaphore.
+ *
+ ****************************************************************************/
+
+static void local_buffer_wakeup(FAR sem_t *sem)
+{
+  int sval;
+
+  while (sem_getvalue(sem, &sval) == 0 && sval < 0)
+    {
+      sem_post(sem);
+    }
+}
+
+/****************************************************************************
+ * Name: local_buffer_pollnotify
+ *
+ * Description:
+ *   Report events to the poll structures waiting on one side of a buffer.
+ *   POLLHUP and POLLERR are always reported.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_LOCAL_POLL
+static void local_buffer_pollnotify(FAR struct pollfd **fdlist,
+                                    pollevent_t eventset)
+{
+  int i;
+
+  for (i = 0; i < LOCAL_BUFFER_NPOLLWAITERS; i++)
+    {
+      FAR struct pollfd *fds = fdlist[i];
+      if (fds)
+        {
+          fds->revents |= (fds->events | POLLHUP | POLLERR) & eventset;
+          if (fds->revents != 0)
+            {
+              ninfo("Report events: %02x\n", fds->revents);
+              poll_notify(fds);
+            }
+        }
+    }
+}
+#else
+#  define local_buffer_pollnotify(f,e)
+#endif
+
+/****************************************************************************
+ * Name: local_buffer_copyin
+ *
+ * Description:
+ *   Add data at the tail of the buffer.  The caller has verified that there
+ *   is space for 'len' bytes.  The ring may wrap so that the copy is done
+ *   in at most two pieces.
+ *
+ ****************************************************************************/
+
+static void local_buffer_copyin(FAR struct local_buffer_s *buf,
+                                FAR const uint8_t *data, size_t len)
+{
+  size_t tail;
+  size_t ncopy;
+
+  DEBUGASSERT(buf->lb_count + len <= CONFIG_NET_LOCAL_BUFSIZE);
+
+  tail = buf->lb_head + buf->lb_count;
+  if (tail >= CONFIG_NET_LOCAL_BUFSIZE)
+    {
+      tail -= CONFIG_NET_LOCAL_BUFSIZE;
+    }
+
+  ncopy = MIN(len, CONFIG_NET_LOCAL_BUFSIZE - tail);
+  memcpy(&buf->lb_data[tail], data, ncopy);
+  memcpy(buf->lb_data, data + ncopy, len - ncopy);
+
+  buf->lb_count += len;
+}
+
+/****************************************************************************
+ * Name: local_buffer_copyout
+ *
+ * Description:
+ *   Remove data from the head of the buffer.  The caller has verified that
+ *   the buffer holds at least 'len' bytes.  If 'data' is NULL, the data is
+ *   discarded.
+ *
+ ****************************************************************************/
+
+static void local_buffer_copyout(FAR struct local_buffer_s *buf,
+                                 FAR uint8_t *data, size_t len)
+{
+  size_t head;
+  size_t ncopy;
+
+  DEBUGASSERT(len <= buf->lb_count);
+
+  head  = buf->lb_head;
+  ncopy = MIN(len, CONFIG_NET_LOCAL_BUFSIZE - head);
+
+  if (data != NULL)
+    {
+      memcpy(data, &buf->lb_data[head], ncopy);
+      memcpy(data + ncopy, buf->lb_data, len - ncopy);
+    }
+
+  head += len;
+  if (head >= CONFIG_NET_LOCAL_BUFSIZE)
+    {
+      head -= CONFIG_NET_LOCAL_BUFSIZE;
+    }
+
+  buf->lb_head   = head;
+  buf->lb_count -= len;
+}
+
+/****************************************************************************
+ * Name: local_buffer_detach
+ *
+ * Description:
+ *   Mark one buffer closed, wake up any threads waiting on either side, and
+ *   release this end's reference to the buffer.
+ *
+ ****************************************************************************/
+
+static void local_buffer_detach(FAR struct local_buffer_s *buf)
+{
+  buf->lb_closed = true;
+
+  local_buffer_wakeup(&buf->lb_rdsem);
+  local_buffer_wakeup(&buf->lb_wrsem);
+
+#ifdef HAVE_LOCAL_POLL
+  local_buffer_pollnotify(buf->lb_rdfds, POLLIN | POLLHUP);
+  local_buffer_pollnotify(buf->lb_wrfds, POLLERR);
+#endif
+
+  local_buffer_release(buf);
+}
+
+/****************************************************************************
+ * Name: local_buffer_pollslot
+ *
+ * Description:
+ *   Find the slot in a list of poll waiters that holds 'fds', or an empty
+ *   slot if 'fds' is NULL.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_LOCAL_POLL
+static FAR struct pollfd **local_buffer_pollslot(FAR struct pollfd **fdlist,
+                                                 FAR struct pollfd *fds)
+{
+  int i;
+
+  for (i = 0; i < LOCAL_BUFFER_NPOLLWAITERS; i++)
+    {
+      if (fdlist[i] == fds)
+        {
+          return &fdlist[i];
+        }
+    }
+
+  return NULL;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: local_buffer_alloc
+ *
+ * Description:
+ *   Allocate a buffer with one reference.
+ *
+ ****************************************************************************/
+
+FAR struct local_buffer_s *local_buffer_alloc(void)
+{
+  FAR struct local_buffer_s *buf;
+
+  buf = (FAR struct local_buffer_s *)
+    kmm_zalloc(sizeof(struct local_buffer_s));
+
+  if (buf != NULL)
+    {
+      /* These semaphores are used for signaling and, hence, should not
+       * have priority inheritance enabled.
+       */
+
+      sem_init(&buf->lb_rdsem, 0, 0);
+      sem_setprotocol(&buf->lb_rdsem, SEM_PRIO_NONE);
+
+      sem_init(&buf->lb_wrsem, 0, 0);
+      sem_setprotocol(&buf->lb_wrsem, SEM_PRIO_NONE);
+
+      buf->lb_crefs = 1;
+    }
+
+  return buf;
+}
+
+/****************************************************************************
+ * Name: local_buffer_release
+ *
+ * Description:
+ *   Release a reference to a buffer and free it when the last reference is
+ *   released.
+ *
+ ****************************************************************************/
+
+void local_buffer_release(FAR struct local_buffer_s *buf)
+{
+  net_lock();
+
+  DEBUGASSERT(buf->lb_crefs > 0);
+  if (--buf->lb_crefs == 0)
+    {
+      sem_destroy(&buf->lb_rdsem);
+      sem_destroy(&buf->lb_wrsem);
+      kmm_free(buf);
+    }
+
+  net_unlock();
+}
+
+/****************************************************************************
+ * Name: local_buffer_create
+ *
+ * Description:
+ *   Allocate the two buffers of a directly connected pair of sockets and
+ *   attach them to 'conn'.
+ *
+ ****************************************************************************/
+
+int local_buffer_create(FAR struct local_conn_s *conn)
+{
+  DEBUGASSERT(conn->lc_inbuf == NULL && conn->lc_outbuf == NULL);
+
+  conn->lc_inbuf = local_buffer_alloc();
+  if (conn->lc_inbuf == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  conn->lc_outbuf = local_buffer_alloc();
+  if (conn->lc_outbuf == NULL)
+    {
+      local_buffer_release(conn->lc_inbuf);
+      conn->lc_inbuf = NULL;
+      return -ENOMEM;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: local_buffer_share
+ *
+ * Description:
+ *   Attach the buffers created for 'peer' to 'conn', crossing the incoming
+ *   and outgoing directions.
+ *
+ ****************************************************************************/
+
+void local_buffer_share(FAR struct local_conn_s *conn,
+                        FAR struct local_conn_s *peer)
+{
+  DEBUGASSERT(peer->lc_inbuf != NULL && peer->lc_outbuf != NULL);
+
+  net_lock();
+  conn->lc_inbuf  = peer->lc_outbuf;
+  conn->lc_outbuf = peer->lc_inbuf;
+
+  conn->lc_inbuf->lb_crefs++;
+  conn->lc_outbuf->lb_crefs++;
+  net_unlock();
+}
+
+/****************************************************************************
+ * Name: local_buffer_close
+ *
+ * Description:
+ *   Detach the buffers from a connection that is being closed.
+ *
+ ****************************************************************************/
+
+void local_buffer_close(FAR struct local_conn_s *conn)
+{
+  net_lock();
+
+  if (conn->lc_inbuf != NULL)
+    {
+      local_buffer_detach(conn->lc_inbuf);
+      conn->lc_inbuf = NULL;
+    }
+
+  if (conn->lc_outbuf != NULL)
+    {
+      local_buffer_detach(conn->lc_outbuf);
+      conn->lc_outbuf = NULL;
+    }
+
+  net_unlock();
+}
+
+/****************************************************************************
+ * Name: local_buffer_write
+ *
+ * Description:
+ *   Copy data into a buffer, waiting for space as necessary unless
+ *   'nonblock' is true.
+ *
+ ****************************************************************************/
+
+ssize_t local_buffer_write(FAR struct local_buffer_s *buf,
+                           FAR const uint8_t *data, size_t len,
+                           bool message, bool nonblock)
+{
+  size_t nwritten = 0;
+  size_t space;
+  ssize_t ret;
+
+  DEBUGASSERT(buf != NULL && (data != NULL || len == 0));
+
+  if (message)
+    {
+      /* The message must fit in the buffer along with its length */
+
+      if (len + LOCAL_MSGHDR_SIZE > CONFIG_NET_LOCAL_BUFSIZE)
+        {
+          return -EMSGSIZE;
+        }
+    }
+  else if (len == 0)
+    {
+      return 0;
+    }
+
+  net_lock();
+  for (; ; )
+    {
+      /* Writing to a buffer whose reader is gone is an error */
+
+      if (buf->lb_closed)
+        {
+          ret = nwritten > 0 ? (ssize_t)nwritten : -EPIPE;
+          break;
+        }
+
+      space = CONFIG_NET_LOCAL_BUFSIZE - buf->lb_count;
+      if (message)
+        {
+          /* A message is written in its entirety or not at all */
+
+          if (space >= len + LOCAL_MSGHDR_SIZE)
+            {
+              uint16_t msglen = (uint16_t)len;
+
+              local_buffer_copyin(buf, (FAR const uint8_t *)&msglen,
+                                  LOCAL_MSGHDR_SIZE);
+              local_buffer_copyin(buf, data, len);
+
+              local_buffer_wakeup(&buf->lb_rdsem);
+              local_buffer_pollnotify(buf->lb_rdfds, POLLIN);
+
+              ret = len;
+              break;
+            }
+        }
+      else if (space > 0)
+        {
+          /* Copy as much of the stream data as will fit and let the
+           * reader have it.
+           */
+
+          size_t ncopy = MIN(space, len - nwritten);
+
+          local_buffer_copyin(buf, data + nwritten, ncopy);
+          nwritten += ncopy;
+
+          local_buffer_wakeup(&buf->lb_rdsem);
+          local_buffer_pollnotify(buf->lb_rdfds, POLLIN);
+
+          if (nwritten >= len)
+            {
+              ret = nwritten;
+              break;
+            }
+
+          continue;
+        }
+
+      /* The buffer is full.  Return what has been written so far or wait
+       * for the reader to make space.
+       */
+
+      if (nonblock)
+        {
+          ret = nwritten > 0 ? (ssize_t)nwritten : -EAGAIN;
+          break;
+        }
+
+      ret = net_lockedwait(&buf->lb_wrsem);
+      if (ret < 0)
+        {
+          int errcode = get_errno();
+          ret = nwritten > 0 ? (ssize_t)nwritten : -errcode;
+          break;
+        }
+    }
+
+  net_unlock();
+  return ret;
+}
+
+/****************************************************************************
+ * Name: local_buffer_read
+ *
+ * Description:
+ *   Copy data out of a buffer, waiting for data unless 'nonblock' is true.
+ *
+ ****************************************************************************/
+
+ssize_t local_buffer_read(FAR struct local_buffer_s *buf, FAR uint8_t *data,
+                          size_t len, bool message, bool nonblock)
+{
+  ssize_t ret;
+
+  DEBUGASSERT(buf != NULL && (data != NULL || len == 0));
+
+  net_lock();
+  for (; ; )
+    {
+      if (buf->lb_count > 0)
+        {
+          if (message)
+            {
+              uint16_t msglen;
+              size_t ncopy;
+
+              /* Take one message.  Any part of it that does not fit in the
+               * user buffer is discarded.
+               */
+
+              local_buffer_copyout(buf, (FAR uint8_t *)&msglen,
+                                   LOCAL_MSGHDR_SIZE);
+              DEBUGASSERT(msglen <= buf->lb_count);
+
+              ncopy = MIN(msglen, len);
+              local_buffer_copyout(buf, data, ncopy);
+              local_buffer_copyout(buf, NULL, msglen - ncopy);
+              ret = ncopy;
+            }
+          else
+            {
+              ret = MIN(buf->lb_count, len);
+              local_buffer_copyout(buf, data, ret);
+            }
+
+          local_buffer_wakeup(&buf->lb_wrsem);
+          local_buffer_pollnotify(buf->lb_wrfds, POLLOUT);
+          break;
+        }
+
+      /* The buffer is empty.  If the writer is gone, this is end-of-file */
+
+      if (buf->lb_closed)
+        {
+          ret = 0;
+          break;
+        }
+
+      if (nonblock)
+        {
+          ret = -EAGAIN;
+          break;
+        }
+
+      ret = net_lockedwait(&buf->lb_rdsem);
+      if (ret < 0)
+        {
+          ret = -get_errno();
+          break;
+        }
+    }
+
+  net_unlock();
+  return ret;
+}
+
+/****************************************************************************
+ * Name: psock_local_pair
+ *
+ * Description:
+ *   Connect two new, unbound Unix domain sockets to each other.
+ *
+ ****************************************************************************/
+
+int psock_local_pair(FAR struct socket *psock0, FAR struct socket *psock1)
+{
+  FAR struct local_conn_s *conn0;
+  FAR struct local_conn_s *conn1;
+  int ret;
+
+  DEBUGASSERT(psock0 && psock0->s_conn && psock1 && psock1->s_conn);
+  DEBUGASSERT(psock0->s_type == psock1->s_type);
+
+  conn0 = (FAR struct local_conn_s *)psock0->s_conn;
+  conn1 = (FAR struct local_conn_s *)psock1->s_conn;
+
+  ret = local_buffer_create(conn0);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  local_buffer_share(conn1, conn0);
+
+  conn0->lc_proto = psock0->s_type;
+  conn0->lc_type  = LOCAL_TYPE_UNNAMED;
+  conn0->lc_state = LOCAL_STATE_CONNECTED;
+
+  conn1->lc_proto = psock1->s_type;
+  conn1->lc_type  = LOCAL_TYPE_UNNAMED;
+  conn1->lc_state = LOCAL_STATE_CONNECTED;
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: local_buffer_pollsetup
+ *
+ * Description:
+ *   Setup to monitor events on a directly connected Unix domain socket.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_LOCAL_POLL
+int local_buffer_pollsetup(FAR struct socket *psock, FAR struct pollfd *fds)
+{
+  FAR struct local_conn_s *conn = (FAR struct local_conn_s *)psock->s_conn;
+  FAR struct local_buffer_s *inbuf;
+  FAR struct local_buffer_s *outbuf;
+  FAR struct pollfd **rdslot = NULL;
+  FAR struct pollfd **wrslot = NULL;
+  pollevent_t eventset = 0;
+
+  net_lock();
+
+  inbuf  = conn->lc_inbuf;
+  outbuf = conn->lc_outbuf;
+
+  /* Find slots for the poll structure in the buffers */
+
+  if (inbuf != NULL)
+    {
+      rdslot = local_buffer_pollslot(inbuf->lb_rdfds, NULL);
+    }
+
+  if (outbuf != NULL)
+    {
+      wrslot = local_buffer_pollslot(outbuf->lb_wrfds, NULL);
+    }
+
+  if ((inbuf != NULL && rdslot == NULL) || (outbuf != NULL && wrslot == NULL))
+    {
+      net_unlock();
+      return -EBUSY;
+    }
+
+  if (rdslot != NULL)
+    {
+      *rdslot = fds;
+    }
+
+  if (wrslot != NULL)
+    {
+      *wrslot = fds;
+    }
+
+  fds->priv = conn;
+
+  /* Report the events that are already pending */
+
+  if (inbuf != NULL)
+    {
+      if (inbuf->lb_count > 0)
+        {
+          eventset |= POLLIN;
+        }
+
+      if (inbuf->lb_closed)
+        {
+          eventset |= (POLLIN | POLLHUP);
+        }
+    }
+
+  if (outbuf != NULL)
+    {
+      if (outbuf->lb_closed)
+        {
+          eventset |= POLLERR;
+        }
+      else if (outbuf->lb_count + (psock->s_type == SOCK_DGRAM ?
+               LOCAL_MSGHDR_SIZE : 0) < CONFIG_NET_LOCAL_BUFSIZE)
+        {
+          eventset |= POLLOUT;
+        }
+    }
+  else if (psock->s_type == SOCK_DGRAM)
+    {
+      /* An unconnected datagram socket can always try to send */
+
+      eventset |= POLLOUT;
+    }
+
+  if (inbuf == NULL && outbuf == NULL && psock->s_type != SOCK_DGRAM)
+    {
+      /* A stream socket that is not connected */
+
+      eventset |= POLLERR;
+    }
+
+  if (eventset != 0)
+    {
+      fds->revents |= (fds->events | POLLHUP | POLLERR) & eventset;
+      if (fds->revents != 0)
+        {
+          poll_notify(fds);
+        }
+    }
+
+  net_unlock();
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: local_buffer_pollteardown
+ *
+ * Description:
+ *   Teardown monitoring of events on a directly connected Unix domain
+ *   socket.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_LOCAL_POLL
+int local_buffer_pollteardown(FAR struct socket *psock,
+                              FAR struct pollfd *fds)
+{
+  FAR struct local_conn_s *conn = (FAR struct local_conn_s *)psock->s_conn;
+  FAR struct pollfd **slot;
+
+  net_lock();
+
+  if (conn->lc_inbuf != NULL)
+    {
+      slot = local_buffer_pollslot(conn->lc_inbuf->lb_rdfds, fds);
+      if (slot != NULL)
+        {
+          *slot = NULL;
+        }
+    }
+
+  if (conn->lc_outbuf != NULL)
+    {
+      slot = local_buffer_pollslot(conn->lc_outbuf->lb_wrfds, fds);
+      if (slot != NULL)
+        {
+          *slot = NULL;
+        }
+    }
+
+  fds->priv = NULL;
+  net_unlock();
+  return OK;
+}
+#endif
+
+#endif /* CONFIG_NET && CONFIG_NET_LOCAL_DIRECT */
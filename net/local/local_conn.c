@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_conn.c
  *
- *   Copyright (C) 2015-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -52,6 +52,16 @@
 
 #include "local/local.h"
 
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_LOCAL_DIRECT) && defined(CONFIG_NET_LOCAL_DGRAM)
+/* A list of all bound SOCK_DGRAM connections */
+
+dq_queue_t g_local_receivers;
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -70,6 +80,10 @@ void local_initialize(void)
 #ifdef CONFIG_NET_LOCAL_STREAM
   dq_init(&g_local_listeners);
 #endif
+
+#if defined(CONFIG_NET_LOCAL_DIRECT) && defined(CONFIG_NET_LOCAL_DGRAM)
+  dq_init(&g_local_receivers);
+#endif
 }
 
 /****************************************************************************
@@ -89,10 +103,12 @@ FAR struct local_conn_s *local_alloc(void)
 
   if (conn)
     {
+#ifndef CONFIG_NET_LOCAL_DIRECT
       /* Initialize non-zero elements the new connection structure */
 
       conn->lc_infd  = -1;
       conn->lc_outfd = -1;
+#endif
 
 #ifdef CONFIG_NET_LOCAL_STREAM
       /* This semaphore is used for signaling and, hence, should not have
@@ -124,6 +140,15 @@ void local_free(FAR struct local_conn_s *conn)
 {
   DEBUGASSERT(conn != NULL);
 
+#ifdef CONFIG_NET_LOCAL_DIRECT
+  /* Detach from the connection buffers, waking up the peer */
+
+  local_buffer_close(conn);
+
+#ifdef CONFIG_NET_LOCAL_STREAM
+  sem_destroy(&conn->lc_waitsem);
+#endif
+#else
   /* Make sure that the read-only FIFO is closed */
 
   if (conn->lc_infd >= 0)
@@ -146,6 +171,7 @@ void local_free(FAR struct local_conn_s *conn)
   local_release_fifos(conn);
   sem_destroy(&conn->lc_waitsem);
 #endif
+#endif /* CONFIG_NET_LOCAL_DIRECT */
 
   /* And free the connection structure */
 
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_connnect.c
  *
- *   Copyright (C) 2015-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -148,6 +148,22 @@ static int inline local_stream_connect(FAR struct local_conn_s *client,
   server->u.server.lc_pending++;
   DEBUGASSERT(server->u.server.lc_pending != 0);
 
+#ifdef CONFIG_NET_LOCAL_DIRECT
+  /* Create the buffers needed for the connection.  The server side will
+   * share them when it accepts the connection.
+   */
+
+  ret = local_buffer_create(client);
+  if (ret < 0)
+    {
+      nerr("ERROR: Failed to create buffers for %s: %d\n",
+           client->lc_path, ret);
+
+      server->u.server.lc_pending--;
+      net_unlock();
+      return ret;
+    }
+#else
   /* Create the FIFOs needed for the connection */
 
   ret = local_create_fifos(client);
@@ -175,6 +191,7 @@ static int inline local_stream_connect(FAR struct local_conn_s *client,
     }
 
   DEBUGASSERT(client->lc_outfd >= 0);
+#endif /* CONFIG_NET_LOCAL_DIRECT */
 
   /* Add ourself to the list of waiting connections and notify the server. */
 
@@ -196,6 +213,20 @@ static int inline local_stream_connect(FAR struct local_conn_s *client,
 
   /* Did we successfully connect? */
 
+#ifdef CONFIG_NET_LOCAL_DIRECT
+  if (ret < 0)
+    {
+      nerr("ERROR: Failed to connect: %d\n", ret);
+      local_buffer_close(client);
+      client->lc_state = LOCAL_STATE_BOUND;
+      return ret;
+    }
+
+  /* Yes.. the server side now shares the buffers */
+
+  client->lc_state = LOCAL_STATE_CONNECTED;
+  return OK;
+#else
   if (ret < 0)
     {
       nerr("ERROR: Failed to connect: %d\n", ret);
@@ -224,6 +255,7 @@ errout_with_fifos:
   (void)local_release_fifos(client);
   client->lc_state = LOCAL_STATE_BOUND;
   return ret;
+#endif /* CONFIG_NET_LOCAL_DIRECT */
 }
 
 /****************************************************************************
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_netpoll.c
  *
- *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -152,7 +152,7 @@ void local_accept_pollnotify(FAR struct local_conn_s *conn,
           if (fds->revents != 0)
             {
               ninfo("Report events: %02x\n", fds->revents);
-              sem_post(fds->sem);
+              poll_notify(fds);
             }
         }
     }
@@ -178,10 +178,29 @@ void local_accept_pollnotify(FAR struct local_conn_s *conn,
 int local_pollsetup(FAR struct socket *psock, FAR struct pollfd *fds)
 {
   FAR struct local_conn_s *conn;
+#ifndef CONFIG_NET_LOCAL_DIRECT
   int ret = -ENOSYS;
+#endif
 
   conn = (FAR struct local_conn_s *)psock->s_conn;
 
+#ifdef CONFIG_NET_LOCAL_DIRECT
+#ifdef CONFIG_NET_LOCAL_STREAM
+  if (conn->lc_state == LOCAL_STATE_LISTENING &&
+      conn->lc_type  == LOCAL_TYPE_PATHNAME)
+    {
+      return local_accept_pollsetup(conn, fds, true);
+    }
+#else
+  UNUSED(conn);
+#endif
+
+  /* Stream and datagram sockets are both monitored through their
+   * connection buffers.
+   */
+
+  return local_buffer_pollsetup(psock, fds);
+#else
   if (conn->lc_proto == SOCK_DGRAM)
     {
       return ret;
@@ -294,8 +313,9 @@ int local_pollsetup(FAR struct socket *psock, FAR struct pollfd *fds)
 
 pollerr:
   fds->revents |= POLLERR;
-  sem_post(fds->sem);
+  poll_notify(fds);
   return OK;
+#endif /* CONFIG_NET_LOCAL_DIRECT */
 }
 
 /****************************************************************************
@@ -317,11 +337,26 @@ pollerr:
 int local_pollteardown(FAR struct socket *psock, FAR struct pollfd *fds)
 {
   FAR struct local_conn_s *conn;
+#ifndef CONFIG_NET_LOCAL_DIRECT
   int status = OK;
   int ret = -ENOSYS;
+#endif
 
   conn = (FAR struct local_conn_s *)psock->s_conn;
 
+#ifdef CONFIG_NET_LOCAL_DIRECT
+#ifdef CONFIG_NET_LOCAL_STREAM
+  if (conn->lc_state == LOCAL_STATE_LISTENING &&
+      conn->lc_type  == LOCAL_TYPE_PATHNAME)
+    {
+      return local_accept_pollsetup(conn, fds, false);
+    }
+#else
+  UNUSED(conn);
+#endif
+
+  return local_buffer_pollteardown(psock, fds);
+#else
   if (conn->lc_proto == SOCK_DGRAM)
     {
       return ret;
@@ -401,6 +436,7 @@ int local_pollteardown(FAR struct socket *psock, FAR struct pollfd *fds)
 #endif
 
   return status;
+#endif /* CONFIG_NET_LOCAL_DIRECT */
 }
 
 #endif /* HAVE_LOCAL_POLL */
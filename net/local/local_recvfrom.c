@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_recvfrom.c
  *
- *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -64,6 +64,137 @@
  * Private Functions
  ****************************************************************************/
 
+#ifdef CONFIG_NET_LOCAL_DIRECT
+/****************************************************************************
+ * Function: psock_stream_recvfrom
+ *
+ * Description:
+ *   psock_stream_recvfrom() receives data from a directly connected local
+ *   stream socket.
+ *
+ * Input Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   buf      Buffer to receive data
+ *   len      Length of buffer
+ *   flags    Receive flags
+ *   from     Address of source (may be NULL)
+ *   fromlen  The length of the address structure
+ *
+ * Returned Value:
+ *   On success, returns the number of characters received.  If no data is
+ *   available to be received and the peer has performed an orderly shutdown,
+ *   zero is returned.  Otherwise, a negated errno value is returned.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_STREAM
+static inline ssize_t
+psock_stream_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
+                      int flags, FAR struct sockaddr *from,
+                      FAR socklen_t *fromlen)
+{
+  FAR struct local_conn_s *conn = (FAR struct local_conn_s *)psock->s_conn;
+  ssize_t nread;
+  int ret;
+
+  /* Verify that this is a connected peer socket */
+
+  if (conn->lc_state != LOCAL_STATE_CONNECTED || conn->lc_inbuf == NULL)
+    {
+      nerr("ERROR: not connected\n");
+      return -ENOTCONN;
+    }
+
+  /* Copy the data directly out of the incoming buffer */
+
+  nread = local_buffer_read(conn->lc_inbuf, (FAR uint8_t *)buf, len, false,
+                            _SS_ISNONBLOCK(psock->s_flags));
+  if (nread < 0)
+    {
+      return nread;
+    }
+
+  /* Return the address family */
+
+  if (from)
+    {
+      ret = local_getaddr(conn, from, fromlen);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  return nread;
+}
+#endif /* CONFIG_NET_LOCAL_STREAM */
+
+/****************************************************************************
+ * Function: psock_dgram_recvfrom
+ *
+ * Description:
+ *   psock_dgram_recvfrom() receives one message from a bound local datagram
+ *   socket or from one end of a datagram socketpair().
+ *
+ * Input Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   buf      Buffer to receive data
+ *   len      Length of buffer
+ *   flags    Receive flags
+ *   from     Address of source (may be NULL)
+ *   fromlen  The length of the address structure
+ *
+ * Returned Value:
+ *   On success, returns the number of characters received.  Otherwise, a
+ *   negated errno value is returned.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_DGRAM
+static inline ssize_t
+psock_dgram_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
+                     int flags, FAR struct sockaddr *from,
+                     FAR socklen_t *fromlen)
+{
+  FAR struct local_conn_s *conn = (FAR struct local_conn_s *)psock->s_conn;
+  ssize_t nread;
+  int ret;
+
+  /* Only a bound socket or a socketpair() end has an incoming buffer */
+
+  if (conn->lc_inbuf == NULL)
+    {
+      nerr("ERROR: Not bound\n");
+      return -ENOTCONN;
+    }
+
+  /* Take the next message.  Any part that does not fit in 'buf' is
+   * discarded.
+   */
+
+  nread = local_buffer_read(conn->lc_inbuf, (FAR uint8_t *)buf, len, true,
+                            _SS_ISNONBLOCK(psock->s_flags));
+  if (nread < 0)
+    {
+      return nread;
+    }
+
+  /* Return the address family */
+
+  if (from)
+    {
+      ret = local_getaddr(conn, from, fromlen);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  return nread;
+}
+#endif /* CONFIG_NET_LOCAL_DGRAM */
+
+#else /* CONFIG_NET_LOCAL_DIRECT */
 /****************************************************************************
  * Name: psock_fifo_read
  *
@@ -380,7 +511,8 @@ errout_with_halfduplex:
   (void)local_release_halfduplex(conn);
   return ret;
 }
-#endif /* CONFIG_NET_LOCAL_STREAM */
+#endif /* CONFIG_NET_LOCAL_DGRAM */
+#endif /* CONFIG_NET_LOCAL_DIRECT */
 
 /****************************************************************************
  * Public Functions
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_recvpacket.c
  *
- *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -54,6 +54,7 @@
  * Public Functions
  ****************************************************************************/
 
+#ifndef CONFIG_NET_LOCAL_DIRECT
 /****************************************************************************
  * Name: local_fifo_read
  *
@@ -189,6 +190,8 @@ int local_sync(int fd)
   return ret < 0 ? ret : pktlen;
 }
 
+#endif /* !CONFIG_NET_LOCAL_DIRECT */
+
 /****************************************************************************
  * Name: local_getaddr
  *
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_release.c
  *
- *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -82,12 +82,15 @@ int local_release(FAR struct local_conn_s *conn)
 
   DEBUGASSERT(conn->lc_state != LOCAL_STATE_ACCEPT);
 
-  /* If the socket is connected (SOCK_STREAM client), then disconnect it */
+  /* If the socket is connected (SOCK_STREAM client or one end of a
+   * socketpair()), then disconnect it
+   */
 
   if (conn->lc_state == LOCAL_STATE_CONNECTED ||
       conn->lc_state == LOCAL_STATE_DISCONNECTED)
     {
-      DEBUGASSERT(conn->lc_proto == SOCK_STREAM);
+      DEBUGASSERT(conn->lc_proto == SOCK_STREAM ||
+                  conn->lc_type == LOCAL_TYPE_UNNAMED);
 
       /* Just free the connection structure */
     }
@@ -118,6 +121,18 @@ int local_release(FAR struct local_conn_s *conn)
     }
 #endif /* CONFIG_NET_LOCAL_STREAM */
 
+#if defined(CONFIG_NET_LOCAL_DIRECT) && defined(CONFIG_NET_LOCAL_DGRAM)
+  /* Is the socket a bound SOCK_DGRAM receiver? */
+
+  if (conn->lc_proto == SOCK_DGRAM && conn->lc_state == LOCAL_STATE_BOUND &&
+      conn->lc_inbuf != NULL)
+    {
+      /* Remove the receiver from the list of receivers */
+
+      dq_rem(&conn->lc_node, &g_local_receivers);
+    }
+#endif
+
   /* For the remaining states (LOCAL_STATE_UNBOUND and LOCAL_STATE_UNBOUND),
    * we simply free the connection structure.
    */
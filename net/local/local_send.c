@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_send.c
  *
- *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -47,6 +47,7 @@
 
 #include <nuttx/net/net.h>
 
+#include "socket/socket.h"
 #include "local/local.h"
 
 /****************************************************************************
@@ -76,11 +77,28 @@ ssize_t psock_local_send(FAR struct socket *psock, FAR const void *buf,
                          size_t len, int flags)
 {
   FAR struct local_conn_s *peer;
+#ifndef CONFIG_NET_LOCAL_DIRECT
   int ret;
+#endif
 
   DEBUGASSERT(psock && psock->s_conn && buf);
   peer = (FAR struct local_conn_s *)psock->s_conn;
 
+#ifdef CONFIG_NET_LOCAL_DIRECT
+  /* Verify that this is a connected peer socket */
+
+  if (peer->lc_state != LOCAL_STATE_CONNECTED ||
+      peer->lc_outbuf == NULL)
+    {
+      nerr("ERROR: not connected\n");
+      return -ENOTCONN;
+    }
+
+  /* Copy the data directly into the peer's incoming buffer */
+
+  return local_buffer_write(peer->lc_outbuf, (FAR const uint8_t *)buf, len,
+                            false, _SS_ISNONBLOCK(psock->s_flags));
+#else
   /* Verify that this is a connected peer socket and that it has opened the
    * outgoing FIFO for write-only access.
    */
@@ -99,6 +117,7 @@ ssize_t psock_local_send(FAR struct socket *psock, FAR const void *buf,
   /* If the send was successful, then the full packet will have been sent */
 
   return ret < 0 ? ret : len;
+#endif
 }
 
 #endif /* CONFIG_NET && CONFIG_NET_LOCAL_STREAM */
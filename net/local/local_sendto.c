@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/local/local_sendto.c
  *
- *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -43,6 +43,7 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <unistd.h>
+#include <string.h>
 #include <errno.h>
 #include <assert.h>
 #include <debug.h>
@@ -52,6 +53,40 @@
 #include "socket/socket.h"
 #include "local/local.h"
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: local_find_receiver
+ *
+ * Description:
+ *   Find the bound SOCK_DGRAM connection with the matching path.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_DIRECT
+static FAR struct local_conn_s *local_find_receiver(FAR const char *path)
+{
+  FAR struct local_conn_s *conn;
+
+  for (conn = (FAR struct local_conn_s *)g_local_receivers.head;
+       conn;
+       conn = (FAR struct local_conn_s *)dq_next(&conn->lc_node))
+    {
+      if (strncmp(conn->lc_path, path, UNIX_PATH_MAX-1) == 0)
+        {
+          return conn;
+        }
+    }
+
+  return NULL;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -87,6 +122,64 @@ ssize_t psock_local_sendto(FAR struct socket *psock, FAR const void *buf,
 {
   FAR struct local_conn_s *conn = (FAR struct local_conn_s *)psock->s_conn;
   FAR struct sockaddr_un *unaddr = (FAR struct sockaddr_un *)to;
+#ifdef CONFIG_NET_LOCAL_DIRECT
+  FAR struct local_conn_s *receiver;
+  FAR struct local_buffer_s *outbuf;
+  bool nonblock = _SS_ISNONBLOCK(psock->s_flags);
+  ssize_t nsent;
+
+  DEBUGASSERT(buf != NULL || len == 0);
+
+  /* One end of a socketpair() sends to the other end.  The destination
+   * address, if any, is ignored.
+   */
+
+  if (conn->lc_state == LOCAL_STATE_CONNECTED)
+    {
+      DEBUGASSERT(conn->lc_outbuf != NULL);
+      return local_buffer_write(conn->lc_outbuf, (FAR const uint8_t *)buf,
+                                len, true, nonblock);
+    }
+
+  /* Otherwise, a destination is required.  At present, only standard
+   * pathname type address are support
+   */
+
+  if (to == NULL)
+    {
+      return -EDESTADDRREQ;
+    }
+
+  if (tolen < sizeof(sa_family_t) + 2)
+    {
+     /* EFAULT - An invalid user space address was specified for a parameter */
+
+     return -EFAULT;
+    }
+
+  /* Find the receiver and hold a reference to its buffer while the message
+   * is copied into it.
+   */
+
+  net_lock();
+  receiver = local_find_receiver(unaddr->sun_path);
+  if (receiver == NULL)
+    {
+      net_unlock();
+      nerr("ERROR: No receiver bound to %s\n", unaddr->sun_path);
+      return -ECONNREFUSED;
+    }
+
+  outbuf = receiver->lc_inbuf;
+  outbuf->lb_crefs++;
+
+  nsent = local_buffer_write(outbuf, (FAR const uint8_t *)buf, len, true,
+                             nonblock);
+
+  local_buffer_release(outbuf);
+  net_unlock();
+  return nsent;
+#else
   ssize_t nsent;
   int ret;
 
@@ -172,6 +265,7 @@ errout_with_halfduplex:
 
   (void)local_release_halfduplex(conn);
   return nsent;
+#endif /* CONFIG_NET_LOCAL_DIRECT */
 }
 
 #endif /* CONFIG_NET && CONFIG_NET_LOCAL_DGRAM */
@@ -0,0 +1,365 @@
+/****************************************************************************
+ * net/netdev/netdev_pktq.c
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NETDEV_PKTQUEUE)
+
+#include <stdint.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/spinlock.h>
+#include <nuttx/net/netdev.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* A full (load and store) memory barrier that orders the accesses to a
+ * descriptor and the ring indices as seen by the other side of the ring.
+ * SP_DMB() cannot be used:  It is not provided by all SMP architectures
+ * and it may order only stores.  Without SMP, only the compiler must be
+ * kept from reordering the accesses.
+ */
+
+#if defined(CONFIG_SMP) && defined(__GNUC__)
+#  define PKTQ_MB() __sync_synchronize()
+#elif defined(__GNUC__)
+#  define PKTQ_MB() __asm__ __volatile__ ("" : : : "memory")
+#elif defined(CONFIG_SMP)
+#  define PKTQ_MB() SP_DMB()
+#else
+#  define PKTQ_MB()
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: netdev_pktq_init
+ *
+ * Description:
+ *   Initialize an empty packet queue.  The caller must have set the pd_buf
+ *   field of each descriptor to a distinct packet buffer.
+ *
+ * Parameters:
+ *   pktq  - The packet queue to be initialized
+ *   desc  - An array of ndesc packet descriptors
+ *   ndesc - The number of descriptors.  This must be a power of two.
+ *
+ * Returned Value:
+ *   OK on success; -EINVAL if ndesc is not a power of two.
+ *
+ ****************************************************************************/
+
+int netdev_pktq_init(FAR struct netdev_pktq_s *pktq,
+                     FAR struct netdev_pktdesc_s *desc, uint16_t ndesc)
+{
+  DEBUGASSERT(pktq != NULL && desc != NULL);
+
+  if (ndesc == 0 || (ndesc & (ndesc - 1)) != 0)
+    {
+      nerr("ERROR: Bad queue size: %u\n", ndesc);
+      return -EINVAL;
+    }
+
+  pktq->pq_desc = desc;
+  pktq->pq_size = ndesc;
+  pktq->pq_head = 0;
+  pktq->pq_tail = 0;
+  return OK;
+}
+
+/****************************************************************************
+ * Function: netdev_pktq_head
+ *
+ * Description:
+ *   Return the descriptor at the head of a packet queue.  This is the
+ *   oldest packet in the queue.
+ *
+ * Parameters:
+ *   pktq - The packet queue
+ *
+ * Returned Value:
+ *   The head descriptor
+ *
+ * Assumptions:
+ *   Called by the consumer side of the queue after it has verified that
+ *   the queue is not empty.
+ *
+ ****************************************************************************/
+
+FAR struct netdev_pktdesc_s *
+netdev_pktq_head(FAR struct netdev_pktq_s *pktq)
+{
+  /* Make sure that the descriptor is read after the tail index that
+   * showed the queue not to be empty.
+   */
+
+  PKTQ_MB();
+  return &pktq->pq_desc[pktq->pq_head & (pktq->pq_size - 1)];
+}
+
+/****************************************************************************
+ * Function: netdev_pktq_tail
+ *
+ * Description:
+ *   Return the descriptor at the tail of a packet queue.  This descriptor
+ *   receives the next packet that is added to the queue.
+ *
+ * Parameters:
+ *   pktq - The packet queue
+ *
+ * Returned Value:
+ *   The tail descriptor
+ *
+ * Assumptions:
+ *   Called by the producer side of the queue after it has verified that
+ *   the queue is not full.
+ *
+ ****************************************************************************/
+
+FAR struct netdev_pktdesc_s *
+netdev_pktq_tail(FAR struct netdev_pktq_s *pktq)
+{
+  /* Make sure that the descriptor is written after the head index that
+   * showed the consumer to be done with it.
+   */
+
+  PKTQ_MB();
+  return &pktq->pq_desc[pktq->pq_tail & (pktq->pq_size - 1)];
+}
+
+/****************************************************************************
+ * Function: netdev_pktq_commit
+ *
+ * Description:
+ *   Add the descriptor at the tail of a packet queue to the queue.  The
+ *   producer must have filled in the descriptor before calling this.
+ *
+ * Parameters:
+ *   pktq - The packet queue
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called by the producer side of the queue.  The queue is not full.
+ *
+ ****************************************************************************/
+
+void netdev_pktq_commit(FAR struct netdev_pktq_s *pktq)
+{
+  DEBUGASSERT(!netdev_pktq_full(pktq));
+
+  PKTQ_MB();
+  pktq->pq_tail++;
+}
+
+/****************************************************************************
+ * Function: netdev_pktq_remove
+ *
+ * Description:
+ *   Remove the descriptor at the head of a packet queue from the queue.  The
+ *   consumer must be done with the descriptor and its buffer.
+ *
+ * Parameters:
+ *   pktq - The packet queue
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called by the consumer side of the queue.  The queue is not empty.
+ *
+ ****************************************************************************/
+
+void netdev_pktq_remove(FAR struct netdev_pktq_s *pktq)
+{
+  DEBUGASSERT(!netdev_pktq_empty(pktq));
+
+  PKTQ_MB();
+  pktq->pq_head++;
+}
+
+/****************************************************************************
+ * Function: netdev_pktq_put
+ *
+ * Description:
+ *   Add the packet in d_buf to the tail of a packet queue.  d_buf is
+ *   exchanged with the free buffer of the tail descriptor and d_len is
+ *   cleared so that d_buf may immediately be used for the next packet.
+ *
+ * Parameters:
+ *   dev  - The network device holding the packet
+ *   pktq - The packet queue
+ *
+ * Returned Value:
+ *   OK on success; -ENOSPC if the queue is full.  The packet is left in
+ *   d_buf if it could not be queued.
+ *
+ * Assumptions:
+ *   Called by the producer side of the queue.
+ *
+ ****************************************************************************/
+
+int netdev_pktq_put(FAR struct net_driver_s *dev,
+                    FAR struct netdev_pktq_s *pktq)
+{
+  FAR struct netdev_pktdesc_s *desc;
+  FAR uint8_t *buf;
+
+  if (netdev_pktq_full(pktq))
+    {
+      return -ENOSPC;
+    }
+
+  desc         = netdev_pktq_tail(pktq);
+  buf          = desc->pd_buf;
+  desc->pd_buf = dev->d_buf;
+  desc->pd_len = dev->d_len;
+  dev->d_buf   = buf;
+  dev->d_len   = 0;
+
+  netdev_pktq_commit(pktq);
+  return OK;
+}
+
+/****************************************************************************
+ * Function: netdev_pktq_get
+ *
+ * Description:
+ *   Remove the packet at the head of a packet queue and make it the packet
+ *   in d_buf.  The buffer previously in d_buf becomes the free buffer of
+ *   the head descriptor; any packet in d_buf is lost.
+ *
+ * Parameters:
+ *   dev  - The network device to receive the packet
+ *   pktq - The packet queue
+ *
+ * Returned Value:
+ *   OK on success; -ENODATA if the queue is empty.
+ *
+ * Assumptions:
+ *   Called by the consumer side of the queue.
+ *
+ ****************************************************************************/
+
+int netdev_pktq_get(FAR struct net_driver_s *dev,
+                    FAR struct netdev_pktq_s *pktq)
+{
+  FAR struct netdev_pktdesc_s *desc;
+  FAR uint8_t *buf;
+
+  if (netdev_pktq_empty(pktq))
+    {
+      return -ENODATA;
+    }
+
+  desc         = netdev_pktq_head(pktq);
+  buf          = desc->pd_buf;
+  dev->d_len   = desc->pd_len;
+  desc->pd_buf = dev->d_buf;
+  desc->pd_len = 0;
+  dev->d_buf   = buf;
+
+  netdev_pktq_remove(pktq);
+  return OK;
+}
+
+/****************************************************************************
+ * Function: netdev_rxqueue_process
+ *
+ * Description:
+ *   Dispatch a batch of received packets.  Packets are removed from the
+ *   head of the RX queue one at a time and passed to the driver's input
+ *   function in d_buf.  If the input function leaves a response in d_buf
+ *   (d_len > 0), the response is added to the TX queue.
+ *
+ *   Processing stops when the budget is exhausted, when the RX queue is
+ *   empty, or when the TX queue has no room for a response.  The driver
+ *   should schedule more work if packets remain in the RX queue and should
+ *   start transmission if packets were added to the TX queue.
+ *
+ * Parameters:
+ *   dev    - The network device
+ *   rxq    - The queue of received packets
+ *   txq    - The queue of packets to be transmitted
+ *   input  - The driver function that dispatches the packet in d_buf,
+ *            normally by calling ipv4_input(), ipv6_input() or arp_arpin()
+ *            and performing any link layer output on the response.
+ *   budget - The maximum number of packets to dispatch
+ *
+ * Returned Value:
+ *   The number of packets dispatched.
+ *
+ * Assumptions:
+ *   Called with the network locked by the consumer side of the RX queue
+ *   and the producer side of the TX queue.
+ *
+ ****************************************************************************/
+
+int netdev_rxqueue_process(FAR struct net_driver_s *dev,
+                           FAR struct netdev_pktq_s *rxq,
+                           FAR struct netdev_pktq_s *txq,
+                           devif_poll_callback_t input, int budget)
+{
+  int npackets = 0;
+
+  DEBUGASSERT(dev != NULL && rxq != NULL && txq != NULL && input != NULL);
+
+  while (npackets < budget && !netdev_pktq_empty(rxq) &&
+         !netdev_pktq_full(txq))
+    {
+      (void)netdev_pktq_get(dev, rxq);
+      (void)input(dev);
+      npackets++;
+
+      if (dev->d_len > 0)
+        {
+          (void)netdev_pktq_put(dev, txq);
+        }
+    }
+
+  return npackets;
+}
+
+#endif /* CONFIG_NET && CONFIG_NETDEV_PKTQUEUE */
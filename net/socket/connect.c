@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/socket/connect.c
  *
- *   Copyright (C) 2007-2012, 2015-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2012, 2015-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -304,6 +304,15 @@ static uint16_t psock_connect_interrupt(FAR struct net_driver_s *dev,
         }
 #endif /* CONFIG_NET_IPv6 */
 
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+      /* Leave room for the timestamps option in every segment */
+
+      if ((pstate->tc_conn->tcpoptflags & TCP_OPTF_TS) != 0)
+        {
+          pstate->tc_conn->mss -= TCP_OPT_TS_ALIGNED;
+        }
+#endif
+
 #ifdef CONFIG_NETDEV_MULTINIC
       /* We now have to filter all outgoing transfers so that they use only
        * the MSS of this device.
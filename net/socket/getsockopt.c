@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/socket/getsockopt.c
  *
- *   Copyright (C) 2007-2009, 2012, 2014 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2012, 2014, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -43,11 +43,13 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <netinet/in.h>
 #include <debug.h>
 #include <assert.h>
 #include <errno.h>
 
 #include "socket/socket.h"
+#include "tcp/tcp.h"
 #include "usrsock/usrsock.h"
 #include "utils/utils.h"
 
@@ -101,6 +103,30 @@ int psock_getsockopt(FAR struct socket *psock, int level, int option,
 {
   int errcode;
 
+#ifdef CONFIG_NET_TCP_CC
+  /* Options at the IPPROTO_TCP level are handled by the TCP layer */
+
+  if (level == IPPROTO_TCP && psock->s_type == SOCK_STREAM)
+    {
+      int ret;
+
+      if (!value || !value_len)
+        {
+          errcode = EINVAL;
+          goto errout;
+        }
+
+      ret = tcp_getsockopt(psock, option, value, value_len);
+      if (ret < 0)
+        {
+          errcode = -ret;
+          goto errout;
+        }
+
+      return OK;
+    }
+#endif
+
   /* Verify that the socket option if valid (but might not be supported ) */
 
   if (!_SO_GETVALID(option) || !value || !value_len)
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/socket/net_close.c
  *
- *   Copyright (C) 2007-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -51,6 +51,7 @@
 #include <arch/irq.h>
 
 #include <nuttx/semaphore.h>
+#include <nuttx/fs/fs.h>
 #include <nuttx/net/net.h>
 #include <nuttx/net/netdev.h>
 #include <nuttx/net/tcp.h>
@@ -279,6 +280,10 @@ end_wait:
 static inline void netclose_txnotify(FAR struct socket *psock,
                                      FAR struct tcp_conn_s *conn)
 {
+  /* Make sure that the next poll includes this connection */
+
+  tcp_readyadd(conn);
+
 #ifdef CONFIG_NET_IPv4
 #ifdef CONFIG_NET_IPv6
   /* If both IPv4 and IPv6 support are enabled, then we will need to select
@@ -525,6 +530,15 @@ int psock_close(FAR struct socket *psock)
       goto errout;
     }
 
+  /* Remove the socket from any epoll interest lists if the socket will
+   * not persist after this.
+   */
+
+  if (psock->s_crefs <= 1)
+    {
+      epoll_release(psock);
+    }
+
   /* We perform the close operation only if this is the last count on
    * the socket. (actually, I think the socket crefs only takes the values
    * 0 and 1 right now).
@@ -185,7 +185,7 @@ ssize_t psock_send(FAR struct socket *psock, FAR const void *buf, size_t len,
         break;
 #endif /* CONFIG_NET_TCP || CONFIG_NET_LOCAL_STREAM */
 
-#ifdef CONFIG_NET_UDP
+#if defined(CONFIG_NET_UDP) || defined(CONFIG_NET_LOCAL_DGRAM)
       case SOCK_DGRAM:
         {
 #ifdef CONFIG_NET_LOCAL_DGRAM
@@ -194,8 +194,13 @@ ssize_t psock_send(FAR struct socket *psock, FAR const void *buf, size_t len,
 #endif
             {
               /* Local UDP packet send */
+
+#ifdef CONFIG_NET_LOCAL_DIRECT
+              ret = psock_local_sendto(psock, buf, len, flags, NULL, 0);
+#else
 #warning Missing logic
               ret = -ENOSYS;
+#endif
             }
 #endif /* CONFIG_NET_LOCAL_DGRAM */
 
@@ -228,7 +233,7 @@ ssize_t psock_send(FAR struct socket *psock, FAR const void *buf, size_t len,
 #endif /* CONFIG_NET_UDP */
         }
         break;
-#endif /* CONFIG_NET_UDP */
+#endif /* CONFIG_NET_UDP || CONFIG_NET_LOCAL_DGRAM */
 
 #ifdef CONFIG_NET_USRSOCK
       case SOCK_USRSOCK_TYPE:
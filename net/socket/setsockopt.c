@@ -1,8 +1,8 @@
 /****************************************************************************
  * net/socket/setsockopt.c
  *
- *   Copyright (C) 2007, 2008, 2011-2012, 2014-2015 Gregory Nutt. All rights
- *     reserved.
+ *   Copyright (C) 2007, 2008, 2011-2012, 2014-2015, 2017 Gregory Nutt.
+ *     All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -44,6 +44,7 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <netinet/in.h>
 #include <errno.h>
 #include <debug.h>
 #include <assert.h>
@@ -52,6 +53,7 @@
 #include <nuttx/net/net.h>
 
 #include "socket/socket.h"
+#include "tcp/tcp.h"
 #include "usrsock/usrsock.h"
 #include "utils/utils.h"
 
@@ -110,6 +112,30 @@ int psock_setsockopt(FAR struct socket *psock, int level, int option,
 {
   int errcode;
 
+#ifdef CONFIG_NET_TCP_CC
+  /* Options at the IPPROTO_TCP level are handled by the TCP layer */
+
+  if (level == IPPROTO_TCP && psock->s_type == SOCK_STREAM)
+    {
+      int ret;
+
+      if (!value)
+        {
+          errcode = EINVAL;
+          goto errout;
+        }
+
+      ret = tcp_setsockopt(psock, option, value, value_len);
+      if (ret < 0)
+        {
+          errcode = -ret;
+          goto errout;
+        }
+
+      return OK;
+    }
+#endif
+
   /* Verify that the socket option if valid (but might not be supported ) */
 
   if (!_SO_SETVALID(option) || !value)
@@ -0,0 +1,171 @@
+/****************************************************************************
+ * net/socket/socketpair.c
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_LOCAL_DIRECT)
+
+#include <sys/socket.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/net/net.h>
+
+#include "socket/socket.h"
+#include "local/local.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: socketpair
+ *
+ * Description:
+ *   socketpair() creates an unnamed pair of connected sockets and returns
+ *   their descriptors in sv[0] and sv[1].  The two sockets are
+ *   indistinguishable.  Only the PF_LOCAL domain is supported.
+ *
+ * Parameters:
+ *   domain   (see sys/socket.h)
+ *   type     (see sys/socket.h)
+ *   protocol (see sys/socket.h)
+ *   sv       The location to return the two socket descriptors
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -1 on error with errno set appropriately.
+ *
+ *   EAFNOSUPPORT
+ *     The specified address family is not supported on this machine.
+ *   EFAULT
+ *     The address sv does not specify valid memory.
+ *   EMFILE
+ *     Process file table overflow.
+ *   ENFILE
+ *     The system limit on the total number of open files has been reached.
+ *   ENOBUFS or ENOMEM
+ *     Insufficient memory is available.
+ *   EPROTONOSUPPORT
+ *     The specified protocol is not supported within this domain.
+ *
+ ****************************************************************************/
+
+int socketpair(int domain, int type, int protocol, int sv[2])
+{
+  FAR struct socket *psock[2];
+  int sockfd[2];
+  int errcode;
+  int ret;
+  int i;
+
+  if (sv == NULL)
+    {
+      errcode = EFAULT;
+      goto errout;
+    }
+
+  if (domain != PF_LOCAL)
+    {
+      errcode = EAFNOSUPPORT;
+      goto errout;
+    }
+
+  /* Allocate and initialize the two sockets */
+
+  for (i = 0; i < 2; i++)
+    {
+      sockfd[i] = sockfd_allocate(0);
+      if (sockfd[i] < 0)
+        {
+          errcode = ENFILE;
+          goto errout_with_sockets;
+        }
+
+      psock[i] = sockfd_socket(sockfd[i]);
+      if (psock[i] == NULL)
+        {
+          errcode = ENOSYS; /* should not happen */
+          goto errout_with_sockfd;
+        }
+
+      ret = psock_socket(domain, type, protocol, psock[i]);
+      if (ret < 0)
+        {
+          /* The errno value has already been set by psock_socket() */
+
+          errcode = get_errno();
+          goto errout_with_sockfd;
+        }
+    }
+
+  /* Connect the two sockets to each other */
+
+  ret = psock_local_pair(psock[0], psock[1]);
+  if (ret < 0)
+    {
+      errcode = -ret;
+      goto errout_with_sockets;
+    }
+
+  psock[0]->s_flags |= (_SF_BOUND | _SF_CONNECTED);
+  psock[1]->s_flags |= (_SF_BOUND | _SF_CONNECTED);
+
+  sv[0] = sockfd[0];
+  sv[1] = sockfd[1];
+  return OK;
+
+errout_with_sockfd:
+  /* Release the socket descriptor that was not initialized */
+
+  sockfd_release(sockfd[i]);
+
+errout_with_sockets:
+  /* Close the sockets that were fully initialized */
+
+  while (--i >= 0)
+    {
+      (void)psock_close(psock[i]);
+    }
+
+errout:
+  set_errno(errcode);
+  return ERROR;
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_LOCAL_DIRECT */
@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/tcp/tcp.h
  *
- *   Copyright (C) 2014-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -43,8 +43,11 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <queue.h>
 
+#include <nuttx/clock.h>
 #include <nuttx/net/iob.h>
 #include <nuttx/net/ip.h>
 
@@ -126,10 +129,135 @@
 #endif
 #endif
 
+/* Sequence number comparisons that are valid across wrap-around */
+
+#define TCP_SEQ_LT(a,b)     ((int32_t)((a) - (b)) < 0)
+#define TCP_SEQ_LE(a,b)     ((int32_t)((a) - (b)) <= 0)
+#define TCP_SEQ_GT(a,b)     ((int32_t)((a) - (b)) > 0)
+#define TCP_SEQ_GE(a,b)     ((int32_t)((a) - (b)) >= 0)
+
+/* Optional TCP features that are negotiated in the SYN segments */
+
+#if defined(CONFIG_NET_TCP_WINDOW_SCALE) || \
+    defined(CONFIG_NET_TCP_TIMESTAMPS) || defined(CONFIG_NET_TCP_SACK)
+#  define HAVE_TCP_OPTIONS  1
+
+/* Values for the tcpoptflags field of struct tcp_conn_s */
+
+#  define TCP_OPTF_WS       (1 << 0) /* Window scaling is in use */
+#  define TCP_OPTF_TS       (1 << 1) /* Timestamps are in use */
+#  define TCP_OPTF_SACK     (1 << 2) /* Selective acknowledgments are in use */
+
+/* Size of the timestamps option as sent, padded with two NOPs */
+
+#  define TCP_OPT_TS_ALIGNED 12
+#endif
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+/* The timestamp clock (RFC 7323, section 5.4) ticks in milliseconds */
+
+#  define TCP_TSCLOCK()     ((uint32_t)TICK2MSEC(clock_systimer()))
+#endif
+
+#ifdef CONFIG_NET_TCP_SACK
+/* The size of the SACK scoreboard.  This is also the maximum number of
+ * blocks that fit into the 40 bytes of TCP options.
+ */
+
+#  define TCP_SACK_NBLOCKS  4
+#endif
+
+#ifdef CONFIG_NET_TCP_CC
+/* Values for the flags field of struct tcp_cc_s */
+
+#  define TCP_CC_TIMING       (1 << 0) /* A segment is being timed for RTT */
+#  define TCP_CC_RTTVALID     (1 << 1) /* srtt and rttvar hold a measurement */
+#  define TCP_CC_FASTREXMIT   (1 << 2) /* Retransmit the first un-ACKed segment */
+#  define TCP_CC_EPOCH        (1 << 3) /* CUBIC: A congestion epoch is running */
+#endif
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
 
+#ifdef CONFIG_NET_TCP_CC
+/* Congestion control.  The common logic in tcp_cc.c handles slow start,
+ * fast retransmit and NewReno fast recovery.  A congestion control
+ * algorithm provides the growth of the congestion window during congestion
+ * avoidance and the reduction of the congestion window on a loss.
+ *
+ *   name       - The name used with the TCP_CONGESTION socket option
+ *   init       - Initialize the algorithm-specific state of a connection
+ *   cong_avoid - Grow the congestion window after 'acked' new bytes were
+ *                ACKed while not in slow start
+ *   ssthresh   - Return the new slow start threshold after a loss
+ */
+
+struct tcp_conn_s;        /* Forward reference */
+
+struct tcp_cc_ops_s
+{
+  FAR const char *name;
+  CODE void (*init)(FAR struct tcp_conn_s *conn);
+  CODE void (*cong_avoid)(FAR struct tcp_conn_s *conn, uint32_t acked);
+  CODE uint32_t (*ssthresh)(FAR struct tcp_conn_s *conn);
+};
+
+/* Per-connection congestion control state.  Windows and sequence numbers
+ * are in bytes; RTT estimates are in microseconds.
+ */
+
+struct tcp_cc_s
+{
+  FAR const struct tcp_cc_ops_s *ops; /* Congestion control algorithm */
+  uint32_t cwnd;          /* Congestion window */
+  uint32_t ssthresh;      /* Slow start threshold */
+  uint32_t lastack;       /* Highest ACK number received */
+  uint32_t sndmax;        /* Highest sequence number sent plus one */
+  uint32_t recover;       /* sndmax when recovery was entered (RFC 6582) */
+  uint32_t rttseq;        /* ACK of this sequence number ends RTT timing */
+  systime_t rttstart;     /* Time when the timed segment was sent */
+  uint32_t srtt;          /* Smoothed round trip time */
+  uint32_t rttvar;        /* Round trip time variation */
+  uint32_t nrto;          /* Number of retransmission timeouts */
+  uint32_t nfastrexmit;   /* Number of fast retransmissions */
+  uint8_t  state;         /* TCP_CA_OPEN, TCP_CA_RECOVERY or TCP_CA_LOSS */
+  uint8_t  dupacks;       /* Number of consecutive duplicate ACKs */
+  uint8_t  flags;         /* See TCP_CC_* definitions */
+#ifdef CONFIG_NET_TCP_CC_CUBIC
+  uint32_t wmax;          /* Window before the last reduction */
+  uint32_t origin;        /* Window at the plateau of the cubic function */
+  uint32_t west;          /* Estimated window of standard TCP */
+  uint32_t k;             /* Time to reach the plateau (msec) */
+  systime_t epoch;        /* Start of the current congestion epoch */
+#endif
+};
+#endif
+
+#ifdef CONFIG_NET_TCP_SACK
+/* One block of selectively ACKed data:  The sequence numbers of the first
+ * byte and of the byte following the block.
+ */
+
+struct tcp_sack_s
+{
+  uint32_t left;          /* First sequence number of the block */
+  uint32_t right;         /* Sequence number following the block */
+};
+#endif
+
+#ifdef CONFIG_NET_TCP_OOSEQ
+/* One block of out-of-order data:  The sequence number of its first byte
+ * and the I/O buffer chain that holds the data.
+ */
+
+struct tcp_ooseq_s
+{
+  uint32_t seqno;         /* Sequence number of the first byte */
+  FAR struct iob_s *iob;  /* The data */
+};
+#endif
+
 /* Representation of a TCP connection.
  *
  * The tcp_conn_s structure is used for identifying a connection. All
@@ -147,6 +275,14 @@ struct tcp_hdr_s;         /* Forward reference */
 struct tcp_conn_s
 {
   dq_entry_t node;        /* Implements a doubly linked list */
+#ifdef CONFIG_NET_TCP_CONNHASH
+  FAR struct tcp_conn_s *hnext; /* Next in the connection hash chain */
+  FAR struct tcp_conn_s *pnext; /* Next in the local port hash chain */
+#endif
+#ifdef CONFIG_NET_TCP_READYLIST
+  dq_entry_t rnode;       /* Supports the list of ready connections */
+  bool     ready;         /* True: The connection is in the ready list */
+#endif
   union ip_binding_u u;   /* IP address binding */
   uint8_t  rcvseq[4];     /* The sequence number that we expect to
                            * receive next */
@@ -168,7 +304,11 @@ struct tcp_conn_s
   uint16_t rport;         /* The remoteTCP port, in network byte order */
   uint16_t mss;           /* Current maximum segment size for the
                            * connection */
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+  uint32_t winsize;       /* Current window size of the connection */
+#else
   uint16_t winsize;       /* Current window size of the connection */
+#endif
 #ifdef CONFIG_NET_TCP_WRITE_BUFFERS
   uint32_t unacked;       /* Number bytes sent but not yet ACKed */
 #else
@@ -194,6 +334,24 @@ struct tcp_conn_s
   struct iob_queue_s readahead;   /* Read-ahead buffering */
 #endif
 
+#ifdef CONFIG_NET_TCP_OOSEQ
+  /* Out-of-order receive queue
+   *
+   *   ooseq     - Blocks of data received above rcvseq, in sequence order.
+   *               Blocks never overlap or touch.
+   *   nooseq    - The number of blocks in ooseq
+   *   ooseqlast - The sequence number of the most recent out-of-order
+   *               segment.  The block holding it is reported first in the
+   *               SACK option.
+   */
+
+  struct tcp_ooseq_s ooseq[CONFIG_NET_TCP_OOSEQ_NSEGS];
+  uint8_t  nooseq;
+#ifdef CONFIG_NET_TCP_SACK
+  uint32_t ooseqlast;
+#endif
+#endif
+
 #ifdef CONFIG_NET_TCP_WRITE_BUFFERS
   /* Write buffering
    *
@@ -213,6 +371,37 @@ struct tcp_conn_s
                            * segment (next greater sndseq) */
 #endif
 
+#ifdef CONFIG_NET_TCP_CC
+  struct tcp_cc_s cc;     /* Congestion control state */
+#endif
+
+#ifdef HAVE_TCP_OPTIONS
+  /* TCP options negotiated in the SYN segments
+   *
+   *   tcpoptflags - The options in use, see TCP_OPTF_* definitions
+   *   snd_wscale  - The peer's window scale shift count
+   *   ts_recent   - The timestamp to echo to the peer
+   *   sack        - The SACK scoreboard:  Blocks of data above the ACK
+   *                 number that the peer has received, in sequence order
+   *   nsack       - The number of blocks in the scoreboard
+   *   rexmitnxt   - The next sequence number to retransmit during fast
+   *                 recovery
+   */
+
+  uint8_t  tcpoptflags;
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+  uint8_t  snd_wscale;
+#endif
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  uint32_t ts_recent;
+#endif
+#ifdef CONFIG_NET_TCP_SACK
+  struct tcp_sack_s sack[TCP_SACK_NBLOCKS];
+  uint8_t  nsack;
+  uint32_t rexmitnxt;
+#endif
+#endif
+
 #ifdef CONFIG_NET_TCPBACKLOG
   /* Listen backlog support
    *
@@ -412,6 +601,27 @@ FAR struct tcp_conn_s *tcp_active(FAR struct net_driver_s *dev,
 
 FAR struct tcp_conn_s *tcp_nextconn(FAR struct tcp_conn_s *conn);
 
+/****************************************************************************
+ * Name: tcp_readyadd, tcp_readyrem, and tcp_nextready
+ *
+ * Description:
+ *   Add a connection that may have output to the list of ready
+ *   connections, remove a connection from the list, and traverse the list.
+ *   devif_poll() polls only the connections in the list.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_READYLIST
+void tcp_readyadd(FAR struct tcp_conn_s *conn);
+void tcp_readyrem(FAR struct tcp_conn_s *conn);
+FAR struct tcp_conn_s *tcp_nextready(FAR struct tcp_conn_s *conn);
+#else
+#  define tcp_readyadd(conn)
+#endif
+
 /****************************************************************************
  * Function: tcp_local_ipv4_device
  *
@@ -1264,6 +1474,349 @@ void tcp_wrbuffer_dump(FAR const char *msg, FAR struct tcp_wrbuffer_s *wrb,
 #endif
 #endif /* CONFIG_NET_TCP_WRITE_BUFFERS */
 
+/****************************************************************************
+ * Function: tcp_cc_init
+ *
+ * Description:
+ *   Initialize the congestion control state of a connection that has just
+ *   entered the ESTABLISHED state.  The algorithm selected with
+ *   TCP_CONGESTION is retained; otherwise the default algorithm is used.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_CC
+void tcp_cc_init(FAR struct tcp_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Function: tcp_cc_ack
+ *
+ * Description:
+ *   Update the congestion control state on receipt of an ACK.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest
+ *   ackno  - The ACK number of the incoming segment
+ *   dupack - True if the segment could be a duplicate ACK:  It carries no
+ *            data, no SYN or FIN and it does not update the window.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_CC
+void tcp_cc_ack(FAR struct tcp_conn_s *conn, uint32_t ackno, bool dupack);
+#endif
+
+/****************************************************************************
+ * Function: tcp_cc_timeout
+ *
+ * Description:
+ *   Update the congestion control state on a retransmission timeout.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_CC
+void tcp_cc_timeout(FAR struct tcp_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Function: tcp_cc_rttsample
+ *
+ * Description:
+ *   Update the smoothed RTT and RTT variation with a new measurement of
+ *   'rtt' microseconds (RFC 6298, section 2).
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_CC
+void tcp_cc_rttsample(FAR struct tcp_conn_s *conn, uint32_t rtt);
+#endif
+
+/****************************************************************************
+ * Function: tcp_cc_sent
+ *
+ * Description:
+ *   Called when 'len' bytes starting at sequence number 'seqno' are about
+ *   to be sent.  Starts RTT timing if the segment holds new data and no
+ *   other segment is being timed.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_CC
+void tcp_cc_sent(FAR struct tcp_conn_s *conn, uint32_t seqno, uint32_t len);
+#endif
+
+/****************************************************************************
+ * Function: tcp_cc_sndwnd
+ *
+ * Description:
+ *   Return the number of bytes that may be sent now:  The smaller of the
+ *   congestion window and the receiver's window, less the data in flight.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_CC
+uint32_t tcp_cc_sndwnd(FAR struct tcp_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Function: tcp_cc_select
+ *
+ * Description:
+ *   Select the congestion control algorithm for a connection by name.
+ *
+ * Returned Value:
+ *   OK on success; -ENOENT if there is no algorithm with that name.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_CC
+int tcp_cc_select(FAR struct tcp_conn_s *conn, FAR const char *name);
+#endif
+
+/****************************************************************************
+ * Function: tcp_getsockopt
+ *
+ * Description:
+ *   Get the value of a socket option at the IPPROTO_TCP level.  See
+ *   <netinet/tcp.h> for the supported options.
+ *
+ * Returned Value:
+ *   OK on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_CC
+int tcp_getsockopt(FAR struct socket *psock, int option,
+                   FAR void *value, FAR socklen_t *value_len);
+#endif
+
+/****************************************************************************
+ * Function: tcp_setsockopt
+ *
+ * Description:
+ *   Set the value of a socket option at the IPPROTO_TCP level.  See
+ *   <netinet/tcp.h> for the supported options.
+ *
+ * Returned Value:
+ *   OK on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_CC
+int tcp_setsockopt(FAR struct socket *psock, int option,
+                   FAR const void *value, socklen_t value_len);
+#endif
+
+/****************************************************************************
+ * Function: tcp_sack_reset
+ *
+ * Description:
+ *   Discard the SACK scoreboard of a connection.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_SACK
+void tcp_sack_reset(FAR struct tcp_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Function: tcp_sack_update
+ *
+ * Description:
+ *   Update the SACK scoreboard on receipt of an ACK:  Forget the data that
+ *   is now covered by the ACK number and merge in the SACK blocks of the
+ *   incoming segment.
+ *
+ * Input Parameters:
+ *   conn    - The TCP connection of interest
+ *   ackno   - The ACK number of the incoming segment
+ *   blocks  - The SACK blocks of the incoming segment
+ *   nblocks - The number of SACK blocks
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_SACK
+void tcp_sack_update(FAR struct tcp_conn_s *conn, uint32_t ackno,
+                     FAR const struct tcp_sack_s *blocks, int nblocks);
+#endif
+
+/****************************************************************************
+ * Function: tcp_sack_skip
+ *
+ * Description:
+ *   Return the number of bytes starting at sequence number 'seqno' that the
+ *   peer has already received.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_SACK
+uint32_t tcp_sack_skip(FAR struct tcp_conn_s *conn, uint32_t seqno);
+#endif
+
+/****************************************************************************
+ * Function: tcp_sack_hole
+ *
+ * Description:
+ *   Return the number of bytes from sequence number 'seqno' up to the next
+ *   block that the peer has received, or UINT32_MAX if there is none.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_SACK
+uint32_t tcp_sack_hole(FAR struct tcp_conn_s *conn, uint32_t seqno);
+#endif
+
+/****************************************************************************
+ * Function: tcp_sack_rexmit
+ *
+ * Description:
+ *   Select the data to resend next during fast recovery:  The first byte
+ *   at or after conn->rexmitnxt that the peer has not received and that
+ *   lies below the highest SACKed byte.  Without SACK information, this
+ *   is the oldest un-ACKed byte.
+ *
+ * Input Parameters:
+ *   conn  - The TCP connection of interest
+ *   seqno - Location to return the sequence number to resend
+ *   len   - Location to return the size of the hole at seqno
+ *
+ * Returned Value:
+ *   true if there is data to resend.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_SACK
+bool tcp_sack_rexmit(FAR struct tcp_conn_s *conn, FAR uint32_t *seqno,
+                     FAR uint32_t *len);
+#endif
+
+/****************************************************************************
+ * Function: tcp_ooseq_add
+ *
+ * Description:
+ *   Retain the data of a segment that arrived ahead of the next expected
+ *   sequence number.  The data is merged with the blocks that it overlaps
+ *   or touches.  Data outside of the receive window is discarded.
+ *
+ * Input Parameters:
+ *   dev    - The device that received the segment
+ *   conn   - The TCP connection of interest
+ *   seqno  - The sequence number of the first byte of the data
+ *   buffer - The data
+ *   buflen - The length of the data
+ *
+ * Returned Value:
+ *   OK if the data was retained or was already present; a negated errno
+ *   value if it could not be retained.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_OOSEQ
+int tcp_ooseq_add(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
+                  uint32_t seqno, FAR const uint8_t *buffer,
+                  uint16_t buflen);
+#endif
+
+/****************************************************************************
+ * Function: tcp_ooseq_deliver
+ *
+ * Description:
+ *   Move the out-of-order data that is now in sequence to the read-ahead
+ *   buffers and advance rcvseq past it.  This is called after rcvseq has
+ *   been advanced by an incoming segment.
+ *
+ * Returned Value:
+ *   The number of bytes by which rcvseq was advanced.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_OOSEQ
+uint32_t tcp_ooseq_deliver(FAR struct tcp_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Function: tcp_ooseq_free
+ *
+ * Description:
+ *   Release all of the out-of-order data of a connection.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_OOSEQ
+void tcp_ooseq_free(FAR struct tcp_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Function: tcp_ooseq_sack
+ *
+ * Description:
+ *   Describe the out-of-order data as SACK blocks (RFC 2018).  The block
+ *   holding the most recently received segment comes first; the others
+ *   follow in sequence order.
+ *
+ * Input Parameters:
+ *   conn      - The TCP connection of interest
+ *   blocks    - Location to return the SACK blocks
+ *   maxblocks - The maximum number of blocks to return
+ *
+ * Returned Value:
+ *   The number of blocks returned.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_TCP_OOSEQ) && defined(CONFIG_NET_TCP_SACK)
+int tcp_ooseq_sack(FAR struct tcp_conn_s *conn,
+                   FAR struct tcp_sack_s *blocks, int maxblocks);
+#endif
+
 /****************************************************************************
  * Function: tcp_pollsetup
  *
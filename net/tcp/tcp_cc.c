@@ -0,0 +1,735 @@
+/****************************************************************************
+ * net/tcp/tcp_cc.c
+ * TCP congestion control
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * References:
+ *   RFC 5681, TCP Congestion Control
+ *   RFC 6298, Computing TCP's Retransmission Timer
+ *   RFC 6582, The NewReno Modification to TCP's Fast Recovery Algorithm
+ *   RFC 8312, CUBIC for Fast Long-Distance Networks
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_TCP) && defined(CONFIG_NET_TCP_CC)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <netinet/tcp.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/net/netconfig.h>
+#include <nuttx/net/tcp.h>
+
+#include "tcp/tcp.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The number of duplicate ACKs that trigger a fast retransmit */
+
+#define TCP_CC_DUPTHRESH   3
+
+/* "Infinite" initial slow start threshold */
+
+#define TCP_CC_MAXSSTHRESH 0x7fffffff
+
+/* CUBIC parameters (RFC 8312):  C = 0.4 and beta = 0.7.
+ *
+ *   K (msec)   = cbrt((Wmax - cwnd) / C) with the windows in segments
+ *              = cbrt(bytes * 2.5e9 / mss)
+ *   W(t) - Wmax = C * (t - K)**3 with t in seconds and W in segments
+ *              = (t - K)**3 * 4 * mss / 1e10 with t in msec and W in bytes
+ *
+ * (t - K) is limited so that the cube does not overflow 64 bits.
+ */
+
+#define CUBIC_KSCALE       2500000000ull
+#define CUBIC_CNUM         4
+#define CUBIC_CDEN         10000000000ll
+#define CUBIC_MAXDELTA     60000
+
+/* Default congestion control algorithm */
+
+#ifdef CONFIG_NET_TCP_CC_DEFAULT_CUBIC
+#  define TCP_CC_DEFAULT   (&g_cubic_ops)
+#else
+#  define TCP_CC_DEFAULT   (&g_reno_ops)
+#endif
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static void reno_init(FAR struct tcp_conn_s *conn);
+static void reno_cong_avoid(FAR struct tcp_conn_s *conn, uint32_t acked);
+static uint32_t reno_ssthresh(FAR struct tcp_conn_s *conn);
+
+#ifdef CONFIG_NET_TCP_CC_CUBIC
+static void cubic_init(FAR struct tcp_conn_s *conn);
+static void cubic_cong_avoid(FAR struct tcp_conn_s *conn, uint32_t acked);
+static uint32_t cubic_ssthresh(FAR struct tcp_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct tcp_cc_ops_s g_reno_ops =
+{
+  "reno",
+  reno_init,
+  reno_cong_avoid,
+  reno_ssthresh
+};
+
+#ifdef CONFIG_NET_TCP_CC_CUBIC
+static const struct tcp_cc_ops_s g_cubic_ops =
+{
+  "cubic",
+  cubic_init,
+  cubic_cong_avoid,
+  cubic_ssthresh
+};
+#endif
+
+/* All available congestion control algorithms */
+
+static FAR const struct tcp_cc_ops_s * const g_tcp_cc[] =
+{
+  &g_reno_ops,
+#ifdef CONFIG_NET_TCP_CC_CUBIC
+  &g_cubic_ops,
+#endif
+};
+
+#define TCP_CC_NALGORITHMS (sizeof(g_tcp_cc) / sizeof(g_tcp_cc[0]))
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: reno_init, reno_cong_avoid, and reno_ssthresh
+ *
+ * Description:
+ *   NewReno congestion avoidance:  Grow the congestion window by about one
+ *   segment per round trip time (RFC 5681, equation 3) and halve the
+ *   data in flight on a loss.
+ *
+ ****************************************************************************/
+
+static void reno_init(FAR struct tcp_conn_s *conn)
+{
+}
+
+static void reno_cong_avoid(FAR struct tcp_conn_s *conn, uint32_t acked)
+{
+  FAR struct tcp_cc_s *cc = &conn->cc;
+  uint32_t incr;
+
+  incr = ((uint32_t)conn->mss * conn->mss) / cc->cwnd;
+  cc->cwnd += incr > 0 ? incr : 1;
+}
+
+static uint32_t reno_ssthresh(FAR struct tcp_conn_s *conn)
+{
+  uint32_t ssthresh = conn->unacked / 2;
+
+  return ssthresh > 2 * conn->mss ? ssthresh : 2 * conn->mss;
+}
+
+/****************************************************************************
+ * Name: cubic_root
+ *
+ * Description:
+ *   Integer cube root of a 64-bit value.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_CC_CUBIC
+static uint32_t cubic_root(uint64_t x)
+{
+  uint64_t y = 0;
+  uint64_t b;
+  int s;
+
+  for (s = 63; s >= 0; s -= 3)
+    {
+      y <<= 1;
+      b = 3 * y * (y + 1) + 1;
+      if ((x >> s) >= b)
+        {
+          x -= b << s;
+          y++;
+        }
+    }
+
+  return (uint32_t)y;
+}
+#endif
+
+/****************************************************************************
+ * Name: cubic_init, cubic_cong_avoid, and cubic_ssthresh
+ *
+ * Description:
+ *   CUBIC congestion avoidance (RFC 8312):  After a loss, the congestion
+ *   window follows a cubic function of the time since the loss.  It grows
+ *   quickly back toward the window at which the loss occurred (Wmax),
+ *   flattens out there, and then probes for more bandwidth.  The window is
+ *   never allowed to grow more slowly than standard TCP would.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_CC_CUBIC
+static void cubic_init(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_cc_s *cc = &conn->cc;
+
+  cc->wmax   = 0;
+  cc->origin = 0;
+  cc->west   = 0;
+  cc->k      = 0;
+  cc->flags &= ~TCP_CC_EPOCH;
+}
+
+static void cubic_cong_avoid(FAR struct tcp_conn_s *conn, uint32_t acked)
+{
+  FAR struct tcp_cc_s *cc = &conn->cc;
+  systime_t now = clock_systimer();
+  uint32_t target;
+  uint32_t incr;
+  int64_t offset;
+  int64_t delta;
+
+  /* Start a new congestion epoch on the first ACK after a loss */
+
+  if ((cc->flags & TCP_CC_EPOCH) == 0)
+    {
+      cc->flags |= TCP_CC_EPOCH;
+      cc->epoch  = now;
+      cc->west   = cc->cwnd;
+
+      if (cc->cwnd < cc->wmax)
+        {
+          cc->k      = cubic_root((uint64_t)(cc->wmax - cc->cwnd) *
+                                  (CUBIC_KSCALE / conn->mss));
+          cc->origin = cc->wmax;
+        }
+      else
+        {
+          cc->k      = 0;
+          cc->origin = cc->cwnd;
+        }
+    }
+
+  /* The target is the value of the cubic function one RTT from now */
+
+  delta = (int64_t)TICK2MSEC(now - cc->epoch) + cc->srtt / 1000 - cc->k;
+  if (delta > CUBIC_MAXDELTA)
+    {
+      delta = CUBIC_MAXDELTA;
+    }
+  else if (delta < -CUBIC_MAXDELTA)
+    {
+      delta = -CUBIC_MAXDELTA;
+    }
+
+  offset = delta * delta * delta * CUBIC_CNUM * conn->mss / CUBIC_CDEN;
+  if (offset < 0 && (uint64_t)-offset >= cc->origin)
+    {
+      target = 0;
+    }
+  else
+    {
+      target = (uint32_t)((int64_t)cc->origin + offset);
+    }
+
+  /* Standard TCP grows by 3 * (1 - beta) / (1 + beta) = 9/17 segment per
+   * RTT.  Use that window if it is larger (the "TCP-friendly region").
+   */
+
+  cc->west += (9 * (uint32_t)conn->mss * acked) / (17 * cc->cwnd);
+  if (cc->west > target)
+    {
+      target = cc->west;
+    }
+
+  /* Approach the target over one RTT, but never faster than slow start */
+
+  if (target > cc->cwnd)
+    {
+      incr = (uint32_t)(((uint64_t)(target - cc->cwnd) * acked) / cc->cwnd);
+      if (incr > acked)
+        {
+          incr = acked;
+        }
+    }
+  else
+    {
+      incr = ((uint32_t)conn->mss * acked) / (100 * cc->cwnd);
+    }
+
+  cc->cwnd += incr > 0 ? incr : 1;
+}
+
+static uint32_t cubic_ssthresh(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_cc_s *cc = &conn->cc;
+  uint32_t ssthresh;
+
+  /* Fast convergence:  If the window did not reach the previous Wmax,
+   * then release some bandwidth for new flows.
+   */
+
+  if (cc->cwnd < cc->wmax)
+    {
+      cc->wmax = (cc->cwnd * 17) / 20;
+    }
+  else
+    {
+      cc->wmax = cc->cwnd;
+    }
+
+  cc->flags &= ~TCP_CC_EPOCH;
+
+  ssthresh = (cc->cwnd * 7) / 10;
+  return ssthresh > 2 * conn->mss ? ssthresh : 2 * conn->mss;
+}
+#endif
+
+/****************************************************************************
+ * Name: tcp_cc_dupack
+ *
+ * Description:
+ *   Handle a duplicate ACK.  The third duplicate ACK triggers a fast
+ *   retransmit and starts fast recovery.  Each further duplicate ACK means
+ *   that another segment has left the network and inflates the congestion
+ *   window by one segment.
+ *
+ ****************************************************************************/
+
+static void tcp_cc_dupack(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_cc_s *cc = &conn->cc;
+
+  if (cc->state == TCP_CA_RECOVERY)
+    {
+      cc->cwnd += conn->mss;
+
+#ifdef CONFIG_NET_TCP_SACK
+      /* With SACK information, each duplicate ACK may also resend the
+       * next hole in the scoreboard.
+       */
+
+      if (conn->nsack > 0)
+        {
+          cc->flags |= TCP_CC_FASTREXMIT;
+        }
+#endif
+      return;
+    }
+
+  if (++cc->dupacks != TCP_CC_DUPTHRESH)
+    {
+      return;
+    }
+
+  /* Do not start another recovery for data that was outstanding when the
+   * last recovery or timeout started (RFC 6582, section 4.1).
+   */
+
+  if (TCP_SEQ_LT(cc->lastack, cc->recover))
+    {
+      return;
+    }
+
+  ninfo("Fast retransmit: ackno=%u cwnd=%u unacked=%u\n",
+        cc->lastack, cc->cwnd, conn->unacked);
+
+  cc->ssthresh = cc->ops->ssthresh(conn);
+  cc->cwnd     = cc->ssthresh + TCP_CC_DUPTHRESH * conn->mss;
+  cc->recover  = cc->sndmax;
+  cc->state    = TCP_CA_RECOVERY;
+  cc->flags    = (cc->flags & ~TCP_CC_TIMING) | TCP_CC_FASTREXMIT;
+  cc->nfastrexmit++;
+
+#ifdef CONFIG_NET_TCP_SACK
+  conn->rexmitnxt = cc->lastack;
+#endif
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: tcp_cc_init
+ *
+ * Description:
+ *   Initialize the congestion control state of a connection that has just
+ *   entered the ESTABLISHED state.  The algorithm selected with
+ *   TCP_CONGESTION is retained; otherwise the default algorithm is used.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+void tcp_cc_init(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_cc_s *cc = &conn->cc;
+  FAR const struct tcp_cc_ops_s *ops = cc->ops;
+  uint32_t iw;
+
+  memset(cc, 0, sizeof(struct tcp_cc_s));
+  cc->ops = ops != NULL ? ops : TCP_CC_DEFAULT;
+
+  /* The initial window (RFC 3390):  min(4 * MSS, max(2 * MSS, 4380)) */
+
+  iw = 4380;
+  if (iw < 2 * (uint32_t)conn->mss)
+    {
+      iw = 2 * conn->mss;
+    }
+
+  if (iw > 4 * (uint32_t)conn->mss)
+    {
+      iw = 4 * conn->mss;
+    }
+
+  cc->cwnd     = iw;
+  cc->ssthresh = TCP_CC_MAXSSTHRESH;
+  cc->lastack  = conn->isn;
+  cc->sndmax   = conn->isn;
+  cc->recover  = conn->isn;
+  cc->state    = TCP_CA_OPEN;
+
+#ifdef CONFIG_NET_TCP_SACK
+  tcp_sack_reset(conn);
+#endif
+
+  cc->ops->init(conn);
+}
+
+/****************************************************************************
+ * Function: tcp_cc_ack
+ *
+ * Description:
+ *   Update the congestion control state on receipt of an ACK.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection of interest
+ *   ackno  - The ACK number of the incoming segment
+ *   dupack - True if the segment could be a duplicate ACK:  It carries no
+ *            data, no SYN or FIN and it does not update the window.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+void tcp_cc_ack(FAR struct tcp_conn_s *conn, uint32_t ackno, bool dupack)
+{
+  FAR struct tcp_cc_s *cc = &conn->cc;
+  uint32_t acked;
+
+  if (TCP_SEQ_LE(ackno, cc->lastack))
+    {
+      if (ackno == cc->lastack && dupack && conn->unacked > 0)
+        {
+          tcp_cc_dupack(conn);
+        }
+
+      return;
+    }
+
+  /* New data has been ACKed */
+
+  acked        = ackno - cc->lastack;
+  cc->lastack  = ackno;
+  cc->dupacks  = 0;
+
+  if ((cc->flags & TCP_CC_TIMING) != 0 && TCP_SEQ_GE(ackno, cc->rttseq))
+    {
+      tcp_cc_rttsample(conn, TICK2USEC(clock_systimer() - cc->rttstart));
+      cc->flags &= ~TCP_CC_TIMING;
+    }
+
+  if (cc->state == TCP_CA_RECOVERY)
+    {
+      if (TCP_SEQ_LT(ackno, cc->recover))
+        {
+          /* Partial ACK:  Retransmit the next missing segment and deflate
+           * the window by the amount of new data ACKed, then add back one
+           * segment for the retransmission (RFC 6582, section 3.2).
+           */
+
+          cc->cwnd   = cc->cwnd > acked ? cc->cwnd - acked : 0;
+          cc->cwnd  += conn->mss;
+          cc->flags |= TCP_CC_FASTREXMIT;
+          return;
+        }
+
+      /* Full ACK:  Deflate the window and leave fast recovery */
+
+      cc->cwnd   = cc->ssthresh;
+      cc->state  = TCP_CA_OPEN;
+      cc->flags &= ~TCP_CC_FASTREXMIT;
+      return;
+    }
+
+  cc->state = TCP_CA_OPEN;
+
+  /* Do not grow the window beyond what the receiver allows us to send */
+
+  if (cc->cwnd >= conn->winsize)
+    {
+      return;
+    }
+
+  if (cc->cwnd < cc->ssthresh)
+    {
+      /* Slow start:  One segment per ACK (RFC 5681, section 3.1) */
+
+      cc->cwnd += acked < conn->mss ? acked : conn->mss;
+    }
+  else
+    {
+      cc->ops->cong_avoid(conn, acked);
+    }
+}
+
+/****************************************************************************
+ * Function: tcp_cc_timeout
+ *
+ * Description:
+ *   Update the congestion control state on a retransmission timeout.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+void tcp_cc_timeout(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_cc_s *cc = &conn->cc;
+
+  /* Only reduce ssthresh on the first timeout of a loss event */
+
+  if (cc->state != TCP_CA_LOSS)
+    {
+      cc->ssthresh = cc->ops->ssthresh(conn);
+    }
+#ifdef CONFIG_NET_TCP_SACK
+  else
+    {
+      /* The SACK scoreboard is kept across a timeout so that the data
+       * that the peer has received is not resent.  A second timeout
+       * suggests that the peer has discarded that data (RFC 2018,
+       * section 8).
+       */
+
+      tcp_sack_reset(conn);
+    }
+#endif
+
+  cc->cwnd    = conn->mss;
+  cc->state   = TCP_CA_LOSS;
+  cc->dupacks = 0;
+  cc->recover = cc->sndmax;
+  cc->flags  &= ~(TCP_CC_TIMING | TCP_CC_FASTREXMIT);
+  cc->nrto++;
+}
+
+/****************************************************************************
+ * Function: tcp_cc_rttsample
+ *
+ * Description:
+ *   Update the smoothed RTT and RTT variation with a new measurement of
+ *   'rtt' microseconds (RFC 6298, section 2).
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+void tcp_cc_rttsample(FAR struct tcp_conn_s *conn, uint32_t rtt)
+{
+  FAR struct tcp_cc_s *cc = &conn->cc;
+  uint32_t delta;
+
+  if ((cc->flags & TCP_CC_RTTVALID) == 0)
+    {
+      cc->srtt   = rtt;
+      cc->rttvar = rtt / 2;
+      cc->flags |= TCP_CC_RTTVALID;
+    }
+  else
+    {
+      delta      = rtt > cc->srtt ? rtt - cc->srtt : cc->srtt - rtt;
+      cc->rttvar = (3 * cc->rttvar + delta) / 4;
+      cc->srtt   = (7 * cc->srtt + rtt) / 8;
+    }
+}
+
+/****************************************************************************
+ * Function: tcp_cc_sent
+ *
+ * Description:
+ *   Called when 'len' bytes starting at sequence number 'seqno' are about
+ *   to be sent.  Starts RTT timing if the segment holds new data and no
+ *   other segment is being timed.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+void tcp_cc_sent(FAR struct tcp_conn_s *conn, uint32_t seqno, uint32_t len)
+{
+  FAR struct tcp_cc_s *cc = &conn->cc;
+
+  /* Retransmitted segments are never timed (Karn's algorithm) */
+
+  if (TCP_SEQ_LT(seqno, cc->sndmax))
+    {
+      return;
+    }
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  /* With timestamps, every ACK provides an RTT sample */
+
+  if ((conn->tcpoptflags & TCP_OPTF_TS) != 0)
+    {
+      cc->sndmax = seqno + len;
+      return;
+    }
+#endif
+
+  if ((cc->flags & TCP_CC_TIMING) == 0)
+    {
+      cc->rttseq   = seqno + len;
+      cc->rttstart = clock_systimer();
+      cc->flags   |= TCP_CC_TIMING;
+    }
+
+  cc->sndmax = seqno + len;
+}
+
+/****************************************************************************
+ * Function: tcp_cc_sndwnd
+ *
+ * Description:
+ *   Return the number of bytes that may be sent now:  The smaller of the
+ *   congestion window and the receiver's window, less the data in flight.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+uint32_t tcp_cc_sndwnd(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_cc_s *cc = &conn->cc;
+  uint32_t wnd;
+  uint32_t flight;
+
+  wnd = cc->cwnd < conn->winsize ? cc->cwnd : conn->winsize;
+
+  /* The data in flight extends from the oldest un-ACKed byte to the next
+   * byte to be sent.  After a timeout, this is less than conn->unacked:
+   * The un-ACKed segments are resent from the beginning.
+   */
+
+  flight = conn->isn + conn->sent - cc->lastack;
+  if ((int32_t)flight <= 0)
+    {
+      return wnd;
+    }
+
+  return wnd > flight ? wnd - flight : 0;
+}
+
+/****************************************************************************
+ * Function: tcp_cc_select
+ *
+ * Description:
+ *   Select the congestion control algorithm for a connection by name.
+ *
+ * Returned Value:
+ *   OK on success; -ENOENT if there is no algorithm with that name.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+int tcp_cc_select(FAR struct tcp_conn_s *conn, FAR const char *name)
+{
+  FAR const struct tcp_cc_ops_s *ops;
+  int i;
+
+  for (i = 0; i < TCP_CC_NALGORITHMS; i++)
+    {
+      ops = g_tcp_cc[i];
+      if (strncmp(ops->name, name, TCP_CA_NAME_MAX) == 0)
+        {
+          conn->cc.ops = ops;
+
+          /* Switching the algorithm of an established connection keeps the
+           * current window, but starts the new algorithm afresh.
+           */
+
+          if ((conn->tcpstateflags & TCP_STATE_MASK) == TCP_ESTABLISHED)
+            {
+              ops->init(conn);
+            }
+
+          return OK;
+        }
+    }
+
+  return -ENOENT;
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_TCP && CONFIG_NET_TCP_CC */
@@ -1,7 +1,8 @@
 /****************************************************************************
  * net/tcp/tcp_conn.c
  *
- *   Copyright (C) 2007-2011, 2013-2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2011, 2013-2015, 2017 Gregory Nutt. All rights
+ *     reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Large parts of this file were leveraged from uIP logic:
@@ -44,6 +45,7 @@
 #if defined(CONFIG_NET) && defined(CONFIG_NET_TCP)
 
 #include <stdint.h>
+#include <stddef.h>
 #include <string.h>
 #include <assert.h>
 #include <errno.h>
@@ -69,6 +71,22 @@
 #define IPv4BUF ((struct ipv4_hdr_s *)&dev->d_buf[NET_LL_HDRLEN(dev)])
 #define IPv6BUF ((struct ipv6_hdr_s *)&dev->d_buf[NET_LL_HDRLEN(dev)])
 
+#ifdef CONFIG_NET_TCP_CONNHASH
+#  if (CONFIG_NET_TCP_CONNHASH_SIZE & (CONFIG_NET_TCP_CONNHASH_SIZE - 1)) != 0
+#    error CONFIG_NET_TCP_CONNHASH_SIZE must be a power of two
+#  endif
+
+#  define TCP_HASH_MASK  (CONFIG_NET_TCP_CONNHASH_SIZE - 1)
+#endif
+
+/* Recover the connection from its ready list node */
+
+#ifdef CONFIG_NET_TCP_READYLIST
+#  define READY2CONN(n) \
+  ((FAR struct tcp_conn_s *)((FAR uint8_t *)(n) - \
+                             offsetof(struct tcp_conn_s, rnode)))
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -85,14 +103,230 @@ static dq_queue_t g_free_tcp_connections;
 
 static dq_queue_t g_active_tcp_connections;
 
+#ifdef CONFIG_NET_TCP_READYLIST
+/* The subset of the active connections that may have output */
+
+static dq_queue_t g_ready_tcp_connections;
+#endif
+
 /* Last port used by a TCP connection connection. */
 
 static uint16_t g_last_tcp_port;
 
+#ifdef CONFIG_NET_TCP_CONNHASH
+/* The active connections hashed by remote address, local port, and remote
+ * port.  These are chained through the hnext field.
+ */
+
+static FAR struct tcp_conn_s *g_tcp_connhash[CONFIG_NET_TCP_CONNHASH_SIZE];
+
+/* All connections with a local port assigned, hashed by the local port.
+ * These are chained through the pnext field.
+ */
+
+static FAR struct tcp_conn_s *g_tcp_porthash[CONFIG_NET_TCP_CONNHASH_SIZE];
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: tcp_hashfold, tcp_ipv4_hash, and tcp_ipv6_hash
+ *
+ * Description:
+ *   Reduce a local port number or the remote address and the local and
+ *   remote port numbers of a connection to an index into the connection
+ *   hash tables.  All values are in network byte order.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_CONNHASH
+static inline unsigned int tcp_hashfold(uint32_t key)
+{
+  key ^= key >> 16;
+  key ^= key >> 8;
+  return (unsigned int)key & TCP_HASH_MASK;
+}
+
+#ifdef CONFIG_NET_IPv4
+static inline unsigned int tcp_ipv4_hash(in_addr_t raddr, uint16_t lport,
+                                         uint16_t rport)
+{
+  return tcp_hashfold((uint32_t)raddr ^ ((uint32_t)lport << 16 | rport));
+}
+#endif
+
+#ifdef CONFIG_NET_IPv6
+static inline unsigned int tcp_ipv6_hash(FAR const uint16_t *raddr,
+                                         uint16_t lport, uint16_t rport)
+{
+  uint32_t key = (uint32_t)lport << 16 | rport;
+  int i;
+
+  for (i = 0; i < 8; i += 2)
+    {
+      key ^= (uint32_t)raddr[i] << 16 | raddr[i + 1];
+    }
+
+  return tcp_hashfold(key);
+}
+#endif
+
+/****************************************************************************
+ * Name: tcp_connhash
+ *
+ * Description:
+ *   Return the index of the connection hash table bucket that holds this
+ *   connection.
+ *
+ ****************************************************************************/
+
+static unsigned int tcp_connhash(FAR struct tcp_conn_s *conn)
+{
+#ifdef CONFIG_NET_IPv4
+#ifdef CONFIG_NET_IPv6
+  if (conn->domain == PF_INET)
+#endif
+    {
+      return tcp_ipv4_hash(conn->u.ipv4.raddr, conn->lport, conn->rport);
+    }
+#endif /* CONFIG_NET_IPv4 */
+
+#ifdef CONFIG_NET_IPv6
+#ifdef CONFIG_NET_IPv4
+  else
+#endif
+    {
+      return tcp_ipv6_hash(conn->u.ipv6.raddr, conn->lport, conn->rport);
+    }
+#endif /* CONFIG_NET_IPv6 */
+}
+
+/****************************************************************************
+ * Name: tcp_hashadd and tcp_hashrem
+ *
+ * Description:
+ *   Add a connection to or remove a connection from the connection hash
+ *   table.  The connection is added to the end of its chain so that
+ *   lookups find connections in the same order as a search of the active
+ *   list would.
+ *
+ * Assumptions:
+ *   The caller holds the network lock.
+ *
+ ****************************************************************************/
+
+static void tcp_hashadd(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_conn_s **link = &g_tcp_connhash[tcp_connhash(conn)];
+
+  while (*link != NULL)
+    {
+      link = &(*link)->hnext;
+    }
+
+  conn->hnext = NULL;
+  *link       = conn;
+}
+
+static void tcp_hashrem(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_conn_s **link = &g_tcp_connhash[tcp_connhash(conn)];
+
+  while (*link != NULL)
+    {
+      if (*link == conn)
+        {
+          *link = conn->hnext;
+          break;
+        }
+
+      link = &(*link)->hnext;
+    }
+
+  conn->hnext = NULL;
+}
+
+/****************************************************************************
+ * Name: tcp_portadd and tcp_portrem
+ *
+ * Description:
+ *   Add a connection to or remove a connection from the local port hash
+ *   table.
+ *
+ * Assumptions:
+ *   The caller holds the network lock.
+ *
+ ****************************************************************************/
+
+static void tcp_portadd(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_conn_s **link = &g_tcp_porthash[tcp_hashfold(conn->lport)];
+
+  while (*link != NULL)
+    {
+      link = &(*link)->pnext;
+    }
+
+  conn->pnext = NULL;
+  *link       = conn;
+}
+
+static void tcp_portrem(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_conn_s **link = &g_tcp_porthash[tcp_hashfold(conn->lport)];
+
+  while (*link != NULL)
+    {
+      if (*link == conn)
+        {
+          *link = conn->pnext;
+          break;
+        }
+
+      link = &(*link)->pnext;
+    }
+
+  conn->pnext = NULL;
+}
+#endif /* CONFIG_NET_TCP_CONNHASH */
+
+/****************************************************************************
+ * Name: tcp_setlport
+ *
+ * Description:
+ *   Assign a local port number (in network byte order) to the connection,
+ *   keeping the local port hash table up to date.  A port number of zero
+ *   unbinds the connection.
+ *
+ * Assumptions:
+ *   The caller holds the network lock.
+ *
+ ****************************************************************************/
+
+static void tcp_setlport(FAR struct tcp_conn_s *conn, uint16_t lport)
+{
+#ifdef CONFIG_NET_TCP_CONNHASH
+  if (conn->lport != lport)
+    {
+      if (conn->lport != 0)
+        {
+          tcp_portrem(conn);
+        }
+
+      conn->lport = lport;
+
+      if (lport != 0)
+        {
+          tcp_portadd(conn);
+        }
+    }
+#else
+  conn->lport = lport;
+#endif
+}
+
 /****************************************************************************
  * Name: tcp_ipv4_listener
  *
@@ -110,13 +344,22 @@ static inline FAR struct tcp_conn_s *tcp_ipv4_listener(in_addr_t ipaddr,
                                                        uint16_t portno)
 {
   FAR struct tcp_conn_s *conn;
+#ifndef CONFIG_NET_TCP_CONNHASH
   int i;
+#endif
 
   /* Check if this port number is in use by any active UIP TCP connection */
 
+#ifdef CONFIG_NET_TCP_CONNHASH
+  for (conn = g_tcp_porthash[tcp_hashfold(portno)];
+       conn != NULL;
+       conn = conn->pnext)
+    {
+#else
   for (i = 0; i < CONFIG_NET_TCP_CONNS; i++)
     {
       conn = &g_tcp_connections[i];
+#endif
 
       /* Check if this connection is open and the local port assignment
        * matches the requested port number.
@@ -161,13 +404,22 @@ static inline FAR struct tcp_conn_s *
 tcp_ipv6_listener(const net_ipv6addr_t ipaddr, uint16_t portno)
 {
   FAR struct tcp_conn_s *conn;
+#ifndef CONFIG_NET_TCP_CONNHASH
   int i;
+#endif
 
   /* Check if this port number is in use by any active UIP TCP connection */
 
+#ifdef CONFIG_NET_TCP_CONNHASH
+  for (conn = g_tcp_porthash[tcp_hashfold(portno)];
+       conn != NULL;
+       conn = conn->pnext)
+    {
+#else
   for (i = 0; i < CONFIG_NET_TCP_CONNS; i++)
     {
       conn = &g_tcp_connections[i];
+#endif
 
       /* Check if this connection is open and the local port assignment
        * matches the requested port number.
@@ -236,13 +488,22 @@ static FAR struct tcp_conn_s *
 static FAR struct tcp_conn_s *tcp_listener(uint16_t portno)
 {
   FAR struct tcp_conn_s *conn;
+#ifndef CONFIG_NET_TCP_CONNHASH
   int i;
+#endif
 
   /* Check if this port number is in use by any active UIP TCP connection */
 
+#ifdef CONFIG_NET_TCP_CONNHASH
+  for (conn = g_tcp_porthash[tcp_hashfold(portno)];
+       conn != NULL;
+       conn = conn->pnext)
+    {
+#else
   for (i = 0; i < CONFIG_NET_TCP_CONNS; i++)
     {
       conn = &g_tcp_connections[i];
+#endif
 
       /* Check if this connection is open and the local port assignment
        * matches the requested port number.
@@ -368,12 +629,22 @@ static inline FAR struct tcp_conn_s *
   in_addr_t destipaddr;
 #endif
 
-  conn       = (FAR struct tcp_conn_s *)g_active_tcp_connections.head;
   srcipaddr  = net_ip4addr_conv32(ip->srcipaddr);
 #ifdef CONFIG_NETDEV_MULTINIC
   destipaddr = net_ip4addr_conv32(ip->destipaddr);
 #endif
 
+#ifdef CONFIG_NET_TCP_CONNHASH
+  /* Only the connections in the hash bucket selected by the remote
+   * address and the port numbers can match.
+   */
+
+  conn = g_tcp_connhash[tcp_ipv4_hash(srcipaddr, tcp->destport,
+                                      tcp->srcport)];
+#else
+  conn = (FAR struct tcp_conn_s *)g_active_tcp_connections.head;
+#endif
+
   while (conn)
     {
       /* Find an open connection matching the TCP input. The following
@@ -413,7 +684,11 @@ static inline FAR struct tcp_conn_s *
 
       /* Look at the next active connection */
 
+#ifdef CONFIG_NET_TCP_CONNHASH
+      conn = conn->hnext;
+#else
       conn = (FAR struct tcp_conn_s *)conn->node.flink;
+#endif
     }
 
   return conn;
@@ -443,12 +718,22 @@ static inline FAR struct tcp_conn_s *
   net_ipv6addr_t *destipaddr;
 #endif
 
-  conn       = (FAR struct tcp_conn_s *)g_active_tcp_connections.head;
   srcipaddr  = (net_ipv6addr_t *)ip->srcipaddr;
 #ifdef CONFIG_NETDEV_MULTINIC
   destipaddr = (net_ipv6addr_t *)ip->destipaddr;
 #endif
 
+#ifdef CONFIG_NET_TCP_CONNHASH
+  /* Only the connections in the hash bucket selected by the remote
+   * address and the port numbers can match.
+   */
+
+  conn = g_tcp_connhash[tcp_ipv6_hash(ip->srcipaddr, tcp->destport,
+                                      tcp->srcport)];
+#else
+  conn = (FAR struct tcp_conn_s *)g_active_tcp_connections.head;
+#endif
+
   while (conn)
     {
       /* Find an open connection matching the TCP input. The following
@@ -488,7 +773,11 @@ static inline FAR struct tcp_conn_s *
 
       /* Look at the next active connection */
 
+#ifdef CONFIG_NET_TCP_CONNHASH
+      conn = conn->hnext;
+#else
       conn = (FAR struct tcp_conn_s *)conn->node.flink;
+#endif
     }
 
   return conn;
@@ -539,7 +828,7 @@ static inline int tcp_ipv4_bind(FAR struct tcp_conn_s *conn,
 
   /* Save the local address in the connection structure (network byte order). */
 
-  conn->lport = htons(port);
+  tcp_setlport(conn, htons(port));
 #ifdef CONFIG_NETDEV_MULTINIC
   net_ipv4addr_copy(conn->u.ipv4.laddr, addr->sin_addr.s_addr);
 #endif
@@ -557,7 +846,7 @@ static inline int tcp_ipv4_bind(FAR struct tcp_conn_s *conn,
 
       /* Back out the local address setting */
 
-      conn->lport = 0;
+      tcp_setlport(conn, 0);
 #ifdef CONFIG_NETDEV_MULTINIC
       net_ipv4addr_copy(conn->u.ipv4.laddr, INADDR_ANY);
 #endif
@@ -619,7 +908,7 @@ static inline int tcp_ipv6_bind(FAR struct tcp_conn_s *conn,
 
   /* Save the local address in the connection structure (network byte order). */
 
-  conn->lport = htons(port);
+  tcp_setlport(conn, htons(port));
 #ifdef CONFIG_NETDEV_MULTINIC
   net_ipv6addr_copy(conn->u.ipv6.laddr, addr->sin6_addr.in6_u.u6_addr16);
 #endif
@@ -637,7 +926,7 @@ static inline int tcp_ipv6_bind(FAR struct tcp_conn_s *conn,
 
       /* Back out the local address setting */
 
-      conn->lport = 0;
+      tcp_setlport(conn, 0);
 #ifdef CONFIG_NETDEV_MULTINIC
       net_ipv6addr_copy(conn->u.ipv6.laddr, g_ipv6_allzeroaddr);
 #endif
@@ -670,6 +959,9 @@ void tcp_initialize(void)
 
   dq_init(&g_free_tcp_connections);
   dq_init(&g_active_tcp_connections);
+#ifdef CONFIG_NET_TCP_READYLIST
+  dq_init(&g_ready_tcp_connections);
+#endif
 
   /* Now initialize each connection structure */
 
@@ -843,14 +1135,38 @@ void tcp_free(FAR struct tcp_conn_s *conn)
       /* Remove the connection from the active list */
 
       dq_rem(&conn->node, &g_active_tcp_connections);
+#ifdef CONFIG_NET_TCP_CONNHASH
+      tcp_hashrem(conn);
+#endif
     }
 
+#ifdef CONFIG_NET_TCP_READYLIST
+  /* Remove the connection from the ready list */
+
+  tcp_readyrem(conn);
+#endif
+
+#ifdef CONFIG_NET_TCP_CONNHASH
+  /* Release the local port number */
+
+  if (conn->lport != 0)
+    {
+      tcp_portrem(conn);
+    }
+#endif
+
 #ifdef CONFIG_NET_TCP_READAHEAD
   /* Release any read-ahead buffers attached to the connection */
 
   iob_free_queue(&conn->readahead);
 #endif
 
+#ifdef CONFIG_NET_TCP_OOSEQ
+  /* Release any out-of-order data */
+
+  tcp_ooseq_free(conn);
+#endif
+
 #ifdef CONFIG_NET_TCP_WRITE_BUFFERS
   /* Release any write buffers attached to the connection */
 
@@ -948,6 +1264,77 @@ FAR struct tcp_conn_s *tcp_nextconn(FAR struct tcp_conn_s *conn)
     }
 }
 
+/****************************************************************************
+ * Name: tcp_readyadd
+ *
+ * Description:
+ *   Add a connection to the list of connections that may have output.
+ *   Nothing is done if the connection is already in the list.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_READYLIST
+void tcp_readyadd(FAR struct tcp_conn_s *conn)
+{
+  if (!conn->ready)
+    {
+      dq_addlast(&conn->rnode, &g_ready_tcp_connections);
+      conn->ready = true;
+    }
+}
+
+/****************************************************************************
+ * Name: tcp_readyrem
+ *
+ * Description:
+ *   Remove a connection from the list of connections that may have output.
+ *   Nothing is done if the connection is not in the list.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+void tcp_readyrem(FAR struct tcp_conn_s *conn)
+{
+  if (conn->ready)
+    {
+      dq_rem(&conn->rnode, &g_ready_tcp_connections);
+      conn->ready = false;
+    }
+}
+
+/****************************************************************************
+ * Name: tcp_nextready
+ *
+ * Description:
+ *   Traverse the list of TCP connections that may have output
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+FAR struct tcp_conn_s *tcp_nextready(FAR struct tcp_conn_s *conn)
+{
+  FAR dq_entry_t *node;
+
+  if (!conn)
+    {
+      node = g_ready_tcp_connections.head;
+    }
+  else
+    {
+      node = conn->rnode.flink;
+    }
+
+  return node != NULL ? READY2CONN(node) : NULL;
+}
+#endif /* CONFIG_NET_TCP_READYLIST */
+
 /****************************************************************************
  * Name: tcp_alloc_accept
  *
@@ -1076,9 +1463,9 @@ FAR struct tcp_conn_s *tcp_alloc_accept(FAR struct net_driver_s *dev,
       conn->sa            = 0;
       conn->sv            = 4;
       conn->nrtx          = 0;
-      conn->lport         = tcp->destport;
       conn->rport         = tcp->srcport;
       conn->tcpstateflags = TCP_SYN_RCVD;
+      tcp_setlport(conn, tcp->destport);
 
       tcp_initsequence(conn->sndseq);
       conn->unacked       = 1;
@@ -1111,6 +1498,9 @@ FAR struct tcp_conn_s *tcp_alloc_accept(FAR struct net_driver_s *dev,
        */
 
       dq_addlast(&conn->node, &g_active_tcp_connections);
+#ifdef CONFIG_NET_TCP_CONNHASH
+      tcp_hashadd(conn);
+#endif
     }
 
   return conn;
@@ -1341,7 +1731,10 @@ int tcp_connect(FAR struct tcp_conn_s *conn, FAR const struct sockaddr *addr)
   conn->rto        = TCP_RTO;
   conn->sa         = 0;
   conn->sv         = 16;   /* Initial value of the RTT variance. */
-  conn->lport      = htons((uint16_t)port);
+  tcp_setlport(conn, htons((uint16_t)port));
+#ifdef HAVE_TCP_OPTIONS
+  conn->tcpoptflags = 0;   /* Options are negotiated by the SYN exchange */
+#endif
 #ifdef CONFIG_NET_TCP_WRITE_BUFFERS
   conn->expired    = 0;
   conn->isn        = 0;
@@ -1365,6 +1758,9 @@ int tcp_connect(FAR struct tcp_conn_s *conn, FAR const struct sockaddr *addr)
   /* And, finally, put the connection structure into the active list. */
 
   dq_addlast(&conn->node, &g_active_tcp_connections);
+#ifdef CONFIG_NET_TCP_CONNHASH
+  tcp_hashadd(conn);
+#endif
   ret = OK;
 
 errout_with_lock:
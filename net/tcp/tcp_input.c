@@ -47,9 +47,12 @@
 #if defined(CONFIG_NET) && defined(CONFIG_NET_TCP)
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 #include <debug.h>
 
+#include <netinet/tcp.h>
+
 #include <nuttx/net/netconfig.h>
 #include <nuttx/net/netdev.h>
 #include <nuttx/net/netstats.h>
@@ -60,10 +63,249 @@
 #include "utils/utils.h"
 #include "tcp/tcp.h"
 
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The TCP options of an incoming segment */
+
+struct tcp_options_s
+{
+  uint8_t  flags;         /* TCP_OPTF_* bits of the options present */
+  bool     hasmss;        /* True: The MSS option is present */
+  uint16_t mss;           /* Maximum segment size */
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+  uint8_t  wscale;        /* Window scale shift count */
+#endif
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  uint32_t tsval;         /* Timestamp value */
+  uint32_t tsecr;         /* Timestamp echo reply */
+#endif
+#ifdef CONFIG_NET_TCP_SACK
+  uint8_t  nsack;         /* Number of SACK blocks */
+  struct tcp_sack_s sack[TCP_SACK_NBLOCKS];
+#endif
+};
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: tcp_parse_options
+ *
+ * Description:
+ *   Parse the TCP options of an incoming segment
+ *
+ * Parameters:
+ *   dev    - The device driver structure containing the received packet
+ *   tcp    - A pointer to the TCP header in the packet
+ *   hdrlen - Offset of the TCP options in d_buf
+ *   opts   - Location to return the parsed options
+ *
+ * Return:
+ *   None
+ *
+ ****************************************************************************/
+
+static void tcp_parse_options(FAR struct net_driver_s *dev,
+                              FAR struct tcp_hdr_s *tcp, unsigned int hdrlen,
+                              FAR struct tcp_options_s *opts)
+{
+  FAR const uint8_t *optdata = &dev->d_buf[hdrlen];
+  int optlen = ((tcp->tcpoffset >> 4) - 5) << 2;
+  uint8_t opt;
+  uint8_t len;
+  int i;
+
+  opts->flags  = 0;
+  opts->hasmss = false;
+#ifdef CONFIG_NET_TCP_SACK
+  opts->nsack  = 0;
+#endif
+
+  for (i = 0; i < optlen; )
+    {
+      opt = optdata[i];
+      if (opt == TCP_OPT_END)
+        {
+          /* End of options. */
+
+          break;
+        }
+      else if (opt == TCP_OPT_NOOP)
+        {
+          /* NOP option. */
+
+          ++i;
+          continue;
+        }
+
+      /* All other options have a length field, so that we easily can skip
+       * past them.  If the length field is invalid, the options are
+       * malformed and we don't process them further.
+       */
+
+      if (i + 1 >= optlen)
+        {
+          break;
+        }
+
+      len = optdata[i + 1];
+      if (len < 2 || i + len > optlen)
+        {
+          break;
+        }
+
+      switch (opt)
+        {
+          case TCP_OPT_MSS:
+            if (len == TCP_OPT_MSS_LEN)
+              {
+                opts->mss    = ((uint16_t)optdata[i + 2] << 8) |
+                               (uint16_t)optdata[i + 3];
+                opts->hasmss = true;
+              }
+            break;
+
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+          case TCP_OPT_WS:
+            if (len == TCP_OPT_WS_LEN)
+              {
+                opts->wscale = optdata[i + 2] > TCP_MAX_WS ?
+                               TCP_MAX_WS : optdata[i + 2];
+                opts->flags |= TCP_OPTF_WS;
+              }
+            break;
+#endif
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+          case TCP_OPT_TS:
+            if (len == TCP_OPT_TS_LEN)
+              {
+                opts->tsval  = tcp_getsequence((FAR uint8_t *)&optdata[i + 2]);
+                opts->tsecr  = tcp_getsequence((FAR uint8_t *)&optdata[i + 6]);
+                opts->flags |= TCP_OPTF_TS;
+              }
+            break;
+#endif
+
+#ifdef CONFIG_NET_TCP_SACK
+          case TCP_OPT_SACKPERM:
+            if (len == TCP_OPT_SACKPERM_LEN)
+              {
+                opts->flags |= TCP_OPTF_SACK;
+              }
+            break;
+
+          case TCP_OPT_SACK:
+            {
+              int j;
+
+              for (j = i + 2;
+                   j + TCP_OPT_SACK_BLKLEN <= i + len &&
+                   opts->nsack < TCP_SACK_NBLOCKS;
+                   j += TCP_OPT_SACK_BLKLEN)
+                {
+                  opts->sack[opts->nsack].left =
+                    tcp_getsequence((FAR uint8_t *)&optdata[j]);
+                  opts->sack[opts->nsack].right =
+                    tcp_getsequence((FAR uint8_t *)&optdata[j + 4]);
+                  opts->nsack++;
+                }
+            }
+            break;
+#endif
+
+          default:
+            break;
+        }
+
+      i += len;
+    }
+}
+
+/****************************************************************************
+ * Name: tcp_synoptions
+ *
+ * Description:
+ *   Apply the options of the SYN or SYNACK received from the peer:  The
+ *   maximum segment size and the optional features that both sides
+ *   support.
+ *
+ * Parameters:
+ *   dev   - The device driver structure containing the received packet
+ *   conn  - The TCP connection of interest
+ *   opts  - The options of the SYN or SYNACK
+ *   iplen - Length of the IP header
+ *
+ * Return:
+ *   None
+ *
+ ****************************************************************************/
+
+static void tcp_synoptions(FAR struct net_driver_s *dev,
+                           FAR struct tcp_conn_s *conn,
+                           FAR struct tcp_options_s *opts,
+                           unsigned int iplen)
+{
+  if (opts->hasmss)
+    {
+      uint16_t tcp_mss = TCP_MSS(dev, iplen);
+      conn->mss = opts->mss > tcp_mss ? tcp_mss : opts->mss;
+    }
+
+#ifdef HAVE_TCP_OPTIONS
+  /* We offer (and accept) every option that is enabled.  An option is used
+   * only if the peer also sent it.
+   */
+
+  conn->tcpoptflags = opts->flags;
+
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+  if ((opts->flags & TCP_OPTF_WS) != 0)
+    {
+      conn->snd_wscale = opts->wscale;
+    }
+#endif
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  if ((opts->flags & TCP_OPTF_TS) != 0)
+    {
+      /* Every segment will carry the timestamps option */
+
+      conn->ts_recent = opts->tsval;
+      conn->mss      -= TCP_OPT_TS_ALIGNED;
+    }
+#endif
+#endif
+}
+
+/****************************************************************************
+ * Name: tcp_rttest
+ *
+ * Description:
+ *   Update the RTT estimate and the retransmission timeout with a new
+ *   measurement 'm' in half-seconds.
+ *
+ ****************************************************************************/
+
+static void tcp_rttest(FAR struct tcp_conn_s *conn, signed char m)
+{
+  /* This is taken directly from VJs original code in his paper */
+
+  m = m - (conn->sa >> 3);
+  conn->sa += m;
+  if (m < 0)
+    {
+      m = -m;
+    }
+
+  m = m - (conn->sv >> 2);
+  conn->sv += m;
+  conn->rto = (conn->sa >> 3) + conn->sv;
+}
+
 /****************************************************************************
  * Name: tcp_input
  *
@@ -92,9 +334,12 @@ static void tcp_input(FAR struct net_driver_s *dev, unsigned int iplen)
   uint16_t tmp16;
   uint16_t flags;
   uint16_t result;
-  uint8_t  opt;
+#ifdef CONFIG_NET_TCP_CC
+  uint32_t winsize;
+  bool     dupack = false;
+#endif
+  struct tcp_options_s opts;
   int      len;
-  int      i;
 
 #ifdef CONFIG_NET_STATISTICS
   /* Bump up the count of TCP packets received */
@@ -212,58 +457,10 @@ static void tcp_input(FAR struct net_driver_s *dev, unsigned int iplen)
 
           net_incr32(conn->rcvseq, 1);
 
-          /* Parse the TCP MSS option, if present. */
+          /* Parse the TCP options, if present. */
 
-          if ((tcp->tcpoffset & 0xf0) > 0x50)
-            {
-              for (i = 0; i < ((tcp->tcpoffset >> 4) - 5) << 2 ; )
-                {
-                  opt = dev->d_buf[hdrlen + i];
-                  if (opt == TCP_OPT_END)
-                    {
-                      /* End of options. */
-
-                      break;
-                    }
-                  else if (opt == TCP_OPT_NOOP)
-                    {
-                      /* NOP option. */
-
-                      ++i;
-                    }
-                  else if (opt == TCP_OPT_MSS &&
-                          dev->d_buf[hdrlen + 1 + i] == TCP_OPT_MSS_LEN)
-                    {
-                      uint16_t tcp_mss = TCP_MSS(dev, iplen);
-
-                      /* An MSS option with the right option length. */
-
-                      tmp16 = ((uint16_t)dev->d_buf[hdrlen + 2 + i] << 8) |
-                               (uint16_t)dev->d_buf[hdrlen + 3 + i];
-                      conn->mss = tmp16 > tcp_mss ? tcp_mss : tmp16;
-
-                      /* And we are done processing options. */
-
-                      break;
-                    }
-                  else
-                    {
-                      /* All other options have a length field, so that we easily
-                       * can skip past them.
-                       */
-
-                      if (dev->d_buf[hdrlen + 1 + i] == 0)
-                        {
-                          /* If the length field is zero, the options are malformed
-                           * and we don't process them further.
-                           */
-
-                          break;
-                        }
-                      i += dev->d_buf[hdrlen + 1 + i];
-                    }
-                }
-            }
+          tcp_parse_options(dev, tcp, hdrlen, &opts);
+          tcp_synoptions(dev, conn, &opts, iplen);
 
           /* Our response will be a SYNACK. */
 
@@ -293,10 +490,61 @@ reset:
 
 found:
 
+  /* The segment may permit more output on the connection.  Make sure that
+   * the connection is included in the next poll.
+   */
+
+  tcp_readyadd(conn);
+
+  /* Parse the TCP options, if present. */
+
+  tcp_parse_options(dev, tcp, hdrlen, &opts);
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  /* Reject old duplicate segments whose sequence numbers may have wrapped
+   * around (PAWS, RFC 7323, section 5.3).  Unless the segment is a bare
+   * ACK, acknowledge it.
+   */
+
+  if ((conn->tcpoptflags & TCP_OPTF_TS) != 0 &&
+      (opts.flags & TCP_OPTF_TS) != 0 &&
+      (tcp->flags & (TCP_RST | TCP_SYN)) == 0 &&
+      TCP_SEQ_LT(opts.tsval, conn->ts_recent))
+    {
+      ninfo("PAWS: tsval=%u ts_recent=%u\n", opts.tsval, conn->ts_recent);
+
+      if (dev->d_len > iplen + ((tcp->tcpoffset >> 4) << 2) ||
+          (tcp->flags & TCP_FIN) != 0)
+        {
+          tcp_send(dev, conn, TCP_ACK, tcpiplen);
+          return;
+        }
+
+      goto drop;
+    }
+#endif
+
+#ifdef CONFIG_NET_TCP_CC
+  /* Remember the previous window size.  An ACK that updates the window is
+   * not a duplicate ACK.
+   */
+
+  winsize = conn->winsize;
+#endif
+
   /* Update the connection's window size */
 
   conn->winsize = ((uint16_t)tcp->wnd[0] << 8) + (uint16_t)tcp->wnd[1];
 
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+  /* The window of a SYN segment is never scaled (RFC 7323, section 2.2) */
+
+  if ((conn->tcpoptflags & TCP_OPTF_WS) != 0 && (tcp->flags & TCP_SYN) == 0)
+    {
+      conn->winsize <<= conn->snd_wscale;
+    }
+#endif
+
   flags = 0;
 
   /* We do a very naive form of TCP reset processing; we just accept
@@ -327,6 +575,10 @@ found:
 
   dev->d_len -= (len + iplen);
 
+  /* The data follows the TCP options */
+
+  dev->d_appdata = &dev->d_buf[NET_LL_HDRLEN(dev) + iplen + len];
+
   /* First, check if the sequence number of the incoming packet is
    * what we're expecting next. If not, we send out an ACK with the
    * correct numbers in, unless we are in the SYN_RCVD state and
@@ -342,11 +594,38 @@ found:
       if ((dev->d_len > 0 || ((tcp->flags & (TCP_SYN | TCP_FIN)) != 0)) &&
           memcmp(tcp->seqno, conn->rcvseq, 4) != 0)
         {
+#ifdef CONFIG_NET_TCP_OOSEQ
+          /* Keep the data of a segment that arrived ahead of a missing
+           * segment so that the peer need only resend the missing one.
+           */
+
+          if ((conn->tcpstateflags & TCP_STATE_MASK) == TCP_ESTABLISHED &&
+              (conn->tcpstateflags & TCP_STOPPED) == 0 && dev->d_len > 0 &&
+              (tcp->flags & (TCP_SYN | TCP_FIN | TCP_URG)) == 0)
+            {
+              (void)tcp_ooseq_add(dev, conn, tcp_getsequence(tcp->seqno),
+                                  dev->d_appdata, dev->d_len);
+            }
+#endif
+
           tcp_send(dev, conn, TCP_ACK, tcpiplen);
           return;
         }
     }
 
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  /* Remember the timestamp to echo.  This is the timestamp of the segment
+   * at the left edge of the receive window (RFC 7323, section 4.3).
+   */
+
+  if ((conn->tcpoptflags & TCP_OPTF_TS) != 0 &&
+      (opts.flags & TCP_OPTF_TS) != 0 &&
+      TCP_SEQ_LE(tcp_getsequence(tcp->seqno), tcp_getsequence(conn->rcvseq)))
+    {
+      conn->ts_recent = opts.tsval;
+    }
+#endif
+
   /* Next, check if the incoming segment acknowledges any outstanding
    * data. If so, we update the sequence number, reset the length of
    * the outstanding data, calculate RTT estimations, and reset the
@@ -404,6 +683,43 @@ found:
             }
         }
 
+#ifdef CONFIG_NET_TCP_CC
+      /* Let congestion control account for the ACK, and detect duplicate
+       * ACKs.
+       */
+
+      if ((conn->tcpstateflags & TCP_STATE_MASK) == TCP_ESTABLISHED)
+        {
+#ifdef CONFIG_NET_TCP_SACK
+          if ((conn->tcpoptflags & TCP_OPTF_SACK) != 0)
+            {
+              tcp_sack_update(conn, ackseq, opts.sack, opts.nsack);
+            }
+#endif
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+          /* The echoed timestamp of an ACK of new data is an RTT sample */
+
+          if ((conn->tcpoptflags & TCP_OPTF_TS) != 0 &&
+              (opts.flags & TCP_OPTF_TS) != 0 && opts.tsecr != 0 &&
+              TCP_SEQ_GT(ackseq, conn->cc.lastack))
+            {
+              tcp_cc_rttsample(conn, (TCP_TSCLOCK() - opts.tsecr) * 1000);
+            }
+#endif
+
+          /* A segment that carries no data, no SYN or FIN, does not
+           * update the window and acknowledges nothing new is a duplicate
+           * ACK.
+           */
+
+          dupack = dev->d_len == 0 && winsize == conn->winsize &&
+                   (tcp->flags & (TCP_SYN | TCP_FIN)) == 0 &&
+                   TCP_SEQ_LE(ackseq, conn->cc.lastack);
+          tcp_cc_ack(conn, ackseq, dupack);
+        }
+#endif
+
       /* Update sequence number to the unacknowledge sequence number.  If
        * there is still outstanding, unacknowledged data, then this will
        * be beyond ackseq.
@@ -413,34 +729,44 @@ found:
             conn->sndseq, ackseq, unackseq, conn->unacked);
       tcp_setsequence(conn->sndseq, ackseq);
 
-      /* Do RTT estimation, unless we have done retransmissions. */
+#ifdef CONFIG_NET_TCP_CC
+      /* A duplicate ACK is no RTT sample and does not restart the
+       * retransmission timer (RFC 6298, section 5.3).  The application is
+       * polled below if congestion control has something to send.
+       */
 
-      if (conn->nrtx == 0)
+      if (!dupack)
+#endif
         {
-          signed char m;
-          m = conn->rto - conn->timer;
-
-          /* This is taken directly from VJs original code in his paper */
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+          /* With timestamps, the echoed timestamp gives the RTT, even for
+           * retransmitted data (RFC 7323, section 4.1).
+           */
 
-          m = m - (conn->sa >> 3);
-          conn->sa += m;
-          if (m < 0)
+          if ((conn->tcpoptflags & TCP_OPTF_TS) != 0 &&
+              (opts.flags & TCP_OPTF_TS) != 0 && opts.tsecr != 0)
             {
-              m = -m;
+              uint32_t rtt = (TCP_TSCLOCK() - opts.tsecr) / 500;
+              tcp_rttest(conn, rtt > 127 ? 127 : rtt);
             }
+          else
+#endif
 
-          m = m - (conn->sv >> 2);
-          conn->sv += m;
-          conn->rto = (conn->sa >> 3) + conn->sv;
-        }
+          /* Do RTT estimation, unless we have done retransmissions. */
+
+          if (conn->nrtx == 0)
+            {
+              tcp_rttest(conn, conn->rto - conn->timer);
+            }
 
-        /* Set the acknowledged flag. */
+          /* Set the acknowledged flag. */
 
-       flags |= TCP_ACKDATA;
+          flags |= TCP_ACKDATA;
 
-       /* Reset the retransmission timer. */
+          /* Reset the retransmission timer. */
 
-       conn->timer = conn->rto;
+          conn->timer = conn->rto;
+        }
     }
 
   /* Do different things depending on in what state the connection is. */
@@ -469,6 +795,9 @@ found:
             tcp_setsequence(conn->sndseq, conn->isn);
             conn->sent          = 0;
             conn->sndseq_max    = 0;
+#endif
+#ifdef CONFIG_NET_TCP_CC
+            tcp_cc_init(conn);
 #endif
             conn->unacked       = 0;
             flags               = TCP_CONNECTED;
@@ -505,59 +834,9 @@ found:
 
         if ((flags & TCP_ACKDATA) != 0 && (tcp->flags & TCP_CTL) == (TCP_SYN | TCP_ACK))
           {
-            /* Parse the TCP MSS option, if present. */
+            /* Apply the TCP options, if present. */
 
-            if ((tcp->tcpoffset & 0xf0) > 0x50)
-              {
-                for (i = 0; i < ((tcp->tcpoffset >> 4) - 5) << 2 ; )
-                  {
-                    opt = dev->d_buf[hdrlen + i];
-                    if (opt == TCP_OPT_END)
-                      {
-                        /* End of options. */
-
-                        break;
-                      }
-                    else if (opt == TCP_OPT_NOOP)
-                      {
-                        /* NOP option. */
-
-                        ++i;
-                      }
-                    else if (opt == TCP_OPT_MSS &&
-                              dev->d_buf[hdrlen + 1 + i] == TCP_OPT_MSS_LEN)
-                      {
-                        uint16_t tcp_mss = TCP_MSS(dev, iplen);
-
-                        /* An MSS option with the right option length. */
-
-                        tmp16 =
-                          (dev->d_buf[hdrlen + 2 + i] << 8) |
-                          dev->d_buf[hdrlen + 3 + i];
-                        conn->mss = tmp16 > tcp_mss ? tcp_mss : tmp16;
-
-                        /* And we are done processing options. */
-
-                        break;
-                      }
-                    else
-                      {
-                        /* All other options have a length field, so that we
-                         * easily can skip past them.
-                         */
-
-                        if (dev->d_buf[hdrlen + 1 + i] == 0)
-                          {
-                            /* If the length field is zero, the options are
-                             * malformed and we don't process them further.
-                             */
-
-                            break;
-                          }
-                        i += dev->d_buf[hdrlen + 1 + i];
-                      }
-                  }
-              }
+            tcp_synoptions(dev, conn, &opts, iplen);
 
             conn->tcpstateflags = TCP_ESTABLISHED;
             memcpy(conn->rcvseq, tcp->seqno, 4);
@@ -568,6 +847,9 @@ found:
 #ifdef CONFIG_NET_TCP_WRITE_BUFFERS
             conn->isn           = tcp_getsequence(tcp->ackno);
             tcp_setsequence(conn->sndseq, conn->isn);
+#endif
+#ifdef CONFIG_NET_TCP_CC
+            tcp_cc_init(conn);
 #endif
             dev->d_len          = 0;
             dev->d_sndlen       = 0;
@@ -731,6 +1013,14 @@ found:
                 /* Update the sequence number using the saved length */
 
                 net_incr32(conn->rcvseq, len);
+
+#ifdef CONFIG_NET_TCP_OOSEQ
+                /* The segment may have filled the hole in front of
+                 * retained out-of-order data.
+                 */
+
+                (void)tcp_ooseq_deliver(conn);
+#endif
               }
 
             /* Send the response, ACKing the data or not, as appropriate */
@@ -739,6 +1029,25 @@ found:
             return;
           }
 
+#ifdef CONFIG_NET_TCP_CC
+        /* A duplicate ACK carries no data and acknowledges nothing new, so
+         * the application was not called above.  During fast recovery,
+         * poll the application now so that a lost segment is retransmitted
+         * and the inflated congestion window is used immediately rather
+         * than on the next device poll.
+         */
+
+        if (dupack && conn->cc.state == TCP_CA_RECOVERY)
+          {
+            dev->d_len    = 0;
+            dev->d_sndlen = 0;
+
+            result = tcp_callback(dev, conn, TCP_POLL);
+            tcp_appsend(dev, conn, result);
+            return;
+          }
+#endif
+
         goto drop;
 
       case TCP_LAST_ACK:
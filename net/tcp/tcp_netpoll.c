@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/tcp/tcp_netpoll.c
  *
- *   Copyright (C) 2008-2009, 2011-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2008-2009, 2011-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -44,6 +44,7 @@
 #include <debug.h>
 
 #include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
 #include <nuttx/net/net.h>
 
 #include <devif/devif.h>
@@ -132,7 +133,7 @@ static uint16_t tcp_poll_interrupt(FAR struct net_driver_s *dev, FAR void *conn,
       if (eventset)
         {
           info->fds->revents |= eventset;
-          sem_post(info->fds->sem);
+          poll_notify(info->fds);
         }
     }
 
@@ -211,6 +212,13 @@ int tcp_pollsetup(FAR struct socket *psock, FAR struct pollfd *fds)
   cb->priv     = (FAR void *)info;
   cb->event    = tcp_poll_interrupt;
 
+  /* POLLOUT is reported by the next TCP poll of the connection */
+
+  if ((fds->events & POLLOUT) != 0)
+    {
+      tcp_readyadd(conn);
+    }
+
   /* Save the reference in the poll info structure as fds private as well
    * for use during poll teardown as well.
    */
@@ -292,7 +300,7 @@ int tcp_pollsetup(FAR struct socket *psock, FAR struct pollfd *fds)
     {
       /* Yes.. then signal the poll logic */
 
-      sem_post(fds->sem);
+      poll_notify(fds);
     }
 
   net_unlock();
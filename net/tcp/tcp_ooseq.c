@@ -0,0 +1,444 @@
+/****************************************************************************
+ * net/tcp/tcp_ooseq.c
+ * TCP out-of-order receive queue
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * References:
+ *   RFC 793, Transmission Control Protocol
+ *   RFC 2018, TCP Selective Acknowledgment Options
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_TCP) && defined(CONFIG_NET_TCP_OOSEQ)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/net/netconfig.h>
+#include <nuttx/net/netdev.h>
+#include <nuttx/net/iob.h>
+#include <nuttx/net/tcp.h>
+
+#include "iob/iob.h"
+#include "tcp/tcp.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The sequence number following the data in a block */
+
+#define OOSEQ_END(b)   ((b)->seqno + (b)->iob->io_pktlen)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcp_ooseq_window
+ *
+ * Description:
+ *   Return the number of bytes above rcvseq that the peer may send.  This
+ *   is also limited to the size of one I/O buffer chain.
+ *
+ ****************************************************************************/
+
+static uint32_t tcp_ooseq_window(FAR struct net_driver_s *dev,
+                                 FAR struct tcp_conn_s *conn)
+{
+  uint32_t wnd = NET_DEV_RCVWNDO(dev);
+
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+  if ((conn->tcpoptflags & TCP_OPTF_WS) != 0)
+    {
+      wnd <<= CONFIG_NET_TCP_WINDOW_SHIFT;
+    }
+#endif
+
+  /* io_pktlen is 16 bits wide */
+
+  return wnd > UINT16_MAX ? UINT16_MAX : wnd;
+}
+
+/****************************************************************************
+ * Name: tcp_ooseq_remove
+ *
+ * Description:
+ *   Remove 'nblocks' blocks starting with block 'index' from the queue.
+ *   The I/O buffer chains of the blocks are not freed.
+ *
+ ****************************************************************************/
+
+static void tcp_ooseq_remove(FAR struct tcp_conn_s *conn, int index,
+                             int nblocks)
+{
+  memmove(&conn->ooseq[index], &conn->ooseq[index + nblocks],
+          (conn->nooseq - index - nblocks) * sizeof(struct tcp_ooseq_s));
+  conn->nooseq -= nblocks;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: tcp_ooseq_add
+ *
+ * Description:
+ *   Retain the data of a segment that arrived ahead of the next expected
+ *   sequence number.  The data is merged with the blocks that it overlaps
+ *   or touches.  Data outside of the receive window is discarded.
+ *
+ * Input Parameters:
+ *   dev    - The device that received the segment
+ *   conn   - The TCP connection of interest
+ *   seqno  - The sequence number of the first byte of the data
+ *   buffer - The data
+ *   buflen - The length of the data
+ *
+ * Returned Value:
+ *   OK if the data was retained or was already present; a negated errno
+ *   value if it could not be retained.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+int tcp_ooseq_add(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
+                  uint32_t seqno, FAR const uint8_t *buffer,
+                  uint16_t buflen)
+{
+  FAR struct tcp_ooseq_s *ooseq = conn->ooseq;
+  FAR struct iob_s *iob;
+  uint32_t rcvseq = tcp_getsequence(conn->rcvseq);
+  uint32_t left   = seqno;
+  uint32_t right  = seqno + buflen;
+  uint32_t limit;
+  uint32_t end;
+  bool append = false;
+  bool join;
+  int ret;
+  int i;
+  int j;
+
+  /* Only data above rcvseq and inside of the receive window is kept */
+
+  limit = rcvseq + tcp_ooseq_window(dev, conn);
+  if (buflen == 0 || TCP_SEQ_LE(left, rcvseq) || TCP_SEQ_GE(left, limit))
+    {
+      return -EINVAL;
+    }
+
+  if (TCP_SEQ_GT(right, limit))
+    {
+      right = limit;
+    }
+
+#ifdef CONFIG_NET_TCP_SACK
+  conn->ooseqlast = seqno;
+#endif
+
+  /* Find the first block that does not end before the new data */
+
+  for (i = 0; i < conn->nooseq && TCP_SEQ_LT(OOSEQ_END(&ooseq[i]), left);
+       i++)
+    {
+    }
+
+  /* If that block begins at or before the new data, then the new data is
+   * either a duplicate or it extends the block.
+   */
+
+  if (i < conn->nooseq && TCP_SEQ_LE(ooseq[i].seqno, left))
+    {
+      end = OOSEQ_END(&ooseq[i]);
+      if (TCP_SEQ_GE(end, right))
+        {
+          return OK;
+        }
+
+      buffer += end - left;
+      left    = end;
+      append  = true;
+    }
+
+  /* Discard the blocks that the new data covers completely */
+
+  i = append ? i + 1 : i;
+  for (j = i; j < conn->nooseq && TCP_SEQ_LE(OOSEQ_END(&ooseq[j]), right);
+       j++)
+    {
+      iob_free_chain(ooseq[j].iob);
+    }
+
+  tcp_ooseq_remove(conn, i, j - i);
+
+  /* Block i now follows the new data.  If the new data reaches it, keep
+   * only the part of the new data that precedes it.
+   */
+
+  join = (i < conn->nooseq && TCP_SEQ_LE(ooseq[i].seqno, right));
+  if (join)
+    {
+      right = ooseq[i].seqno;
+    }
+
+  if (append)
+    {
+      /* Extend the preceding block.  If not all of the data fits, the
+       * block is extended only by the part that was copied.
+       */
+
+      iob = ooseq[i - 1].iob;
+      ret = iob_trycopyin(iob, buffer, right - left, iob->io_pktlen, true);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      if (join)
+        {
+          /* The hole between the two blocks is filled */
+
+          iob_concat(iob, ooseq[i].iob);
+          tcp_ooseq_remove(conn, i, 1);
+        }
+
+      return OK;
+    }
+
+  /* Copy the data into a new I/O buffer chain */
+
+  iob = iob_tryalloc(true);
+  if (iob == NULL)
+    {
+      ninfo("No I/O buffer for out-of-order data\n");
+      return -ENOMEM;
+    }
+
+  ret = iob_trycopyin(iob, buffer, right - left, 0, true);
+  if (ret < 0)
+    {
+      ninfo("Failed to copy out-of-order data\n");
+      iob_free_chain(iob);
+      return ret;
+    }
+
+  if (join)
+    {
+      /* Prepend the data to the following block */
+
+      iob_concat(iob, ooseq[i].iob);
+      ooseq[i].seqno = left;
+      ooseq[i].iob   = iob;
+      return OK;
+    }
+
+  /* The data becomes a new block at index i.  If the queue is full, the
+   * highest block is discarded:  The lowest blocks will be in sequence
+   * soonest.
+   */
+
+  if (conn->nooseq >= CONFIG_NET_TCP_OOSEQ_NSEGS)
+    {
+      if (i >= CONFIG_NET_TCP_OOSEQ_NSEGS)
+        {
+          iob_free_chain(iob);
+          return -ENOSPC;
+        }
+
+      conn->nooseq--;
+      iob_free_chain(ooseq[conn->nooseq].iob);
+    }
+
+  memmove(&ooseq[i + 1], &ooseq[i],
+          (conn->nooseq - i) * sizeof(struct tcp_ooseq_s));
+  conn->nooseq++;
+
+  ooseq[i].seqno = left;
+  ooseq[i].iob   = iob;
+  return OK;
+}
+
+/****************************************************************************
+ * Function: tcp_ooseq_deliver
+ *
+ * Description:
+ *   Move the out-of-order data that is now in sequence to the read-ahead
+ *   buffers and advance rcvseq past it.  This is called after rcvseq has
+ *   been advanced by an incoming segment.
+ *
+ * Returned Value:
+ *   The number of bytes by which rcvseq was advanced.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+uint32_t tcp_ooseq_deliver(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_ooseq_s *ooseq = conn->ooseq;
+  FAR struct iob_s *iob;
+  uint32_t rcvseq = tcp_getsequence(conn->rcvseq);
+  uint32_t start  = rcvseq;
+  uint32_t seqno;
+  uint32_t end;
+
+  while (conn->nooseq > 0 && TCP_SEQ_LE(ooseq[0].seqno, rcvseq))
+    {
+      seqno = ooseq[0].seqno;
+      iob   = ooseq[0].iob;
+      end   = OOSEQ_END(&ooseq[0]);
+      tcp_ooseq_remove(conn, 0, 1);
+
+      if (TCP_SEQ_LE(end, rcvseq))
+        {
+          /* The segment that filled the hole covered the whole block */
+
+          iob_free_chain(iob);
+          continue;
+        }
+
+      /* Hand over the I/O buffer chain, less the bytes that were already
+       * received.
+       */
+
+      iob = iob_trimhead(iob, rcvseq - seqno);
+      if (iob_tryadd_queue(iob, &conn->readahead) < 0)
+        {
+          /* The peer will resend the data */
+
+          ninfo("Failed to queue out-of-order data\n");
+          iob_free_chain(iob);
+          break;
+        }
+
+      rcvseq = end;
+    }
+
+  tcp_setsequence(conn->rcvseq, rcvseq);
+  return rcvseq - start;
+}
+
+/****************************************************************************
+ * Function: tcp_ooseq_free
+ *
+ * Description:
+ *   Release all of the out-of-order data of a connection.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+void tcp_ooseq_free(FAR struct tcp_conn_s *conn)
+{
+  while (conn->nooseq > 0)
+    {
+      conn->nooseq--;
+      iob_free_chain(conn->ooseq[conn->nooseq].iob);
+    }
+}
+
+/****************************************************************************
+ * Function: tcp_ooseq_sack
+ *
+ * Description:
+ *   Describe the out-of-order data as SACK blocks (RFC 2018).  The block
+ *   holding the most recently received segment comes first; the others
+ *   follow in sequence order.
+ *
+ * Input Parameters:
+ *   conn      - The TCP connection of interest
+ *   blocks    - Location to return the SACK blocks
+ *   maxblocks - The maximum number of blocks to return
+ *
+ * Returned Value:
+ *   The number of blocks returned.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_SACK
+int tcp_ooseq_sack(FAR struct tcp_conn_s *conn,
+                   FAR struct tcp_sack_s *blocks, int maxblocks)
+{
+  FAR struct tcp_ooseq_s *ooseq = conn->ooseq;
+  int first = -1;
+  int nblocks = 0;
+  int i;
+
+  if (maxblocks <= 0)
+    {
+      return 0;
+    }
+
+  for (i = 0; i < conn->nooseq; i++)
+    {
+      if (TCP_SEQ_LE(ooseq[i].seqno, conn->ooseqlast) &&
+          TCP_SEQ_GT(OOSEQ_END(&ooseq[i]), conn->ooseqlast))
+        {
+          blocks[0].left  = ooseq[i].seqno;
+          blocks[0].right = OOSEQ_END(&ooseq[i]);
+          first           = i;
+          nblocks         = 1;
+          break;
+        }
+    }
+
+  for (i = 0; i < conn->nooseq && nblocks < maxblocks; i++)
+    {
+      if (i != first)
+        {
+          blocks[nblocks].left  = ooseq[i].seqno;
+          blocks[nblocks].right = OOSEQ_END(&ooseq[i]);
+          nblocks++;
+        }
+    }
+
+  return nblocks;
+}
+#endif /* CONFIG_NET_TCP_SACK */
+
+#endif /* CONFIG_NET && CONFIG_NET_TCP && CONFIG_NET_TCP_OOSEQ */
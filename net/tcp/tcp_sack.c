@@ -0,0 +1,337 @@
+/****************************************************************************
+ * net/tcp/tcp_sack.c
+ * TCP selective acknowledgment scoreboard
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * References:
+ *   RFC 2018, TCP Selective Acknowledgment Options
+ *   RFC 6675, A Conservative Loss Recovery Algorithm Based on Selective
+ *             Acknowledgment (SACK) for TCP
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_TCP) && defined(CONFIG_NET_TCP_SACK)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <debug.h>
+
+#include <nuttx/net/netconfig.h>
+#include <nuttx/net/tcp.h>
+
+#include "tcp/tcp.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcp_sack_insert
+ *
+ * Description:
+ *   Add the block [left, right) to the scoreboard, merging it with the
+ *   blocks that it overlaps or touches.  The scoreboard is kept in
+ *   sequence number order.  If the scoreboard is full, the highest block
+ *   is discarded:  The lowest blocks describe the holes that are resent
+ *   first.
+ *
+ ****************************************************************************/
+
+static void tcp_sack_insert(FAR struct tcp_conn_s *conn, uint32_t left,
+                            uint32_t right)
+{
+  FAR struct tcp_sack_s *sack = conn->sack;
+  int i;
+  int j;
+
+  /* Find the first block that does not end before the new block */
+
+  for (i = 0; i < conn->nsack && TCP_SEQ_LT(sack[i].right, left); i++)
+    {
+    }
+
+  /* Absorb all blocks that overlap or touch the new block */
+
+  for (j = i; j < conn->nsack && TCP_SEQ_LE(sack[j].left, right); j++)
+    {
+      if (TCP_SEQ_LT(sack[j].left, left))
+        {
+          left = sack[j].left;
+        }
+
+      if (TCP_SEQ_GT(sack[j].right, right))
+        {
+          right = sack[j].right;
+        }
+    }
+
+  if (j == i)
+    {
+      /* Nothing was absorbed.  Make room for a new block at index i. */
+
+      if (conn->nsack >= TCP_SACK_NBLOCKS)
+        {
+          if (i >= TCP_SACK_NBLOCKS)
+            {
+              return;
+            }
+
+          conn->nsack--;
+        }
+
+      memmove(&sack[i + 1], &sack[i],
+              (conn->nsack - i) * sizeof(struct tcp_sack_s));
+      conn->nsack++;
+    }
+  else if (j > i + 1)
+    {
+      /* Blocks i through j - 1 collapse into the single block at i */
+
+      memmove(&sack[i + 1], &sack[j],
+              (conn->nsack - j) * sizeof(struct tcp_sack_s));
+      conn->nsack -= j - i - 1;
+    }
+
+  sack[i].left  = left;
+  sack[i].right = right;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: tcp_sack_reset
+ *
+ * Description:
+ *   Discard the SACK scoreboard of a connection.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+void tcp_sack_reset(FAR struct tcp_conn_s *conn)
+{
+  conn->nsack     = 0;
+  conn->rexmitnxt = conn->cc.lastack;
+}
+
+/****************************************************************************
+ * Function: tcp_sack_update
+ *
+ * Description:
+ *   Update the SACK scoreboard on receipt of an ACK:  Forget the data that
+ *   is now covered by the ACK number and merge in the SACK blocks of the
+ *   incoming segment.
+ *
+ * Input Parameters:
+ *   conn    - The TCP connection of interest
+ *   ackno   - The ACK number of the incoming segment
+ *   blocks  - The SACK blocks of the incoming segment
+ *   nblocks - The number of SACK blocks
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+void tcp_sack_update(FAR struct tcp_conn_s *conn, uint32_t ackno,
+                     FAR const struct tcp_sack_s *blocks, int nblocks)
+{
+  FAR struct tcp_sack_s *sack = conn->sack;
+  uint32_t left;
+  uint32_t right;
+  int i;
+  int j;
+
+  /* Drop the blocks below the ACK number and trim the block that the ACK
+   * number falls into.
+   */
+
+  for (i = 0, j = 0; i < conn->nsack; i++)
+    {
+      if (TCP_SEQ_GT(sack[i].right, ackno))
+        {
+          sack[j].left  = TCP_SEQ_GT(sack[i].left, ackno) ?
+                          sack[i].left : ackno;
+          sack[j].right = sack[i].right;
+          j++;
+        }
+    }
+
+  conn->nsack = j;
+
+  /* Merge in the new blocks.  Blocks that are malformed, that report data
+   * below the ACK number (D-SACK, RFC 2883) or data that was never sent
+   * are ignored.
+   */
+
+  for (i = 0; i < nblocks; i++)
+    {
+      left  = blocks[i].left;
+      right = blocks[i].right;
+
+      if (TCP_SEQ_GE(left, right) || TCP_SEQ_LE(right, ackno) ||
+          TCP_SEQ_GT(right, conn->cc.sndmax))
+        {
+          ninfo("Ignoring SACK block %u-%u ackno=%u\n", left, right, ackno);
+          continue;
+        }
+
+      if (TCP_SEQ_LT(left, ackno))
+        {
+          left = ackno;
+        }
+
+      tcp_sack_insert(conn, left, right);
+    }
+}
+
+/****************************************************************************
+ * Function: tcp_sack_skip
+ *
+ * Description:
+ *   Return the number of bytes starting at sequence number 'seqno' that the
+ *   peer has already received.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+uint32_t tcp_sack_skip(FAR struct tcp_conn_s *conn, uint32_t seqno)
+{
+  FAR struct tcp_sack_s *sack = conn->sack;
+  int i;
+
+  for (i = 0; i < conn->nsack && TCP_SEQ_LE(sack[i].left, seqno); i++)
+    {
+      if (TCP_SEQ_LT(seqno, sack[i].right))
+        {
+          return sack[i].right - seqno;
+        }
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Function: tcp_sack_hole
+ *
+ * Description:
+ *   Return the number of bytes from sequence number 'seqno' up to the next
+ *   block that the peer has received, or UINT32_MAX if there is none.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+uint32_t tcp_sack_hole(FAR struct tcp_conn_s *conn, uint32_t seqno)
+{
+  FAR struct tcp_sack_s *sack = conn->sack;
+  int i;
+
+  for (i = 0; i < conn->nsack; i++)
+    {
+      if (TCP_SEQ_GT(sack[i].left, seqno))
+        {
+          return sack[i].left - seqno;
+        }
+    }
+
+  return UINT32_MAX;
+}
+
+/****************************************************************************
+ * Function: tcp_sack_rexmit
+ *
+ * Description:
+ *   Select the data to resend next during fast recovery:  The first byte
+ *   at or after conn->rexmitnxt that the peer has not received and that
+ *   lies below the highest SACKed byte.  Without SACK information, this
+ *   is the oldest un-ACKed byte.
+ *
+ * Input Parameters:
+ *   conn  - The TCP connection of interest
+ *   seqno - Location to return the sequence number to resend
+ *   len   - Location to return the size of the hole at seqno
+ *
+ * Returned Value:
+ *   true if there is data to resend.
+ *
+ * Assumptions:
+ *   Called from network stack logic with the network stack locked
+ *
+ ****************************************************************************/
+
+bool tcp_sack_rexmit(FAR struct tcp_conn_s *conn, FAR uint32_t *seqno,
+                     FAR uint32_t *len)
+{
+  uint32_t seq = conn->cc.lastack;
+
+  if (conn->nsack == 0)
+    {
+      *seqno = seq;
+      *len   = UINT32_MAX;
+      return true;
+    }
+
+  /* Do not resend the holes that were already resent in this recovery */
+
+  if (TCP_SEQ_GT(conn->rexmitnxt, seq))
+    {
+      seq = conn->rexmitnxt;
+    }
+
+  seq += tcp_sack_skip(conn, seq);
+
+  /* Data above the highest SACKed byte is not known to be lost */
+
+  if (TCP_SEQ_GE(seq, conn->sack[conn->nsack - 1].right))
+    {
+      return false;
+    }
+
+  *seqno = seq;
+  *len   = tcp_sack_hole(conn, seq);
+  return true;
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_TCP && CONFIG_NET_TCP_SACK */
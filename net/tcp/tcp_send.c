@@ -1,7 +1,8 @@
 /****************************************************************************
  * net/tcp/tcp_send.c
  *
- *   Copyright (C) 2007-2010, 2012, 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2010, 2012, 2015, 2017 Gregory Nutt. All rights
+ *     reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Adapted for NuttX from logic in uIP which also has a BSD-like license:
@@ -284,6 +285,97 @@ static void tcp_sendcomplete(FAR struct net_driver_s *dev,
 #endif
 }
 
+/****************************************************************************
+ * Name: tcp_timestamps
+ *
+ * Description:
+ *   Add the timestamps option, padded with two NOPs, at 'opt'.
+ *
+ * Parameters:
+ *   conn - The TCP connection structure holding connection information
+ *   opt  - The location of the option in the TCP header
+ *
+ * Return:
+ *   The size of the option
+ *
+ * Assumptions:
+ *   Called with the network locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+static unsigned int tcp_timestamps(FAR struct tcp_conn_s *conn,
+                                   FAR uint8_t *opt)
+{
+  uint32_t tsval = TCP_TSCLOCK();
+
+  opt[0]  = TCP_OPT_NOOP;
+  opt[1]  = TCP_OPT_NOOP;
+  opt[2]  = TCP_OPT_TS;
+  opt[3]  = TCP_OPT_TS_LEN;
+  opt[4]  = tsval >> 24;
+  opt[5]  = (tsval >> 16) & 0xff;
+  opt[6]  = (tsval >> 8) & 0xff;
+  opt[7]  = tsval & 0xff;
+  opt[8]  = conn->ts_recent >> 24;
+  opt[9]  = (conn->ts_recent >> 16) & 0xff;
+  opt[10] = (conn->ts_recent >> 8) & 0xff;
+  opt[11] = conn->ts_recent & 0xff;
+  return TCP_OPT_TS_ALIGNED;
+}
+#endif
+
+/****************************************************************************
+ * Name: tcp_sackblocks
+ *
+ * Description:
+ *   Add the SACK option, padded with two NOPs, at 'opt'.  The option
+ *   reports the out-of-order data that has been received.
+ *
+ * Parameters:
+ *   conn  - The TCP connection structure holding connection information
+ *   opt   - The location of the option in the TCP header
+ *   space - The number of bytes available for the option
+ *
+ * Return:
+ *   The size of the option; zero if there is nothing to report
+ *
+ * Assumptions:
+ *   Called with the network locked.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_TCP_SACK) && defined(CONFIG_NET_TCP_OOSEQ)
+static unsigned int tcp_sackblocks(FAR struct tcp_conn_s *conn,
+                                   FAR uint8_t *opt, unsigned int space)
+{
+  struct tcp_sack_s blocks[TCP_SACK_NBLOCKS];
+  FAR uint8_t *ptr;
+  int nblocks;
+  int i;
+
+  nblocks = tcp_ooseq_sack(conn, blocks,
+                           (space - 4) / TCP_OPT_SACK_BLKLEN);
+  if (nblocks <= 0)
+    {
+      return 0;
+    }
+
+  opt[0] = TCP_OPT_NOOP;
+  opt[1] = TCP_OPT_NOOP;
+  opt[2] = TCP_OPT_SACK;
+  opt[3] = 2 + nblocks * TCP_OPT_SACK_BLKLEN;
+
+  for (i = 0, ptr = &opt[4]; i < nblocks; i++, ptr += TCP_OPT_SACK_BLKLEN)
+    {
+      tcp_setsequence(ptr, blocks[i].left);
+      tcp_setsequence(ptr + 4, blocks[i].right);
+    }
+
+  return 4 + nblocks * TCP_OPT_SACK_BLKLEN;
+}
+#endif
+
 /****************************************************************************
  * Name: tcp_sendcommon
  *
@@ -391,10 +483,56 @@ void tcp_send(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
               uint16_t flags, uint16_t len)
 {
   FAR struct tcp_hdr_s *tcp = tcp_header(dev);
+  FAR uint8_t *opt = (FAR uint8_t *)tcp + TCP_HDRLEN;
+  unsigned int optlen = 0;
+  unsigned int paylen;
+
+  paylen = len - (opt - &dev->d_buf[NET_LL_HDRLEN(dev)]);
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  /* Once negotiated, the timestamps option is sent in every segment but
+   * resets.
+   */
+
+  if ((conn->tcpoptflags & TCP_OPTF_TS) != 0 && (flags & TCP_RST) == 0)
+    {
+      optlen = TCP_OPT_TS_ALIGNED;
+    }
+#endif
+
+#if defined(CONFIG_NET_TCP_SACK) && defined(CONFIG_NET_TCP_OOSEQ)
+  /* Report out-of-order data in ACKs without payload.  The payload of a
+   * data segment would not leave room for the option within the MSS.
+   */
+
+  if ((conn->tcpoptflags & TCP_OPTF_SACK) != 0 && conn->nooseq > 0 &&
+      paylen == 0 && (flags & (TCP_RST | TCP_SYN)) == 0)
+    {
+      optlen += tcp_sackblocks(conn, opt + optlen,
+                               TCP_MAX_OPTLEN - optlen);
+    }
+#endif
+
+  /* The payload, if any, is at d_appdata.  That is not where it belongs if
+   * we add options or if d_appdata still refers to the payload of an
+   * incoming segment that carried options.
+   */
+
+  if (paylen > 0 && (FAR uint8_t *)dev->d_appdata != opt + optlen)
+    {
+      memmove(opt + optlen, dev->d_appdata, paylen);
+    }
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  if ((conn->tcpoptflags & TCP_OPTF_TS) != 0 && (flags & TCP_RST) == 0)
+    {
+      (void)tcp_timestamps(conn, opt);
+    }
+#endif
 
   tcp->flags     = flags;
-  dev->d_len     = len;
-  tcp->tcpoffset = (TCP_HDRLEN / 4) << 4;
+  dev->d_len     = len + optlen;
+  tcp->tcpoffset = ((TCP_HDRLEN + optlen) / 4) << 4;
   tcp_sendcommon(dev, conn, tcp);
 }
 
@@ -536,7 +674,12 @@ void tcp_ack(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
              uint8_t ack)
 {
   struct tcp_hdr_s *tcp;
+  FAR uint8_t *opt;
+  unsigned int optlen;
   uint16_t tcp_mss;
+#ifdef HAVE_TCP_OPTIONS
+  uint8_t optflags;
+#endif
 
   /* Get values that vary with the underlying IP domain */
 
@@ -550,9 +693,9 @@ void tcp_ack(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
       tcp     = TCPIPv6BUF;
       tcp_mss = TCP_IPv6_MSS(dev);
 
-      /* Set the the packet length for the TCP Maximum Segment Size */
+      /* Set the the packet length for the TCP header without options */
 
-      dev->d_len  = IPv6TCP_HDRLEN + TCP_OPT_MSS_LEN;
+      dev->d_len  = IPv6TCP_HDRLEN;
     }
 #endif /* CONFIG_NET_IPv6 */
 
@@ -566,23 +709,78 @@ void tcp_ack(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
       tcp     = TCPIPv4BUF;
       tcp_mss = TCP_IPv4_MSS(dev);
 
-      /* Set the the packet length for the TCP Maximum Segment Size */
+      /* Set the the packet length for the TCP header without options */
 
-      dev->d_len  = IPv4TCP_HDRLEN + TCP_OPT_MSS_LEN;
+      dev->d_len  = IPv4TCP_HDRLEN;
     }
 #endif /* CONFIG_NET_IPv4 */
 
   /* Save the ACK bits */
 
-  tcp->flags      = ack;
+  tcp->flags = ack;
 
   /* We send out the TCP Maximum Segment Size option with our ack. */
 
-  tcp->optdata[0] = TCP_OPT_MSS;
-  tcp->optdata[1] = TCP_OPT_MSS_LEN;
-  tcp->optdata[2] = tcp_mss >> 8;
-  tcp->optdata[3] = tcp_mss & 0xff;
-  tcp->tcpoffset  = ((TCP_HDRLEN + TCP_OPT_MSS_LEN) / 4) << 4;
+  opt        = (FAR uint8_t *)tcp + TCP_HDRLEN;
+  opt[0]     = TCP_OPT_MSS;
+  opt[1]     = TCP_OPT_MSS_LEN;
+  opt[2]     = tcp_mss >> 8;
+  opt[3]     = tcp_mss & 0xff;
+  optlen     = TCP_OPT_MSS_LEN;
+
+#ifdef HAVE_TCP_OPTIONS
+  /* A SYN offers all of the options that we support.  A SYNACK accepts
+   * those that the peer offered in its SYN.
+   */
+
+  if ((ack & TCP_ACK) == 0)
+    {
+      optflags = 0;
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+      optflags |= TCP_OPTF_WS;
+#endif
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+      optflags |= TCP_OPTF_TS;
+#endif
+#ifdef CONFIG_NET_TCP_SACK
+      optflags |= TCP_OPTF_SACK;
+#endif
+    }
+  else
+    {
+      optflags = conn->tcpoptflags;
+    }
+
+#ifdef CONFIG_NET_TCP_WINDOW_SCALE
+  if ((optflags & TCP_OPTF_WS) != 0)
+    {
+      opt[optlen++] = TCP_OPT_NOOP;
+      opt[optlen++] = TCP_OPT_WS;
+      opt[optlen++] = TCP_OPT_WS_LEN;
+      opt[optlen++] = CONFIG_NET_TCP_WINDOW_SHIFT;
+    }
+#endif
+
+#ifdef CONFIG_NET_TCP_SACK
+  if ((optflags & TCP_OPTF_SACK) != 0)
+    {
+      opt[optlen++] = TCP_OPT_NOOP;
+      opt[optlen++] = TCP_OPT_NOOP;
+      opt[optlen++] = TCP_OPT_SACKPERM;
+      opt[optlen++] = TCP_OPT_SACKPERM_LEN;
+    }
+#endif
+
+#ifdef CONFIG_NET_TCP_TIMESTAMPS
+  if ((optflags & TCP_OPTF_TS) != 0)
+    {
+      optlen += tcp_timestamps(conn, &opt[optlen]);
+    }
+#endif
+#endif /* HAVE_TCP_OPTIONS */
+
+  dev->d_len    += optlen;
+  tcp->tcpoffset = ((TCP_HDRLEN + optlen) / 4) << 4;
 
   /* Complete the common portions of the TCP message */
 
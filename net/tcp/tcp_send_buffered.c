@@ -311,6 +311,183 @@ static inline bool psock_send_addrchck(FAR struct tcp_conn_s *conn)
 #  define psock_send_addrchck(r) (true)
 #endif /* CONFIG_NET_ETHERNET */
 
+/****************************************************************************
+ * Function: psock_send_fastrexmit
+ *
+ * Description:
+ *   Retransmit one segment of un-ACKed data.  This is requested by the
+ *   congestion control logic on the third duplicate ACK and on a partial
+ *   ACK during fast recovery.  Without SACK, the oldest un-ACKed segment
+ *   is resent; with SACK, the next hole in the scoreboard is resent.
+ *   Unlike a retransmission on a timeout, only this one segment is resent
+ *   and the write buffer queues are not changed.
+ *
+ * Parameters:
+ *   dev   - The structure of the network driver that caused the interrupt
+ *   conn  - The TCP connection structure
+ *
+ * Returned Value:
+ *   true if a segment was set up for sending.
+ *
+ * Assumptions:
+ *   Running at the interrupt level
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_CC
+static bool psock_send_fastrexmit(FAR struct net_driver_s *dev,
+                                  FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_wrbuffer_s *wrb;
+  FAR sq_entry_t *entry;
+  uint32_t seqno;
+  uint32_t offset;
+  uint32_t maxlen;
+  size_t sndlen;
+
+#ifdef CONFIG_NET_TCP_SACK
+  if (!tcp_sack_rexmit(conn, &seqno, &maxlen))
+    {
+      return false;
+    }
+#else
+  seqno  = conn->cc.lastack;
+  maxlen = UINT32_MAX;
+#endif
+
+  /* Find the write buffer that holds the data:  A buffer in the unacked_q
+   * or the partially sent write buffer at the head of the write_q.
+   */
+
+  for (entry = sq_peek(&conn->unacked_q); entry; entry = sq_next(entry))
+    {
+      wrb = (FAR struct tcp_wrbuffer_s *)entry;
+      if (seqno - WRB_SEQNO(wrb) < WRB_SENT(wrb))
+        {
+          break;
+        }
+    }
+
+  if (entry == NULL)
+    {
+      wrb = (FAR struct tcp_wrbuffer_s *)sq_peek(&conn->write_q);
+      if (wrb == NULL || WRB_SENT(wrb) == 0 ||
+          seqno - WRB_SEQNO(wrb) >= WRB_SENT(wrb))
+        {
+          return false;
+        }
+    }
+
+  if (!psock_send_addrchck(conn))
+    {
+      return false;
+    }
+
+  offset = seqno - WRB_SEQNO(wrb);
+  sndlen = WRB_SENT(wrb) - offset;
+  if (sndlen > conn->mss)
+    {
+      sndlen = conn->mss;
+    }
+
+  if (sndlen > maxlen)
+    {
+      sndlen = maxlen;
+    }
+
+  ninfo("FASTREXMIT: wrb=%p seqno=%u sndlen=%u\n", wrb, seqno, sndlen);
+
+  tcp_setsequence(conn->sndseq, seqno);
+
+#ifdef NEED_IPDOMAIN_SUPPORT
+  send_ipselect(dev, conn);
+#endif
+  devif_iob_send(dev, WRB_IOB(wrb), sndlen, offset);
+
+#ifdef CONFIG_NET_TCP_SACK
+  conn->rexmitnxt = seqno + sndlen;
+#endif
+  return true;
+}
+#endif
+
+/****************************************************************************
+ * Function: psock_send_skipsacked
+ *
+ * Description:
+ *   When data is resent after a retransmission timeout, skip the data at
+ *   the head of the write_q that the peer has already ACKed or selectively
+ *   ACKed.  Write buffers that are skipped entirely are moved to the
+ *   unacked_q.
+ *
+ * Parameters:
+ *   conn  - The TCP connection structure
+ *
+ * Returned Value:
+ *   The write buffer at the head of the write_q or NULL if the write_q is
+ *   now empty.
+ *
+ * Assumptions:
+ *   Running at the interrupt level
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_SACK
+static FAR struct tcp_wrbuffer_s *
+psock_send_skipsacked(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_wrbuffer_s *wrb;
+  uint32_t seqno;
+  uint32_t nskip;
+
+  while ((wrb = (FAR struct tcp_wrbuffer_s *)sq_peek(&conn->write_q)) != NULL &&
+         WRB_SEQNO(wrb) != (unsigned)-1)
+    {
+      /* The ACK number may also have moved past the data:  The peer may
+       * have ACKed everything that it selectively ACKed before.
+       */
+
+      seqno = WRB_SEQNO(wrb) + WRB_SENT(wrb);
+      if (TCP_SEQ_LT(seqno, conn->cc.lastack))
+        {
+          nskip = conn->cc.lastack - seqno;
+        }
+      else
+        {
+          nskip = tcp_sack_skip(conn, seqno);
+        }
+
+      if (nskip == 0)
+        {
+          break;
+        }
+
+      if (nskip > WRB_PKTLEN(wrb) - WRB_SENT(wrb))
+        {
+          nskip = WRB_PKTLEN(wrb) - WRB_SENT(wrb);
+        }
+
+      ninfo("SKIP: wrb=%p seqno=%u nskip=%u\n", wrb, seqno, nskip);
+
+      /* Account for the skipped data as if it had been sent */
+
+      WRB_SENT(wrb) += nskip;
+      conn->unacked += nskip;
+      conn->sent    += nskip;
+
+      if (WRB_SENT(wrb) < WRB_PKTLEN(wrb))
+        {
+          break;
+        }
+
+      (void)sq_remfirst(&conn->write_q);
+      psock_insert_segment(wrb, &conn->unacked_q);
+    }
+
+  return wrb;
+}
+#endif
+
 /****************************************************************************
  * Function: psock_send_interrupt
  *
@@ -453,7 +630,7 @@ static uint16_t psock_send_interrupt(FAR struct net_driver_s *dev,
                   ninfo("ACK: wrb=%p trim %u bytes\n", wrb, trimlen);
 
                   WRB_TRIM(wrb, trimlen);
-                  WRB_SEQNO(wrb) = ackno;
+                  WRB_SEQNO(wrb) += trimlen;
                   WRB_SENT(wrb) -= trimlen;
 
                   /* Set the new sequence number for what remains */
@@ -487,10 +664,14 @@ static uint16_t psock_send_interrupt(FAR struct net_driver_s *dev,
           ninfo("ACK: wrb=%p seqno=%u nacked=%u sent=%u ackno=%u\n",
                 wrb, WRB_SEQNO(wrb), nacked, WRB_SENT(wrb), ackno);
 
-          /* Trim the ACKed bytes from the beginning of the write buffer. */
+          /* Trim the ACKed bytes from the beginning of the write buffer.
+           * After a retransmission timeout, the ACK may cover data that
+           * has not been sent again.  Only the data that was sent is
+           * trimmed so that the sequence number stays with the data.
+           */
 
           WRB_TRIM(wrb, nacked);
-          WRB_SEQNO(wrb) = ackno;
+          WRB_SEQNO(wrb) += nacked;
           WRB_SENT(wrb) -= nacked;
 
           ninfo("ACK: wrb=%p seqno=%u pktlen=%u sent=%u\n",
@@ -677,6 +858,25 @@ static uint16_t psock_send_interrupt(FAR struct net_driver_s *dev,
       return flags;
     }
 
+#ifdef CONFIG_NET_TCP_CC
+  /* Has congestion control detected a lost segment?  If so, resend it now
+   * rather than waiting for the retransmission timeout.  This cannot be
+   * done if the packet buffer still holds incoming data.
+   */
+
+  if ((conn->cc.flags & TCP_CC_FASTREXMIT) != 0 &&
+      (conn->tcpstateflags & TCP_ESTABLISHED) &&
+      (flags & TCP_NEWDATA) == 0)
+    {
+      conn->cc.flags &= ~TCP_CC_FASTREXMIT;
+      if (psock_send_fastrexmit(dev, conn))
+        {
+          flags &= ~TCP_POLL;
+          return flags;
+        }
+    }
+#endif
+
   /* We get here if (1) not all of the data has been ACKed, (2) we have been
    * asked to retransmit data, (3) the connection is still healthy, and (4)
    * the outgoing packet is available for our use.  In this case, we are
@@ -685,9 +885,21 @@ static uint16_t psock_send_interrupt(FAR struct net_driver_s *dev,
    * next polling cycle.
    */
 
+#ifdef CONFIG_NET_TCP_CC
+  /* With congestion control, each ACK of new data may also clock out more
+   * data, but only as much as the congestion window allows.
+   */
+
+  if ((conn->tcpstateflags & TCP_ESTABLISHED) &&
+      (flags & (TCP_POLL | TCP_REXMIT | TCP_ACKDATA)) &&
+      (flags & TCP_NEWDATA) == 0 &&
+      !(sq_empty(&conn->write_q)) &&
+      tcp_cc_sndwnd(conn) > 0)
+#else
   if ((conn->tcpstateflags & TCP_ESTABLISHED) &&
       (flags & (TCP_POLL | TCP_REXMIT)) &&
       !(sq_empty(&conn->write_q)))
+#endif
     {
       /* Check if the destination IP address is in the ARP  or Neighbor
        * table.  If not, then the send won't actually make it out... it
@@ -698,6 +910,7 @@ static uint16_t psock_send_interrupt(FAR struct net_driver_s *dev,
         {
           FAR struct tcp_wrbuffer_s *wrb;
           uint32_t predicted_seqno;
+          uint32_t sndwnd;
           size_t sndlen;
 
           /* Peek at the head of the write queue (but don't remove anything
@@ -705,13 +918,21 @@ static uint16_t psock_send_interrupt(FAR struct net_driver_s *dev,
            * the write_q is not empty.
            */
 
+#ifdef CONFIG_NET_TCP_SACK
+          wrb = psock_send_skipsacked(conn);
+          if (wrb == NULL)
+            {
+              return flags;
+            }
+#else
           wrb = (FAR struct tcp_wrbuffer_s *)sq_peek(&conn->write_q);
           DEBUGASSERT(wrb);
+#endif
 
           /* Get the amount of data that we can send in the next packet.
            * We will send either the remaining data in the buffer I/O
            * buffer chain, or as much as will fit given the MSS and current
-           * window size.
+           * window size (and the congestion window).
            */
 
           sndlen = WRB_PKTLEN(wrb) - WRB_SENT(wrb);
@@ -720,11 +941,35 @@ static uint16_t psock_send_interrupt(FAR struct net_driver_s *dev,
               sndlen = conn->mss;
             }
 
-          if (sndlen > conn->winsize)
+#ifdef CONFIG_NET_TCP_CC
+          sndwnd = tcp_cc_sndwnd(conn);
+#else
+          sndwnd = conn->winsize;
+#endif
+          if (sndlen > sndwnd)
             {
-              sndlen = conn->winsize;
+              sndlen = sndwnd;
             }
 
+#ifdef CONFIG_NET_TCP_SACK
+          /* When resending, stop at the next data that the peer has */
+
+          if (WRB_SEQNO(wrb) != (unsigned)-1)
+            {
+              uint32_t hole = tcp_sack_hole(conn,
+                                            WRB_SEQNO(wrb) + WRB_SENT(wrb));
+              if (sndlen > hole)
+                {
+                  sndlen = hole;
+                }
+            }
+
+          if (sndlen == 0)
+            {
+              return flags;
+            }
+#endif
+
           ninfo("SEND: wrb=%p pktlen=%u sent=%u sndlen=%u\n",
                 wrb, WRB_PKTLEN(wrb), WRB_SENT(wrb), sndlen);
 
@@ -763,6 +1008,12 @@ static uint16_t psock_send_interrupt(FAR struct net_driver_s *dev,
 
           devif_iob_send(dev, WRB_IOB(wrb), sndlen, WRB_SENT(wrb));
 
+#ifdef CONFIG_NET_TCP_CC
+          /* Let congestion control time the segment for RTT estimation */
+
+          tcp_cc_sent(conn, WRB_SEQNO(wrb) + WRB_SENT(wrb), sndlen);
+#endif
+
           /* Remember how much data we send out now so that we know
            * when everything has been acknowledged.  Just increment
            * the amount of data sent. This will be needed in sequence
@@ -846,6 +1097,10 @@ static uint16_t psock_send_interrupt(FAR struct net_driver_s *dev,
 static inline void send_txnotify(FAR struct socket *psock,
                                  FAR struct tcp_conn_s *conn)
 {
+  /* Make sure that the next poll includes this connection */
+
+  tcp_readyadd(conn);
+
 #ifdef CONFIG_NET_IPv4
 #ifdef CONFIG_NET_IPv6
   /* If both IPv4 and IPv6 support are enabled, then we will need to select
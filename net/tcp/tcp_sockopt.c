@@ -0,0 +1,232 @@
+/****************************************************************************
+ * net/tcp/tcp_sockopt.c
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_TCP) && defined(CONFIG_NET_TCP_CC)
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <netinet/tcp.h>
+
+#include <nuttx/net/net.h>
+#include <nuttx/net/tcp.h>
+
+#include "tcp/tcp.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* conn->rto is in units of half seconds */
+
+#define RTO2USEC(rto)  ((uint32_t)(rto) * 500000)
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: tcp_getsockopt
+ *
+ * Description:
+ *   Get the value of a socket option at the IPPROTO_TCP level.  See
+ *   <netinet/tcp.h> for the supported options.
+ *
+ * Parameters:
+ *   psock     Socket structure of the socket to query
+ *   option    identifies the option to get
+ *   value     Points to the argument value
+ *   value_len The length of the argument value
+ *
+ * Returned Value:
+ *   OK on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int tcp_getsockopt(FAR struct socket *psock, int option,
+                   FAR void *value, FAR socklen_t *value_len)
+{
+  FAR struct tcp_conn_s *conn;
+  int ret = OK;
+
+  if (psock->s_type != SOCK_STREAM || psock->s_conn == NULL ||
+      (psock->s_domain != PF_INET && psock->s_domain != PF_INET6))
+    {
+      return -ENOPROTOOPT;
+    }
+
+  conn = (FAR struct tcp_conn_s *)psock->s_conn;
+
+  net_lock();
+  switch (option)
+    {
+      case TCP_INFO:
+        {
+          FAR struct tcp_cc_s *cc = &conn->cc;
+          struct tcp_info info;
+
+          memset(&info, 0, sizeof(struct tcp_info));
+          info.tcpi_state         = conn->tcpstateflags & TCP_STATE_MASK;
+          info.tcpi_ca_state      = cc->state;
+          info.tcpi_retransmits   = conn->nrtx;
+          info.tcpi_rto           = RTO2USEC(conn->rto);
+          info.tcpi_snd_mss       = conn->mss;
+          info.tcpi_rtt           = cc->srtt;
+          info.tcpi_rttvar        = cc->rttvar;
+          info.tcpi_snd_ssthresh  = cc->ssthresh;
+          info.tcpi_snd_cwnd      = cc->cwnd;
+          info.tcpi_snd_wnd       = conn->winsize;
+          info.tcpi_unacked       = conn->unacked;
+          info.tcpi_total_retrans = cc->nrto;
+          info.tcpi_fast_retrans  = cc->nfastrexmit;
+
+          /* The value is silently truncated if the buffer is too small */
+
+          if (*value_len > sizeof(struct tcp_info))
+            {
+              *value_len = sizeof(struct tcp_info);
+            }
+
+          memcpy(value, &info, *value_len);
+        }
+        break;
+
+      case TCP_CONGESTION:
+        {
+          FAR const char *name = "";
+          socklen_t len;
+
+          if (conn->cc.ops != NULL)
+            {
+              name = conn->cc.ops->name;
+            }
+
+          len = strlen(name) + 1;
+          if (*value_len < len)
+            {
+              ret = -EINVAL;
+              break;
+            }
+
+          memcpy(value, name, len);
+          *value_len = len;
+        }
+        break;
+
+      default:
+        ret = -ENOPROTOOPT;
+        break;
+    }
+
+  net_unlock();
+  return ret;
+}
+
+/****************************************************************************
+ * Function: tcp_setsockopt
+ *
+ * Description:
+ *   Set the value of a socket option at the IPPROTO_TCP level.  See
+ *   <netinet/tcp.h> for the supported options.
+ *
+ * Parameters:
+ *   psock     Socket structure of socket to operate on
+ *   option    identifies the option to set
+ *   value     Points to the argument value
+ *   value_len The length of the argument value
+ *
+ * Returned Value:
+ *   OK on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int tcp_setsockopt(FAR struct socket *psock, int option,
+                   FAR const void *value, socklen_t value_len)
+{
+  FAR struct tcp_conn_s *conn;
+  int ret;
+
+  if (psock->s_type != SOCK_STREAM || psock->s_conn == NULL ||
+      (psock->s_domain != PF_INET && psock->s_domain != PF_INET6))
+    {
+      return -ENOPROTOOPT;
+    }
+
+  conn = (FAR struct tcp_conn_s *)psock->s_conn;
+
+  switch (option)
+    {
+      case TCP_CONGESTION:
+        {
+          char name[TCP_CA_NAME_MAX];
+
+          /* The name need not be NUL terminated */
+
+          if (value_len == 0 || value_len >= TCP_CA_NAME_MAX)
+            {
+              return -EINVAL;
+            }
+
+          memcpy(name, value, value_len);
+          name[value_len] = '\0';
+
+          net_lock();
+          ret = tcp_cc_select(conn, name);
+          net_unlock();
+        }
+        break;
+
+      case TCP_INFO:
+        ret = -EINVAL;
+        break;
+
+      default:
+        ret = -ENOPROTOOPT;
+        break;
+    }
+
+  return ret;
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_TCP && CONFIG_NET_TCP_CC */
@@ -72,6 +72,17 @@
 #define IPv4BUF ((struct ipv4_hdr_s *)&dev->d_buf[NET_LL_HDRLEN(dev)])
 #define IPv6BUF ((struct ipv6_hdr_s *)&dev->d_buf[NET_LL_HDRLEN(dev)])
 
+#ifdef CONFIG_NET_UDP_CONNHASH
+#  if (CONFIG_NET_UDP_CONNHASH_SIZE & (CONFIG_NET_UDP_CONNHASH_SIZE - 1)) != 0
+#    error CONFIG_NET_UDP_CONNHASH_SIZE must be a power of two
+#  endif
+
+/* Reduce a local port number (network byte order) to a hash table index */
+
+#  define udp_porthash(p) \
+     ((unsigned int)((p) ^ ((p) >> 8)) & (CONFIG_NET_UDP_CONNHASH_SIZE - 1))
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -93,6 +104,14 @@ static dq_queue_t g_active_udp_connections;
 
 static uint16_t g_last_udp_port;
 
+#ifdef CONFIG_NET_UDP_CONNHASH
+/* All connections with a local port assigned, hashed by the local port.
+ * These are chained through the pnext field.
+ */
+
+static FAR struct udp_conn_s *g_udp_porthash[CONFIG_NET_UDP_CONNHASH_SIZE];
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -121,6 +140,70 @@ static inline void _udp_semtake(FAR sem_t *sem)
 
 #define _udp_semgive(sem) sem_post(sem)
 
+/****************************************************************************
+ * Name: udp_setlport()
+ *
+ * Description:
+ *   Assign a local port number (in network byte order) to the connection,
+ *   keeping the local port hash table up to date.  A port number of zero
+ *   unbinds the connection.
+ *
+ *   New connections are added to the end of their hash chain so that
+ *   lookups find connections in the same order as a search of the active
+ *   list would.
+ *
+ ****************************************************************************/
+
+static void udp_setlport(FAR struct udp_conn_s *conn, uint16_t lport)
+{
+#ifdef CONFIG_NET_UDP_CONNHASH
+  FAR struct udp_conn_s **link;
+
+  if (conn->lport == lport)
+    {
+      return;
+    }
+
+  /* The hash table is also accessed by the network, so the network must be
+   * locked while the connection is moved.
+   */
+
+  net_lock();
+
+  if (conn->lport != 0)
+    {
+      for (link = &g_udp_porthash[udp_porthash(conn->lport)];
+           *link != NULL;
+           link = &(*link)->pnext)
+        {
+          if (*link == conn)
+            {
+              *link = conn->pnext;
+              break;
+            }
+        }
+    }
+
+  conn->lport = lport;
+  conn->pnext = NULL;
+
+  if (lport != 0)
+    {
+      link = &g_udp_porthash[udp_porthash(lport)];
+      while (*link != NULL)
+        {
+          link = &(*link)->pnext;
+        }
+
+      *link = conn;
+    }
+
+  net_unlock();
+#else
+  conn->lport = lport;
+#endif
+}
+
 /****************************************************************************
  * Name: udp_find_conn()
  *
@@ -139,13 +222,22 @@ static FAR struct udp_conn_s *udp_find_conn(uint16_t portno)
 #endif
 {
   FAR struct udp_conn_s *conn;
+#ifndef CONFIG_NET_UDP_CONNHASH
   int i;
+#endif
 
   /* Now search each connection structure. */
 
+#ifdef CONFIG_NET_UDP_CONNHASH
+  for (conn = g_udp_porthash[udp_porthash(portno)];
+       conn != NULL;
+       conn = conn->pnext)
+    {
+#else
   for (i = 0; i < CONFIG_NET_UDP_CONNS; i++)
     {
       conn = &g_udp_connections[i];
+#endif
 
 #ifdef CONFIG_NETDEV_MULTINIC
       /* If the port local port number assigned to the connections matches
@@ -280,7 +372,16 @@ static inline FAR struct udp_conn_s *
   FAR struct ipv4_hdr_s *ip = IPv4BUF;
   FAR struct udp_conn_s *conn;
 
+#ifdef CONFIG_NET_UDP_CONNHASH
+  /* Only the connections in the hash bucket selected by the destination
+   * port can match.
+   */
+
+  conn = g_udp_porthash[udp_porthash(udp->destport)];
+#else
   conn = (FAR struct udp_conn_s *)g_active_udp_connections.head;
+#endif
+
   while (conn)
     {
       /* If the local UDP port is non-zero, the connection is considered
@@ -322,7 +423,11 @@ static inline FAR struct udp_conn_s *
 
       /* Look at the next active connection */
 
+#ifdef CONFIG_NET_UDP_CONNHASH
+      conn = conn->pnext;
+#else
       conn = (FAR struct udp_conn_s *)conn->node.flink;
+#endif
     }
 
   return conn;
@@ -348,7 +453,16 @@ static inline FAR struct udp_conn_s *
   FAR struct ipv6_hdr_s *ip = IPv6BUF;
   FAR struct udp_conn_s *conn;
 
+#ifdef CONFIG_NET_UDP_CONNHASH
+  /* Only the connections in the hash bucket selected by the destination
+   * port can match.
+   */
+
+  conn = g_udp_porthash[udp_porthash(udp->destport)];
+#else
   conn = (FAR struct udp_conn_s *)g_active_udp_connections.head;
+#endif
+
   while (conn)
     {
       /* If the local UDP port is non-zero, the connection is considered
@@ -390,7 +504,11 @@ static inline FAR struct udp_conn_s *
 
       /* Look at the next active connection */
 
+#ifdef CONFIG_NET_UDP_CONNHASH
+      conn = conn->pnext;
+#else
       conn = (FAR struct udp_conn_s *)conn->node.flink;
+#endif
     }
 
   return conn;
@@ -486,7 +604,7 @@ void udp_free(FAR struct udp_conn_s *conn)
   DEBUGASSERT(conn->crefs == 0);
 
   _udp_semtake(&g_free_sem);
-  conn->lport = 0;
+  udp_setlport(conn, 0);
 
   /* Remove the connection from the active list */
 
@@ -632,11 +750,11 @@ int udp_bind(FAR struct udp_conn_s *conn, FAR const struct sockaddr *addr)
       /* Yes.. Select any unused local port number */
 
 #ifdef CONFIG_NETDEV_MULTINIC
-      conn->lport = htons(udp_select_port(conn->domain, &conn->u));
+      udp_setlport(conn, htons(udp_select_port(conn->domain, &conn->u)));
 #else
-      conn->lport = htons(udp_select_port());
+      udp_setlport(conn, htons(udp_select_port()));
 #endif
-      ret         = OK;
+      ret = OK;
     }
   else
     {
@@ -654,8 +772,8 @@ int udp_bind(FAR struct udp_conn_s *conn, FAR const struct sockaddr *addr)
         {
           /* No.. then bind the socket to the port */
 
-          conn->lport = portno;
-          ret         = OK;
+          udp_setlport(conn, portno);
+          ret = OK;
         }
 
       net_unlock();
@@ -702,9 +820,9 @@ int udp_connect(FAR struct udp_conn_s *conn, FAR const struct sockaddr *addr)
        */
 
 #ifdef CONFIG_NETDEV_MULTINIC
-      conn->lport = htons(udp_select_port(conn->domain, &conn->u));
+      udp_setlport(conn, htons(udp_select_port(conn->domain, &conn->u)));
 #else
-      conn->lport = htons(udp_select_port());
+      udp_setlport(conn, htons(udp_select_port()));
 #endif
     }
 
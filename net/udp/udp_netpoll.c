@@ -44,6 +44,7 @@
 #include <debug.h>
 
 #include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
 #include <nuttx/net/net.h>
 
 #include <devif/devif.h>
@@ -129,7 +130,7 @@ static uint16_t udp_poll_interrupt(FAR struct net_driver_s *dev, FAR void *conn,
       if (eventset)
         {
           info->fds->revents |= eventset;
-          sem_post(info->fds->sem);
+          poll_notify(info->fds);
         }
     }
 
@@ -258,7 +259,7 @@ int udp_pollsetup(FAR struct socket *psock, FAR struct pollfd *fds)
   if (fds->revents != 0)
     {
       /* Yes.. then signal the poll logic */
-      sem_post(fds->sem);
+      poll_notify(fds);
     }
 
   net_unlock();
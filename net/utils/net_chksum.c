@@ -1,7 +1,7 @@
 /****************************************************************************
  * net/utils/net_chksum.c
  *
- *   Copyright (C) 2007-2010, 2012, 2014-2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2010, 2012, 2014-2015, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -41,8 +41,11 @@
 #ifdef CONFIG_NET
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <debug.h>
 
+#include <arpa/inet.h>
+
 #include <nuttx/net/netconfig.h>
 #include <nuttx/net/netdev.h>
 #include <nuttx/net/ip.h>
@@ -57,6 +60,53 @@
 #define IPv4BUF   ((struct ipv4_hdr_s *)&dev->d_buf[NET_LL_HDRLEN(dev)])
 #define IPv6BUF   ((struct ipv6_hdr_s *)&dev->d_buf[NET_LL_HDRLEN(dev)])
 
+/* chksum() accumulates 32-bit words.  If a 64-bit type is available, the
+ * carries simply collect in the upper 32-bits of the accumulator:  A 64 KiB
+ * buffer cannot overflow it.  Otherwise, each carry out of the 32-bit
+ * accumulator is added back in immediately (the "end-around carry").
+ */
+
+#ifdef CONFIG_HAVE_LONG_LONG
+typedef uint64_t chksum_acc_t;
+#  define CHKSUM_ADD(acc, val) \
+     do { (acc) += (val); } while (0)
+#else
+typedef uint32_t chksum_acc_t;
+#  define CHKSUM_ADD(acc, val) \
+     do \
+       { \
+         uint32_t _val = (val); \
+         (acc) += _val; \
+         if ((acc) < _val) \
+           { \
+             (acc)++; \
+           } \
+       } \
+     while (0)
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: chksum_fold
+ *
+ * Description:
+ *   Fold a one's complement sum into 16-bits.
+ *
+ ****************************************************************************/
+
+static inline uint16_t chksum_fold(chksum_acc_t acc)
+{
+  while ((acc >> 16) != 0)
+    {
+      acc = (acc & 0xffff) + (acc >> 16);
+    }
+
+  return (uint16_t)acc;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -68,6 +118,12 @@
  *   Calculate the raw change some over the memory region described by
  *   data and len.
  *
+ *   The one's complement sum does not depend on byte order (RFC 1071), so
+ *   the data is summed as native, aligned 32-bit words and the byte order
+ *   of the result is corrected at the end.  If the data begins on an odd
+ *   address, the first byte is summed separately and the bytes of the sum
+ *   of the remaining data are swapped.
+ *
  * Input Parameters:
  *   sum  - Partial calculations carried over from a previous call to chksum().
  *          This should be zero on the first time that check sum is called.
@@ -82,40 +138,96 @@
 #ifndef CONFIG_NET_ARCH_CHKSUM
 uint16_t chksum(uint16_t sum, FAR const uint8_t *data, uint16_t len)
 {
-  FAR const uint8_t *dataptr;
-  FAR const uint8_t *last_byte;
-  uint16_t t;
+  FAR const uint32_t *lptr;
+  FAR const uint16_t *sptr;
+  chksum_acc_t acc = 0;
+  uint32_t total;
+  uint16_t first = 0;
+  uint16_t last;
+  bool odd;
 
-  dataptr = data;
-  last_byte = data + len - 1;
+  if (len == 0)
+    {
+      return sum;
+    }
+
+  /* Get 16-bit alignment.  The first byte is the high order byte of the
+   * first big endian word.
+   */
+
+  odd = (((uintptr_t)data & 1) != 0);
+  if (odd)
+    {
+      first = (uint16_t)*data++ << 8;
+      len--;
+    }
+
+  /* Get 32-bit alignment */
+
+  sptr = (FAR const uint16_t *)data;
+  if (((uintptr_t)sptr & 2) != 0 && len >= 2)
+    {
+      CHKSUM_ADD(acc, *sptr++);
+      len -= 2;
+    }
+
+  /* Sum 16 bytes per iteration, then any remaining 32-bit words */
 
-  while (dataptr < last_byte)
+  lptr = (FAR const uint32_t *)sptr;
+  while (len >= 16)
     {
-      /* At least two more bytes */
+      CHKSUM_ADD(acc, lptr[0]);
+      CHKSUM_ADD(acc, lptr[1]);
+      CHKSUM_ADD(acc, lptr[2]);
+      CHKSUM_ADD(acc, lptr[3]);
+      lptr += 4;
+      len  -= 16;
+    }
 
-      t = ((uint16_t)dataptr[0] << 8) + dataptr[1];
-      sum += t;
-      if (sum < t)
-        {
-          sum++; /* carry */
-        }
+  while (len >= 4)
+    {
+      CHKSUM_ADD(acc, *lptr++);
+      len -= 4;
+    }
 
-      dataptr += 2;
+  /* Then a trailing 16-bit word and/or a trailing byte.  A trailing byte is
+   * padded with a zero byte to make a 16-bit word.
+   */
+
+  sptr = (FAR const uint16_t *)lptr;
+  if (len >= 2)
+    {
+      CHKSUM_ADD(acc, *sptr++);
+      len -= 2;
     }
 
-  if (dataptr == last_byte)
+  if (len > 0)
     {
-      t = (dataptr[0] << 8) + 0;
-      sum += t;
-      if (sum < t)
-        {
-          sum++; /* carry */
-        }
+      last = 0;
+      *(FAR uint8_t *)&last = *(FAR const uint8_t *)sptr;
+      CHKSUM_ADD(acc, last);
     }
 
+  /* Fold the sum of native words to 16-bits and convert it to host order.
+   * If the data began on an odd address, all of those words were sampled
+   * one byte off, so the bytes of the sum must be swapped.
+   */
+
+  last = NTOHS(chksum_fold(acc));
+  if (odd)
+    {
+      last = (uint16_t)((last << 8) | (last >> 8));
+    }
+
+  /* Add in the first byte and the caller's partial sum */
+
+  total = (uint32_t)sum + last + first;
+  total = (total & 0xffff) + (total >> 16);
+  total = (total & 0xffff) + (total >> 16);
+
   /* Return sum in host byte order. */
 
-  return sum;
+  return (uint16_t)total;
 }
 #endif /* CONFIG_NET_ARCH_CHKSUM */
 
@@ -151,4 +263,67 @@ uint16_t net_chksum(FAR uint16_t *data, uint16_t len)
 }
 #endif /* CONFIG_NET_ARCH_CHKSUM */
 
+/****************************************************************************
+ * Name: net_chksum_adjust
+ *
+ * Description:
+ *   Update an Internet checksum after some 16-bit words of the data that it
+ *   covers have been modified, without re-summing all of the data.  The
+ *   new checksum is computed as described in RFC 1624, equation 3:
+ *
+ *     HC' = ~(~HC + ~m + m')
+ *
+ *   The checksum and the data are all used as they appear in the packet
+ *   (network byte order).
+ *
+ * Input Parameters:
+ *   chksum  - The checksum field from the packet header.
+ *   olddata - The old values of the modified words.
+ *   newdata - The new values of the modified words.
+ *   nwords  - The number of 16-bit words modified.
+ *
+ * Returned Value:
+ *   The new value of the checksum field.
+ *
+ ****************************************************************************/
+
+uint16_t net_chksum_adjust(uint16_t chksum, FAR const uint16_t *olddata,
+                           FAR const uint16_t *newdata, unsigned int nwords)
+{
+  uint32_t sum = (uint16_t)~chksum;
+
+  while (nwords-- > 0)
+    {
+      sum += (uint16_t)~*olddata++;
+      sum += *newdata++;
+      sum  = (sum & 0xffff) + (sum >> 16);
+    }
+
+  sum = (sum & 0xffff) + (sum >> 16);
+  return (uint16_t)~sum;
+}
+
+/****************************************************************************
+ * Name: net_chksum_adjust16
+ *
+ * Description:
+ *   Update an Internet checksum after one 16-bit word of the data that it
+ *   covers has been modified.  This is net_chksum_adjust() for the common
+ *   case of a single field.
+ *
+ * Input Parameters:
+ *   chksum - The checksum field from the packet header.
+ *   oldval - The old value of the modified word.
+ *   newval - The new value of the modified word.
+ *
+ * Returned Value:
+ *   The new value of the checksum field.
+ *
+ ****************************************************************************/
+
+uint16_t net_chksum_adjust16(uint16_t chksum, uint16_t oldval, uint16_t newval)
+{
+  return net_chksum_adjust(chksum, &oldval, &newval, 1);
+}
+
 #endif /* CONFIG_NET */
@@ -242,6 +242,34 @@ uint16_t chksum(uint16_t sum, FAR const uint8_t *data, uint16_t len);
 uint16_t net_chksum(FAR uint16_t *data, uint16_t len);
 #endif
 
+/****************************************************************************
+ * Name: net_chksum_adjust and net_chksum_adjust16
+ *
+ * Description:
+ *   Update an Internet checksum after some 16-bit words of the data that it
+ *   covers have been modified, without re-summing all of the data (see RFC
+ *   1624).  This is useful when only a few header fields are rewritten.
+ *
+ *   The checksum and the data are all used as they appear in the packet
+ *   (network byte order).
+ *
+ * Input Parameters:
+ *   chksum  - The checksum field from the packet header.
+ *   olddata - The old values of the modified words.
+ *   newdata - The new values of the modified words.
+ *   nwords  - The number of 16-bit words modified.
+ *   oldval  - The old value of a single modified word.
+ *   newval  - The new value of a single modified word.
+ *
+ * Returned Value:
+ *   The new value of the checksum field.
+ *
+ ****************************************************************************/
+
+uint16_t net_chksum_adjust(uint16_t chksum, FAR const uint16_t *olddata,
+                           FAR const uint16_t *newdata, unsigned int nwords);
+uint16_t net_chksum_adjust16(uint16_t chksum, uint16_t oldval, uint16_t newval);
+
 /****************************************************************************
  * Name: ipv4_upperlayer_chksum
  *
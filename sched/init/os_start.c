@@ -1,7 +1,7 @@
 /****************************************************************************
  * sched/init/os_start.c
  *
- *   Copyright (C) 2007-2014, 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2014, 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -426,7 +426,9 @@ void os_start(void)
   for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++, g_lastpid++)
 #endif
     {
+#ifndef CONFIG_SCHED_READYBITMAP
       FAR dq_queue_t *tasklist;
+#endif
       int hashndx;
 
       /* Assign the process ID(s) of ZERO to the idle task(s) */
@@ -520,12 +522,16 @@ void os_start(void)
        * run list.
        */
 
+#ifdef CONFIG_SCHED_READYBITMAP
+      (void)sched_addreadylist((FAR struct tcb_s *)&g_idletcb[cpu]);
+#else
 #ifdef CONFIG_SMP
       tasklist = TLIST_HEAD(TSTATE_TASK_RUNNING, cpu);
 #else
       tasklist = TLIST_HEAD(TSTATE_TASK_RUNNING);
 #endif
       dq_addfirst((FAR dq_entry_t *)&g_idletcb[cpu], tasklist);
+#endif
 
       /* Initialize the processor-specific portion of the TCB */
 
@@ -43,6 +43,7 @@
 #include <nuttx/arch.h>
 #include <nuttx/irq.h>
 #include <nuttx/random.h>
+#include <nuttx/sched_note.h>
 
 #include "irq/irq.h"
 
@@ -106,5 +107,7 @@ void irq_dispatch(int irq, FAR void *context)
 
   /* Then dispatch to the interrupt handler */
 
+  sched_note_irqhandler(irq, true);
   vector(irq, context, arg);
+  sched_note_irqhandler(irq, false);
 }
@@ -1,7 +1,7 @@
 /****************************************************************************
  *  sched/mqueue/mq_initialize.c
  *
- *   Copyright (C) 2007, 2009, 2011 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2009, 2011, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -61,6 +61,7 @@ struct mq_des_block_s
  * Public Data
  ****************************************************************************/
 
+#ifndef CONFIG_MQ_ARENA
 /* The g_msgfree is a list of messages that are available for general
  * use.  The number of messages in this list is a system configuration
  * item.
@@ -73,6 +74,7 @@ sq_queue_t  g_msgfree;
  */
 
 sq_queue_t  g_msgfreeirq;
+#endif
 
 /* The g_desfree data structure is a list of message descriptors available
  * to the operating system for general use. The number of messages in the
@@ -85,6 +87,7 @@ sq_queue_t  g_desfree;
  * Private Data
  ****************************************************************************/
 
+#ifndef CONFIG_MQ_ARENA
 /* g_msgalloc is a pointer to the start of the allocated block of
  * messages.
  */
@@ -96,6 +99,7 @@ static struct mqueue_msg_s  *g_msgalloc;
  */
 
 static struct mqueue_msg_s  *g_msgfreeirqalloc;
+#endif
 
 /* g_desalloc is a list of allocated block of message queue descriptors. */
 
@@ -105,6 +109,7 @@ static sq_queue_t g_desalloc;
  * Private Functions
  ****************************************************************************/
 
+#ifndef CONFIG_MQ_ARENA
 /****************************************************************************
  * Name: mq_msgblockalloc
  *
@@ -143,6 +148,7 @@ mq_msgblockalloc(FAR sq_queue_t *queue, uint16_t nmsgs,
 
   return mqmsgblock;
 }
+#endif /* !CONFIG_MQ_ARENA */
 
 /****************************************************************************
  * Public Functions
@@ -166,11 +172,15 @@ mq_msgblockalloc(FAR sq_queue_t *queue, uint16_t nmsgs,
 
 void mq_initialize(void)
 {
-  /* Initialize the message free lists */
+  sq_init(&g_desalloc);
+
+#ifndef CONFIG_MQ_ARENA
+  /* Initialize the message free lists.  With message queue arenas,
+   * messages are allocated along with each message queue instead.
+   */
 
   sq_init(&g_msgfree);
   sq_init(&g_msgfreeirq);
-  sq_init(&g_desalloc);
 
   /* Allocate a block of messages for general use */
 
@@ -185,6 +195,7 @@ void mq_initialize(void)
   g_msgfreeirqalloc =
     mq_msgblockalloc(&g_msgfreeirq, NUM_INTERRUPT_MSGS,
                      MQ_ALLOC_IRQ);
+#endif
 
   /* Allocate a block of message queue descriptors */
 
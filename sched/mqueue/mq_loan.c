@@ -0,0 +1,402 @@
+/****************************************************************************
+ *  sched/mqueue/mq_loan.c
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <mqueue.h>
+#include <sched.h>
+#include <debug.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/arch.h>
+#include <nuttx/cancelpt.h>
+
+#include "mqueue/mqueue.h"
+
+#ifdef CONFIG_MQ_LOAN
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mq_loanmsg
+ *
+ * Description:
+ *   Map the address of loaned message data back to the message structure
+ *   in the message queue's arena and end the loan.  Only messages that
+ *   are currently on loan are accepted so that a buffer that is queued,
+ *   free, or already returned cannot be linked into a list twice.
+ *
+ * Parameters:
+ *   msgq - The message queue that owns the arena
+ *   buf  - The loaned message data
+ *
+ * Return Value:
+ *   The message structure or NULL if 'buf' is not the data of a message
+ *   on loan from the message queue's arena.
+ *
+ ****************************************************************************/
+
+static FAR struct mqueue_msg_s *
+mq_loanmsg(FAR struct mqueue_inode_s *msgq, FAR const void *buf)
+{
+  FAR struct mqueue_msg_s *mqmsg;
+  FAR uint8_t *addr = (FAR uint8_t *)MQ_MSG_FROMDATA(buf);
+  size_t msgsize = MQ_MSG_SIZE(msgq->maxmsgsize);
+  irqstate_t flags;
+  size_t offset;
+
+  if (buf == NULL || addr < msgq->arena)
+    {
+      return NULL;
+    }
+
+  offset = addr - msgq->arena;
+  if ((offset % msgsize) != 0 || (offset / msgsize) >= msgq->maxmsgs)
+    {
+      return NULL;
+    }
+
+  /* Check and clear the loan mark atomically so that concurrent calls
+   * with the same buffer cannot both succeed.
+   */
+
+  mqmsg = (FAR struct mqueue_msg_s *)addr;
+
+  flags = enter_critical_section();
+  if (mqmsg->type != MQ_ALLOC_LOANED)
+    {
+      mqmsg = NULL;
+    }
+  else
+    {
+      mqmsg->type = MQ_ALLOC_ARENA;
+    }
+
+  leave_critical_section(flags);
+  return mqmsg;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mq_loan
+ *
+ * Description:
+ *   Borrow an unused message buffer from the arena of the message queue
+ *   specified by "mqdes."  The buffer can hold up to the "mq_msgsize"
+ *   attribute of the message queue.  The caller may build the message in
+ *   the buffer and then queue it, without copying, with mq_loansend().
+ *   A loaned buffer that is not sent must be given back with
+ *   mq_loanreturn().
+ *
+ *   Loaned buffers count against the capacity of the message queue.  If
+ *   no buffer is available and O_NONBLOCK is not set, mq_loan() will
+ *   block until a buffer becomes available.
+ *
+ *   Loaned buffers must be sent or returned before the message queue is
+ *   closed.
+ *
+ * Parameters:
+ *   mqdes - Message queue descriptor
+ *
+ * Return Value:
+ *   On success, mq_loan() returns the address of the message buffer; on
+ *   error, NULL is returned, with errno set to indicate the error:
+ *
+ *   EAGAIN   The queue was full, and the O_NONBLOCK flag was set for the
+ *            message queue description referred to by mqdes.
+ *   EINVAL   mqdes is NULL.
+ *   EPERM    Message queue opened not opened for writing.
+ *   EINTR    The call was interrupted by a signal handler.
+ *
+ ****************************************************************************/
+
+FAR void *mq_loan(mqd_t mqdes)
+{
+  FAR struct mqueue_inode_s *msgq;
+  FAR struct mqueue_msg_s *mqmsg = NULL;
+  irqstate_t flags;
+
+  /* mq_loan() is a cancellation point */
+
+  (void)enter_cancellation_point();
+
+  /* Verify the input parameters */
+
+  if (mqdes == NULL)
+    {
+      set_errno(EINVAL);
+      leave_cancellation_point();
+      return NULL;
+    }
+
+  if ((mqdes->oflags & O_WROK) == 0)
+    {
+      set_errno(EPERM);
+      leave_cancellation_point();
+      return NULL;
+    }
+
+  /* Take a message from the arena, waiting for one to become available
+   * if necessary.
+   */
+
+  sched_lock();
+  msgq = mqdes->msgq;
+
+  flags = enter_critical_section();
+  if (up_interrupt_context() || /* In an interrupt handler */
+      !MQ_ISFULL(msgq)       || /* OR Message queue not full */
+      mq_waitsend(mqdes) == OK) /* OR Successfully waited for mq not full */
+    {
+      mqmsg = mq_msgalloc(msgq);
+      if (mqmsg == NULL)
+        {
+          /* Only possible in an interrupt handler */
+
+          set_errno(EAGAIN);
+        }
+      else
+        {
+          mqmsg->type = MQ_ALLOC_LOANED;
+        }
+    }
+
+  leave_critical_section(flags);
+  sched_unlock();
+  leave_cancellation_point();
+
+  return mqmsg != NULL ? mqmsg->mail : NULL;
+}
+
+/****************************************************************************
+ * Name: mq_loansend
+ *
+ * Description:
+ *   Add a message built in a buffer obtained from mq_loan() to the message
+ *   queue specified by "mqdes."  The message is queued without copying
+ *   and ownership of the buffer passes to the message queue.  Since the
+ *   space for the message is already reserved, mq_loansend() never
+ *   blocks.
+ *
+ * Parameters:
+ *   mqdes - Message queue descriptor
+ *   buf - The loaned buffer holding the message
+ *   msglen - The length of the message in bytes
+ *   prio - The priority of the message
+ *
+ * Return Value:
+ *   On success, mq_loansend() returns 0 (OK); on error, -1 (ERROR) is
+ *   returned, with errno set to indicate the error:
+ *
+ *   EINVAL   Either buf or mqdes is NULL, buf is not a buffer loaned from
+ *            this message queue, or the value of prio is invalid.
+ *   EPERM    Message queue opened not opened for writing.
+ *   EMSGSIZE 'msglen' was greater than the maxmsgsize attribute of the
+ *            message queue.
+ *
+ ****************************************************************************/
+
+int mq_loansend(mqd_t mqdes, FAR void *buf, size_t msglen, int prio)
+{
+  FAR struct mqueue_msg_s *mqmsg;
+
+  if (mq_verifysend(mqdes, buf, msglen, prio) != OK)
+    {
+      return ERROR;
+    }
+
+  mqmsg = mq_loanmsg(mqdes->msgq, buf);
+  if (mqmsg == NULL)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  return mq_dosend(mqdes, mqmsg, buf, msglen, prio);
+}
+
+/****************************************************************************
+ * Name: mq_loanreceive
+ *
+ * Description:
+ *   Receive the oldest of the highest priority messages from the message
+ *   queue specified by "mqdes" without copying it.  The address of the
+ *   message data in the message queue's arena is returned in "buf" and
+ *   ownership of the buffer passes to the caller.  The buffer must be
+ *   given back with mq_loanreturn() when the caller is finished with it.
+ *   Until then, it counts against the capacity of the message queue.
+ *
+ *   If the message queue is empty and O_NONBLOCK was not set,
+ *   mq_loanreceive() will block until a message is added to the message
+ *   queue.
+ *
+ * Parameters:
+ *   mqdes - Message Queue Descriptor
+ *   buf - The location to return the address of the message data
+ *   prio - If not NULL, the location to store message priority.
+ *
+ * Return Value:
+ *   One success, the length of the selected message in bytes is returned.
+ *   On failure, -1 (ERROR) is returned and the errno is set appropriately:
+ *
+ *   EAGAIN   The queue was empty, and the O_NONBLOCK flag was set
+ *            for the message queue description referred to by 'mqdes'.
+ *   EPERM    Message queue opened not opened for reading.
+ *   EINTR    The call was interrupted by a signal handler.
+ *   EINVAL   Invalid 'buf' or 'mqdes'
+ *
+ ****************************************************************************/
+
+ssize_t mq_loanreceive(mqd_t mqdes, FAR void **buf, FAR int *prio)
+{
+  FAR struct mqueue_msg_s *mqmsg;
+  irqstate_t flags;
+  ssize_t ret = ERROR;
+
+  DEBUGASSERT(up_interrupt_context() == false);
+
+  /* mq_loanreceive() is a cancellation point */
+
+  (void)enter_cancellation_point();
+
+  /* Verify the input parameters */
+
+  if (buf == NULL || mqdes == NULL)
+    {
+      set_errno(EINVAL);
+      leave_cancellation_point();
+      return ERROR;
+    }
+
+  if ((mqdes->oflags & O_RDOK) == 0)
+    {
+      set_errno(EPERM);
+      leave_cancellation_point();
+      return ERROR;
+    }
+
+  /* Get the next message from the message queue, as in mq_receive() */
+
+  sched_lock();
+
+  flags = enter_critical_section();
+  mqmsg = mq_waitreceive(mqdes);
+  if (mqmsg)
+    {
+      mqmsg->type = MQ_ALLOC_LOANED;
+    }
+
+  leave_critical_section(flags);
+
+  if (mqmsg)
+    {
+      /* Hand the message over to the caller.  It remains allocated from
+       * the arena until the caller returns it.
+       */
+
+      *buf = mqmsg->mail;
+      if (prio)
+        {
+          *prio = mqmsg->priority;
+        }
+
+      ret = mqmsg->msglen;
+    }
+
+  sched_unlock();
+  leave_cancellation_point();
+  return ret;
+}
+
+/****************************************************************************
+ * Name: mq_loanreturn
+ *
+ * Description:
+ *   Give a buffer obtained from mq_loan() or mq_loanreceive() back to the
+ *   arena of the message queue specified by "mqdes."  A task waiting for
+ *   the message queue to become non-full will be awakened.
+ *
+ * Parameters:
+ *   mqdes - Message queue descriptor
+ *   buf - The loaned buffer
+ *
+ * Return Value:
+ *   On success, mq_loanreturn() returns 0 (OK); on error, -1 (ERROR) is
+ *   returned, with errno set to indicate the error:
+ *
+ *   EINVAL   Either buf or mqdes is NULL or buf is not a buffer loaned
+ *            from this message queue.
+ *
+ ****************************************************************************/
+
+int mq_loanreturn(mqd_t mqdes, FAR void *buf)
+{
+  FAR struct mqueue_inode_s *msgq;
+  FAR struct mqueue_msg_s *mqmsg;
+
+  if (mqdes == NULL)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  msgq  = mqdes->msgq;
+  mqmsg = mq_loanmsg(msgq, buf);
+  if (mqmsg == NULL)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  sched_lock();
+  mq_msgfree(msgq, mqmsg);
+  mq_wakesend(msgq);
+  sched_unlock();
+  return OK;
+}
+
+#endif /* CONFIG_MQ_LOAN */
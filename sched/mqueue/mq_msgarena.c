@@ -0,0 +1,270 @@
+/****************************************************************************
+ *  sched/mqueue/mq_msgarena.c
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <strings.h>
+#include <queue.h>
+#include <assert.h>
+
+#include <nuttx/irq.h>
+
+#include "mqueue/mqueue.h"
+
+#ifdef CONFIG_MQ_ARENA
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Map a message priority to its priority bucket */
+
+#define MQ_BUCKET(p) ((p) < (MQ_NBUCKETS - 1) ? (p) : (MQ_NBUCKETS - 1))
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mq_arenainit
+ *
+ * Description:
+ *   Carve the message queue's arena into maxmsgs messages of maxmsgsize
+ *   bytes each and place them in the queue's free list.  The arena itself
+ *   is allocated by mq_msgqalloc() along with the message queue structure.
+ *
+ * Inputs:
+ *   msgq - The newly allocated message queue
+ *
+ * Return Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void mq_arenainit(FAR struct mqueue_inode_s *msgq)
+{
+  FAR struct mqueue_msg_s *mqmsg;
+  FAR uint8_t *next;
+  size_t msgsize;
+  int i;
+
+  msgsize = MQ_MSG_SIZE(msgq->maxmsgsize);
+  next    = msgq->arena;
+
+  sq_init(&msgq->msgfree);
+  for (i = 0; i < msgq->maxmsgs; i++)
+    {
+      mqmsg       = (FAR struct mqueue_msg_s *)next;
+      mqmsg->type = MQ_ALLOC_ARENA;
+      sq_addlast((FAR sq_entry_t *)mqmsg, &msgq->msgfree);
+      next       += msgsize;
+    }
+
+  for (i = 0; i < MQ_NBUCKETS; i++)
+    {
+      sq_init(&msgq->msglist[i]);
+    }
+
+  msgq->prioset = 0;
+}
+
+/****************************************************************************
+ * Name: mq_msgalloc
+ *
+ * Description:
+ *   Take a free message from the message queue's arena.  This may be
+ *   called from interrupt handlers.
+ *
+ * Inputs:
+ *   msgq - The message queue that will hold the message
+ *
+ * Return Value:
+ *   A reference to the allocated message or NULL if the arena is
+ *   exhausted, i.e., if the message queue is full.
+ *
+ ****************************************************************************/
+
+FAR struct mqueue_msg_s *mq_msgalloc(FAR struct mqueue_inode_s *msgq)
+{
+  FAR struct mqueue_msg_s *mqmsg;
+  irqstate_t flags;
+
+  flags = enter_critical_section();
+  mqmsg = (FAR struct mqueue_msg_s *)sq_remfirst(&msgq->msgfree);
+  leave_critical_section(flags);
+
+  return mqmsg;
+}
+
+/****************************************************************************
+ * Name: mq_msgfree
+ *
+ * Description:
+ *   Return a message to the message queue's arena.  The caller is
+ *   responsible for waking up any senders that are waiting for the
+ *   message queue to become non-full (see mq_wakesend()).
+ *
+ * Inputs:
+ *   msgq  - The message queue that owns the message
+ *   mqmsg - The message to free
+ *
+ * Return Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void mq_msgfree(FAR struct mqueue_inode_s *msgq,
+                FAR struct mqueue_msg_s *mqmsg)
+{
+  irqstate_t flags;
+
+  DEBUGASSERT(mqmsg->type == MQ_ALLOC_ARENA);
+
+  /* Put the message at the head of the free list where it is most likely
+   * to still be in cache when it is used again.
+   */
+
+  flags = enter_critical_section();
+  sq_addfirst((FAR sq_entry_t *)mqmsg, &msgq->msgfree);
+  leave_critical_section(flags);
+}
+
+/****************************************************************************
+ * Name: mq_msgenqueue
+ *
+ * Description:
+ *   Add a message to the message queue in priority order.  Messages of
+ *   equal priority are kept in FIFO order.  For priorities below
+ *   MQ_NBUCKETS-1, this is simply an append to the priority's bucket.
+ *
+ * Inputs:
+ *   msgq  - The message queue to receive the message
+ *   mqmsg - The message to add.  The priority must already be set.
+ *
+ * Return Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called from within a critical section.
+ *
+ ****************************************************************************/
+
+void mq_msgenqueue(FAR struct mqueue_inode_s *msgq,
+                   FAR struct mqueue_msg_s *mqmsg)
+{
+  FAR sq_queue_t *list;
+  FAR struct mqueue_msg_s *next;
+  FAR struct mqueue_msg_s *prev;
+  int bucket;
+
+  bucket = MQ_BUCKET(mqmsg->priority);
+  list   = &msgq->msglist[bucket];
+
+  if (bucket < MQ_NBUCKETS - 1)
+    {
+      sq_addlast((FAR sq_entry_t *)mqmsg, list);
+    }
+  else
+    {
+      /* The last bucket holds a range of priorities.  Search it for the
+       * location to insert the new message.
+       */
+
+      for (prev = NULL, next = (FAR struct mqueue_msg_s *)list->head;
+           next && mqmsg->priority <= next->priority;
+           prev = next, next = next->next);
+
+      if (prev)
+        {
+          sq_addafter((FAR sq_entry_t *)prev, (FAR sq_entry_t *)mqmsg, list);
+        }
+      else
+        {
+          sq_addfirst((FAR sq_entry_t *)mqmsg, list);
+        }
+    }
+
+  msgq->prioset |= (uint32_t)1 << bucket;
+}
+
+/****************************************************************************
+ * Name: mq_msgdequeue
+ *
+ * Description:
+ *   Remove the oldest message of the highest priority from the message
+ *   queue.
+ *
+ * Inputs:
+ *   msgq - The message queue
+ *
+ * Return Value:
+ *   The removed message or NULL if the message queue is empty.
+ *
+ * Assumptions:
+ *   Called from within a critical section.
+ *
+ ****************************************************************************/
+
+FAR struct mqueue_msg_s *mq_msgdequeue(FAR struct mqueue_inode_s *msgq)
+{
+  FAR struct mqueue_msg_s *mqmsg;
+  FAR sq_queue_t *list;
+  int bucket;
+
+  if (msgq->prioset == 0)
+    {
+      return NULL;
+    }
+
+  bucket = flsl((long)msgq->prioset) - 1;
+  list   = &msgq->msglist[bucket];
+
+  mqmsg  = (FAR struct mqueue_msg_s *)sq_remfirst(list);
+  DEBUGASSERT(mqmsg != NULL);
+
+  if (sq_empty(list))
+    {
+      msgq->prioset &= ~((uint32_t)1 << bucket);
+    }
+
+  return mqmsg;
+}
+
+#endif /* CONFIG_MQ_ARENA */
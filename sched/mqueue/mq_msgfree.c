@@ -1,7 +1,7 @@
 /****************************************************************************
  *  sched/mqueue/mq_msgfree.c
  *
- *   Copyright (C) 2007, 2013, 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2013, 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -60,6 +60,7 @@
  *   allocated dynamically it will be deallocated.
  *
  * Inputs:
+ *   msgq  - The message queue that held the message (unused)
  *   mqmsg - message to free
  *
  * Return Value:
@@ -67,7 +68,8 @@
  *
  ****************************************************************************/
 
-void mq_msgfree(FAR struct mqueue_msg_s *mqmsg)
+void mq_msgfree(FAR struct mqueue_inode_s *msgq,
+                FAR struct mqueue_msg_s *mqmsg)
 {
   irqstate_t flags;
 
@@ -1,7 +1,7 @@
 /****************************************************************************
  *  sched/mqueue/mq_msgqalloc.c
  *
- *   Copyright (C) 2014 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -76,6 +76,11 @@ FAR struct mqueue_inode_s *mq_msgqalloc(mode_t mode,
                                         FAR struct mq_attr *attr)
 {
   FAR struct mqueue_inode_s *msgq;
+#ifdef CONFIG_MQ_ARENA
+  size_t hdrsize;
+  size_t msgsize;
+  int16_t maxmsgs;
+#endif
 
   /* Check if the caller is attempting to allocate a message for messages
    * larger than the configured maximum message size.
@@ -87,16 +92,36 @@ FAR struct mqueue_inode_s *mq_msgqalloc(mode_t mode,
       return NULL;
     }
 
+#ifdef CONFIG_MQ_ARENA
+  /* Allocate memory for the new message queue followed by its arena of
+   * messages, each sized for the queue's maximum message size.
+   */
+
+  maxmsgs = attr ? (int16_t)attr->mq_maxmsg : MQ_MAX_MSGS;
+  msgsize = MQ_MSG_SIZE(attr ? attr->mq_msgsize : MQ_MAX_BYTES);
+  hdrsize = (sizeof(struct mqueue_inode_s) + MQ_MSG_ALIGN) & ~MQ_MSG_ALIGN;
+
+  if (maxmsgs <= 0)
+    {
+      return NULL;
+    }
+
+  msgq = (FAR struct mqueue_inode_s *)
+    kmm_zalloc(hdrsize + maxmsgs * msgsize);
+#else
   /* Allocate memory for the new message queue. */
 
   msgq = (FAR struct mqueue_inode_s *)
     kmm_zalloc(sizeof(struct mqueue_inode_s));
+#endif
 
   if (msgq)
     {
       /* Initialize the new named message queue */
 
+#ifndef CONFIG_MQ_ARENA
       sq_init(&msgq->msglist);
+#endif
       if (attr)
         {
           msgq->maxmsgs    = (int16_t)attr->mq_maxmsg;
@@ -108,6 +133,11 @@ FAR struct mqueue_inode_s *mq_msgqalloc(mode_t mode,
           msgq->maxmsgsize = MQ_MAX_BYTES;
         }
 
+#ifdef CONFIG_MQ_ARENA
+      msgq->arena = (FAR uint8_t *)msgq + hdrsize;
+      mq_arenainit(msgq);
+#endif
+
 #ifndef CONFIG_DISABLE_SIGNALS
       msgq->ntpid = INVALID_PROCESS_ID;
 #endif
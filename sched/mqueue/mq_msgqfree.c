@@ -1,7 +1,7 @@
 /****************************************************************************
  *  sched/mqueue/mq_msgqfree.c
  *
- *   Copyright (C) 2007, 2009 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2009, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -67,6 +67,7 @@
 
 void mq_msgqfree(FAR struct mqueue_inode_s *msgq)
 {
+#ifndef CONFIG_MQ_ARENA
   FAR struct mqueue_msg_s *curr;
   FAR struct mqueue_msg_s *next;
 
@@ -78,11 +79,14 @@ void mq_msgqfree(FAR struct mqueue_inode_s *msgq)
       /* Deallocate the message structure. */
 
       next = curr->next;
-      mq_msgfree(curr);
+      mq_msgfree(msgq, curr);
       curr = next;
     }
+#endif
 
-  /* Then deallocate the message queue itself */
+  /* Then deallocate the message queue itself.  If there is a message
+   * arena, it is a part of the same allocation.
+   */
 
   sched_kfree(msgq);
 }
@@ -1,7 +1,7 @@
 /****************************************************************************
  *  sched/mqueue/mq_rcvinternal.c
  *
- *   Copyright (C) 2007, 2008, 2012-2013, 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2008, 2012-2013, 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -165,7 +165,11 @@ FAR struct mqueue_msg_s *mq_waitreceive(mqd_t mqdes)
 
   /* Get the message from the head of the queue */
 
+#ifdef CONFIG_MQ_ARENA
+  while ((rcvmsg = mq_msgdequeue(msgq)) == NULL)
+#else
   while ((rcvmsg = (FAR struct mqueue_msg_s *)sq_remfirst(&msgq->msglist)) == NULL)
+#endif
     {
       /* The queue is empty!  Should we block until there the above condition
        * has been satisfied?
@@ -248,8 +252,6 @@ FAR struct mqueue_msg_s *mq_waitreceive(mqd_t mqdes)
 ssize_t mq_doreceive(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg,
                      FAR char *ubuffer, int *prio)
 {
-  FAR struct tcb_s *btcb;
-  irqstate_t flags;
   FAR struct mqueue_inode_s *msgq;
   ssize_t rcvmsglen;
 
@@ -270,11 +272,43 @@ ssize_t mq_doreceive(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg,
 
   /* We are done with the message.  Deallocate it now. */
 
-  mq_msgfree(mqmsg);
+  msgq = mqdes->msgq;
+  mq_msgfree(msgq, mqmsg);
 
   /* Check if any tasks are waiting for the MQ not full event. */
 
-  msgq = mqdes->msgq;
+  mq_wakesend(msgq);
+
+  /* Return the length of the message transferred to the user buffer */
+
+  return rcvmsglen;
+}
+
+/****************************************************************************
+ * Name: mq_wakesend
+ *
+ * Description:
+ *   Wake up the highest priority task that is waiting for the message
+ *   queue to become non-full, if there is one.  This is called after a
+ *   message is removed from the message queue or, when message queue
+ *   arenas are used, after a message is returned to the arena.
+ *
+ * Parameters:
+ *   msgq - The message queue that is no longer full
+ *
+ * Return Value:
+ *   None
+ *
+ * Assumptions:
+ * - Pre-emption should be disabled throughout this call.
+ *
+ ****************************************************************************/
+
+void mq_wakesend(FAR struct mqueue_inode_s *msgq)
+{
+  FAR struct tcb_s *btcb;
+  irqstate_t flags;
+
   if (msgq->nwaitnotfull > 0)
     {
       /* Find the highest priority task that is waiting for
@@ -301,8 +335,4 @@ ssize_t mq_doreceive(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg,
 
       leave_critical_section(flags);
     }
-
-  /* Return the length of the message transferred to the user buffer */
-
-  return rcvmsglen;
 }
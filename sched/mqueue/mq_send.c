@@ -1,7 +1,7 @@
 /****************************************************************************
  *  sched/mqueue/mq_send.c
  *
- *   Copyright (C) 2007, 2009, 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2009, 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -132,13 +132,13 @@ int mq_send(mqd_t mqdes, FAR const char *msg, size_t msglen, int prio)
 
   flags = enter_critical_section();
   if (up_interrupt_context()      || /* In an interrupt handler */
-      msgq->nmsgs < msgq->maxmsgs || /* OR Message queue not full */
+      !MQ_ISFULL(msgq)            || /* OR Message queue not full */
       mq_waitsend(mqdes) == OK)      /* OR Successfully waited for mq not full */
     {
       /* Allocate the message */
 
       leave_critical_section(flags);
-      mqmsg = mq_msgalloc();
+      mqmsg = mq_msgalloc(msgq);
 
       /* Check if the message was sucessfully allocated */
 
@@ -1,7 +1,7 @@
 /****************************************************************************
  *  sched/mqueue/mq_sndinternal.c
  *
- *   Copyright (C) 2007, 2009, 2013-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2009, 2013-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -117,6 +117,7 @@ int mq_verifysend(mqd_t mqdes, FAR const char *msg, size_t msglen, int prio)
   return OK;
 }
 
+#ifndef CONFIG_MQ_ARENA
 /****************************************************************************
  * Name: mq_msgalloc
  *
@@ -136,7 +137,7 @@ int mq_verifysend(mqd_t mqdes, FAR const char *msg, size_t msglen, int prio)
  *   handler will be notified.
  *
  * Inputs:
- *   None
+ *   msgq - The message queue that will hold the message (unused)
  *
  * Return Value:
  *   A reference to the allocated msg structure.  On a failure to allocate,
@@ -144,7 +145,7 @@ int mq_verifysend(mqd_t mqdes, FAR const char *msg, size_t msglen, int prio)
  *
  ****************************************************************************/
 
-FAR struct mqueue_msg_s *mq_msgalloc(void)
+FAR struct mqueue_msg_s *mq_msgalloc(FAR struct mqueue_inode_s *msgq)
 {
   FAR struct mqueue_msg_s *mqmsg;
   irqstate_t flags;
@@ -201,6 +202,7 @@ FAR struct mqueue_msg_s *mq_msgalloc(void)
 
   return mqmsg;
 }
+#endif /* !CONFIG_MQ_ARENA */
 
 /****************************************************************************
  * Name: mq_waitsend
@@ -256,7 +258,7 @@ int mq_waitsend(mqd_t mqdes)
 
   /* Verify that the queue is indeed full as the caller thinks */
 
-  if (msgq->nmsgs >= msgq->maxmsgs)
+  if (MQ_ISFULL(msgq))
     {
       /* Should we block until there is sufficient space in the
        * message queue?
@@ -281,7 +283,7 @@ int mq_waitsend(mqd_t mqdes)
            * receiving message queue
            */
 
-          while (msgq->nmsgs >= msgq->maxmsgs)
+          while (MQ_ISFULL(msgq))
             {
               /* Block until the message queue is no longer full.
                * When we are unblocked, we will try again
@@ -325,7 +327,8 @@ int mq_waitsend(mqd_t mqdes)
  *
  * Parameters:
  *   mqdes - Message queue descriptor
- *   msg - Message to send
+ *   mqmsg - The allocated message structure to be queued
+ *   msg - Message to send (may be mqmsg->mail for loaned messages)
  *   msglen - The length of the message in bytes
  *   prio - The priority of the message
  *
@@ -341,8 +344,10 @@ int mq_dosend(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg, FAR const char *msg,
 {
   FAR struct tcb_s *btcb;
   FAR struct mqueue_inode_s *msgq;
+#ifndef CONFIG_MQ_ARENA
   FAR struct mqueue_msg_s *next;
   FAR struct mqueue_msg_s *prev;
+#endif
   irqstate_t flags;
 
   /* Get a pointer to the message queue */
@@ -355,14 +360,22 @@ int mq_dosend(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg, FAR const char *msg,
   mqmsg->priority = prio;
   mqmsg->msglen   = msglen;
 
-  /* Copy the message data into the message */
+  /* Copy the message data into the message.  There is nothing to copy if
+   * the message data was built in place in a loaned message.
+   */
 
-  memcpy((FAR void *)mqmsg->mail, (FAR const void *)msg, msglen);
+  if (msg != mqmsg->mail)
+    {
+      memcpy((FAR void *)mqmsg->mail, (FAR const void *)msg, msglen);
+    }
 
   /* Insert the new message in the message queue */
 
   flags = enter_critical_section();
 
+#ifdef CONFIG_MQ_ARENA
+  mq_msgenqueue(msgq, mqmsg);
+#else
   /* Search the message list to find the location to insert the new
    * message. Each is list is maintained in ascending priority order.
    */
@@ -382,6 +395,7 @@ int mq_dosend(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg, FAR const char *msg,
     {
       sq_addfirst((FAR sq_entry_t *)mqmsg, &msgq->msglist);
     }
+#endif
 
   /* Increment the count of messages in the queue */
 
@@ -1,7 +1,7 @@
 /****************************************************************************
  *  sched/mqueue/mq_timedsend.c
  *
- *   Copyright (C) 2007-2009, 2011, 2013-2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2011, 2013-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -195,9 +195,10 @@ int mq_timedsend(mqd_t mqdes, FAR const char *msg, size_t msglen, int prio,
       return ERROR;
     }
 
+#ifndef CONFIG_MQ_ARENA
   /* Pre-allocate a message structure */
 
-  mqmsg = mq_msgalloc();
+  mqmsg = mq_msgalloc(mqdes->msgq);
   if (mqmsg == NULL)
     {
       /* Failed to allocate the message. mq_msgalloc() does not set the
@@ -208,6 +209,7 @@ int mq_timedsend(mqd_t mqdes, FAR const char *msg, size_t msglen, int prio,
       leave_cancellation_point();
       return ERROR;
     }
+#endif
 
   /* Get a pointer to the message queue */
 
@@ -228,7 +230,16 @@ int mq_timedsend(mqd_t mqdes, FAR const char *msg, size_t msglen, int prio,
    * exceeded in that case.
    */
 
+#ifdef CONFIG_MQ_ARENA
+  /* Messages are allocated from the message queue's arena which is
+   * exhausted exactly when the message queue is full.
+   */
+
+  mqmsg = mq_msgalloc(msgq);
+  if (mqmsg != NULL)
+#else
   if (msgq->nmsgs < msgq->maxmsgs || up_interrupt_context())
+#endif
     {
       /* Do the send with no further checks (possibly exceeding maxmsgs)
        * Currently mq_dosend() always returns OK.
@@ -312,6 +323,19 @@ int mq_timedsend(mqd_t mqdes, FAR const char *msg, size_t msglen, int prio,
       goto errout_in_critical_section;
     }
 
+#ifdef CONFIG_MQ_ARENA
+  /* There is room in the arena now.  Allocate the message before leaving
+   * the critical section so that an interrupt handler cannot take it.
+   */
+
+  mqmsg = mq_msgalloc(msgq);
+  if (mqmsg == NULL)
+    {
+      result = ENOMEM;
+      goto errout_in_critical_section;
+    }
+#endif
+
   /* That is the end of the atomic operations */
 
   leave_critical_section(flags);
@@ -346,7 +370,9 @@ errout_in_critical_section:
  */
 
 errout_with_mqmsg:
-  mq_msgfree(mqmsg);
+#ifndef CONFIG_MQ_ARENA
+  mq_msgfree(msgq, mqmsg);
+#endif
   sched_unlock();
 
   set_errno(result);
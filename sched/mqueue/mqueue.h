@@ -1,7 +1,7 @@
 /****************************************************************************
  *  sched/mqueue/mqueue.h
  *
- *   Copyright (C) 2007, 2009, 2011, 2013-2014 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2009, 2011, 2013-2014, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -44,6 +44,7 @@
 #include <nuttx/compiler.h>
 
 #include <sys/types.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <limits.h>
@@ -75,6 +76,29 @@
 
 #define NUM_INTERRUPT_MSGS   8
 
+#ifdef CONFIG_MQ_ARENA
+/* The size of one message in a message queue arena with the given maximum
+ * message size.  Messages are aligned to the size of a pointer.
+ */
+
+#  define MQ_MSG_ALIGN         (sizeof(uintptr_t) - 1)
+#  define MQ_MSG_SIZE(n) \
+     ((offsetof(struct mqueue_msg_s, mail) + (n) + MQ_MSG_ALIGN) & \
+      ~MQ_MSG_ALIGN)
+
+/* Recover the message structure from a pointer to its data */
+
+#  define MQ_MSG_FROMDATA(d) \
+     ((FAR struct mqueue_msg_s *)((FAR char *)(d) - \
+      offsetof(struct mqueue_msg_s, mail)))
+
+/* The queue is full when its arena has no more free messages */
+
+#  define MQ_ISFULL(q)         sq_empty(&(q)->msgfree)
+#else
+#  define MQ_ISFULL(q)         ((q)->nmsgs >= (q)->maxmsgs)
+#endif
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
@@ -83,7 +107,9 @@ enum mqalloc_e
 {
   MQ_ALLOC_FIXED = 0,  /* pre-allocated; never freed */
   MQ_ALLOC_DYN,        /* dynamically allocated; free when unused */
-  MQ_ALLOC_IRQ         /* Preallocated, reserved for interrupt handling */
+  MQ_ALLOC_IRQ,        /* Preallocated, reserved for interrupt handling */
+  MQ_ALLOC_ARENA,      /* Allocated from the message queue's arena */
+  MQ_ALLOC_LOANED      /* Arena message on loan to the user */
 };
 
 /* This structure describes one buffered POSIX message. */
@@ -93,12 +119,16 @@ struct mqueue_msg_s
   FAR struct mqueue_msg_s *next;  /* Forward link to next message */
   uint8_t type;                   /* (Used to manage allocations) */
   uint8_t priority;               /* priority of message */
-#if MQ_MAX_BYTES < 256
+#if MQ_MAX_BYTES < 256 && !defined(CONFIG_MQ_ARENA)
   uint8_t msglen;                 /* Message data length */
 #else
   uint16_t msglen;                /* Message data length */
 #endif
+#ifdef CONFIG_MQ_ARENA
+  char mail[1];                   /* Message data (sized by the queue) */
+#else
   char mail[MQ_MAX_BYTES];        /* Message data */
+#endif
 };
 
 /****************************************************************************
@@ -113,6 +143,7 @@ extern "C"
 #define EXTERN extern
 #endif
 
+#ifndef CONFIG_MQ_ARENA
 /* The g_msgfree is a list of messages that are available for general use.
  * The number of messages in this list is a system configuration item.
  */
@@ -124,6 +155,7 @@ EXTERN sq_queue_t  g_msgfree;
  */
 
 EXTERN sq_queue_t  g_msgfreeirq;
+#endif
 
 /* The g_desfree data structure is a list of message descriptors available
  * to the operating system for general use. The number of messages in the
@@ -145,7 +177,17 @@ void weak_function mq_initialize(void);
 void mq_desblockalloc(void);
 
 FAR struct mqueue_inode_s *mq_findnamed(FAR const char *mq_name);
-void mq_msgfree(FAR struct mqueue_msg_s *mqmsg);
+void mq_msgfree(FAR struct mqueue_inode_s *msgq,
+                FAR struct mqueue_msg_s *mqmsg);
+
+/* mq_msgarena.c ***********************************************************/
+
+#ifdef CONFIG_MQ_ARENA
+void mq_arenainit(FAR struct mqueue_inode_s *msgq);
+void mq_msgenqueue(FAR struct mqueue_inode_s *msgq,
+                   FAR struct mqueue_msg_s *mqmsg);
+FAR struct mqueue_msg_s *mq_msgdequeue(FAR struct mqueue_inode_s *msgq);
+#endif
 
 /* mq_waitirq.c ************************************************************/
 
@@ -157,11 +199,12 @@ int mq_verifyreceive(mqd_t mqdes, FAR char *msg, size_t msglen);
 FAR struct mqueue_msg_s *mq_waitreceive(mqd_t mqdes);
 ssize_t mq_doreceive(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg,
                      FAR char *ubuffer, FAR int *prio);
+void mq_wakesend(FAR struct mqueue_inode_s *msgq);
 
 /* mq_sndinternal.c ********************************************************/
 
 int mq_verifysend(mqd_t mqdes, FAR const char *msg, size_t msglen, int prio);
-FAR struct mqueue_msg_s *mq_msgalloc(void);
+FAR struct mqueue_msg_s *mq_msgalloc(FAR struct mqueue_inode_s *msgq);
 int mq_waitsend(mqd_t mqdes);
 int mq_dosend(mqd_t mqdes, FAR struct mqueue_msg_s *mqmsg,
               FAR const char *msg, size_t msglen, int prio);
@@ -1,7 +1,7 @@
 /****************************************************************************
  * sched/sched/sched.h
  *
- *   Copyright (C) 2007-2014, 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2014, 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -374,6 +374,15 @@ bool sched_addprioritized(FAR struct tcb_s *tcb, DSEG dq_queue_t *list);
 void sched_mergeprioritized(FAR dq_queue_t *list1, FAR dq_queue_t *list2,
                             uint8_t task_state);
 bool sched_mergepending(void);
+#ifdef CONFIG_SCHED_READYBITMAP
+bool sched_addreadylist(FAR struct tcb_s *tcb);
+void sched_remreadylist(FAR struct tcb_s *tcb);
+#else
+#  define sched_addreadylist(t) \
+     sched_addprioritized(t, (FAR dq_queue_t *)&g_readytorun)
+#  define sched_remreadylist(t) \
+     dq_rem((FAR dq_entry_t *)(t), (FAR dq_queue_t *)&g_readytorun)
+#endif
 void sched_addblocked(FAR struct tcb_s *btcb, tstate_t task_state);
 void sched_removeblocked(FAR struct tcb_s *btcb);
 int  sched_setpriority(FAR struct tcb_s *tcb, int sched_priority);
@@ -434,6 +443,18 @@ int  sched_cpu_pause(FAR struct tcb_s *tcb);
 void weak_function sched_process_cpuload(void);
 #endif
 
+/* CPU accounting support */
+
+#ifdef CONFIG_SCHED_CPUACCT
+void sched_cpuacct_ready(FAR struct tcb_s *tcb);
+void sched_cpuacct_suspend(FAR struct tcb_s *tcb);
+void sched_cpuacct_resume(FAR struct tcb_s *tcb);
+#else
+#  define sched_cpuacct_ready(t)
+#  define sched_cpuacct_suspend(t)
+#  define sched_cpuacct_resume(t)
+#endif
+
 /* TCB operations */
 
 bool sched_verifytcb(FAR struct tcb_s *tcb);
@@ -84,6 +84,10 @@ bool sched_addreadytorun(FAR struct tcb_s *btcb)
   FAR struct tcb_s *rtcb = this_task();
   bool ret;
 
+  /* The wait for the CPU starts now */
+
+  sched_cpuacct_ready(btcb);
+
   /* Check if pre-emption is disabled for the current running task and if
    * the new ready-to-run task would cause the current running task to be
    * pre-empted.  NOTE that IRQs disabled implies that pre-emption is
@@ -103,7 +107,7 @@ bool sched_addreadytorun(FAR struct tcb_s *btcb)
 
   /* Otherwise, add the new task to the ready-to-run task list */
 
-  else if (sched_addprioritized(btcb, (FAR dq_queue_t *)&g_readytorun))
+  else if (sched_addreadylist(btcb))
     {
       /* The new btcb was added at the head of the ready-to-run list.  It
        * is now the new active task!
@@ -173,6 +177,10 @@ bool sched_addreadytorun(FAR struct tcb_s *btcb)
   int cpu;
   int me;
 
+  /* The wait for the CPU starts now */
+
+  sched_cpuacct_ready(btcb);
+
   /* Check if the blocked TCB is locked to this CPU */
 
   if ((btcb->flags & TCB_FLAG_CPU_LOCKED) != 0)
@@ -0,0 +1,275 @@
+/****************************************************************************
+ * sched/sched/sched_cpuacct.c
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <time.h>
+#include <errno.h>
+#include <assert.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/irq.h>
+#include <nuttx/sched.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_CPUACCT
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_HAVE_LONG_LONG
+#  error CONFIG_SCHED_CPUACCT requires 64-bit integer support
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_cpuacct_now
+ *
+ * Description:
+ *   Return the time since power-up in microseconds.  This is the same time
+ *   base as CLOCK_MONOTONIC, i.e., the platform timer in tickless mode.
+ *
+ ****************************************************************************/
+
+static inline uint64_t sched_cpuacct_now(void)
+{
+  struct timespec ts;
+
+  (void)clock_systimespec(&ts);
+  return (uint64_t)ts.tv_sec * USEC_PER_SEC + ts.tv_nsec / NSEC_PER_USEC;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_cpuacct_ready
+ *
+ * Description:
+ *   Called when a thread is added to the ready-to-run list.  This starts
+ *   the measurement of the latency until the thread runs.  A thread that is
+ *   already waiting for the CPU (for example, if it is re-prioritized)
+ *   keeps its original ready time.
+ *
+ * Input Parameters:
+ *   tcb - The TCB of the thread that became ready-to-run.
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called within a critical section.
+ *
+ ****************************************************************************/
+
+void sched_cpuacct_ready(FAR struct tcb_s *tcb)
+{
+  if (tcb->acct.readytime == 0)
+    {
+      tcb->acct.readytime = sched_cpuacct_now();
+    }
+}
+
+/****************************************************************************
+ * Name: sched_cpuacct_suspend
+ *
+ * Description:
+ *   Called from sched_suspend_scheduler() when a thread stops running.  The
+ *   time since the thread last started to run is charged to it.  If the
+ *   thread is still ready-to-run, then it was preempted and it starts to
+ *   wait for the CPU again.
+ *
+ * Input Parameters:
+ *   tcb - The TCB of the thread that is being suspended.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void sched_cpuacct_suspend(FAR struct tcb_s *tcb)
+{
+  FAR struct cpuacct_s *acct = &tcb->acct;
+  uint64_t now = sched_cpuacct_now();
+
+  if (now > acct->switchin)
+    {
+      acct->runtime += now - acct->switchin;
+    }
+
+  if (tcb->task_state < FIRST_BLOCKED_STATE)
+    {
+      /* Involuntary context switch */
+
+      acct->nivcsw++;
+      acct->readytime = now;
+    }
+  else
+    {
+      /* Voluntary context switch:  The thread blocked */
+
+      acct->nvcsw++;
+      acct->readytime = 0;
+    }
+}
+
+/****************************************************************************
+ * Name: sched_cpuacct_resume
+ *
+ * Description:
+ *   Called from sched_resume_scheduler() when a thread starts to run.  The
+ *   time that the thread waited since it became ready-to-run is added to
+ *   its latency histogram.
+ *
+ * Input Parameters:
+ *   tcb - The TCB of the thread that is being resumed.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void sched_cpuacct_resume(FAR struct tcb_s *tcb)
+{
+  FAR struct cpuacct_s *acct = &tcb->acct;
+  uint64_t now = sched_cpuacct_now();
+
+  acct->switchin = now;
+
+  if (acct->readytime != 0)
+    {
+      uint32_t latency;
+      uint32_t tmp;
+      int bucket;
+
+      if (now <= acct->readytime)
+        {
+          latency = 0;
+        }
+      else if (now - acct->readytime > UINT32_MAX)
+        {
+          latency = UINT32_MAX;
+        }
+      else
+        {
+          latency = (uint32_t)(now - acct->readytime);
+        }
+
+      if (latency > acct->maxlatency)
+        {
+          acct->maxlatency = latency;
+        }
+
+      /* Bucket n holds latencies from 2**n up to 2**(n+1) microseconds */
+
+      for (bucket = 0, tmp = latency >> 1;
+           tmp != 0 && bucket < CPUACCT_NBUCKETS - 1;
+           bucket++, tmp >>= 1);
+
+      acct->latency[bucket]++;
+      acct->readytime = 0;
+    }
+}
+
+/****************************************************************************
+ * Name: sched_cpuacct
+ *
+ * Description:
+ *   Return the CPU accounting data for the thread with the selected PID.  The
+ *   run time includes the time that the thread has been running since it was
+ *   last switched in.
+ *
+ * Input Parameters:
+ *   pid  - The task ID of the thread of interest.  pid == 0 is the IDLE
+ *          thread.
+ *   acct - The location to return the CPU accounting data
+ *
+ * Returned Value:
+ *   OK (0) on success; a negated errno value on failure.  The only reason
+ *   that this function can fail is if 'pid' no longer refers to a valid
+ *   thread.
+ *
+ ****************************************************************************/
+
+int sched_cpuacct(pid_t pid, FAR struct cpuacct_s *acct)
+{
+  FAR struct tcb_s *tcb;
+  irqstate_t flags;
+  uint64_t now;
+  int ret = -ESRCH;
+
+  DEBUGASSERT(acct != NULL);
+
+  /* The thread must stay valid and its counts must be consistent while we
+   * copy them.
+   */
+
+  flags = enter_critical_section();
+
+  tcb = sched_gettcb(pid);
+  if (tcb != NULL)
+    {
+      *acct = tcb->acct;
+
+      /* Add the time of the current run if the thread is running now */
+
+      if (tcb->task_state == TSTATE_TASK_RUNNING)
+        {
+          now = sched_cpuacct_now();
+          if (now > acct->switchin)
+            {
+              acct->runtime += now - acct->switchin;
+            }
+        }
+
+      ret = OK;
+    }
+
+  leave_critical_section(flags);
+  return ret;
+}
+
+#endif /* CONFIG_SCHED_CPUACCT */
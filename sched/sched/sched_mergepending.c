@@ -1,7 +1,7 @@
 /****************************************************************************
  * sched/sched/sched_mergepending.c
  *
- *   Copyright (C) 2007, 2009, 2012, 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2009, 2012, 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -84,7 +84,39 @@
  *
  ****************************************************************************/
 
-#ifndef CONFIG_SMP
+#ifdef CONFIG_SCHED_READYBITMAP
+bool sched_mergepending(void)
+{
+  FAR struct tcb_s *ptcb;
+  FAR struct tcb_s *rtcb;
+  bool ret = false;
+
+  rtcb = this_task();
+
+  /* Move every TCB from the g_pendingtasks list to the ready-to-run list.
+   * The ready-to-run list is indexed by priority so each insertion takes
+   * constant time; there is no need to walk the two lists in parallel.
+   */
+
+  while ((ptcb = (FAR struct tcb_s *)
+          dq_remfirst((FAR dq_queue_t *)&g_pendingtasks)) != NULL)
+    {
+      ptcb->task_state = TSTATE_TASK_READYTORUN;
+      ret |= sched_addreadylist(ptcb);
+    }
+
+  /* Check if the head of the ready-to-run list has changed */
+
+  if (ret)
+    {
+      rtcb->task_state        = TSTATE_TASK_READYTORUN;
+      this_task()->task_state = TSTATE_TASK_RUNNING;
+    }
+
+  return ret;
+}
+
+#elif !defined(CONFIG_SMP)
 bool sched_mergepending(void)
 {
   FAR struct tcb_s *ptcb;
@@ -1,7 +1,7 @@
 /****************************************************************************
  * sched/sched/sched_note.c
  *
- *   Copyright (C) 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -45,6 +45,8 @@
 #include <errno.h>
 
 #include <nuttx/sched.h>
+#include <nuttx/arch.h>
+#include <nuttx/irq.h>
 #include <nuttx/clock.h>
 #include <nuttx/spinlock.h>
 #include <nuttx/sched_note.h>
@@ -57,14 +59,47 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+#ifdef CONFIG_SCHED_NOTE_LOCKFREE
+#  ifdef CONFIG_SMP
+#    define NOTE_NCPUS CONFIG_SMP_NCPUS
+#  else
+#    define NOTE_NCPUS 1
+#  endif
+
+/* A full (load and store) memory barrier that orders the note data and the
+ * buffer indices as seen by other CPUs.  SP_DMB() cannot be used:  It is
+ * not provided by all SMP architectures and it may order only stores.
+ * Without SMP, only the compiler must be kept from reordering the accesses.
+ */
+
+#  if defined(CONFIG_SMP) && defined(__GNUC__)
+#    define NOTE_DMB() __sync_synchronize()
+#  elif defined(__GNUC__)
+#    define NOTE_DMB() __asm__ __volatile__ ("" : : : "memory")
+#  elif defined(CONFIG_SMP)
+#    define NOTE_DMB() SP_DMB()
+#  else
+#    define NOTE_DMB()
+#  endif
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+/* With CONFIG_SCHED_NOTE_LOCKFREE, there is one of these for each CPU.
+ * ni_head is modified only by the owning CPU and ni_tail only by the
+ * reader.
+ */
+
 struct note_info_s
 {
   volatile unsigned int ni_head;
   volatile unsigned int ni_tail;
+#ifdef CONFIG_SCHED_NOTE_LOCKFREE
+  volatile uint32_t ni_dropped;  /* Notes discarded because buffer was full */
+  uint32_t ni_reported;          /* Discarded notes reported to the reader */
+#endif
   uint8_t ni_buffer[CONFIG_SCHED_NOTE_BUFSIZE];
 };
 
@@ -92,7 +127,11 @@ static void note_add(FAR const uint8_t *note, uint8_t notelen);
  * Private Data
  ****************************************************************************/
 
+#ifdef CONFIG_SCHED_NOTE_LOCKFREE
+static struct note_info_s g_note_info[NOTE_NCPUS];
+#else
 static struct note_info_s g_note_info;
+#endif
 
 /****************************************************************************
  * Private Functions
@@ -124,6 +163,30 @@ static inline unsigned int note_next(unsigned int ndx, unsigned int offset)
   return ndx;
 }
 
+/****************************************************************************
+ * Name: note_timestamp
+ *
+ * Description:
+ *   Return the LS 32-bits of the time since power up in microseconds.
+ *   In tickless mode, the platform timer provides sub-tick resolution.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_NOTE_LOCKFREE
+static inline uint32_t note_timestamp(void)
+{
+#ifdef CONFIG_SCHED_TICKLESS
+  struct timespec ts;
+
+  (void)up_timer_gettime(&ts);
+  return (uint32_t)ts.tv_sec * USEC_PER_SEC +
+         (uint32_t)ts.tv_nsec / NSEC_PER_USEC;
+#else
+  return (uint32_t)clock_systimer() * USEC_PER_TICK;
+#endif
+}
+#endif
+
 /****************************************************************************
  * Name: note_common
  *
@@ -144,7 +207,11 @@ static inline unsigned int note_next(unsigned int ndx, unsigned int offset)
 static void note_common(FAR struct tcb_s *tcb, FAR struct note_common_s *note,
                         uint8_t length, uint8_t type)
 {
+#ifdef CONFIG_SCHED_NOTE_LOCKFREE
+  uint32_t systime    = note_timestamp();
+#else
   uint32_t systime    = (uint32_t)clock_systimer();
+#endif
 
   /* Save all of the common fields */
 
@@ -198,6 +265,249 @@ void note_spincommon(FAR struct tcb_s *tcb, FAR volatile spinlock_t *spinlock,
 }
 #endif
 
+#ifdef CONFIG_SCHED_NOTE_LOCKFREE
+/****************************************************************************
+ * Name: note_used
+ *
+ * Description:
+ *   Length of data in a circular buffer with the given indices.
+ *
+ ****************************************************************************/
+
+static inline unsigned int note_used(unsigned int head, unsigned int tail)
+{
+  if (tail > head)
+    {
+      head += CONFIG_SCHED_NOTE_BUFSIZE;
+    }
+
+  return head - tail;
+}
+
+/****************************************************************************
+ * Name: note_add
+ *
+ * Description:
+ *   Add the variable length note to the head of this CPU's circular buffer.
+ *   The note is discarded if there is not enough space for it.
+ *
+ *   Only the local interrupts are disabled so that notes from interrupt
+ *   handlers cannot interleave with this one.  The reader never modifies
+ *   the head index, so no lock is needed to serialize with it:  The note
+ *   data is written first and then published by updating the head index.
+ *
+ * Input Parameters:
+ *   note    - The note to add
+ *   notelen - The length of the note
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+static void note_add(FAR const uint8_t *note, uint8_t notelen)
+{
+  FAR struct note_info_s *ni;
+  irqstate_t flags;
+  unsigned int head;
+  unsigned int space;
+  int cpu;
+
+  DEBUGASSERT(note != NULL && notelen < CONFIG_SCHED_NOTE_BUFSIZE);
+
+  flags = up_irq_save();
+  cpu   = this_cpu();
+
+#ifdef CONFIG_SMP
+  /* Ignore notes that are not in the set of monitored CPUs */
+
+  if ((CONFIG_SCHED_INSTRUMENTATION_CPUSET & (1 << cpu)) == 0)
+    {
+      /* Not in the set of monitored CPUs.  Do not log the note. */
+
+      up_irq_restore(flags);
+      return;
+    }
+#endif
+
+  ni    = &g_note_info[cpu];
+  head  = ni->ni_head;
+  space = CONFIG_SCHED_NOTE_BUFSIZE - 1 - note_used(head, ni->ni_tail);
+
+  if (notelen > space)
+    {
+      /* The reader is not keeping up.  Discard the new note rather than
+       * disturbing the notes that the reader may be removing now.
+       */
+
+      ni->ni_dropped++;
+    }
+  else
+    {
+      unsigned int nbytes = CONFIG_SCHED_NOTE_BUFSIZE - head;
+
+      /* Make sure that the space is written only after the tail index
+       * that showed the reader to be done with it.
+       */
+
+      NOTE_DMB();
+
+      /* Copy the note into the buffer, handling wraparound */
+
+      if (nbytes >= notelen)
+        {
+          memcpy(&ni->ni_buffer[head], note, notelen);
+        }
+      else
+        {
+          memcpy(&ni->ni_buffer[head], note, nbytes);
+          memcpy(ni->ni_buffer, note + nbytes, notelen - nbytes);
+        }
+
+      /* Make sure that the note is visible before the new head index */
+
+      NOTE_DMB();
+      ni->ni_head = note_next(head, notelen);
+    }
+
+  up_irq_restore(flags);
+}
+
+/****************************************************************************
+ * Name: note_peek
+ *
+ * Description:
+ *   Return the byte at the given offset from the tail of a CPU's buffer.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_NOTE_GET
+static inline uint8_t note_peek(FAR struct note_info_s *ni,
+                                unsigned int tail, unsigned int offset)
+{
+  return ni->ni_buffer[note_next(tail, offset)];
+}
+#endif
+
+/****************************************************************************
+ * Name: note_oldest
+ *
+ * Description:
+ *   Find the CPU whose buffer holds the oldest note so that the reader
+ *   sees the notes from all CPUs in time order.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   The buffer holding the oldest note or NULL if all buffers are empty.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_NOTE_GET
+static FAR struct note_info_s *note_oldest(void)
+{
+  FAR struct note_info_s *oldest = NULL;
+  uint32_t oldtime = 0;
+  int cpu;
+
+  for (cpu = 0; cpu < NOTE_NCPUS; cpu++)
+    {
+      FAR struct note_info_s *ni = &g_note_info[cpu];
+      unsigned int tail = ni->ni_tail;
+      unsigned int head = ni->ni_head;
+      unsigned int offset;
+      uint32_t systime;
+
+      if (head == tail)
+        {
+          continue;
+        }
+
+      /* Make sure that the note is read after the head index */
+
+      NOTE_DMB();
+
+      offset  = offsetof(struct note_common_s, nc_systime);
+      systime = (uint32_t)note_peek(ni, tail, offset) |
+                (uint32_t)note_peek(ni, tail, offset + 1) << 8 |
+                (uint32_t)note_peek(ni, tail, offset + 2) << 16 |
+                (uint32_t)note_peek(ni, tail, offset + 3) << 24;
+
+      /* Timestamps wrap around so compare their difference */
+
+      if (oldest == NULL || (int32_t)(systime - oldtime) < 0)
+        {
+          oldest  = ni;
+          oldtime = systime;
+        }
+    }
+
+  return oldest;
+}
+#endif
+
+/****************************************************************************
+ * Name: note_dropped
+ *
+ * Description:
+ *   Format a NOTE_DROPPED note for the first CPU that discarded notes since
+ *   the last report.
+ *
+ * Input Parameters:
+ *   note   - Location to return the note
+ *   commit - True: Mark the discarded notes as reported
+ *
+ * Returned Value:
+ *   True if a note was formatted.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_NOTE_GET
+static bool note_dropped(FAR struct note_dropped_s *note, bool commit)
+{
+  FAR struct note_info_s *ni;
+  uint32_t systime;
+  uint32_t count;
+  int cpu;
+
+  for (cpu = 0; cpu < NOTE_NCPUS; cpu++)
+    {
+      ni    = &g_note_info[cpu];
+      count = ni->ni_dropped - ni->ni_reported;
+      if (count != 0)
+        {
+          systime = note_timestamp();
+
+          memset(note, 0, sizeof(struct note_dropped_s));
+          note->ndr_cmn.nc_length     = sizeof(struct note_dropped_s);
+          note->ndr_cmn.nc_type       = NOTE_DROPPED;
+#ifdef CONFIG_SMP
+          note->ndr_cmn.nc_cpu        = cpu;
+#endif
+          note->ndr_cmn.nc_systime[0] = (uint8_t)( systime        & 0xff);
+          note->ndr_cmn.nc_systime[1] = (uint8_t)((systime >> 8)  & 0xff);
+          note->ndr_cmn.nc_systime[2] = (uint8_t)((systime >> 16) & 0xff);
+          note->ndr_cmn.nc_systime[3] = (uint8_t)((systime >> 24) & 0xff);
+          note->ndr_count[0]          = (uint8_t)( count          & 0xff);
+          note->ndr_count[1]          = (uint8_t)((count >> 8)    & 0xff);
+          note->ndr_count[2]          = (uint8_t)((count >> 16)   & 0xff);
+          note->ndr_count[3]          = (uint8_t)((count >> 24)   & 0xff);
+
+          if (commit)
+            {
+              ni->ni_reported += count;
+            }
+
+          return true;
+        }
+    }
+
+  return false;
+}
+#endif
+
+#else /* CONFIG_SCHED_NOTE_LOCKFREE */
 /****************************************************************************
  * Name: note_length
  *
@@ -346,6 +656,7 @@ static void note_add(FAR const uint8_t *note, uint8_t notelen)
 
   g_note_info.ni_head = head;
 }
+#endif /* CONFIG_SCHED_NOTE_LOCKFREE */
 
 /****************************************************************************
  * Public Functions
@@ -582,6 +893,27 @@ void sched_note_spinabort(FAR struct tcb_s *tcb, FAR volatile void *spinlock)
 }
 #endif
 
+#ifdef CONFIG_SCHED_INSTRUMENTATION_IRQHANDLER
+void sched_note_irqhandler(int irq, bool enter)
+{
+  struct note_irqhandler_s note;
+
+  /* Format the note.  The interrupted task is the current task. */
+
+  note_common(this_task(), &note.nih_cmn, sizeof(struct note_irqhandler_s),
+              enter ? NOTE_IRQ_ENTER : NOTE_IRQ_LEAVE);
+#ifdef CONFIG_SMP
+  note.nih_cmn.nc_cpu = this_cpu();
+#endif
+  note.nih_irq[0] = (uint8_t)(irq & 0xff);
+  note.nih_irq[1] = (uint8_t)((irq >> 8) & 0xff);
+
+  /* Add the note to circular buffer */
+
+  note_add((FAR const uint8_t *)&note, sizeof(struct note_irqhandler_s));
+}
+#endif
+
 /****************************************************************************
  * Name: sched_note_get
  *
@@ -600,7 +932,95 @@ void sched_note_spinabort(FAR struct tcb_s *tcb, FAR volatile void *spinlock)
  *
  ****************************************************************************/
 
-#ifdef CONFIG_SCHED_NOTE_GET
+#if defined(CONFIG_SCHED_NOTE_GET) && defined(CONFIG_SCHED_NOTE_LOCKFREE)
+ssize_t sched_note_get(FAR uint8_t *buffer, size_t buflen)
+{
+  FAR struct note_info_s *ni;
+  struct note_dropped_s dropped;
+  irqstate_t flags;
+  unsigned int nbytes;
+  unsigned int tail;
+  ssize_t notelen;
+
+  DEBUGASSERT(buffer != NULL);
+
+  /* Only the local interrupts are disabled.  The other CPUs continue to
+   * add notes to their buffers while the note is removed.
+   */
+
+  flags = up_irq_save();
+
+  /* Report any discarded notes first */
+
+  if (note_dropped(&dropped, true))
+    {
+      if (buflen < sizeof(struct note_dropped_s))
+        {
+          notelen = -EFBIG;
+        }
+      else
+        {
+          memcpy(buffer, &dropped, sizeof(struct note_dropped_s));
+          notelen = sizeof(struct note_dropped_s);
+        }
+
+      goto errout_with_irq;
+    }
+
+  /* Find the buffer with the oldest note */
+
+  ni = note_oldest();
+  if (ni == NULL)
+    {
+      notelen = 0;
+      goto errout_with_irq;
+    }
+
+  /* Get the length of the note at the tail index */
+
+  tail    = ni->ni_tail;
+  notelen = ni->ni_buffer[tail];
+  DEBUGASSERT(notelen <= note_used(ni->ni_head, tail));
+
+  /* Is the user buffer large enough to hold the note? */
+
+  if (buflen >= notelen)
+    {
+      /* Copy the note to the user buffer, handling wraparound */
+
+      nbytes = CONFIG_SCHED_NOTE_BUFSIZE - tail;
+      if (nbytes >= notelen)
+        {
+          memcpy(buffer, &ni->ni_buffer[tail], notelen);
+        }
+      else
+        {
+          memcpy(buffer, &ni->ni_buffer[tail], nbytes);
+          memcpy(buffer + nbytes, ni->ni_buffer, notelen - nbytes);
+        }
+
+      /* Make sure that the note has been read before releasing the space */
+
+      NOTE_DMB();
+      ni->ni_tail = note_next(tail, notelen);
+    }
+  else
+    {
+      /* Remove the large note so that we do not get constipated and return
+       * an error.
+       */
+
+      NOTE_DMB();
+      ni->ni_tail = note_next(tail, notelen);
+      notelen     = -EFBIG;
+    }
+
+errout_with_irq:
+  up_irq_restore(flags);
+  return notelen;
+}
+
+#elif defined(CONFIG_SCHED_NOTE_GET)
 ssize_t sched_note_get(FAR uint8_t *buffer, size_t buflen)
 {
   FAR struct note_common_s *note;
@@ -685,7 +1105,38 @@ errout_with_csection:
  *
  ****************************************************************************/
 
-#ifdef CONFIG_SCHED_NOTE_GET
+#if defined(CONFIG_SCHED_NOTE_GET) && defined(CONFIG_SCHED_NOTE_LOCKFREE)
+ssize_t sched_note_size(void)
+{
+  FAR struct note_info_s *ni;
+  struct note_dropped_s dropped;
+  irqstate_t flags;
+  ssize_t notelen;
+
+  flags = up_irq_save();
+
+  /* Any discarded notes will be reported first.  Otherwise, return the size
+   * of the oldest note.
+   */
+
+  if (note_dropped(&dropped, false))
+    {
+      notelen = sizeof(struct note_dropped_s);
+    }
+  else if ((ni = note_oldest()) != NULL)
+    {
+      notelen = ni->ni_buffer[ni->ni_tail];
+    }
+  else
+    {
+      notelen = 0;
+    }
+
+  up_irq_restore(flags);
+  return notelen;
+}
+
+#elif defined(CONFIG_SCHED_NOTE_GET)
 ssize_t sched_note_size(void)
 {
   FAR struct note_common_s *note;
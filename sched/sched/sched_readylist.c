@@ -0,0 +1,212 @@
+/****************************************************************************
+ * sched/sched/sched_readylist.c
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <strings.h>
+#include <queue.h>
+#include <assert.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_READYBITMAP
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define READY_NPRIORITIES (SCHED_PRIORITY_MAX + 1)
+#define READY_NWORDS      ((READY_NPRIORITIES + 31) >> 5)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure indexes the g_readytorun list.  The list is still the
+ * authority on which task runs next (this_task() is the head of the list);
+ * the index only tells where a new task must be inserted.  All tasks of the
+ * same priority are adjacent in the list, so each priority level is a FIFO
+ * bucket described by its last entry.
+ */
+
+struct readymap_s
+{
+  uint32_t bitmap[READY_NWORDS];             /* Non-empty priority levels */
+  FAR struct tcb_s *tail[READY_NPRIORITIES]; /* Last TCB at each level */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct readymap_s g_readymap;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_readyprev
+ *
+ * Description:
+ *   Return the TCB that a new task of the given priority must follow in the
+ *   g_readytorun list:  The last TCB of the lowest non-empty priority level
+ *   that is greater than or equal to 'priority'.  NULL is returned if the
+ *   new task belongs at the head of the list.
+ *
+ ****************************************************************************/
+
+static inline FAR struct tcb_s *sched_readyprev(int priority)
+{
+  uint32_t bitmap;
+  int ndx;
+
+  ndx    = priority >> 5;
+  bitmap = g_readymap.bitmap[ndx] & (UINT32_MAX << (priority & 31));
+
+  while (bitmap == 0)
+    {
+      if (++ndx >= READY_NWORDS)
+        {
+          return NULL;
+        }
+
+      bitmap = g_readymap.bitmap[ndx];
+    }
+
+  return g_readymap.tail[(ndx << 5) + ffs((int)bitmap) - 1];
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_addreadylist
+ *
+ * Description:
+ *   Add a TCB to the g_readytorun list after all other TCBs of the same or
+ *   higher priority.  This is equivalent to:
+ *
+ *     sched_addprioritized(tcb, (FAR dq_queue_t *)&g_readytorun);
+ *
+ *   but takes constant time.
+ *
+ * Inputs:
+ *   tcb - Points to the TCB to add to the ready-to-run list
+ *
+ * Return Value:
+ *   true if the head of the list has changed.
+ *
+ * Assumptions:
+ * - The caller has established a critical section.
+ * - The priority of the TCB must not change while the TCB is in the
+ *   g_readytorun list; it must be removed and re-added instead.
+ *
+ ****************************************************************************/
+
+bool sched_addreadylist(FAR struct tcb_s *tcb)
+{
+  FAR struct tcb_s *prev;
+  uint8_t priority = tcb->sched_priority;
+
+  prev = sched_readyprev(priority);
+
+  g_readymap.tail[priority] = tcb;
+  g_readymap.bitmap[priority >> 5] |= (uint32_t)1 << (priority & 31);
+
+  if (prev == NULL)
+    {
+      dq_addfirst((FAR dq_entry_t *)tcb, (FAR dq_queue_t *)&g_readytorun);
+      return true;
+    }
+
+  dq_addafter((FAR dq_entry_t *)prev, (FAR dq_entry_t *)tcb,
+              (FAR dq_queue_t *)&g_readytorun);
+  return false;
+}
+
+/****************************************************************************
+ * Name: sched_remreadylist
+ *
+ * Description:
+ *   Remove a TCB from the g_readytorun list.
+ *
+ * Inputs:
+ *   tcb - Points to the TCB to remove from the ready-to-run list
+ *
+ * Return Value:
+ *   None
+ *
+ * Assumptions:
+ *   The caller has established a critical section.
+ *
+ ****************************************************************************/
+
+void sched_remreadylist(FAR struct tcb_s *tcb)
+{
+  FAR struct tcb_s *prev;
+  uint8_t priority = tcb->sched_priority;
+
+  /* If this is the last TCB of its priority level, then the previous TCB
+   * becomes the last one.  Or the level becomes empty if there is no
+   * previous TCB of the same priority.
+   */
+
+  if (g_readymap.tail[priority] == tcb)
+    {
+      prev = tcb->blink;
+      if (prev != NULL && prev->sched_priority == priority)
+        {
+          g_readymap.tail[priority] = prev;
+        }
+      else
+        {
+          g_readymap.tail[priority] = NULL;
+          g_readymap.bitmap[priority >> 5] &=
+            ~((uint32_t)1 << (priority & 31));
+        }
+    }
+
+  dq_rem((FAR dq_entry_t *)tcb, (FAR dq_queue_t *)&g_readytorun);
+}
+
+#endif /* CONFIG_SCHED_READYBITMAP */
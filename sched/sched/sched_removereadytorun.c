@@ -100,7 +100,7 @@ bool sched_removereadytorun(FAR struct tcb_s *rtcb)
    * is always the g_readytorun list.
    */
 
-  dq_rem((FAR dq_entry_t *)rtcb, (FAR dq_queue_t *)&g_readytorun);
+  sched_remreadylist(rtcb);
 
   /* Since the TCB is not in any list, it is now invalid */
 
@@ -1,7 +1,7 @@
 /****************************************************************************
  * sched/sched/sched_resumescheduler.c
  *
- *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2015, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -48,7 +48,7 @@
 #include "sched/sched.h"
 
 #if CONFIG_RR_INTERVAL > 0 || defined(CONFIG_SCHED_SPORADIC) || \
-    defined(CONFIG_SCHED_INSTRUMENTATION)
+    defined(CONFIG_SCHED_INSTRUMENTATION) || defined(CONFIG_SCHED_CPUACCT)
 
 /****************************************************************************
  * Public Functions
@@ -95,6 +95,12 @@ void sched_resume_scheduler(FAR struct tcb_s *tcb)
     }
 #endif
 
+#ifdef CONFIG_SCHED_CPUACCT
+  /* Start charging time to the task and record its ready-to-run latency */
+
+  sched_cpuacct_resume(tcb);
+#endif
+
 #ifdef CONFIG_SCHED_INSTRUMENTATION
   /* Inidicate the the task has been resumed */
 
@@ -103,4 +109,5 @@ void sched_resume_scheduler(FAR struct tcb_s *tcb)
 
 }
 
-#endif /* CONFIG_RR_INTERVAL > 0 || CONFIG_SCHED_SPORADIC || CONFIG_SCHED_INSTRUMENTATION */
+#endif /* CONFIG_RR_INTERVAL > 0 || CONFIG_SCHED_SPORADIC ||
+        * CONFIG_SCHED_INSTRUMENTATION || CONFIG_SCHED_CPUACCT */
@@ -1,7 +1,7 @@
 /****************************************************************************
  * sched/sched/sched_setpriority.c
  *
- *   Copyright (C) 2009, 2013, 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2009, 2013, 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -164,9 +164,19 @@ static inline void sched_running_setpriority(FAR struct tcb_s *tcb,
 
   else
     {
+#ifdef CONFIG_SCHED_READYBITMAP
+      /* The ready-to-run list is indexed by priority so the TCB must be
+       * removed and re-added.  It will remain at the head of the list.
+       */
+
+      sched_remreadylist(tcb);
+      tcb->sched_priority = (uint8_t)sched_priority;
+      (void)sched_addreadylist(tcb);
+#else
       /* Change the task priority */
 
       tcb->sched_priority = (uint8_t)sched_priority;
+#endif
     }
 }
 
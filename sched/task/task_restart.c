@@ -1,7 +1,7 @@
 /****************************************************************************
  * sched/task/task_restart.c
  *
- *   Copyright (C) 2007, 2009, 2012-2013, 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007, 2009, 2012-2013, 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -153,7 +153,17 @@ int task_restart(pid_t pid)
   tasklist = TLIST_HEAD(tcb->cmn.task_state);
 #endif
 
-  dq_rem((FAR dq_entry_t *)tcb, tasklist);
+#ifdef CONFIG_SCHED_READYBITMAP
+  if (tasklist == (FAR dq_queue_t *)&g_readytorun)
+    {
+      sched_remreadylist((FAR struct tcb_s *)tcb);
+    }
+  else
+#endif
+    {
+      dq_rem((FAR dq_entry_t *)tcb, tasklist);
+    }
+
   tcb->cmn.task_state = TSTATE_TASK_INVALID;
 
   /* Deallocate anything left in the TCB's queues */
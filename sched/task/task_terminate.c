@@ -1,7 +1,7 @@
 /****************************************************************************
  * sched/task/task_terminate.c
  *
- *   Copyright (C) 2007-2009, 2011-2014, 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2011-2014, 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -159,7 +159,17 @@ int task_terminate(pid_t pid, bool nonblocking)
 
   /* Remove the task from the task list */
 
-  dq_rem((FAR dq_entry_t *)dtcb, tasklist);
+#ifdef CONFIG_SCHED_READYBITMAP
+  if (tasklist == (FAR dq_queue_t *)&g_readytorun)
+    {
+      sched_remreadylist(dtcb);
+    }
+  else
+#endif
+    {
+      dq_rem((FAR dq_entry_t *)dtcb, tasklist);
+    }
+
   dtcb->task_state = TSTATE_TASK_INVALID;
 
   /* At this point, the TCB should no longer be accessible to the system */
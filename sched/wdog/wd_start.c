@@ -1,7 +1,7 @@
 /****************************************************************************
  * sched/wdog/wd_start.c
  *
- *   Copyright (C) 2007-2009, 2012, 2014, 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2007-2009, 2012, 2014, 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -90,6 +90,68 @@ typedef void (*wdentry4_t)(int argc, wdparm_t arg1, wdparm_t arg2,
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: wd_dispatch
+ *
+ * Description:
+ *   Execute the function of a watchdog that has been removed from the
+ *   active watchdog queue.
+ *
+ * Parameters:
+ *   wdog - The expired watchdog
+ *
+ * Return Value:
+ *   None
+ *
+ ****************************************************************************/
+
+static inline void wd_dispatch(FAR struct wdog_s *wdog)
+{
+  /* Indicate that the watchdog is no longer active. */
+
+  WDOG_CLRACTIVE(wdog);
+
+  /* Execute the watchdog function */
+
+  up_setpicbase(wdog->picbase);
+  switch (wdog->argc)
+    {
+      default:
+        DEBUGPANIC();
+        break;
+
+      case 0:
+        (*((wdentry0_t)(wdog->func)))(0);
+        break;
+
+#if CONFIG_MAX_WDOGPARMS > 0
+      case 1:
+        (*((wdentry1_t)(wdog->func)))(1, wdog->parm[0]);
+        break;
+#endif
+#if CONFIG_MAX_WDOGPARMS > 1
+      case 2:
+        (*((wdentry2_t)(wdog->func)))(2,
+                        wdog->parm[0], wdog->parm[1]);
+        break;
+#endif
+#if CONFIG_MAX_WDOGPARMS > 2
+      case 3:
+        (*((wdentry3_t)(wdog->func)))(3,
+                        wdog->parm[0], wdog->parm[1],
+                        wdog->parm[2]);
+        break;
+#endif
+#if CONFIG_MAX_WDOGPARMS > 3
+      case 4:
+        (*((wdentry4_t)(wdog->func)))(4,
+                        wdog->parm[0], wdog->parm[1],
+                        wdog->parm[2], wdog->parm[3]);
+        break;
+#endif
+    }
+}
+
 /****************************************************************************
  * Name: wd_expiration
  *
@@ -107,6 +169,19 @@ typedef void (*wdentry4_t)(int argc, wdparm_t arg1, wdparm_t arg2,
  *
  ****************************************************************************/
 
+#ifdef CONFIG_WDOG_TIMERWHEEL
+static inline void wd_expiration(void)
+{
+  FAR struct wdog_s *wdog;
+
+  /* Execute all of the watchdogs that expire at the current wheel time */
+
+  while ((wdog = wd_wheel_expired()) != NULL)
+    {
+      wd_dispatch(wdog);
+    }
+}
+#else
 static inline void wd_expiration(void)
 {
   FAR struct wdog_s *wdog;
@@ -135,52 +210,13 @@ static inline void wd_expiration(void)
               ((FAR struct wdog_s *)g_wdactivelist.head)->lag += wdog->lag;
             }
 
-          /* Indicate that the watchdog is no longer active. */
-
-          WDOG_CLRACTIVE(wdog);
-
           /* Execute the watchdog function */
 
-          up_setpicbase(wdog->picbase);
-          switch (wdog->argc)
-            {
-              default:
-                DEBUGPANIC();
-                break;
-
-              case 0:
-                (*((wdentry0_t)(wdog->func)))(0);
-                break;
-
-#if CONFIG_MAX_WDOGPARMS > 0
-              case 1:
-                (*((wdentry1_t)(wdog->func)))(1, wdog->parm[0]);
-                break;
-#endif
-#if CONFIG_MAX_WDOGPARMS > 1
-              case 2:
-                (*((wdentry2_t)(wdog->func)))(2,
-                                wdog->parm[0], wdog->parm[1]);
-                break;
-#endif
-#if CONFIG_MAX_WDOGPARMS > 2
-              case 3:
-                (*((wdentry3_t)(wdog->func)))(3,
-                                wdog->parm[0], wdog->parm[1],
-                                wdog->parm[2]);
-                break;
-#endif
-#if CONFIG_MAX_WDOGPARMS > 3
-              case 4:
-                (*((wdentry4_t)(wdog->func)))(4,
-                                wdog->parm[0], wdog->parm[1],
-                                wdog->parm[2], wdog->parm[3]);
-                break;
-#endif
-            }
+          wd_dispatch(wdog);
         }
     }
 }
+#endif
 
 /****************************************************************************
  * Public Functions
@@ -222,10 +258,12 @@ static inline void wd_expiration(void)
 int wd_start(WDOG_ID wdog, int32_t delay, wdentry_t wdentry,  int argc, ...)
 {
   va_list ap;
+#ifndef CONFIG_WDOG_TIMERWHEEL
   FAR struct wdog_s *curr;
   FAR struct wdog_s *prev;
   FAR struct wdog_s *next;
   int32_t now;
+#endif
   irqstate_t flags;
   int i;
 
@@ -289,6 +327,12 @@ int wd_start(WDOG_ID wdog, int32_t delay, wdentry_t wdentry,  int argc, ...)
   (void)sched_timer_cancel();
 #endif
 
+#ifdef CONFIG_WDOG_TIMERWHEEL
+  /* Add the watchdog to the wheel slot for its expiration time */
+
+  wd_wheel_insert(wdog, delay);
+
+#else
   /* Do the easy case first -- when the watchdog timer queue is empty. */
 
   if (g_wdactivelist.head == NULL)
@@ -374,9 +418,13 @@ int wd_start(WDOG_ID wdog, int32_t delay, wdentry_t wdentry,  int argc, ...)
         }
     }
 
-  /* Put the lag into the watchdog structure and mark it as active. */
+  /* Put the lag into the watchdog structure. */
 
   wdog->lag = delay;
+#endif
+
+  /* Mark the watchdog as active */
+
   WDOG_SETACTIVE(wdog);
 
 #ifdef CONFIG_SCHED_TICKLESS
@@ -420,12 +468,14 @@ int wd_start(WDOG_ID wdog, int32_t delay, wdentry_t wdentry,  int argc, ...)
 #ifdef CONFIG_SCHED_TICKLESS
 unsigned int wd_timer(int ticks)
 {
+#ifndef CONFIG_WDOG_TIMERWHEEL
   FAR struct wdog_s *wdog;
+  int decr;
+#endif
 #ifdef CONFIG_SMP
   irqstate_t flags;
 #endif
   unsigned int ret;
-  int decr;
 
 #ifdef CONFIG_SMP
   /* We are in an interrupt handler as, as a consequence, interrupts are
@@ -440,6 +490,22 @@ unsigned int wd_timer(int ticks)
   flags = enter_critical_section();
 #endif
 
+#ifdef CONFIG_WDOG_TIMERWHEEL
+  /* Advance the wheel over the interval that just expired, stopping at each
+   * tick where watchdogs expire or move down the wheel.
+   */
+
+  while (ticks > 0)
+    {
+      ticks -= wd_wheel_advance(ticks);
+      wd_expiration();
+    }
+
+  /* Return the delay for the next wheel event */
+
+  ret = wd_wheel_next();
+
+#else
   /* Check if there are any active watchdogs to process */
 
   while (g_wdactivelist.head != NULL && ticks > 0)
@@ -474,6 +540,7 @@ unsigned int wd_timer(int ticks)
 
   ret = g_wdactivelist.head ?
           ((FAR struct wdog_s *)g_wdactivelist.head)->lag : 0;
+#endif
 
 #ifdef CONFIG_SMP
   leave_critical_section(flags);
@@ -502,6 +569,13 @@ void wd_timer(void)
   flags = enter_critical_section();
 #endif
 
+#ifdef CONFIG_WDOG_TIMERWHEEL
+  /* Advance the wheel by one tick and run any watchdogs that expire */
+
+  (void)wd_wheel_advance(1);
+  wd_expiration();
+
+#else
   /* Check if there are any active watchdogs to process */
 
   if (g_wdactivelist.head)
@@ -514,6 +588,7 @@ void wd_timer(void)
 
       wd_expiration();
     }
+#endif
 
 #ifdef CONFIG_SMP
   leave_critical_section(flags);
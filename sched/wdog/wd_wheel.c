@@ -0,0 +1,400 @@
+/****************************************************************************
+ * sched/wdog/wd_wheel.c
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <strings.h>
+#include <assert.h>
+
+#include <nuttx/wdog.h>
+
+#include "wdog/wdog.h"
+
+#ifdef CONFIG_WDOG_TIMERWHEEL
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_WDOG_WHEEL_LEVELS
+#  define CONFIG_WDOG_WHEEL_LEVELS 4
+#endif
+
+#if CONFIG_WDOG_WHEEL_LEVELS < 2 || CONFIG_WDOG_WHEEL_LEVELS > 6
+#  error CONFIG_WDOG_WHEEL_LEVELS out of range
+#endif
+
+/* Wheel geometry.  Each level has 32 slots so that the non-empty slots of
+ * a level can be represented with a single 32-bit bitmap.  A slot at level
+ * 'l' spans WHEEL_SPAN(l) ticks.
+ */
+
+#define WHEEL_BITS          5
+#define WHEEL_SLOTS         (1 << WHEEL_BITS)
+#define WHEEL_MASK          (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS        CONFIG_WDOG_WHEEL_LEVELS
+
+#define WHEEL_SHIFT(l)      ((l) * WHEEL_BITS)
+#define WHEEL_SPAN(l)       ((uint32_t)1 << WHEEL_SHIFT(l))
+#define WHEEL_RANGE         WHEEL_SPAN(WHEEL_LEVELS)
+
+#define WHEEL_INDEX(l,s)    ((l) * WHEEL_SLOTS + (s))
+#define WHEEL_LEVEL(i)      ((i) >> WHEEL_BITS)
+#define WHEEL_SLOT(i)       ((i) & WHEEL_MASK)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct wd_wheel_s
+{
+  uint32_t now;                             /* Current wheel time in ticks */
+  uint32_t bitmap[WHEEL_LEVELS];            /* Non-empty slots of each level */
+
+  /* Each slot is a list of watchdogs linked through the next field.  The
+   * prev field of the first watchdog in a slot points to the last watchdog
+   * in the slot so that watchdogs can be appended in FIFO order.
+   */
+
+  FAR struct wdog_s *slot[WHEEL_LEVELS * WHEEL_SLOTS];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct wd_wheel_s g_wdwheel;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_wheel_link
+ *
+ * Description:
+ *   Add a watchdog to the wheel slot that corresponds to its expiration
+ *   time.  Watchdogs expiring within the next 32 ticks go into level 0;
+ *   others go into the lowest level whose span covers the delay.
+ *
+ ****************************************************************************/
+
+static void wd_wheel_link(FAR struct wdog_s *wdog)
+{
+  FAR struct wdog_s **head;
+  uint32_t delta = wdog->expire - g_wdwheel.now;
+  uint32_t when  = wdog->expire;
+  unsigned int ndx;
+  int level;
+
+  /* Delays beyond the range of the wheel are parked in the top level at
+   * the slot farthest from now.  They are re-inserted when that slot is
+   * cascaded.
+   */
+
+  if (delta >= WHEEL_RANGE)
+    {
+      delta = WHEEL_RANGE - 1;
+      when  = g_wdwheel.now + delta;
+    }
+
+  for (level = 0; delta >= WHEEL_SPAN(level + 1); level++);
+
+  ndx        = (when >> WHEEL_SHIFT(level)) & WHEEL_MASK;
+  wdog->slot = WHEEL_INDEX(level, ndx);
+  wdog->next = NULL;
+
+  head = &g_wdwheel.slot[wdog->slot];
+  if (*head == NULL)
+    {
+      wdog->prev = wdog;
+      *head      = wdog;
+      g_wdwheel.bitmap[level] |= (uint32_t)1 << ndx;
+    }
+  else
+    {
+      FAR struct wdog_s *tail = (*head)->prev;
+
+      tail->next    = wdog;
+      wdog->prev    = tail;
+      (*head)->prev = wdog;
+    }
+}
+
+/****************************************************************************
+ * Name: wd_wheel_cascade
+ *
+ * Description:
+ *   Re-insert all of the watchdogs in one slot of an upper level.  They
+ *   will move to lower levels now that their expiration time is nearer.
+ *
+ ****************************************************************************/
+
+static void wd_wheel_cascade(int level, unsigned int ndx)
+{
+  FAR struct wdog_s **head = &g_wdwheel.slot[WHEEL_INDEX(level, ndx)];
+  FAR struct wdog_s *wdog;
+  FAR struct wdog_s *next;
+
+  wdog  = *head;
+  *head = NULL;
+  g_wdwheel.bitmap[level] &= ~((uint32_t)1 << ndx);
+
+  for (; wdog != NULL; wdog = next)
+    {
+      next = wdog->next;
+      wd_wheel_link(wdog);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_wheel_insert
+ *
+ * Description:
+ *   Add a watchdog to the timer wheel so that it expires 'delay' ticks
+ *   after the current wheel time.
+ *
+ ****************************************************************************/
+
+void wd_wheel_insert(FAR struct wdog_s *wdog, int32_t delay)
+{
+  DEBUGASSERT(delay > 0);
+
+  wdog->expire = g_wdwheel.now + (uint32_t)delay;
+  wd_wheel_link(wdog);
+}
+
+/****************************************************************************
+ * Name: wd_wheel_remove
+ *
+ * Description:
+ *   Remove an active watchdog from the timer wheel.
+ *
+ ****************************************************************************/
+
+bool wd_wheel_remove(FAR struct wdog_s *wdog)
+{
+  FAR struct wdog_s **head = &g_wdwheel.slot[wdog->slot];
+  bool empty = false;
+
+  DEBUGASSERT(*head != NULL);
+
+  if (wdog == *head)
+    {
+      *head = wdog->next;
+      if (*head != NULL)
+        {
+          (*head)->prev = wdog->prev;
+        }
+      else
+        {
+          g_wdwheel.bitmap[WHEEL_LEVEL(wdog->slot)] &=
+            ~((uint32_t)1 << WHEEL_SLOT(wdog->slot));
+          empty = true;
+        }
+    }
+  else
+    {
+      wdog->prev->next = wdog->next;
+      if (wdog->next != NULL)
+        {
+          wdog->next->prev = wdog->prev;
+        }
+      else
+        {
+          (*head)->prev = wdog->prev;
+        }
+    }
+
+  wdog->next = NULL;
+  wdog->prev = NULL;
+  return empty;
+}
+
+/****************************************************************************
+ * Name: wd_wheel_remaining
+ *
+ * Description:
+ *   Return the number of ticks before an active watchdog expires.
+ *
+ ****************************************************************************/
+
+int wd_wheel_remaining(FAR struct wdog_s *wdog)
+{
+  return (int)(wdog->expire - g_wdwheel.now);
+}
+
+/****************************************************************************
+ * Name: wd_wheel_next
+ *
+ * Description:
+ *   Return the number of ticks until the next wheel event (an expiration or
+ *   a cascade of a non-empty slot), or zero if the wheel is empty.
+ *
+ ****************************************************************************/
+
+unsigned int wd_wheel_next(void)
+{
+  uint32_t next = 0;
+  uint32_t bitmap;
+  uint32_t base;
+  uint32_t due;
+  unsigned int curr;
+  int level;
+
+  for (level = 0; level < WHEEL_LEVELS; level++)
+    {
+      bitmap = g_wdwheel.bitmap[level];
+      if (bitmap == 0)
+        {
+          continue;
+        }
+
+      /* Rotate the bitmap so that bit 0 corresponds to the slot following
+       * the current slot of this level.  The current slot itself comes
+       * last:  it is not processed again until the level wraps around.
+       */
+
+      base = g_wdwheel.now >> WHEEL_SHIFT(level);
+      curr = base & WHEEL_MASK;
+
+      if (curr != WHEEL_MASK)
+        {
+          bitmap = (bitmap >> (curr + 1)) | (bitmap << (WHEEL_MASK - curr));
+        }
+
+      /* ffs() returns the distance, in slots, to the next non-empty slot.
+       * That slot is processed at the start of its span.
+       */
+
+      due = ((base + ffs((int)bitmap)) << WHEEL_SHIFT(level)) -
+            g_wdwheel.now;
+
+      if (next == 0 || due < next)
+        {
+          next = due;
+        }
+    }
+
+  return next;
+}
+
+/****************************************************************************
+ * Name: wd_wheel_advance
+ *
+ * Description:
+ *   Advance the wheel time by up to 'ticks' ticks, stopping early at the
+ *   first tick where watchdogs become due or must be cascaded to a lower
+ *   level.
+ *
+ ****************************************************************************/
+
+unsigned int wd_wheel_advance(unsigned int ticks)
+{
+  unsigned int next;
+  int level;
+
+  DEBUGASSERT(ticks > 0);
+
+  /* No wheel event can happen before the next non-empty slot, so any
+   * number of ticks up to that point can be skipped at once.
+   */
+
+  next = ticks;
+  if (ticks > 1)
+    {
+      next = wd_wheel_next();
+      if (next == 0 || next > ticks)
+        {
+          next = ticks;
+        }
+    }
+
+  g_wdwheel.now += next;
+
+  /* Cascade the upper levels whose current slot just started.  Higher
+   * levels go first because they may refill a lower level slot that is
+   * also due now.  Watchdogs that are due now land in the current level 0
+   * slot.
+   */
+
+  for (level = WHEEL_LEVELS - 1; level > 0; level--)
+    {
+      if ((g_wdwheel.now & (WHEEL_SPAN(level) - 1)) == 0)
+        {
+          wd_wheel_cascade(level,
+                           (g_wdwheel.now >> WHEEL_SHIFT(level)) & WHEEL_MASK);
+        }
+    }
+
+  return next;
+}
+
+/****************************************************************************
+ * Name: wd_wheel_expired
+ *
+ * Description:
+ *   Remove and return the next watchdog that expires at the current wheel
+ *   time, or NULL if there are no more.
+ *
+ ****************************************************************************/
+
+FAR struct wdog_s *wd_wheel_expired(void)
+{
+  FAR struct wdog_s *wdog;
+
+  wdog = g_wdwheel.slot[WHEEL_INDEX(0, g_wdwheel.now & WHEEL_MASK)];
+  if (wdog != NULL)
+    {
+      DEBUGASSERT(wdog->expire == g_wdwheel.now);
+      (void)wd_wheel_remove(wdog);
+    }
+
+  return wdog;
+}
+
+#endif /* CONFIG_WDOG_TIMERWHEEL */
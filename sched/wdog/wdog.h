@@ -66,12 +66,14 @@ extern "C"
 
 extern sq_queue_t g_wdfreelist;
 
+#ifndef CONFIG_WDOG_TIMERWHEEL
 /* The g_wdactivelist data structure is a singly linked list ordered by
  * watchdog expiration time. When watchdog timers expire,the functions on
  * this linked list are removed and the function is called.
  */
 
 extern sq_queue_t g_wdactivelist;
+#endif
 
 /* This is the number of free, pre-allocated watchdog structures in the
  * g_wdfreelist.  This value is used to enforce a reserve for interrupt
@@ -158,6 +160,103 @@ void wd_timer(void);
 struct tcb_s;
 void wd_recover(FAR struct tcb_s *tcb);
 
+#ifdef CONFIG_WDOG_TIMERWHEEL
+/****************************************************************************
+ * Name: wd_wheel_insert
+ *
+ * Description:
+ *   Add a watchdog to the timer wheel so that it expires 'delay' ticks
+ *   after the current wheel time.
+ *
+ * Parameters:
+ *   wdog  - The watchdog to be added
+ *   delay - The delay in clock ticks (must be greater than zero)
+ *
+ * Return Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called in a critical section.
+ *
+ ****************************************************************************/
+
+void wd_wheel_insert(FAR struct wdog_s *wdog, int32_t delay);
+
+/****************************************************************************
+ * Name: wd_wheel_remove
+ *
+ * Description:
+ *   Remove an active watchdog from the timer wheel.
+ *
+ * Parameters:
+ *   wdog - The watchdog to be removed
+ *
+ * Return Value:
+ *   True if the wheel slot that held the watchdog is now empty.  In that
+ *   case, the time of the next expiration may have changed.
+ *
+ * Assumptions:
+ *   Called in a critical section.
+ *
+ ****************************************************************************/
+
+bool wd_wheel_remove(FAR struct wdog_s *wdog);
+
+/****************************************************************************
+ * Name: wd_wheel_remaining
+ *
+ * Description:
+ *   Return the number of ticks before an active watchdog expires.
+ *
+ ****************************************************************************/
+
+int wd_wheel_remaining(FAR struct wdog_s *wdog);
+
+/****************************************************************************
+ * Name: wd_wheel_advance
+ *
+ * Description:
+ *   Advance the wheel time by up to 'ticks' ticks, stopping early at the
+ *   first tick where watchdogs become due or must be cascaded to a lower
+ *   level.  Watchdogs that are due are moved to the expired slot where
+ *   they can be collected with wd_wheel_expired().
+ *
+ * Parameters:
+ *   ticks - The maximum number of ticks to advance (must be > 0)
+ *
+ * Return Value:
+ *   The number of ticks actually consumed (always greater than zero).
+ *
+ * Assumptions:
+ *   Called in a critical section.
+ *
+ ****************************************************************************/
+
+unsigned int wd_wheel_advance(unsigned int ticks);
+
+/****************************************************************************
+ * Name: wd_wheel_expired
+ *
+ * Description:
+ *   Remove and return the next watchdog that expires at the current wheel
+ *   time, or NULL if there are no more.
+ *
+ ****************************************************************************/
+
+FAR struct wdog_s *wd_wheel_expired(void);
+
+/****************************************************************************
+ * Name: wd_wheel_next
+ *
+ * Description:
+ *   Return the number of ticks until the next wheel event (an expiration or
+ *   a cascade of a non-empty slot), or zero if the wheel is empty.
+ *
+ ****************************************************************************/
+
+unsigned int wd_wheel_next(void);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
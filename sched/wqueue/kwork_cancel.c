@@ -1,7 +1,7 @@
 /****************************************************************************
  * sched/wqueue/kwork_cancel.c
  *
- *   Copyright (C) 2014, 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014, 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -92,19 +92,38 @@ static int work_qcancel(FAR struct kwork_wqueue_s *wqueue,
   flags = enter_critical_section();
   if (work->worker != NULL)
     {
+      /* Work with a non-zero delay is still in the delayed work queue.
+       * The delay is cleared when the work is moved to the ready queue.
+       */
+
+      FAR dq_queue_t *q = work->delay > 0 ? &wqueue->delayq :
+                          WORK_READYQ(wqueue, work);
+
       /* A little test of the integrity of the work queue */
 
       DEBUGASSERT(work->dq.flink != NULL ||
-                  (FAR dq_entry_t *)work == wqueue->q.tail);
+                  (FAR dq_entry_t *)work == q->tail);
       DEBUGASSERT(work->dq.blink != NULL ||
-                  (FAR dq_entry_t *)work == wqueue->q.head);
+                  (FAR dq_entry_t *)work == q->head);
 
       /* Remove the entry from the work queue and make sure that it is
        * marked as available (i.e., the worker field is nullified).
        */
 
-      dq_rem((FAR dq_entry_t *)work, &wqueue->q);
+      dq_rem((FAR dq_entry_t *)work, q);
       work->worker = NULL;
+
+#ifdef CONFIG_SCHED_WORKSTATS
+      if (q == &wqueue->delayq)
+        {
+          wqueue->stats.ndelayed--;
+        }
+      else
+        {
+          wqueue->stats.nready--;
+        }
+#endif
+
       ret = OK;
     }
 
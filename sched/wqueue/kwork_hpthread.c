@@ -149,6 +149,7 @@ int work_hpstart(void)
 
   g_hpwork.delay          = CONFIG_SCHED_HPWORKPERIOD / USEC_PER_TICK;
   dq_init(&g_hpwork.q);
+  dq_init(&g_hpwork.delayq);
 
   /* Start the high-priority, kernel mode worker thread */
 
@@ -1,7 +1,7 @@
 /****************************************************************************
  * sched/wqueue/work_lpthread.c
  *
- *   Copyright (C) 2009-2014 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2009-2014, 2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -63,6 +63,12 @@
 
 struct lp_wqueue_s g_lpwork;
 
+#ifdef CONFIG_SCHED_LPWORK_PERCPU
+/* The per-CPU ready queues of the low priority work queue */
+
+static struct dq_queue_s g_lpcpuq[CONFIG_SMP_NCPUS];
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -188,6 +194,16 @@ int work_lpstart(void)
 
   g_lpwork.delay = CONFIG_SCHED_LPWORKPERIOD / USEC_PER_TICK;
   dq_init(&g_lpwork.q);
+  dq_init(&g_lpwork.delayq);
+
+#ifdef CONFIG_SCHED_LPWORK_PERCPU
+  for (wndx = 0; wndx < CONFIG_SMP_NCPUS; wndx++)
+    {
+      dq_init(&g_lpcpuq[wndx]);
+    }
+
+  g_lpwork.cpuq = g_lpcpuq;
+#endif
 
   /* Don't permit any of the threads to run until we have fully initialized
    * g_lpwork.
@@ -219,6 +235,18 @@ int work_lpstart(void)
 
       g_lpwork.worker[wndx].pid  = pid;
       g_lpwork.worker[wndx].busy = true;
+
+#ifdef CONFIG_SCHED_LPWORK_PERCPU
+      /* Bind the worker thread to its CPU */
+
+      {
+        cpu_set_t cpuset;
+
+        CPU_ZERO(&cpuset);
+        CPU_SET(wndx % CONFIG_SMP_NCPUS, &cpuset);
+        (void)sched_setaffinity(pid, sizeof(cpu_set_t), &cpuset);
+      }
+#endif
     }
 
   sched_unlock();
@@ -1,7 +1,7 @@
 /****************************************************************************
  * sched/wqueue/work_process.c
  *
- *   Copyright (C) 2009-2014, 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2009-2014, 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -71,6 +71,109 @@
 #  define MIN(a,b) ((a) < (b) ? (a) : (b))
 #endif
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: work_expire
+ *
+ * Description:
+ *   Move all delayed work whose delay has elapsed to the tail of the ready
+ *   queue.  The delayed work queue is ordered by expiration time, so only
+ *   the head of that queue needs to be examined.
+ *
+ *   The time that the work became ready is saved in qtime and the delay is
+ *   cleared.  A zero delay then indicates that the work is in the ready
+ *   queue.
+ *
+ * Input parameters:
+ *   wqueue - Describes the work queue to be processed
+ *   ctick  - The current time in clock ticks
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called in a critical section.
+ *
+ ****************************************************************************/
+
+static void work_expire(FAR struct kwork_wqueue_s *wqueue, systime_t ctick)
+{
+  FAR struct work_s *work;
+
+  while ((work = (FAR struct work_s *)wqueue->delayq.head) != NULL &&
+         WORK_REMAINING(work, ctick) == 0)
+    {
+      (void)dq_remfirst(&wqueue->delayq);
+
+      work->qtime += work->delay;
+      work->delay  = 0;
+
+      dq_addlast((FAR dq_entry_t *)work, WORK_READYQ(wqueue, work));
+
+#ifdef CONFIG_SCHED_WORKSTATS
+      wqueue->stats.ndelayed--;
+      wqueue->stats.nready++;
+#endif
+    }
+}
+
+/****************************************************************************
+ * Name: work_next
+ *
+ * Description:
+ *   Remove and return the next ready work for the worker thread 'wndx'.
+ *
+ *   If the work queue has per-CPU ready queues, the worker thread first
+ *   takes work from the ready queue of the CPU that it is bound to.  If
+ *   there is none, it steals the oldest work from the ready queues of the
+ *   other CPUs.
+ *
+ * Input parameters:
+ *   wqueue - Describes the work queue to be processed
+ *   wndx   - The worker thread index
+ *
+ * Returned Value:
+ *   The next work to perform or NULL if there is no ready work.
+ *
+ * Assumptions:
+ *   Called in a critical section.
+ *
+ ****************************************************************************/
+
+static FAR struct work_s *work_next(FAR struct kwork_wqueue_s *wqueue,
+                                    int wndx)
+{
+#ifdef CONFIG_SCHED_LPWORK_PERCPU
+  if (wqueue->cpuq != NULL)
+    {
+      FAR dq_entry_t *work;
+      int cpu = wndx % CONFIG_SMP_NCPUS;
+      int i;
+
+      for (i = 0; i < CONFIG_SMP_NCPUS; i++)
+        {
+          work = dq_remfirst(&wqueue->cpuq[cpu]);
+          if (work != NULL)
+            {
+              return (FAR struct work_s *)work;
+            }
+
+          if (++cpu >= CONFIG_SMP_NCPUS)
+            {
+              cpu = 0;
+            }
+        }
+
+      return NULL;
+    }
+#endif
+
+  return (FAR struct work_s *)dq_remfirst(&wqueue->q);
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -94,7 +197,7 @@
 
 void work_process(FAR struct kwork_wqueue_s *wqueue, systime_t period, int wndx)
 {
-  volatile FAR struct work_s *work;
+  FAR struct work_s *work;
   worker_t  worker;
   irqstate_t flags;
   FAR void *arg;
@@ -115,102 +218,85 @@ void work_process(FAR struct kwork_wqueue_s *wqueue, systime_t period, int wndx)
 
   stick = clock_systimer();
 
-  /* And check each entry in the work queue.  Since we have disabled
-   * interrupts we know:  (1) we will not be suspended unless we do
-   * so ourselves, and (2) there will be no changes to the work queue
+  /* Perform all of the work that is ready to run.  Since we have disabled
+   * interrupts we know:  (1) we will not be suspended unless we do so
+   * ourselves, and (2) there will be no changes to the work queue.
    */
 
-  work = (FAR struct work_s *)wqueue->q.head;
-  while (work)
+  for (; ; )
     {
-      /* Is this work ready?  It is ready if there is no delay or if
-       * the delay has elapsed. qtime is the time that the work was added
-       * to the work queue.  It will always be greater than or equal to
-       * zero.  Therefore a delay of zero will always execute immediately.
+      /* First, move any delayed work that has become ready to the ready
+       * queue.
        */
 
-      ctick   = clock_systimer();
-      elapsed = ctick - work->qtime;
-      if (elapsed >= work->delay)
-        {
-          /* Remove the ready-to-execute work from the list */
+      ctick = clock_systimer();
+      work_expire(wqueue, ctick);
 
-          (void)dq_rem((struct dq_entry_s *)work, &wqueue->q);
+      /* Then take the work at the head of the ready queue */
 
-          /* Extract the work description from the entry (in case the work
-           * instance by the re-used after it has been de-queued).
-           */
+      work = work_next(wqueue, wndx);
+      if (work == NULL)
+        {
+          break;
+        }
 
-          worker = work->worker;
+#ifdef CONFIG_SCHED_WORKSTATS
+      /* Update the statistics for this queue */
 
-          /* Check for a race condition where the work may be nullified
-           * before it is removed from the queue.
-           */
+      elapsed = ctick - work->qtime;
+      if (elapsed > wqueue->stats.maxlatency)
+        {
+          wqueue->stats.maxlatency = elapsed;
+        }
 
-          if (worker != NULL)
-            {
-              /* Extract the work argument (before re-enabling interrupts) */
+      wqueue->stats.totlatency += elapsed;
+      wqueue->stats.nready--;
+      wqueue->stats.nrun++;
+#endif
 
-              arg = work->arg;
+      /* Extract the work description from the entry (in case the work
+       * instance by the re-used after it has been de-queued).
+       */
 
-              /* Mark the work as no longer being queued */
+      worker = work->worker;
 
-              work->worker = NULL;
+      /* Check for a race condition where the work may be nullified
+       * before it is removed from the queue.
+       */
 
-              /* Do the work.  Re-enable interrupts while the work is being
-               * performed... we don't have any idea how long this will take!
-               */
+      if (worker != NULL)
+        {
+          /* Extract the work argument (before re-enabling interrupts) */
 
-              leave_critical_section(flags);
-              worker(arg);
+          arg = work->arg;
 
-              /* Now, unfortunately, since we re-enabled interrupts we don't
-               * know the state of the work list and we will have to start
-               * back at the head of the list.
-               */
+          /* Mark the work as no longer being queued */
 
-              flags = enter_critical_section();
-              work  = (FAR struct work_s *)wqueue->q.head;
-            }
-          else
-            {
-              /* Cancelled.. Just move to the next work in the list with
-               * interrupts still disabled.
-               */
+          work->worker = NULL;
 
-              work = (FAR struct work_s *)work->dq.flink;
-            }
-        }
-      else /* elapsed < work->delay */
-        {
-          /* This one is not ready.
-           *
-           * NOTE that elapsed is relative to the the current time,
-           * not the time of beginning of this queue processing pass.
-           * So it may need an adjustment.
+          /* Do the work.  Re-enable interrupts while the work is being
+           * performed... we don't have any idea how long this will take!
            */
 
-          elapsed += (ctick - stick);
-          if (elapsed > work->delay)
-            {
-              /* The delay has expired while we are processing */
-
-              elapsed = work->delay;
-            }
-
-          /* Will it be ready before the next scheduled wakeup interval? */
-
-          remaining = work->delay - elapsed;
-          if (remaining < next)
-            {
-              /* Yes.. Then schedule to wake up when the work is ready */
+          leave_critical_section(flags);
+          worker(arg);
+          flags = enter_critical_section();
+        }
+    }
 
-              next = remaining;
-            }
+  /* Will the next delayed work be ready before the next scheduled wakeup
+   * interval?  Only the head of the delayed work queue needs to be checked.
+   */
 
-          /* Then try the next in the list. */
+  work = (FAR struct work_s *)wqueue->delayq.head;
+  if (work != NULL)
+    {
+      remaining = WORK_REMAINING(work, clock_systimer());
+      if (remaining < next)
+        {
+          /* Yes.. Then schedule to wake up when the work is ready */
 
-          work = (FAR struct work_s *)work->dq.flink;
+          next = remaining;
         }
     }
 
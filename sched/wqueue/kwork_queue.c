@@ -1,7 +1,7 @@
 /****************************************************************************
  * sched/wqueue/kwork_queue.c
  *
- *   Copyright (C) 2014, 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014, 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -49,6 +49,7 @@
 #include <nuttx/clock.h>
 #include <nuttx/wqueue.h>
 
+#include "sched/sched.h"
 #include "wqueue/wqueue.h"
 
 #ifdef CONFIG_SCHED_WORKQUEUE
@@ -108,7 +109,50 @@ static void work_qqueue(FAR struct kwork_wqueue_s *wqueue,
 
   work->qtime  = clock_systimer(); /* Time work queued */
 
-  dq_addlast((FAR dq_entry_t *)work, &wqueue->q);
+  if (delay == 0)
+    {
+      /* The work is ready to run now */
+
+      dq_addlast((FAR dq_entry_t *)work, WORK_READYQ(wqueue, work));
+#ifdef CONFIG_SCHED_WORKSTATS
+      wqueue->stats.nready++;
+#endif
+    }
+  else
+    {
+      FAR struct work_s *curr;
+
+      /* Insert the work into the delayed work queue, ordered by the time
+       * of expiration.  Work is typically queued with similar delays, so
+       * search backward from the tail of the queue.  Work with the same
+       * expiration time stays in FIFO order.
+       */
+
+      for (curr  = (FAR struct work_s *)wqueue->delayq.tail;
+           curr != NULL && WORK_REMAINING(curr, work->qtime) > delay;
+           curr  = (FAR struct work_s *)curr->dq.blink);
+
+      if (curr == NULL)
+        {
+          dq_addfirst((FAR dq_entry_t *)work, &wqueue->delayq);
+        }
+      else
+        {
+          dq_addafter((FAR dq_entry_t *)curr, (FAR dq_entry_t *)work,
+                      &wqueue->delayq);
+        }
+
+#ifdef CONFIG_SCHED_WORKSTATS
+      wqueue->stats.ndelayed++;
+#endif
+    }
+
+#ifdef CONFIG_SCHED_WORKSTATS
+  if (wqueue->stats.nready + wqueue->stats.ndelayed > wqueue->stats.maxdepth)
+    {
+      wqueue->stats.maxdepth = wqueue->stats.nready + wqueue->stats.ndelayed;
+    }
+#endif
 
   leave_critical_section(flags);
 }
@@ -146,8 +190,40 @@ static void work_qqueue(FAR struct kwork_wqueue_s *wqueue,
  *
  ****************************************************************************/
 
+#ifdef CONFIG_SCHED_LPWORK_PERCPU
 int work_queue(int qid, FAR struct work_s *work, worker_t worker,
                FAR void *arg, systime_t delay)
+{
+  return work_queue_cpu(qid, work, worker, arg, delay, -1);
+}
+
+/****************************************************************************
+ * Name: work_queue_cpu
+ *
+ * Description:
+ *   Queue kernel-mode work to be performed at a later time, preferably on
+ *   the CPU 'cpu'.  See work_queue().
+ *
+ * Input parameters:
+ *   qid    - The work queue ID (index)
+ *   work   - The work structure to queue
+ *   worker - The worker callback to be invoked.
+ *   arg    - The argument that will be passed to the worker callback.
+ *   delay  - Delay (in clock ticks) from the time queue until the worker
+ *            is invoked. Zero means to perform the work immediately.
+ *   cpu    - The preferred CPU, or -1 to use the current CPU.
+ *
+ * Returned Value:
+ *   Zero on success, a negated errno on failure
+ *
+ ****************************************************************************/
+
+int work_queue_cpu(int qid, FAR struct work_s *work, worker_t worker,
+                   FAR void *arg, systime_t delay, int cpu)
+#else
+int work_queue(int qid, FAR struct work_s *work, worker_t worker,
+               FAR void *arg, systime_t delay)
+#endif
 {
 #ifdef CONFIG_SCHED_HPWORK
   if (qid == HPWORK)
@@ -162,10 +238,26 @@ int work_queue(int qid, FAR struct work_s *work, worker_t worker,
 #ifdef CONFIG_SCHED_LPWORK
   if (qid == LPWORK)
     {
+#ifdef CONFIG_SCHED_LPWORK_PERCPU
+      /* Select the CPU whose ready queue will receive the work */
+
+      if (cpu < 0 || cpu >= CONFIG_SMP_NCPUS)
+        {
+          cpu = this_cpu();
+        }
+
+      work->cpu = cpu;
+
+      /* Queue low priority work and wake up a worker on that CPU */
+
+      work_qqueue((FAR struct kwork_wqueue_s *)&g_lpwork, work, worker, arg, delay);
+      return work_lpsignal(cpu);
+#else
       /* Queue low priority work */
 
       work_qqueue((FAR struct kwork_wqueue_s *)&g_lpwork, work, worker, arg, delay);
       return work_signal(LPWORK);
+#endif
     }
   else
 #endif
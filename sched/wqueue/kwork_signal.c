@@ -1,7 +1,7 @@
 /****************************************************************************
  * sched/wqueue/work_signal.c
  *
- *   Copyright (C) 2014, 2016 Gregory Nutt. All rights reserved.
+ *   Copyright (C) 2014, 2016-2017 Gregory Nutt. All rights reserved.
  *   Author: Gregory Nutt <gnutt@nuttx.org>
  *
  * Redistribution and use in source and binary forms, with or without
@@ -52,6 +52,82 @@
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: work_lpsignal
+ *
+ * Description:
+ *   Wake up an idle low-priority worker thread, preferring one that is
+ *   bound to 'cpu'.
+ *
+ * Input parameters:
+ *   cpu - The preferred CPU, or -1 if any worker thread will do
+ *
+ * Returned Value:
+ *   Zero on success, a negated errno on failure
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_LPWORK
+int work_lpsignal(int cpu)
+{
+  int ret;
+  int i;
+
+  /* Find an IDLE worker thread */
+
+  for (i = 0; i < CONFIG_SCHED_LPNTHREADS; i++)
+    {
+      /* Is this worker thread busy? */
+
+      if (!g_lpwork.worker[i].busy)
+        {
+          /* No.. select this thread */
+
+          break;
+        }
+    }
+
+#ifdef CONFIG_SCHED_LPWORK_PERCPU
+  /* Prefer an IDLE worker thread that is bound to the requested CPU.  That
+   * thread will find the work on its own CPU's ready queue.  Any other IDLE
+   * thread will have to steal the work.
+   */
+
+  if (cpu >= 0)
+    {
+      int j;
+
+      for (j = cpu; j < CONFIG_SCHED_LPNTHREADS; j += CONFIG_SMP_NCPUS)
+        {
+          if (!g_lpwork.worker[j].busy)
+            {
+              i = j;
+              break;
+            }
+        }
+    }
+#endif
+
+  /* If all of the IDLE threads are busy, then just return successfully */
+
+  if (i >= CONFIG_SCHED_LPNTHREADS)
+    {
+      return OK;
+    }
+
+  /* Otherwise, signal the selected IDLE thread */
+
+  ret = kill(g_lpwork.worker[i].pid, SIGWORK);
+  if (ret < 0)
+    {
+      int errcode = errno;
+      return -errcode;
+    }
+
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: work_signal
  *
@@ -85,32 +161,7 @@ int work_signal(int qid)
 #ifdef CONFIG_SCHED_LPWORK
   if (qid == LPWORK)
     {
-      int i;
-
-      /* Find an IDLE worker thread */
-
-      for (i = 0; i < CONFIG_SCHED_LPNTHREADS; i++)
-        {
-          /* Is this worker thread busy? */
-
-          if (!g_lpwork.worker[i].busy)
-            {
-              /* No.. select this thread */
-
-              break;
-            }
-        }
-
-      /* If all of the IDLE threads are busy, then just return successfully */
-
-      if (i >= CONFIG_SCHED_LPNTHREADS)
-        {
-          return OK;
-        }
-
-      /* Otherwise, signal the first IDLE thread found */
-
-      pid = g_lpwork.worker[i].pid;
+      return work_lpsignal(-1);
     }
   else
 #endif
@@ -47,6 +47,7 @@
 #include <queue.h>
 
 #include <nuttx/clock.h>
+#include <nuttx/wqueue.h>
 
 #ifdef CONFIG_SCHED_WORKQUEUE
 
@@ -59,6 +60,22 @@
 #define HPWORKNAME "hpwork"
 #define LPWORKNAME "lpwork"
 
+/* Return the number of clock ticks remaining before delayed work 'w' is
+ * ready to run at time 'now'.
+ */
+
+#define WORK_REMAINING(w,now) \
+  (((now) - (w)->qtime) >= (w)->delay ? 0 : (w)->delay - ((now) - (w)->qtime))
+
+/* Return the ready queue that receives work 'w' from work queue 'wq' */
+
+#ifdef CONFIG_SCHED_LPWORK_PERCPU
+#  define WORK_READYQ(wq,w) \
+  ((wq)->cpuq != NULL ? &(wq)->cpuq[(w)->cpu] : &(wq)->q)
+#else
+#  define WORK_READYQ(wq,w) (&(wq)->q)
+#endif
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
@@ -75,7 +92,14 @@ struct kworker_s
 struct kwork_wqueue_s
 {
   systime_t         delay;     /* Delay between polling cycles (ticks) */
-  struct dq_queue_s q;         /* The queue of pending work */
+  struct dq_queue_s q;         /* The queue of work that is ready to run */
+  struct dq_queue_s delayq;    /* Delayed work, ordered by expiration */
+#ifdef CONFIG_SCHED_WORKSTATS
+  struct work_stats_s stats;   /* Work queue statistics */
+#endif
+#ifdef CONFIG_SCHED_LPWORK_PERCPU
+  FAR struct dq_queue_s *cpuq; /* Per-CPU ready queues (LPWORK only) */
+#endif
   struct kworker_s  worker[1]; /* Describes a worker thread */
 };
 
@@ -87,7 +111,14 @@ struct kwork_wqueue_s
 struct hp_wqueue_s
 {
   systime_t         delay;     /* Delay between polling cycles (ticks) */
-  struct dq_queue_s q;         /* The queue of pending work */
+  struct dq_queue_s q;         /* The queue of work that is ready to run */
+  struct dq_queue_s delayq;    /* Delayed work, ordered by expiration */
+#ifdef CONFIG_SCHED_WORKSTATS
+  struct work_stats_s stats;   /* Work queue statistics */
+#endif
+#ifdef CONFIG_SCHED_LPWORK_PERCPU
+  FAR struct dq_queue_s *cpuq; /* Per-CPU ready queues (LPWORK only) */
+#endif
   struct kworker_s  worker[1]; /* Describes the single high priority worker */
 };
 #endif
@@ -99,8 +130,15 @@ struct hp_wqueue_s
 #ifdef CONFIG_SCHED_LPWORK
 struct lp_wqueue_s
 {
-  systime_t         delay;  /* Delay between polling cycles (ticks) */
-  struct dq_queue_s q;      /* The queue of pending work */
+  systime_t         delay;     /* Delay between polling cycles (ticks) */
+  struct dq_queue_s q;         /* The queue of work that is ready to run */
+  struct dq_queue_s delayq;    /* Delayed work, ordered by expiration */
+#ifdef CONFIG_SCHED_WORKSTATS
+  struct work_stats_s stats;   /* Work queue statistics */
+#endif
+#ifdef CONFIG_SCHED_LPWORK_PERCPU
+  FAR struct dq_queue_s *cpuq; /* Per-CPU ready queues (LPWORK only) */
+#endif
 
   /* Describes each thread in the low priority queue's thread pool */
 
@@ -187,5 +225,24 @@ int work_lpstart(void);
 
 void work_process(FAR struct kwork_wqueue_s *wqueue, systime_t period, int wndx);
 
+/****************************************************************************
+ * Name: work_lpsignal
+ *
+ * Description:
+ *   Wake up an idle low-priority worker thread, preferring one that is
+ *   bound to 'cpu'.
+ *
+ * Input parameters:
+ *   cpu - The preferred CPU, or -1 if any worker thread will do
+ *
+ * Returned Value:
+ *   Zero on success, a negated errno on failure
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_LPWORK
+int work_lpsignal(int cpu);
+#endif
+
 #endif /* CONFIG_SCHED_WORKQUEUE */
 #endif /* __SCHED_WQUEUE_WQUEUE_H */
@@ -252,8 +252,8 @@ SYSCALL_LOOKUP(up_assert,                  2, STUB_up_assert)
   SYSCALL_LOOKUP(sched_getstreams,         0, STUB_sched_getstreams)
 #  endif
 
-#  if defined(CONFIG_NET_SENDFILE)
-  SYSCALL_LOOKUP(sendfile,                 4, STUB_fs_sendifile)
+#  if defined(CONFIG_FS_SENDFILE)
+  SYSCALL_LOOKUP(sendfile,                 4, STUB_sendfile)
 #  endif
 
 #  if !defined(CONFIG_DISABLE_MOUNTPOINT)
@@ -371,6 +371,9 @@ SYSCALL_LOOKUP(up_assert,                  2, STUB_up_assert)
   SYSCALL_LOOKUP(sendto,                   6, STUB_sendto)
   SYSCALL_LOOKUP(setsockopt,               5, STUB_setsockopt)
   SYSCALL_LOOKUP(socket,                   3, STUB_socket)
+#  ifdef CONFIG_NET_LOCAL_DIRECT
+  SYSCALL_LOOKUP(socketpair,               4, STUB_socketpair)
+#  endif
 #endif
 
 /* The following is defined only if CONFIG_TASK_NAME_SIZE > 0 */
@@ -0,0 +1,609 @@
+/****************************************************************************
+ * tools/note2trace.c
+ *
+ *   Copyright (C) 2017 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* These must agree with include/nuttx/sched_note.h */
+
+#define STREAM_MAGIC         "NXNT"
+#define STREAM_VERSION       1
+#define STREAM_SMP           (1 << 0)
+#define STREAM_HDRSIZE       8
+
+#define NOTE_START           0
+#define NOTE_STOP            1
+#define NOTE_SUSPEND         2
+#define NOTE_RESUME          3
+#define NOTE_CPU_START       4
+#define NOTE_CPU_STARTED     5
+#define NOTE_CPU_PAUSE       6
+#define NOTE_CPU_PAUSED      7
+#define NOTE_CPU_RESUME      8
+#define NOTE_CPU_RESUMED     9
+#define NOTE_PREEMPT_LOCK    10
+#define NOTE_PREEMPT_UNLOCK  11
+#define NOTE_CSECTION_ENTER  12
+#define NOTE_CSECTION_LEAVE  13
+#define NOTE_SPINLOCK_LOCK   14
+#define NOTE_SPINLOCK_LOCKED 15
+#define NOTE_SPINLOCK_UNLOCK 16
+#define NOTE_SPINLOCK_ABORT  17
+#define NOTE_IRQ_ENTER       18
+#define NOTE_IRQ_LEAVE       19
+#define NOTE_DROPPED         20
+#define NTYPES               21
+
+#define MAX_CPUS             32
+#define MAX_PIDS             65536
+
+/* Each CPU is shown as a process with three tracks (threads):  The task
+ * running on the CPU, the interrupt handlers, and spinlock waits.
+ */
+
+#define TRACK_TASK           0
+#define TRACK_IRQ            1
+#define TRACK_SPIN           2
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct note_s
+{
+  uint8_t  length;
+  uint8_t  type;
+  uint8_t  priority;
+  uint8_t  cpu;
+  unsigned int pid;
+  uint64_t time;                /* Unwrapped time in microseconds */
+  const uint8_t *data;          /* Type-specific data following the header */
+  unsigned int datalen;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const char *g_notename[NTYPES] =
+{
+  "start", "stop", "suspend", "resume",
+  "cpu start", "cpu started", "cpu pause", "cpu paused",
+  "cpu resume", "cpu resumed", "preempt lock", "preempt unlock",
+  "csection enter", "csection leave", "spinlock", "spinlocked",
+  "spinunlock", "spinabort", "irq enter", "irq leave", "dropped"
+};
+
+static FILE *g_outstream;
+static bool g_first = true;
+static bool g_smp;
+static unsigned int g_ncpus;
+static unsigned int g_ptrsize;
+static unsigned int g_hdrsize;
+
+static char *g_taskname[MAX_PIDS];
+static bool g_running[MAX_CPUS];
+static bool g_spinning[MAX_CPUS];
+static unsigned int g_irqnest[MAX_CPUS];
+
+static uint64_t g_time;
+static uint32_t g_lasttime;
+static bool g_havetime;
+
+static unsigned long g_nnotes;
+static unsigned long g_ndropped;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void show_usage(const char *progname, int exitcode)
+{
+  fprintf(stderr, "USAGE: %s [-h] [-o <outfile>] [<infile>]\n", progname);
+  fprintf(stderr, "\nWhere:\n");
+  fprintf(stderr, "  <infile>:\n");
+  fprintf(stderr, "    A binary note stream read from /dev/note.  Default: stdin\n");
+  fprintf(stderr, "  -o <outfile>:\n");
+  fprintf(stderr, "    The JSON trace file to create.  Default: stdout\n");
+  fprintf(stderr, "  -h:\n");
+  fprintf(stderr, "    Shows this message and exits\n");
+  exit(exitcode);
+}
+
+static uint32_t get_le16(const uint8_t *ptr)
+{
+  return (uint32_t)ptr[1] << 8 | (uint32_t)ptr[0];
+}
+
+static uint32_t get_le32(const uint8_t *ptr)
+{
+  return (uint32_t)ptr[3] << 24 | (uint32_t)ptr[2] << 16 |
+         (uint32_t)ptr[1] << 8  | (uint32_t)ptr[0];
+}
+
+/* Extend the 32-bit microsecond timestamps to 64-bits.  Notes from
+ * different CPUs may be slightly out of order so the difference is signed.
+ */
+
+static uint64_t unwrap_time(uint32_t systime)
+{
+  if (!g_havetime)
+    {
+      g_time     = systime;
+      g_havetime = true;
+    }
+  else
+    {
+      g_time += (int64_t)(int32_t)(systime - g_lasttime);
+    }
+
+  g_lasttime = systime;
+  return g_time;
+}
+
+static const char *task_name(unsigned int pid)
+{
+  static char buffer[16];
+
+  if (pid < MAX_PIDS && g_taskname[pid] != NULL)
+    {
+      return g_taskname[pid];
+    }
+
+  snprintf(buffer, sizeof(buffer), "pid %u", pid);
+  return buffer;
+}
+
+static void set_task_name(unsigned int pid, const uint8_t *name,
+                          unsigned int maxlen)
+{
+  char *copy;
+  unsigned int i;
+
+  if (pid >= MAX_PIDS)
+    {
+      return;
+    }
+
+  copy = malloc(maxlen + 1);
+  if (copy == NULL)
+    {
+      fprintf(stderr, "ERROR: Failed to allocate memory\n");
+      exit(EXIT_FAILURE);
+    }
+
+  /* Keep only characters that do not need to be escaped in JSON */
+
+  for (i = 0; i < maxlen && name[i] != '\0'; i++)
+    {
+      copy[i] = (name[i] >= ' ' && name[i] < 0x7f &&
+                 name[i] != '"' && name[i] != '\\') ? name[i] : '?';
+    }
+
+  copy[i] = '\0';
+
+  free(g_taskname[pid]);
+  g_taskname[pid] = copy;
+}
+
+/* Begin an event record in the "traceEvents" array */
+
+static void begin_event(const char *ph, unsigned int cpu, int track,
+                        uint64_t time)
+{
+  fprintf(g_outstream, "%s\n{\"ph\":\"%s\",\"pid\":%u,\"tid\":%u,"
+          "\"ts\":%llu", g_first ? "" : ",", ph, cpu, cpu * 3 + track,
+          (unsigned long long)time);
+  g_first = false;
+}
+
+static void slice_begin(struct note_s *note, int track, const char *name)
+{
+  begin_event("B", note->cpu, track, note->time);
+  fprintf(g_outstream, ",\"name\":\"%s\",\"args\":{\"pid\":%u,"
+          "\"priority\":%u}}", name, note->pid, note->priority);
+}
+
+static void slice_end(struct note_s *note, int track)
+{
+  begin_event("E", note->cpu, track, note->time);
+  fprintf(g_outstream, "}");
+}
+
+static void instant(struct note_s *note, int track, const char *name,
+                    const char *argname, unsigned long argval)
+{
+  begin_event("i", note->cpu, track, note->time);
+  fprintf(g_outstream, ",\"s\":\"t\",\"name\":\"%s\",\"args\":{\"pid\":%u",
+          name, note->pid);
+
+  if (argname != NULL)
+    {
+      fprintf(g_outstream, ",\"%s\":%lu", argname, argval);
+    }
+
+  fprintf(g_outstream, "}}");
+}
+
+static void metadata(unsigned int cpu, int track, const char *what,
+                     const char *name)
+{
+  fprintf(g_outstream, "%s\n{\"ph\":\"M\",\"pid\":%u,\"tid\":%u,"
+          "\"name\":\"%s\",\"args\":{\"name\":\"%s\"}}",
+          g_first ? "" : ",", cpu, cpu * 3 + track, what, name);
+  g_first = false;
+}
+
+static void emit_metadata(void)
+{
+  char name[32];
+  unsigned int cpu;
+
+  for (cpu = 0; cpu < g_ncpus; cpu++)
+    {
+      snprintf(name, sizeof(name), "CPU%u", cpu);
+      metadata(cpu, TRACK_TASK, "process_name", name);
+      metadata(cpu, TRACK_TASK, "thread_name", "Tasks");
+      metadata(cpu, TRACK_IRQ, "thread_name", "Interrupts");
+      metadata(cpu, TRACK_SPIN, "thread_name", "Spinlock waits");
+    }
+}
+
+/* Convert one note to trace events */
+
+static void convert_note(struct note_s *note)
+{
+  unsigned int cpu = note->cpu;
+  char name[48];
+
+  switch (note->type)
+    {
+      case NOTE_START:
+        set_task_name(note->pid, note->data, note->datalen);
+        instant(note, TRACK_TASK, "start", NULL, 0);
+        break;
+
+      case NOTE_STOP:
+      case NOTE_SUSPEND:
+        if (g_running[cpu])
+          {
+            slice_end(note, TRACK_TASK);
+            g_running[cpu] = false;
+          }
+        break;
+
+      case NOTE_RESUME:
+        if (g_running[cpu])
+          {
+            slice_end(note, TRACK_TASK);
+          }
+
+        slice_begin(note, TRACK_TASK, task_name(note->pid));
+        g_running[cpu] = true;
+        break;
+
+      case NOTE_IRQ_ENTER:
+        snprintf(name, sizeof(name), "irq %lu",
+                 note->datalen >= 2 ? (unsigned long)get_le16(note->data) :
+                 0ul);
+        slice_begin(note, TRACK_IRQ, name);
+        g_irqnest[cpu]++;
+        break;
+
+      case NOTE_IRQ_LEAVE:
+        if (g_irqnest[cpu] > 0)
+          {
+            slice_end(note, TRACK_IRQ);
+            g_irqnest[cpu]--;
+          }
+        break;
+
+      case NOTE_SPINLOCK_LOCK:
+        {
+          unsigned long addr = 0;
+          unsigned int offset;
+          int i;
+
+          /* The spinlock address follows the common header with the
+           * alignment of a pointer.
+           */
+
+          offset = ((g_hdrsize + g_ptrsize - 1) / g_ptrsize) * g_ptrsize -
+                   g_hdrsize;
+
+          if (offset + g_ptrsize <= note->datalen &&
+              g_ptrsize <= sizeof(unsigned long))
+            {
+              for (i = g_ptrsize - 1; i >= 0; i--)
+                {
+                  addr = addr << 8 | note->data[offset + i];
+                }
+            }
+
+          if (g_spinning[cpu])
+            {
+              slice_end(note, TRACK_SPIN);
+            }
+
+          snprintf(name, sizeof(name), "spinlock %#lx", addr);
+          slice_begin(note, TRACK_SPIN, name);
+          g_spinning[cpu] = true;
+        }
+        break;
+
+      case NOTE_SPINLOCK_LOCKED:
+      case NOTE_SPINLOCK_ABORT:
+        if (g_spinning[cpu])
+          {
+            slice_end(note, TRACK_SPIN);
+            g_spinning[cpu] = false;
+          }
+        break;
+
+      case NOTE_CPU_START:
+      case NOTE_CPU_PAUSE:
+      case NOTE_CPU_RESUME:
+        instant(note, TRACK_TASK, g_notename[note->type], "target",
+                note->datalen >= 1 ? note->data[0] : 0);
+        break;
+
+      case NOTE_PREEMPT_LOCK:
+      case NOTE_PREEMPT_UNLOCK:
+      case NOTE_CSECTION_ENTER:
+      case NOTE_CSECTION_LEAVE:
+        instant(note, TRACK_TASK, g_notename[note->type], "count",
+                note->datalen >= 2 ? get_le16(note->data) : 0);
+        break;
+
+      case NOTE_DROPPED:
+        {
+          unsigned long count =
+            note->datalen >= 4 ? get_le32(note->data) : 0;
+
+          g_ndropped += count;
+          instant(note, TRACK_TASK, "dropped", "count", count);
+        }
+        break;
+
+      default:
+        if (note->type < NTYPES)
+          {
+            instant(note, TRACK_TASK, g_notename[note->type], NULL, 0);
+          }
+        else
+          {
+            fprintf(stderr, "WARNING: Unrecognized note type %u\n",
+                    note->type);
+          }
+        break;
+    }
+}
+
+/* Close any slices that are still open at the end of the stream */
+
+static void close_slices(void)
+{
+  struct note_s note;
+  unsigned int cpu;
+
+  memset(&note, 0, sizeof(struct note_s));
+  note.time = g_time;
+
+  for (cpu = 0; cpu < g_ncpus; cpu++)
+    {
+      note.cpu = cpu;
+
+      if (g_running[cpu])
+        {
+          slice_end(&note, TRACK_TASK);
+        }
+
+      if (g_spinning[cpu])
+        {
+          slice_end(&note, TRACK_SPIN);
+        }
+
+      for (; g_irqnest[cpu] > 0; g_irqnest[cpu]--)
+        {
+          slice_end(&note, TRACK_IRQ);
+        }
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv, char **envp)
+{
+  uint8_t buffer[256];
+  struct note_s note;
+  const char *outfile = NULL;
+  FILE *instream;
+  size_t nread;
+  int option;
+
+  while ((option = getopt(argc, argv, ":ho:")) > 0)
+    {
+      switch (option)
+        {
+          case 'h':
+            show_usage(argv[0], EXIT_SUCCESS);
+            break;
+
+          case 'o':
+            outfile = optarg;
+            break;
+
+          case ':':
+            fprintf(stderr, "ERROR: Missing option argument, option: %c\n",
+                    optopt);
+            show_usage(argv[0], EXIT_FAILURE);
+            break;
+
+          default:
+            fprintf(stderr, "ERROR: Unrecognized option: %c\n", optopt);
+            show_usage(argv[0], EXIT_FAILURE);
+            break;
+        }
+    }
+
+  instream = stdin;
+  if (optind < argc)
+    {
+      if (optind + 1 < argc)
+        {
+          fprintf(stderr, "ERROR: Unexpected arguments after %s\n",
+                  argv[optind]);
+          show_usage(argv[0], EXIT_FAILURE);
+        }
+
+      instream = fopen(argv[optind], "rb");
+      if (instream == NULL)
+        {
+          fprintf(stderr, "ERROR: Failed to open %s: %s\n",
+                  argv[optind], strerror(errno));
+          exit(EXIT_FAILURE);
+        }
+    }
+
+  g_outstream = stdout;
+  if (outfile != NULL)
+    {
+      g_outstream = fopen(outfile, "w");
+      if (g_outstream == NULL)
+        {
+          fprintf(stderr, "ERROR: Failed to open %s: %s\n",
+                  outfile, strerror(errno));
+          exit(EXIT_FAILURE);
+        }
+    }
+
+  /* Read and verify the stream header */
+
+  if (fread(buffer, 1, STREAM_HDRSIZE, instream) != STREAM_HDRSIZE ||
+      memcmp(buffer, STREAM_MAGIC, 4) != 0)
+    {
+      fprintf(stderr, "ERROR: Not a note stream\n");
+      exit(EXIT_FAILURE);
+    }
+
+  if (buffer[4] != STREAM_VERSION)
+    {
+      fprintf(stderr, "ERROR: Unsupported stream version %u\n", buffer[4]);
+      exit(EXIT_FAILURE);
+    }
+
+  g_smp     = (buffer[5] & STREAM_SMP) != 0;
+  g_ncpus   = buffer[6];
+  g_ptrsize = buffer[7];
+  g_hdrsize = g_smp ? 10 : 9;
+
+  if (g_ncpus < 1 || g_ncpus > MAX_CPUS || g_ptrsize < 1)
+    {
+      fprintf(stderr, "ERROR: Bad stream header\n");
+      exit(EXIT_FAILURE);
+    }
+
+  fprintf(g_outstream, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+  emit_metadata();
+
+  /* Then convert each note */
+
+  while (fread(buffer, 1, 1, instream) == 1)
+    {
+      if (buffer[0] < g_hdrsize)
+        {
+          fprintf(stderr, "ERROR: Bad note length %u\n", buffer[0]);
+          break;
+        }
+
+      nread = fread(&buffer[1], 1, buffer[0] - 1, instream);
+      if (nread != buffer[0] - 1)
+        {
+          fprintf(stderr, "WARNING: Truncated note at end of stream\n");
+          break;
+        }
+
+      note.length   = buffer[0];
+      note.type     = buffer[1];
+      note.priority = buffer[2];
+      note.cpu      = g_smp ? buffer[3] : 0;
+      note.pid      = get_le16(&buffer[g_hdrsize - 6]);
+      note.time     = unwrap_time(get_le32(&buffer[g_hdrsize - 4]));
+      note.data     = &buffer[g_hdrsize];
+      note.datalen  = note.length - g_hdrsize;
+
+      if (note.cpu >= g_ncpus)
+        {
+          fprintf(stderr, "WARNING: Bad CPU %u\n", note.cpu);
+          continue;
+        }
+
+      convert_note(&note);
+      g_nnotes++;
+    }
+
+  close_slices();
+  fprintf(g_outstream, "\n]}\n");
+
+  fprintf(stderr, "%lu notes converted, %lu notes were dropped\n",
+          g_nnotes, g_ndropped);
+
+  if (instream != stdin)
+    {
+      fclose(instream);
+    }
+
+  if (g_outstream != stdout)
+    {
+      fclose(g_outstream);
+    }
+
+  return EXIT_SUCCESS;
+}